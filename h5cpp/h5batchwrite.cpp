@@ -0,0 +1,418 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "h5batchwrite.h"
+
+#include <functional>
+#include <iostream>
+#include <map>
+#include <numeric>
+
+#include "h5capi.h"
+#include "h5dispatch.h"
+#include "h5typemaps.h"
+#include "h5utils.h"
+#include "hidcloser.h"
+
+using std::cerr;
+using std::endl;
+
+using std::string;
+using std::vector;
+
+namespace h5 {
+
+using DataType = H5ReadWrite::DataType;
+
+namespace {
+
+// Paths are compared as strings, so "a/b/" and "/a/b" must be the same
+string normalizePath(const string& path)
+{
+  string result = path;
+  if (result.empty() || result[0] != '/')
+    result.insert(0, 1, '/');
+
+  while (result.size() > 1 && result.back() == '/')
+    result.pop_back();
+
+  return result;
+}
+
+string joinPath(const string& parent, const string& name)
+{
+  return parent == "/" ? parent + name : parent + "/" + name;
+}
+
+// Creates and opens the objects of one commit. Every object that it
+// opens stays open until the end of the commit, so that later operations
+// on the same path, or on its children, do not need to open it again.
+class BatchCommitter
+{
+public:
+  BatchCommitter(hid_t fileId, hid_t transferId)
+    : m_fileId(fileId), m_transferId(transferId)
+  {
+  }
+
+  // Open the group at a normalized path, creating it (and its parents)
+  // if it does not exist.
+  hid_t group(const string& path)
+  {
+    auto it = m_objects.find(path);
+    if (it != m_objects.end())
+      return it->second.value();
+
+    hid_t groupId;
+    if (path == "/") {
+      groupId = H5Gopen(m_fileId, "/", H5P_DEFAULT);
+    } else {
+      size_t slash = path.rfind('/');
+      string parentPath = slash == 0 ? "/" : path.substr(0, slash);
+      string name = path.substr(slash + 1);
+
+      hid_t parentId = group(parentPath);
+      if (parentId < 0)
+        return H5I_INVALID_HID;
+
+      if (H5Lexists(parentId, name.c_str(), H5P_DEFAULT) > 0) {
+        groupId = H5Gopen(parentId, name.c_str(), H5P_DEFAULT);
+      } else {
+        groupId = H5Gcreate(parentId, name.c_str(), H5P_DEFAULT,
+                            H5P_DEFAULT, H5P_DEFAULT);
+      }
+    }
+
+    if (groupId < 0) {
+      cerr << "Failed to open or create group: " << path << endl;
+      return H5I_INVALID_HID;
+    }
+
+    m_objects.emplace(path, HIDCloser(groupId, H5Gclose));
+    return groupId;
+  }
+
+  // Open the group or data set at a normalized path
+  hid_t object(const string& path)
+  {
+    auto it = m_objects.find(path);
+    if (it != m_objects.end())
+      return it->second.value();
+
+    hid_t objectId = H5Oopen(m_fileId, path.c_str(), H5P_DEFAULT);
+    if (objectId < 0) {
+      cerr << "Failed to open object: " << path << endl;
+      return H5I_INVALID_HID;
+    }
+
+    m_objects.emplace(path, HIDCloser(objectId, H5Oclose));
+    return objectId;
+  }
+
+  bool writeDataSet(const string& path, const string& name,
+                    const vector<int>& dims, DataType type, const void* data,
+                    const WriteOptions& options)
+  {
+    hid_t dataTypeId, memTypeId;
+    if (!h5TypeIds(type, dataTypeId, memTypeId))
+      return false;
+
+    // The values are narrowed by writeElements()
+    if (options.storeFloat16 && type == DataType::Float)
+      dataTypeId = BasicTypeToH5<float16>::dataTypeId();
+
+    hid_t groupId = group(path);
+    if (groupId < 0)
+      return false;
+
+    if (options.quantizeBits > 0 && type == DataType::Float && data) {
+      hid_t dataSetId = createQuantizedDataSet(
+        groupId, name, dims, static_cast<const float*>(data), m_transferId,
+        options);
+      if (dataSetId < 0)
+        return false;
+
+      // Keep it open for attributes that follow
+      m_objects.emplace(joinPath(path, name), HIDCloser(dataSetId, H5Dclose));
+      return true;
+    }
+
+    vector<hsize_t> h5dims(dims.begin(), dims.end());
+    size_t elementSize = H5Tget_size(dataTypeId);
+
+    // Only the chunked layout depends on the dimensions, so the property
+    // lists of the other layouts are shared by every data set that uses
+    // the default allocation.
+    HIDCloser ownCreate(H5I_INVALID_HID, H5Pclose);
+    hid_t createId;
+    auto layout = chooseLayout(h5dims, elementSize, options);
+    if (layout == WriteOptions::Layout::Chunked ||
+        options.allocation != WriteOptions::Allocation::Default ||
+        options.fillTime != WriteOptions::FillTime::Default) {
+      ownCreate = HIDCloser(
+        createDataSetPropertyList(h5dims, elementSize, options), H5Pclose);
+      createId = ownCreate.value();
+    } else {
+      createId = sharedCreationList(layout, h5dims, elementSize, options);
+    }
+
+    if (createId < 0)
+      return false;
+
+    hid_t dataSetId = createDataSet(groupId, name, dims, dataTypeId, createId);
+    if (dataSetId < 0)
+      return false;
+
+    // Keep it open for attributes that follow
+    m_objects.emplace(joinPath(path, name), HIDCloser(dataSetId, H5Dclose));
+
+    // Nothing to write to an empty data set
+    if (!data)
+      return true;
+
+    return writeElements(dataSetId, memTypeId, H5S_ALL, H5S_ALL,
+                         m_transferId, data);
+  }
+
+  bool writeAttribute(const string& path, const string& name, DataType type,
+                      const void* value)
+  {
+    hid_t objectId = object(path);
+    if (objectId < 0)
+      return false;
+
+    hid_t dataTypeId, memTypeId;
+    if (!h5TypeIds(type, dataTypeId, memTypeId)) {
+      cerr << "Failed to get H5 types for "
+           << H5ReadWrite::dataTypeToString(type) << "\n";
+      return false;
+    }
+
+    return h5::writeAttribute(objectId, name, dataTypeId, memTypeId, value);
+  }
+
+  bool writeStringAttribute(const string& path, const string& name,
+                            const string& value)
+  {
+    hid_t objectId = object(path);
+    if (objectId < 0)
+      return false;
+
+    if (!m_stringType.valueIsValid())
+      m_stringType = HIDCloser(createVariableStringType(), H5Tclose);
+
+    hid_t stringType = m_stringType.value();
+    if (stringType < 0)
+      return false;
+
+    // Variable-length strings are written from an array of pointers
+    const char* str = value.c_str();
+    return h5::writeAttribute(objectId, name, stringType, stringType, &str);
+  }
+
+private:
+  hid_t sharedCreationList(WriteOptions::Layout layout,
+                           const vector<hsize_t>& dims, size_t elementSize,
+                           const WriteOptions& options)
+  {
+    HIDCloser& createCloser = layout == WriteOptions::Layout::Compact
+                                ? m_compactCreate
+                                : m_contiguousCreate;
+    if (!createCloser.valueIsValid()) {
+      // Resolve the layout, so that the list does not depend on the size
+      WriteOptions resolved = options;
+      resolved.layout = layout;
+      createCloser = HIDCloser(
+        createDataSetPropertyList(dims, elementSize, resolved), H5Pclose);
+    }
+
+    return createCloser.value();
+  }
+
+  hid_t m_fileId;
+  hid_t m_transferId;
+  std::map<string, HIDCloser> m_objects;
+  HIDCloser m_compactCreate = HIDCloser(H5I_INVALID_HID, H5Pclose);
+  HIDCloser m_contiguousCreate = HIDCloser(H5I_INVALID_HID, H5Pclose);
+  HIDCloser m_stringType = HIDCloser(H5I_INVALID_HID, H5Tclose);
+};
+
+} // end namespace
+
+BatchWrite& BatchWrite::createGroup(const string& path)
+{
+  Operation operation;
+  operation.kind = Kind::Group;
+  operation.path = normalizePath(path);
+  m_operations.push_back(std::move(operation));
+  return *this;
+}
+
+template <typename T>
+BatchWrite& BatchWrite::writeData(const string& path, const string& name,
+                                  const vector<int>& dimensions,
+                                  const T* data, const WriteOptions& options)
+{
+  return writeData(path, name, dimensions, DataTypeOf<T>::value, data,
+                   options);
+}
+
+BatchWrite& BatchWrite::writeData(const string& path, const string& name,
+                                  const vector<int>& dimensions,
+                                  const DataType& type, const void* data,
+                                  const WriteOptions& options)
+{
+  Operation operation;
+  operation.kind = Kind::DataSet;
+  operation.path = normalizePath(path);
+  operation.name = name;
+  operation.dimensions = dimensions;
+  operation.options = options;
+
+  // The extended types have no dispatch(), but they have H5 types
+  hid_t dataTypeId, memTypeId;
+  bool valid = h5TypeIds(type, dataTypeId, memTypeId);
+  size_t elementSize = valid ? H5Tget_size(memTypeId) : 0;
+  for (int dim : dimensions)
+    valid = valid && dim >= 0;
+
+  size_t bytes = std::accumulate(dimensions.cbegin(), dimensions.cend(),
+                                 elementSize, std::multiplies<size_t>());
+
+  // Invalid data is recorded with the type None, and fails the validation
+  if (valid && (data || bytes == 0)) {
+    operation.type = type;
+    const unsigned char* begin = static_cast<const unsigned char*>(data);
+    if (bytes > 0)
+      operation.data.assign(begin, begin + bytes);
+  }
+
+  m_operations.push_back(std::move(operation));
+  return *this;
+}
+
+template <typename T>
+BatchWrite& BatchWrite::setAttribute(const string& path, const string& name,
+                                     T value)
+{
+  Operation operation;
+  operation.kind = Kind::Attribute;
+  operation.path = normalizePath(path);
+  operation.name = name;
+  operation.type = DataTypeOf<T>::value;
+
+  const unsigned char* begin = reinterpret_cast<const unsigned char*>(&value);
+  operation.data.assign(begin, begin + sizeof(T));
+
+  m_operations.push_back(std::move(operation));
+  return *this;
+}
+
+// Specialization for string
+template <>
+BatchWrite& BatchWrite::setAttribute<const string&>(const string& path,
+                                                    const string& name,
+                                                    const string& value)
+{
+  Operation operation;
+  operation.kind = Kind::Attribute;
+  operation.path = normalizePath(path);
+  operation.name = name;
+  operation.type = DataType::String;
+  operation.text = value;
+
+  m_operations.push_back(std::move(operation));
+  return *this;
+}
+
+template <>
+BatchWrite& BatchWrite::setAttribute<const char*>(const string& path,
+                                                  const string& name,
+                                                  const char* value)
+{
+  return setAttribute<const string&>(path, name, value);
+}
+
+bool BatchWrite::validate() const
+{
+  for (size_t i = 0; i < m_operations.size(); ++i) {
+    const Operation& operation = m_operations[i];
+    if (operation.kind != Kind::Group && operation.name.empty()) {
+      cerr << "Batch operation " << i << " on " << operation.path
+           << " has no name\n";
+      return false;
+    }
+
+    if (operation.kind != Kind::Group && operation.type == DataType::None) {
+      cerr << "Batch operation " << i << " on " << operation.path << "/"
+           << operation.name << " has invalid data\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool BatchWrite::commit(int64_t fileId, int64_t transferId) const
+{
+  // Nothing is written if any operation is invalid
+  if (!validate())
+    return false;
+
+  BatchCommitter committer(fileId, transferId);
+  for (const Operation& operation : m_operations) {
+    bool success = false;
+    switch (operation.kind) {
+      case Kind::Group:
+        success = committer.group(operation.path) >= 0;
+        break;
+      case Kind::DataSet:
+        success = committer.writeDataSet(
+          operation.path, operation.name, operation.dimensions,
+          operation.type,
+          operation.data.empty() ? nullptr : operation.data.data(),
+          operation.options);
+        break;
+      case Kind::Attribute:
+        if (operation.type == DataType::String) {
+          success = committer.writeStringAttribute(
+            operation.path, operation.name, operation.text);
+        } else {
+          success = committer.writeAttribute(operation.path, operation.name,
+                                             operation.type,
+                                             operation.data.data());
+        }
+        break;
+    }
+
+    if (!success) {
+      cerr << "Failed to commit the batch at " << operation.path;
+      if (!operation.name.empty())
+        cerr << " (" << operation.name << ")";
+      cerr << endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Instantiate our allowable templates here
+#define INSTANTIATE_BATCHWRITE_TEMPLATES(T, E)                                \
+  template BatchWrite& BatchWrite::writeData(const string&, const string&,    \
+                                             const vector<int>&, const T*,    \
+                                             const WriteOptions&);            \
+  template BatchWrite& BatchWrite::setAttribute(const string&,                \
+                                                const string&, T);
+
+H5CPP_FOR_EACH_BASIC_TYPE(INSTANTIATE_BATCHWRITE_TEMPLATES)
+H5CPP_FOR_EACH_EXTENDED_TYPE(INSTANTIATE_BATCHWRITE_TEMPLATES)
+
+#undef INSTANTIATE_BATCHWRITE_TEMPLATES
+
+template BatchWrite& BatchWrite::setAttribute(const string&, const string&,
+                                              const string&);
+template BatchWrite& BatchWrite::setAttribute(const string&, const string&,
+                                              const char*);
+
+} // namespace h5
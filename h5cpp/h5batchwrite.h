@@ -0,0 +1,112 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5BatchWrite_h
+#define tomvizH5BatchWrite_h
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "h5readwrite.h"
+#include "h5writeoptions.h"
+
+namespace h5 {
+
+/**
+ * Collects groups, data sets and attributes to be written to a file with
+ * H5ReadWrite::commit(), which writes them in the order they were added
+ * in a single pass. Missing intermediate groups are created as needed,
+ * parent groups are opened only once, and property lists are shared
+ * between data sets, which makes writing many small objects much faster
+ * than separate createGroup(), writeData() and setAttribute() calls.
+ *
+ * The data is copied when it is added, so the caller's buffers may be
+ * released before the commit.
+ */
+class BatchWrite
+{
+public:
+  using DataType = H5ReadWrite::DataType;
+
+  /**
+   * Create a group, and any missing groups above it.
+   * @param path The path to the group.
+   */
+  BatchWrite& createGroup(const std::string& path);
+
+  /**
+   * Create a data set and write data to it.
+   * @param path The path of the group of the data set. It is created if
+   *             it does not exist.
+   * @param name The name of the data set.
+   * @param dimensions The dimensions of the data.
+   * @param data The data to write.
+   * @param options How to lay out the data set.
+   */
+  template <typename T>
+  BatchWrite& writeData(const std::string& path, const std::string& name,
+                        const std::vector<int>& dimensions, const T* data,
+                        const WriteOptions& options = WriteOptions());
+
+  /**
+   * Create a data set and write data of type @p type to it.
+   */
+  BatchWrite& writeData(const std::string& path, const std::string& name,
+                        const std::vector<int>& dimensions,
+                        const DataType& type, const void* data,
+                        const WriteOptions& options = WriteOptions());
+
+  /**
+   * Set an attribute on a group or data set. The object may be created
+   * earlier in the same batch.
+   * @param path The path to the group or data set.
+   * @param name The name of the attribute.
+   * @param value The value of the attribute.
+   */
+  template <typename T>
+  BatchWrite& setAttribute(const std::string& path, const std::string& name,
+                           T value);
+
+  /** The number of operations in the batch */
+  size_t size() const { return m_operations.size(); }
+
+  /** Whether the batch has no operations */
+  bool empty() const { return m_operations.empty(); }
+
+  /** Remove all operations */
+  void clear() { m_operations.clear(); }
+
+private:
+  friend class H5ReadWrite;
+
+  enum class Kind {
+    Group,
+    DataSet,
+    Attribute
+  };
+
+  struct Operation
+  {
+    Kind kind;
+    std::string path;
+    std::string name;
+    DataType type = DataType::None;
+    std::vector<int> dimensions;
+    std::vector<unsigned char> data;
+    std::string text;
+    WriteOptions options;
+  };
+
+  // Check the whole batch before anything is written
+  bool validate() const;
+
+  // Write the batch into an open file
+  bool commit(int64_t fileId, int64_t transferId) const;
+
+  std::vector<Operation> m_operations;
+};
+
+} // namespace h5
+
+#endif // tomvizH5BatchWrite_h
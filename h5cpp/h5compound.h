@@ -0,0 +1,63 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5Compound_h
+#define tomvizH5Compound_h
+
+#include <string>
+#include <type_traits>
+
+#include "h5dispatch.h"
+#include "h5readwrite.h"
+
+namespace h5 {
+
+/**
+ * One member of a compound data set, stored as a contiguous column in
+ * memory with one element per record. Column is used for reads, and
+ * ConstColumn for writes. Use column() to make one from a typed pointer.
+ */
+template <typename Pointer>
+struct BasicColumn
+{
+  BasicColumn(const std::string& member_, H5ReadWrite::DataType type_,
+              Pointer data_)
+    : member(member_), type(type_), data(data_)
+  {
+  }
+
+  /** A Column converts to a ConstColumn, so it can be written too */
+  template <typename Other, typename = typename std::enable_if<
+                              std::is_convertible<Other, Pointer>::value>::type>
+  BasicColumn(const BasicColumn<Other>& other)
+    : member(other.member), type(other.type), data(other.data)
+  {
+  }
+
+  /** The name of the compound member */
+  std::string member;
+
+  /** The type of the elements of the column */
+  H5ReadWrite::DataType type;
+
+  /** The elements of the column */
+  Pointer data;
+};
+
+/** Make a column to read member @p member into */
+template <typename T>
+Column column(const std::string& member, T* data)
+{
+  return Column{ member, DataTypeOf<T>::value, data };
+}
+
+/** Make a column to write as member @p member */
+template <typename T>
+ConstColumn column(const std::string& member, const T* data)
+{
+  return ConstColumn{ member, DataTypeOf<T>::value, data };
+}
+
+} // namespace h5
+
+#endif // tomvizH5Compound_h
@@ -0,0 +1,398 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "h5compressiontuner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "h5capi.h"
+#include "h5dispatch.h"
+#include "h5filters.h"
+#include "h5typemaps.h"
+#include "h5utils.h"
+#include "hidcloser.h"
+
+using std::cerr;
+using std::endl;
+
+using std::string;
+using std::vector;
+
+using Clock = std::chrono::steady_clock;
+
+namespace h5 {
+
+using Compression = WriteOptions::Compression;
+using Goal = TuneOptions::Goal;
+
+namespace {
+
+size_t product(const vector<int>& dims)
+{
+  size_t result = 1;
+  for (int dim : dims)
+    result *= dim;
+  return result;
+}
+
+double secondsSince(Clock::time_point start)
+{
+  std::chrono::duration<double> elapsed = Clock::now() - start;
+  return std::max(elapsed.count(), 1e-9);
+}
+
+// Copy the block at @p start with @p counts out of a row-major array
+void copyBlock(const unsigned char* data, const vector<int>& dims,
+               const vector<int>& start, const vector<int>& counts,
+               size_t elementSize, unsigned char* block)
+{
+  const size_t rank = dims.size();
+  vector<size_t> strides(rank, 1);
+  for (size_t i = rank - 1; i > 0; --i)
+    strides[i - 1] = strides[i] * dims[i];
+
+  const size_t rowBytes = counts[rank - 1] * elementSize;
+  const size_t rows = product(counts) / std::max(counts[rank - 1], 1);
+  vector<int> index(rank, 0);
+  for (size_t row = 0; row < rows; ++row) {
+    size_t offset = start[rank - 1];
+    for (size_t i = 0; i + 1 < rank; ++i)
+      offset += (start[i] + index[i]) * strides[i];
+
+    std::memcpy(block + row * rowBytes, data + offset * elementSize,
+                rowBytes);
+
+    for (size_t i = rank - 1; i-- > 0;) {
+      if (++index[i] < counts[i])
+        break;
+      index[i] = 0;
+    }
+  }
+}
+
+// The chunk dimensions that @p options gives a data set
+vector<int> chunkDimensions(const vector<hsize_t>& dims, size_t elementSize,
+                            const WriteOptions& options)
+{
+  HIDCloser createCloser(
+    createDataSetPropertyList(dims, elementSize, options), H5Pclose);
+  if (!createCloser.valueIsValid())
+    return vector<int>();
+
+  vector<hsize_t> chunk(dims.size());
+  if (H5Pget_chunk(createCloser.value(), static_cast<int>(chunk.size()),
+                   chunk.data()) < 0) {
+    return vector<int>();
+  }
+
+  return vector<int>(chunk.begin(), chunk.end());
+}
+
+struct Measurement
+{
+  size_t storedBytes = 0;
+  double writeSeconds = 0;
+  double readSeconds = 0;
+};
+
+// Write the sample to a new in-memory file with @p options, and read
+// every slice of it back
+bool measure(const vector<unsigned char>& sample, const vector<int>& dims,
+             size_t elementSize, hid_t dataTypeId, hid_t memTypeId,
+             const WriteOptions& options, int axis, Measurement& result)
+{
+  // The core driver keeps the file in memory, under a name of its own
+  static std::atomic<unsigned> counter(0);
+  const string name = "h5cpp_tuner_" + std::to_string(counter++);
+
+  HIDCloser accessCloser(H5Pcreate(H5P_FILE_ACCESS), H5Pclose);
+  if (!accessCloser.valueIsValid() ||
+      H5Pset_fapl_core(accessCloser.value(), 1024 * 1024, false) < 0) {
+    cerr << "Failed to set up an in-memory file\n";
+    return false;
+  }
+
+  HIDCloser fileCloser(H5Fcreate(name.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT,
+                                 accessCloser.value()),
+                       H5Fclose);
+  if (!fileCloser.valueIsValid())
+    return false;
+
+  vector<hsize_t> h5dims(dims.begin(), dims.end());
+  Clock::time_point start = Clock::now();
+  {
+    HIDCloser createCloser(
+      createDataSetPropertyList(h5dims, elementSize, options), H5Pclose);
+    if (!createCloser.valueIsValid())
+      return false;
+
+    HIDCloser dataSetCloser(createDataSet(fileCloser.value(), "sample", dims,
+                                          dataTypeId, createCloser.value()),
+                            H5Dclose);
+    if (!dataSetCloser.valueIsValid() ||
+        H5Dwrite(dataSetCloser.value(), memTypeId, H5S_ALL, H5S_ALL,
+                 H5P_DEFAULT, sample.data()) < 0) {
+      return false;
+    }
+
+    // Closing the data set flushes the chunks left in its cache, which
+    // is part of the cost of writing
+  }
+  result.writeSeconds = secondsSince(start);
+
+  HIDCloser dataSetCloser(H5Dopen(fileCloser.value(), "sample", H5P_DEFAULT),
+                          H5Dclose);
+  if (!dataSetCloser.valueIsValid())
+    return false;
+
+  result.storedBytes = H5Dget_storage_size(dataSetCloser.value());
+
+  vector<hsize_t> sliceStart(dims.size(), 0);
+  vector<hsize_t> sliceCounts = h5dims;
+  sliceCounts[axis] = 1;
+  vector<unsigned char> slice(sample.size() / dims[axis]);
+
+  start = Clock::now();
+  for (int i = 0; i < dims[axis]; ++i) {
+    sliceStart[axis] = i;
+    if (!readHyperslab(dataSetCloser.value(), sliceStart, sliceCounts,
+                       memTypeId, H5P_DEFAULT, slice.data())) {
+      return false;
+    }
+  }
+  result.readSeconds = secondsSince(start);
+
+  return true;
+}
+
+// Whether @p a meets the goal better than @p b
+bool better(const Measurement& a, const Measurement& b, Goal goal)
+{
+  switch (goal) {
+    case Goal::Size:
+      if (a.storedBytes != b.storedBytes)
+        return a.storedBytes < b.storedBytes;
+      return a.writeSeconds < b.writeSeconds;
+    case Goal::WriteSpeed:
+      return a.writeSeconds < b.writeSeconds;
+    case Goal::SliceReadSpeed:
+      return a.readSeconds < b.readSeconds;
+  }
+  return false;
+}
+
+TuneResult tune(const void* data, const vector<int>& dims,
+                size_t elementSize, hid_t dataTypeId, hid_t memTypeId,
+                const TuneOptions& options)
+{
+  TuneResult result;
+  result.goal = options.goal;
+
+  if (dims.empty() || product(dims) == 0) {
+    cerr << "There is no data to tune the compression with\n";
+    return result;
+  }
+
+  const int rank = static_cast<int>(dims.size());
+  const int axis =
+    options.sliceAxis >= 0 && options.sliceAxis < rank ? options.sliceAxis
+                                                       : 0;
+
+  // The sample is a block from the middle of the data, of about
+  // sampleBytes, with the largest dimension halved until it fits
+  vector<int> sampleDims = dims;
+  while (product(sampleDims) * elementSize > options.sampleBytes) {
+    auto largest = std::max_element(sampleDims.begin(), sampleDims.end());
+    if (*largest <= 1)
+      break;
+
+    *largest = (*largest + 1) / 2;
+  }
+
+  vector<int> sampleStart(rank);
+  for (int i = 0; i < rank; ++i)
+    sampleStart[i] = (dims[i] - sampleDims[i]) / 2;
+
+  vector<unsigned char> sample(product(sampleDims) * elementSize);
+  copyBlock(static_cast<const unsigned char*>(data), dims, sampleStart,
+            sampleDims, elementSize, sample.data());
+
+  // The chunk shapes, chosen for the full data set
+  const vector<hsize_t> h5dims(dims.begin(), dims.end());
+  vector<vector<int>> chunks;
+  for (size_t bytes : options.chunkBytes) {
+    WriteOptions chunked;
+    chunked.layout = WriteOptions::Layout::Chunked;
+    chunked.sliceAxis = options.sliceAxis;
+    chunked.chunkBytes = bytes;
+    vector<int> chunk = chunkDimensions(h5dims, elementSize, chunked);
+    if (!chunk.empty() &&
+        std::find(chunks.begin(), chunks.end(), chunk) == chunks.end()) {
+      chunks.push_back(chunk);
+    }
+  }
+
+  // The codecs and levels
+  vector<std::pair<Compression, int>> codecs = { { Compression::None, 0 } };
+  if (compressionAvailable(Compression::Deflate)) {
+    codecs.emplace_back(Compression::Deflate, 1);
+    codecs.emplace_back(Compression::Deflate, 6);
+  }
+  if (compressionAvailable(Compression::LZ4))
+    codecs.emplace_back(Compression::LZ4, 0);
+  if (compressionAvailable(Compression::Zstd)) {
+    codecs.emplace_back(Compression::Zstd, 1);
+    codecs.emplace_back(Compression::Zstd, 3);
+    codecs.emplace_back(Compression::Zstd, 9);
+  }
+
+  Measurement best;
+  for (const auto& chunk : chunks) {
+    for (const auto& codec : codecs) {
+      for (int shuffle = 0; shuffle < 2; ++shuffle) {
+        // Shuffling needs compression, and elements of several bytes
+        if (shuffle &&
+            (codec.first == Compression::None || elementSize == 1)) {
+          continue;
+        }
+
+        WriteOptions candidate;
+        candidate.layout = WriteOptions::Layout::Chunked;
+        candidate.chunkDimensions = chunk;
+        candidate.compression = codec.first;
+        candidate.compressionLevel = codec.second;
+        candidate.shuffle = shuffle != 0;
+
+        Measurement measurement;
+        if (!measure(sample, sampleDims, elementSize, dataTypeId, memTypeId,
+                     candidate, axis, measurement)) {
+          continue;
+        }
+
+        if (!result.valid || better(measurement, best, options.goal)) {
+          result.valid = true;
+          result.options = candidate;
+          best = measurement;
+        }
+      }
+    }
+  }
+
+  if (!result.valid) {
+    cerr << "Failed to measure any compression candidate\n";
+    return result;
+  }
+
+  const double megabytes = sample.size() / 1e6;
+  result.sampleBytes = sample.size();
+  result.storedBytes = best.storedBytes;
+  result.ratio = static_cast<double>(sample.size()) /
+                 std::max<size_t>(best.storedBytes, 1);
+  result.writeMBps = megabytes / best.writeSeconds;
+  result.readMBps = megabytes / best.readSeconds;
+  return result;
+}
+
+const char* goalName(Goal goal)
+{
+  switch (goal) {
+    case Goal::Size:
+      return "size";
+    case Goal::WriteSpeed:
+      return "write speed";
+    case Goal::SliceReadSpeed:
+      return "slice read speed";
+  }
+  return "";
+}
+
+const char* codecName(Compression compression)
+{
+  switch (compression) {
+    case Compression::None:
+      return "none";
+    case Compression::Deflate:
+      return "deflate";
+    case Compression::LZ4:
+      return "lz4";
+    case Compression::Zstd:
+      return "zstd";
+  }
+  return "";
+}
+
+} // end namespace
+
+template <typename T>
+TuneResult tuneCompression(const T* data, const vector<int>& dimensions,
+                           const TuneOptions& options)
+{
+  return tune(data, dimensions, sizeof(T), BasicTypeToH5<T>::dataTypeId(),
+              BasicTypeToH5<T>::memTypeId(), options);
+}
+
+bool recordTuning(H5ReadWrite& file, const string& path,
+                  const TuneResult& result)
+{
+  if (!result.valid) {
+    cerr << "The tuning of " << path << " is not valid\n";
+    return false;
+  }
+
+  const WriteOptions& options = result.options;
+  return file.setAttribute(path, "tuning_goal", goalName(result.goal)) &&
+         file.setAttribute(path, "tuning_compression",
+                           codecName(options.compression)) &&
+         file.setAttribute(path, "tuning_compression_level",
+                           options.compressionLevel) &&
+         file.setAttribute(path, "tuning_shuffle",
+                           static_cast<int>(options.shuffle)) &&
+         file.setAttribute(
+           path, "tuning_sample_bytes",
+           static_cast<unsigned long long>(result.sampleBytes)) &&
+         file.setAttribute(path, "tuning_ratio", result.ratio) &&
+         file.setAttribute(path, "tuning_write_mbps", result.writeMBps) &&
+         file.setAttribute(path, "tuning_read_mbps", result.readMBps);
+}
+
+template <typename T>
+bool writeTuned(H5ReadWrite& file, const string& path, const string& name,
+                const vector<int>& dimensions, const T* data,
+                const TuneOptions& options, TuneResult* result)
+{
+  TuneResult tuning = tuneCompression(data, dimensions, options);
+  if (result)
+    *result = tuning;
+
+  if (!tuning.valid) {
+    cerr << "Failed to tune the compression of " << name << endl;
+    return false;
+  }
+
+  if (!file.writeData(path, name, dimensions, data, tuning.options))
+    return false;
+
+  string dataSetPath = path;
+  if (dataSetPath.empty() || dataSetPath.back() != '/')
+    dataSetPath += '/';
+
+  return recordTuning(file, dataSetPath + name, tuning);
+}
+
+// Instantiate our allowable templates here
+#define INSTANTIATE_TUNER_TEMPLATES(T, E)                                      \
+  template TuneResult tuneCompression(const T*, const vector<int>&,            \
+                                      const TuneOptions&);                     \
+  template bool writeTuned(H5ReadWrite&, const string&, const string&,         \
+                           const vector<int>&, const T*, const TuneOptions&,   \
+                           TuneResult*);
+
+H5CPP_FOR_EACH_BASIC_TYPE(INSTANTIATE_TUNER_TEMPLATES)
+
+#undef INSTANTIATE_TUNER_TEMPLATES
+
+} // namespace h5
@@ -0,0 +1,107 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5CompressionTuner_h
+#define tomvizH5CompressionTuner_h
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "h5readwrite.h"
+#include "h5writeoptions.h"
+
+namespace h5 {
+
+/** What tuneCompression() optimizes for, and how it samples the data */
+struct TuneOptions
+{
+  /** Enumeration of the goals */
+  enum class Goal {
+    Size,          // The smallest data set
+    WriteSpeed,    // The fastest writes
+    SliceReadSpeed // The fastest reads of single slices along sliceAxis
+  };
+
+  Goal goal = Goal::Size;
+
+  /**
+   * The axis along which the data set will be read one slice at a time,
+   * or -1 if unknown. It is used as the hint for the chunk shapes, and
+   * SliceReadSpeed reads slices along it (or along axis 0 if unknown).
+   */
+  int sliceAxis = -1;
+
+  /** The most bytes of the data that are compressed for each candidate */
+  size_t sampleBytes = 8 * 1024 * 1024;
+
+  /** The chunk sizes in bytes to try, see WriteOptions::chunkBytes */
+  std::vector<size_t> chunkBytes = { 64 * 1024, 256 * 1024, 1024 * 1024 };
+};
+
+/** The choice of tuneCompression(), and what was measured for it */
+struct TuneResult
+{
+  /** False if nothing could be measured, such as for empty data */
+  bool valid = false;
+
+  TuneOptions::Goal goal = TuneOptions::Goal::Size;
+
+  /** The chosen chunks and compression, to pass to writeData() */
+  WriteOptions options;
+
+  /** The size of the sample, and its size once written */
+  size_t sampleBytes = 0;
+  size_t storedBytes = 0;
+
+  /** sampleBytes / storedBytes */
+  double ratio = 0;
+
+  /** The rates of writing and of reading all slices, in MB/s of data */
+  double writeMBps = 0;
+  double readMBps = 0;
+};
+
+/**
+ * Find the chunk shape and compression that best meet a goal for a
+ * buffer. A block from the middle of the buffer, of at most
+ * TuneOptions::sampleBytes, is written to an in-memory file with every
+ * candidate: each chunk size, without compression, and with each
+ * available codec at a few levels, with and without the byte shuffle.
+ * The write time, the stored size and the time to read every slice are
+ * measured, and the best candidate for the goal is chosen. The chunk
+ * dimensions are chosen for the full dimensions.
+ * @param data The data, with the first dimension slowest.
+ * @param dimensions The dimensions of the data.
+ * @param options The goal and the sampling.
+ * @return The choice. It is invalid on failure.
+ */
+template <typename T>
+TuneResult tuneCompression(const T* data, const std::vector<int>& dimensions,
+                           const TuneOptions& options = TuneOptions());
+
+/**
+ * Record a choice of tuneCompression() as attributes of a data set:
+ * tuning_goal, tuning_compression, tuning_compression_level,
+ * tuning_shuffle, tuning_sample_bytes, tuning_ratio, tuning_write_mbps and
+ * tuning_read_mbps.
+ * @return True on success, false on failure.
+ */
+bool recordTuning(H5ReadWrite& file, const std::string& path,
+                  const TuneResult& result);
+
+/**
+ * Tune the compression of @p data, write it with the choice, and record
+ * the choice on the new data set.
+ * @param result If used, set to the choice.
+ * @return True on success, false on failure.
+ */
+template <typename T>
+bool writeTuned(H5ReadWrite& file, const std::string& path,
+                const std::string& name, const std::vector<int>& dimensions,
+                const T* data, const TuneOptions& options = TuneOptions(),
+                TuneResult* result = nullptr);
+
+} // namespace h5
+
+#endif // tomvizH5CompressionTuner_h
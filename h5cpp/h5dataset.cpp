@@ -0,0 +1,444 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "h5dataset.h"
+
+#include <iostream>
+#include <type_traits>
+
+#include "h5capi.h"
+#include "h5dispatch.h"
+#include "h5typemaps.h"
+#include "h5utils.h"
+#include "hidcloser.h"
+
+using std::cerr;
+using std::endl;
+
+using std::string;
+using std::vector;
+
+static_assert(std::is_same<hid_t, int64_t>::value,
+              "DataSet and Group expect hid_t to be int64_t (HDF5 >= 1.10)");
+
+namespace {
+
+// Just a convenience function. Only sets "ok" if it is not nullptr.
+void setOk(bool* ok, bool status)
+{
+  if (ok)
+    *ok = status;
+}
+
+} // end namespace
+
+namespace h5 {
+
+class DataSet::DataSetImpl {
+public:
+  DataSetImpl(hid_t dataSetId, hid_t transferId, const string& path)
+    : m_dataSet(dataSetId, H5Dclose),
+      m_type(H5Dget_type(dataSetId), H5Tclose),
+      m_transfer(transferId, H5Pclose),
+      m_path(path)
+  {
+    if (!m_type.valueIsValid()) {
+      cerr << "Failed to get the type of " << path << endl;
+      return;
+    }
+
+    m_dataType = h5ToDataType(m_type.value());
+
+    loadDimensions();
+  }
+
+  bool loadDimensions()
+  {
+    vector<hsize_t> dims;
+    if (!dataSetDimensions(m_dataSet.value(), dims)) {
+      m_dims.clear();
+      return false;
+    }
+
+    m_dims.assign(dims.begin(), dims.end());
+    return true;
+  }
+
+  // The type was classified when the data set was opened
+  bool typeMatches(DataType expected)
+  {
+    // Quantized data sets are restored as they are read as float
+    Quantization unused;
+    if (!readableAs(m_dataType, expected) &&
+        !(expected == DataType::Float && quantization(id(), unused))) {
+      cerr << "Type determined does not match that requested." << endl;
+      cerr << H5ReadWrite::dataTypeToString(m_dataType) << " -> "
+           << H5ReadWrite::dataTypeToString(expected) << endl;
+      return false;
+    }
+
+    return true;
+  }
+
+  bool read(DataType dataType, hid_t memTypeId, void* data)
+  {
+    if (!typeMatches(dataType))
+      return false;
+
+    return readElements(id(), memTypeId, H5S_ALL, H5S_ALL, transfer(),
+                        data);
+  }
+
+  bool readSlab(const vector<int>& start, const vector<int>& counts,
+                DataType dataType, hid_t memTypeId, void* data)
+  {
+    if (!typeMatches(dataType))
+      return false;
+
+    vector<hsize_t> h5start(start.begin(), start.end());
+    vector<hsize_t> h5counts(counts.begin(), counts.end());
+    return readHyperslab(id(), h5start, h5counts, memTypeId, transfer(),
+                         data);
+  }
+
+  bool write(hid_t memTypeId, const void* data)
+  {
+    return writeElements(id(), memTypeId, H5S_ALL, H5S_ALL, transfer(),
+                         data);
+  }
+
+  bool writeSlab(const vector<int>& start, const vector<int>& counts,
+                 hid_t memTypeId, const void* data)
+  {
+    vector<hsize_t> h5start(start.begin(), start.end());
+    vector<hsize_t> h5counts(counts.begin(), counts.end());
+    return writeHyperslab(id(), h5start, h5counts, memTypeId, transfer(),
+                          data);
+  }
+
+  hid_t id() { return m_dataSet.value(); }
+
+  hid_t transfer()
+  {
+    return m_transfer.valueIsValid() ? m_transfer.value() : H5P_DEFAULT;
+  }
+
+  HIDCloser m_dataSet;
+  HIDCloser m_type;
+  HIDCloser m_transfer;
+  string m_path;
+  DataType m_dataType = DataType::None;
+  vector<int> m_dims;
+};
+
+DataSet::DataSet() = default;
+
+DataSet::DataSet(int64_t dataSetId, int64_t transferId, const string& path)
+  : m_impl(new DataSetImpl(dataSetId, transferId, path))
+{
+}
+
+DataSet::~DataSet() = default;
+
+DataSet::DataSet(DataSet&& other) noexcept = default;
+
+DataSet& DataSet::operator=(DataSet&& other) noexcept = default;
+
+bool DataSet::isValid() const
+{
+  return m_impl && m_impl->m_dataSet.valueIsValid() &&
+         m_impl->m_type.valueIsValid();
+}
+
+const string& DataSet::path() const
+{
+  static const string empty;
+  return m_impl ? m_impl->m_path : empty;
+}
+
+DataSet::DataType DataSet::type() const
+{
+  return m_impl ? m_impl->m_dataType : DataType::None;
+}
+
+int DataSet::dimensionCount() const
+{
+  return static_cast<int>(dimensions().size());
+}
+
+const vector<int>& DataSet::dimensions() const
+{
+  static const vector<int> empty;
+  return m_impl ? m_impl->m_dims : empty;
+}
+
+int64_t DataSet::id() const
+{
+  return m_impl ? m_impl->id() : H5I_INVALID_HID;
+}
+
+int64_t DataSet::transferPropertyList() const
+{
+  return m_impl ? m_impl->transfer() : H5P_DEFAULT;
+}
+
+bool DataSet::refresh()
+{
+  if (!isValid()) {
+    cerr << "Data set is not valid\n";
+    return false;
+  }
+
+  if (H5Drefresh(m_impl->id()) < 0) {
+    cerr << "Failed to refresh " << path() << endl;
+    return false;
+  }
+
+  return m_impl->loadDimensions();
+}
+
+template <typename T>
+bool DataSet::readData(T* data)
+{
+  if (!isValid()) {
+    cerr << "Data set is not valid\n";
+    return false;
+  }
+
+  const DataType dataType = DataTypeOf<T>::value;
+  const hid_t memTypeId = BasicTypeToH5<T>::memTypeId();
+
+  return m_impl->read(dataType, memTypeId, data);
+}
+
+template <typename T>
+bool DataSet::readData(NDArray<T>& array)
+{
+  if (!isValid()) {
+    cerr << "Data set is not valid\n";
+    return false;
+  }
+
+  array.resize(dimensions());
+  return readData(array.data());
+}
+
+bool DataSet::readData(const DataType& type, void* data)
+{
+  if (!isValid()) {
+    cerr << "Data set is not valid\n";
+    return false;
+  }
+
+  hid_t dataTypeId, memTypeId;
+  if (!h5TypeIds(type, dataTypeId, memTypeId)) {
+    cerr << "Failed to get H5 types for "
+         << H5ReadWrite::dataTypeToString(type) << "\n";
+    return false;
+  }
+
+  return m_impl->read(type, memTypeId, data);
+}
+
+template <typename T>
+bool DataSet::readSlab(const vector<int>& start, const vector<int>& counts,
+                       T* data)
+{
+  if (!isValid()) {
+    cerr << "Data set is not valid\n";
+    return false;
+  }
+
+  const DataType dataType = DataTypeOf<T>::value;
+  const hid_t memTypeId = BasicTypeToH5<T>::memTypeId();
+
+  return m_impl->readSlab(start, counts, dataType, memTypeId, data);
+}
+
+template <typename T>
+bool DataSet::readSlab(const vector<int>& start, const vector<int>& counts,
+                       NDArray<T>& array)
+{
+  array.resize(counts);
+  return readSlab(start, counts, array.data());
+}
+
+bool DataSet::readSlab(const vector<int>& start, const vector<int>& counts,
+                       const DataType& type, void* data)
+{
+  if (!isValid()) {
+    cerr << "Data set is not valid\n";
+    return false;
+  }
+
+  hid_t dataTypeId, memTypeId;
+  if (!h5TypeIds(type, dataTypeId, memTypeId)) {
+    cerr << "Failed to get H5 types for "
+         << H5ReadWrite::dataTypeToString(type) << "\n";
+    return false;
+  }
+
+  return m_impl->readSlab(start, counts, type, memTypeId, data);
+}
+
+template <typename T>
+bool DataSet::writeData(const T* data)
+{
+  if (!isValid()) {
+    cerr << "Data set is not valid\n";
+    return false;
+  }
+
+  return m_impl->write(BasicTypeToH5<T>::memTypeId(), data);
+}
+
+template <typename T>
+bool DataSet::writeSlab(const vector<int>& start, const vector<int>& counts,
+                        const T* data)
+{
+  if (!isValid()) {
+    cerr << "Data set is not valid\n";
+    return false;
+  }
+
+  return m_impl->writeSlab(start, counts, BasicTypeToH5<T>::memTypeId(),
+                           data);
+}
+
+template <typename T>
+bool DataSet::writeSlab(const vector<int>& start, const NDArray<T>& array)
+{
+  return writeSlab(start, array.shape(), array.data());
+}
+
+bool DataSet::writeSlab(const vector<int>& start, const vector<int>& counts,
+                        const DataType& type, const void* data)
+{
+  if (!isValid()) {
+    cerr << "Data set is not valid\n";
+    return false;
+  }
+
+  hid_t dataTypeId, memTypeId;
+  if (!h5TypeIds(type, dataTypeId, memTypeId)) {
+    cerr << "Failed to get H5 types for "
+         << H5ReadWrite::dataTypeToString(type) << "\n";
+    return false;
+  }
+
+  return m_impl->writeSlab(start, counts, memTypeId, data);
+}
+
+bool DataSet::isQuantized()
+{
+  if (!isValid())
+    return false;
+
+  Quantization unused;
+  return quantization(m_impl->id(), unused);
+}
+
+bool DataSet::hasAttribute(const string& name)
+{
+  if (!isValid())
+    return false;
+
+  return H5Aexists(m_impl->id(), name.c_str()) > 0;
+}
+
+template <typename T>
+T DataSet::attribute(const string& name, bool* ok)
+{
+  setOk(ok, false);
+  T result = T();
+
+  if (!isValid()) {
+    cerr << "Data set is not valid\n";
+    return result;
+  }
+
+  const DataType dataType = DataTypeOf<T>::value;
+  const hid_t memTypeId = BasicTypeToH5<T>::memTypeId();
+
+  if (readAttribute(m_impl->id(), ".", name, dataType, memTypeId, &result))
+    setOk(ok, true);
+
+  return result;
+}
+
+// We have a specialization for std::string
+template <>
+string DataSet::attribute<string>(const string& name, bool* ok)
+{
+  setOk(ok, false);
+  string result;
+
+  if (!isValid()) {
+    cerr << "Data set is not valid\n";
+    return result;
+  }
+
+  if (readStringAttribute(m_impl->id(), ".", name, result))
+    setOk(ok, true);
+
+  return result;
+}
+
+template <typename T>
+bool DataSet::setAttribute(const string& name, T value)
+{
+  if (!isValid()) {
+    cerr << "Data set is not valid\n";
+    return false;
+  }
+
+  const hid_t dataTypeId = BasicTypeToH5<T>::dataTypeId();
+  const hid_t memTypeId = BasicTypeToH5<T>::memTypeId();
+
+  return writeAttribute(m_impl->id(), name, dataTypeId, memTypeId, &value);
+}
+
+// Specialization for string
+template <>
+bool DataSet::setAttribute<const string&>(const string& name,
+                                          const string& value)
+{
+  if (!isValid()) {
+    cerr << "Data set is not valid\n";
+    return false;
+  }
+
+  return writeStringAttribute(m_impl->id(), name, value);
+}
+
+template <>
+bool DataSet::setAttribute<const char*>(const string& name, const char* value)
+{
+  return setAttribute<const string&>(name, value);
+}
+
+// Instantiate our allowable templates here
+#define INSTANTIATE_DATASET_TEMPLATES(T, E)                                   \
+  template bool DataSet::readData(T*);                                        \
+  template bool DataSet::readData(NDArray<T>&);                               \
+  template bool DataSet::readSlab(const vector<int>&, const vector<int>&,     \
+                                  T*);                                        \
+  template bool DataSet::readSlab(const vector<int>&, const vector<int>&,     \
+                                  NDArray<T>&);                               \
+  template bool DataSet::writeData(const T*);                                 \
+  template bool DataSet::writeSlab(const vector<int>&, const vector<int>&,    \
+                                   const T*);                                 \
+  template bool DataSet::writeSlab(const vector<int>&, const NDArray<T>&);    \
+  template T DataSet::attribute(const string&, bool*);                        \
+  template bool DataSet::setAttribute(const string&, T);
+
+H5CPP_FOR_EACH_BASIC_TYPE(INSTANTIATE_DATASET_TEMPLATES)
+H5CPP_FOR_EACH_EXTENDED_TYPE(INSTANTIATE_DATASET_TEMPLATES)
+
+#undef INSTANTIATE_DATASET_TEMPLATES
+
+template string DataSet::attribute(const string&, bool*);
+template bool DataSet::setAttribute(const string&, const string&);
+template bool DataSet::setAttribute(const string&, const char*);
+
+} // namespace h5
@@ -0,0 +1,199 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5DataSet_h
+#define tomvizH5DataSet_h
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "h5ndarray.h"
+#include "h5readwrite.h"
+
+namespace h5 {
+
+/**
+ * A handle to an open data set, obtained from H5ReadWrite::openDataSet()
+ * or Group::openDataSet(). The data set stays open for the lifetime of
+ * the handle, and its type, rank and dimensions are cached, so repeated
+ * reads and writes do not resolve the path or reopen the data set.
+ */
+class DataSet
+{
+public:
+  using DataType = H5ReadWrite::DataType;
+
+  /** Creates an invalid handle */
+  DataSet();
+
+  /** Closes the data set */
+  ~DataSet();
+
+  DataSet(DataSet&& other) noexcept;
+  DataSet& operator=(DataSet&& other) noexcept;
+
+  /** Copy constructor is disabled */
+  DataSet(const DataSet&) = delete;
+
+  /** Assignment operator is disabled */
+  DataSet& operator=(const DataSet&) = delete;
+
+  /** Whether the data set was opened successfully */
+  bool isValid() const;
+
+  /** The path the data set was opened with */
+  const std::string& path() const;
+
+  /** The type of the data set, or DataType::None if unknown */
+  DataType type() const;
+
+  /** The number of dimensions of the data set */
+  int dimensionCount() const;
+
+  /** The dimensions of the data set */
+  const std::vector<int>& dimensions() const;
+
+  /**
+   * Refresh the metadata of the data set, and update the cached
+   * dimensions. Use this to see new frames appended by an SWMR writer.
+   * @return True on success, false on failure.
+   */
+  bool refresh();
+
+  /**
+   * Read the whole data set and interpret it as type T. If T is not the
+   * correct type of the data set, an error will occur.
+   * @param data A pointer to a block of memory large enough to hold the
+   *             data set.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool readData(T* data);
+
+  /**
+   * Read the whole data set into @p array, which is reshaped to the
+   * dimensions of the data set.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool readData(NDArray<T>& array);
+
+  /**
+   * Read the whole data set and interpret it as type @p type.
+   * @return True on success, false on failure.
+   */
+  bool readData(const DataType& type, void* data);
+
+  /**
+   * Read a hyperslab of the data set and interpret it as type T.
+   * @param start The offset of the hyperslab in each dimension.
+   * @param counts The size of the hyperslab in each dimension.
+   * @param data A pointer to a block of memory large enough to hold the
+   *             hyperslab.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool readSlab(const std::vector<int>& start,
+                const std::vector<int>& counts, T* data);
+
+  /**
+   * Read a hyperslab of the data set into @p array, which is reshaped to
+   * @p counts.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool readSlab(const std::vector<int>& start,
+                const std::vector<int>& counts, NDArray<T>& array);
+
+  /**
+   * Read a hyperslab of the data set and interpret it as type @p type.
+   * @return True on success, false on failure.
+   */
+  bool readSlab(const std::vector<int>& start,
+                const std::vector<int>& counts, const DataType& type,
+                void* data);
+
+  /**
+   * Overwrite the whole data set.
+   * @param data The data to write. It must hold the whole data set.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool writeData(const T* data);
+
+  /**
+   * Overwrite a hyperslab of the data set.
+   * @param start The offset of the hyperslab in each dimension.
+   * @param counts The size of the hyperslab in each dimension.
+   * @param data The data to write.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool writeSlab(const std::vector<int>& start,
+                 const std::vector<int>& counts, const T* data);
+
+  /**
+   * Overwrite a hyperslab of the data set. The size of the hyperslab is
+   * the shape of @p array.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool writeSlab(const std::vector<int>& start, const NDArray<T>& array);
+
+  /**
+   * Overwrite a hyperslab of the data set with data of type @p type.
+   * @return True on success, false on failure.
+   */
+  bool writeSlab(const std::vector<int>& start,
+                 const std::vector<int>& counts, const DataType& type,
+                 const void* data);
+
+  /**
+   * Check if the data set holds quantized floats, which are restored when
+   * they are read as float, and cannot be read as any other type.
+   */
+  bool isQuantized();
+
+  /** Check if the data set has an attribute with a given name */
+  bool hasAttribute(const std::string& name);
+
+  /**
+   * Read an attribute of the data set and interpret it as type T.
+   * @param name The name of the attribute.
+   * @param ok If used, set to true on success and false on failure.
+   * @return The attribute.
+   */
+  template <typename T>
+  T attribute(const std::string& name, bool* ok = nullptr);
+
+  /**
+   * Set an attribute on the data set.
+   * @param name The name of the attribute.
+   * @param value The value of the attribute.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool setAttribute(const std::string& name, T value);
+
+private:
+  friend class H5ReadWrite;
+  friend class Group;
+  friend class Reducer;
+
+  // Takes ownership of the HDF5 data set and transfer property list ids.
+  DataSet(int64_t dataSetId, int64_t transferId, const std::string& path);
+
+  // The open data set and its transfer property list, for the readers
+  // that are built on DataSet
+  int64_t id() const;
+  int64_t transferPropertyList() const;
+
+  class DataSetImpl;
+  std::unique_ptr<DataSetImpl> m_impl;
+};
+
+} // namespace h5
+
+#endif // tomvizH5DataSet_h
@@ -0,0 +1,96 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5Dispatch_h
+#define tomvizH5Dispatch_h
+
+#include <complex>
+#include <type_traits>
+#include <utility>
+
+#include "h5float16.h"
+#include "h5readwrite.h" // This is included only for the "DataType" enum
+
+// The basic C++ types supported by h5cpp, with their DataType. Expand it
+// with a macro taking (type, DataType enumerator) to generate code for
+// every type, such as explicit template instantiations.
+#define H5CPP_FOR_EACH_BASIC_TYPE(X)                                           \
+  X(char, Int8)                                                                \
+  X(short, Int16)                                                              \
+  X(int, Int32)                                                                \
+  X(long long, Int64)                                                          \
+  X(unsigned char, UInt8)                                                      \
+  X(unsigned short, UInt16)                                                    \
+  X(unsigned int, UInt32)                                                      \
+  X(unsigned long long, UInt64)                                                \
+  X(float, Float)                                                              \
+  X(double, Double)
+
+// The C++ types of the DataTypes that have no basic C++ type. They are
+// supported by the templates of H5ReadWrite, DataSet and Group, but not by
+// dispatch().
+#define H5CPP_FOR_EACH_EXTENDED_TYPE(X)                                        \
+  X(float16, Float16)                                                          \
+  X(std::complex<float>, Complex64)                                            \
+  X(std::complex<double>, Complex128)
+
+namespace h5 {
+
+/** An empty value that carries a type, passed to dispatch() visitors */
+template <typename T>
+struct TypeTag
+{
+  using type = T;
+};
+
+/** The DataType of a C++ type, as DataTypeOf<T>::value */
+template <typename T>
+struct DataTypeOf;
+
+#define H5CPP_DATA_TYPE_OF(T, E)                                               \
+  template <>                                                                  \
+  struct DataTypeOf<T>                                                         \
+    : std::integral_constant<H5ReadWrite::DataType,                            \
+                             H5ReadWrite::DataType::E>                         \
+  {                                                                            \
+  };
+
+H5CPP_FOR_EACH_BASIC_TYPE(H5CPP_DATA_TYPE_OF)
+H5CPP_FOR_EACH_EXTENDED_TYPE(H5CPP_DATA_TYPE_OF)
+
+#undef H5CPP_DATA_TYPE_OF
+
+/**
+ * Call @p visitor with a TypeTag of the C++ type that matches @p type.
+ * The switch is resolved at compile time into a direct branch per type.
+ * With C++14, a generic lambda works as a visitor:
+ *
+ *   dispatch(type, [&](auto tag) {
+ *     using T = typename decltype(tag)::type;
+ *     ...
+ *   });
+ *
+ * @return True if @p visitor was called, false if @p type has no basic
+ *         C++ type (Float16, Complex64, Complex128, String, Compound
+ *         and None).
+ */
+template <typename Visitor>
+bool dispatch(H5ReadWrite::DataType type, Visitor&& visitor)
+{
+  switch (type) {
+#define H5CPP_DISPATCH_CASE(T, E)                                              \
+  case H5ReadWrite::DataType::E:                                               \
+    std::forward<Visitor>(visitor)(TypeTag<T>());                              \
+    return true;
+
+    H5CPP_FOR_EACH_BASIC_TYPE(H5CPP_DISPATCH_CASE)
+
+#undef H5CPP_DISPATCH_CASE
+    default:
+      return false;
+  }
+}
+
+} // namespace h5
+
+#endif // tomvizH5Dispatch_h
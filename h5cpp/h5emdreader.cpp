@@ -0,0 +1,315 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "h5emdreader.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "h5capi.h"
+#include "h5dispatch.h"
+#include "h5typemaps.h"
+#include "h5utils.h"
+#include "hidcloser.h"
+
+using std::cerr;
+using std::endl;
+
+using std::string;
+using std::vector;
+
+namespace h5 {
+
+using DataType = H5ReadWrite::DataType;
+
+namespace {
+
+// The first value of a string attribute, or an empty string if there is
+// none. EMD axes do not always have units.
+string firstString(hid_t objectId, const char* name)
+{
+  vector<string> values;
+  if (H5Aexists(objectId, name) <= 0 ||
+      !readStringAttributeValues(objectId, name, values) || values.empty()) {
+    return string();
+  }
+
+  return values[0];
+}
+
+// Copy a row-major array into @p dst with the order of its dimensions
+// reversed. The source is read in order, one row at a time.
+template <typename T>
+void reverseDimensions(const T* src, const vector<int>& shape, T* dst)
+{
+  const size_t rank = shape.size();
+  if (rank == 0)
+    return;
+
+  // Where a step along each dimension of the source lands in @p dst
+  vector<size_t> dstStrides(rank);
+  size_t total = 1;
+  for (size_t i = 0; i < rank; ++i) {
+    dstStrides[i] = total;
+    total *= shape[i];
+  }
+
+  if (total == 0)
+    return;
+
+  const size_t rowLength = shape[rank - 1];
+  const size_t rowStride = dstStrides[rank - 1];
+  vector<int> index(rank, 0);
+  for (size_t offset = 0; offset < total; offset += rowLength) {
+    size_t base = 0;
+    for (size_t i = 0; i + 1 < rank; ++i)
+      base += index[i] * dstStrides[i];
+
+    const T* row = src + offset;
+    for (size_t i = 0; i < rowLength; ++i)
+      dst[base + i * rowStride] = row[i];
+
+    // Move to the next row
+    for (size_t i = rank - 1; i-- > 0;) {
+      if (++index[i] < shape[i])
+        break;
+      index[i] = 0;
+    }
+  }
+}
+
+} // end namespace
+
+class EmdReader::EmdReaderImpl {
+public:
+  EmdReaderImpl(const string& fileName) : m_file(fileName) {}
+
+  // Open the volume and read every axis, opening each data set once
+  bool open(const string& groupPath)
+  {
+    HIDCloser groupCloser(H5Gopen(m_fileId, groupPath.c_str(), H5P_DEFAULT),
+                          H5Gclose);
+    hid_t groupId = groupCloser.value();
+    if (groupId < 0) {
+      cerr << "Failed to open EMD group: " << groupPath << endl;
+      return false;
+    }
+
+    m_volume = HIDCloser(H5Dopen(groupId, "data", H5P_DEFAULT), H5Dclose);
+    if (!m_volume.valueIsValid()) {
+      cerr << "Failed to open the EMD volume in " << groupPath << endl;
+      return false;
+    }
+
+    HIDCloser typeCloser(H5Dget_type(m_volume.value()), H5Tclose);
+    m_type = h5ToDataType(typeCloser.value());
+
+    vector<hsize_t> dims;
+    if (!dataSetDimensions(m_volume.value(), dims))
+      return false;
+
+    m_dimensions.assign(dims.begin(), dims.end());
+
+    m_axes.clear();
+    for (size_t i = 0; i < m_dimensions.size(); ++i) {
+      string name = "dim" + std::to_string(i + 1);
+      HIDCloser axisCloser(H5Dopen(groupId, name.c_str(), H5P_DEFAULT),
+                           H5Dclose);
+      hid_t axisId = axisCloser.value();
+      if (axisId < 0) {
+        cerr << "Failed to open EMD axis " << groupPath << "/" << name
+             << endl;
+        return false;
+      }
+
+      vector<hsize_t> axisDims;
+      if (!dataSetDimensions(axisId, axisDims) || axisDims.size() != 1 ||
+          static_cast<int>(axisDims[0]) != m_dimensions[i]) {
+        cerr << "EMD axis " << name << " does not match the volume\n";
+        return false;
+      }
+
+      EmdAxis axis;
+      axis.name = firstString(axisId, "name");
+      axis.units = firstString(axisId, "units");
+
+      // HDF5 converts the values of every numeric axis to double
+      axis.values.resize(axisDims[0]);
+      if (!axis.values.empty() &&
+          H5Dread(axisId, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL,
+                  m_transferId, axis.values.data()) < 0) {
+        cerr << "Failed to read EMD axis " << name << endl;
+        return false;
+      }
+
+      m_axes.push_back(std::move(axis));
+    }
+
+    return true;
+  }
+
+  // Check the hyperslab of @p options, and resolve it to the whole
+  // volume if it is not set
+  bool slab(const EmdReadOptions& options, vector<int>& start,
+            vector<int>& counts) const
+  {
+    if (options.counts.empty()) {
+      start.assign(m_dimensions.size(), 0);
+      counts = m_dimensions;
+      return true;
+    }
+
+    start = options.start.empty() ? vector<int>(options.counts.size(), 0)
+                                  : options.start;
+    counts = options.counts;
+    if (start.size() != m_dimensions.size() ||
+        counts.size() != m_dimensions.size()) {
+      cerr << "The hyperslab does not have the rank of the volume\n";
+      return false;
+    }
+
+    for (size_t i = 0; i < m_dimensions.size(); ++i) {
+      if (start[i] < 0 || counts[i] < 0 ||
+          start[i] + counts[i] > m_dimensions[i]) {
+        cerr << "The hyperslab is outside of the volume\n";
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  template <typename T>
+  bool read(NDArray<T>& volume, const EmdReadOptions& options)
+  {
+    if (m_type == DataType::String || m_type == DataType::Compound ||
+        m_type == DataType::None) {
+      cerr << "The EMD volume is not numeric\n";
+      return false;
+    }
+
+    vector<int> start, counts;
+    if (!slab(options, start, counts))
+      return false;
+
+    vector<hsize_t> h5start(start.begin(), start.end());
+    vector<hsize_t> h5counts(counts.begin(), counts.end());
+    const hid_t memTypeId = BasicTypeToH5<T>::memTypeId();
+
+    if (!options.transpose || counts.size() < 2) {
+      volume.resize(counts);
+      return readHyperslab(m_volume.value(), h5start, h5counts, memTypeId,
+                           m_transferId, volume.data());
+    }
+
+    NDArray<T> rowMajor(counts);
+    if (!readHyperslab(m_volume.value(), h5start, h5counts, memTypeId,
+                       m_transferId, rowMajor.data())) {
+      return false;
+    }
+
+    vector<int> reversed(counts.rbegin(), counts.rend());
+    volume.resize(reversed);
+    reverseDimensions(rowMajor.data(), counts, volume.data());
+    return true;
+  }
+
+  H5ReadWrite m_file;
+  hid_t m_fileId = H5I_INVALID_HID;
+  hid_t m_transferId = H5P_DEFAULT;
+  bool m_valid = false;
+  HIDCloser m_volume = HIDCloser(H5I_INVALID_HID, H5Dclose);
+  DataType m_type = DataType::None;
+  vector<int> m_dimensions;
+  vector<EmdAxis> m_axes;
+};
+
+EmdReader::EmdReader(const string& fileName, const string& group)
+  : m_impl(new EmdReaderImpl(fileName))
+{
+  m_impl->m_fileId = m_impl->m_file.fileId();
+  m_impl->m_transferId = m_impl->m_file.transferPropertyList();
+  if (m_impl->m_fileId < 0)
+    return;
+
+  m_impl->m_valid = m_impl->open(group);
+}
+
+EmdReader::~EmdReader() = default;
+
+bool EmdReader::isValid() const
+{
+  return m_impl->m_valid;
+}
+
+DataType EmdReader::type() const
+{
+  return m_impl->m_type;
+}
+
+const vector<int>& EmdReader::dimensions() const
+{
+  return m_impl->m_dimensions;
+}
+
+const vector<EmdAxis>& EmdReader::axes() const
+{
+  return m_impl->m_axes;
+}
+
+vector<EmdAxis> EmdReader::axes(const EmdReadOptions& options) const
+{
+  vector<int> start, counts;
+  if (!isValid() || !m_impl->slab(options, start, counts))
+    return vector<EmdAxis>();
+
+  vector<EmdAxis> result;
+  for (size_t i = 0; i < m_impl->m_axes.size(); ++i) {
+    const EmdAxis& axis = m_impl->m_axes[i];
+    EmdAxis sliced;
+    sliced.name = axis.name;
+    sliced.units = axis.units;
+    sliced.values.assign(axis.values.begin() + start[i],
+                         axis.values.begin() + start[i] + counts[i]);
+    result.push_back(std::move(sliced));
+  }
+
+  if (options.transpose)
+    std::reverse(result.begin(), result.end());
+
+  return result;
+}
+
+template <typename T>
+bool EmdReader::readVolume(NDArray<T>& volume, const EmdReadOptions& options)
+{
+  if (!isValid()) {
+    cerr << "The EMD file is not valid\n";
+    return false;
+  }
+
+  return m_impl->read(volume, options);
+}
+
+template <typename T>
+bool EmdReader::read(NDArray<T>& volume, vector<EmdAxis>& axes,
+                     const EmdReadOptions& options)
+{
+  if (!readVolume(volume, options))
+    return false;
+
+  axes = this->axes(options);
+  return true;
+}
+
+// Instantiate our allowable templates here
+#define INSTANTIATE_EMDREADER_TEMPLATES(T, E)                                 \
+  template bool EmdReader::readVolume(NDArray<T>&, const EmdReadOptions&);    \
+  template bool EmdReader::read(NDArray<T>&, vector<EmdAxis>&,                \
+                                const EmdReadOptions&);
+
+H5CPP_FOR_EACH_BASIC_TYPE(INSTANTIATE_EMDREADER_TEMPLATES)
+
+#undef INSTANTIATE_EMDREADER_TEMPLATES
+
+} // namespace h5
@@ -0,0 +1,117 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5EmdReader_h
+#define tomvizH5EmdReader_h
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "h5ndarray.h"
+#include "h5readwrite.h"
+
+namespace h5 {
+
+/** One axis of an EMD volume, read from a "dimN" data set */
+struct EmdAxis
+{
+  std::string name;
+  std::string units;
+  std::vector<double> values;
+};
+
+/** How EmdReader::readVolume() reads the volume */
+struct EmdReadOptions
+{
+  /**
+   * The offset and size of the hyperslab to read in each dimension of the
+   * file. The whole volume is read if @p counts is empty.
+   */
+  std::vector<int> start;
+  std::vector<int> counts;
+
+  /**
+   * Reverse the order of the dimensions, so that the first dimension of
+   * the file varies fastest in memory, as in Fortran order.
+   */
+  bool transpose = false;
+};
+
+/**
+ * Reads the volume and axes of an EMD group, such as the
+ * "/data/tomography" group written by Tomviz. The group, the volume and
+ * each "dimN" data set are opened once, when the reader is created: the
+ * type and dimensions of the volume are cached, and the axes are read with
+ * their "name" and "units" attributes. The volume itself is only read by
+ * readVolume(), so creating a reader and calling axes() loads only the
+ * axes, such as for building a catalogue.
+ */
+class EmdReader
+{
+public:
+  using DataType = H5ReadWrite::DataType;
+
+  /**
+   * Open an EMD file and read the axes of one of its groups.
+   * @param fileName the file to open.
+   * @param group the EMD group that holds the "data" and "dimN" data sets.
+   */
+  explicit EmdReader(const std::string& fileName,
+                     const std::string& group = "/data/tomography");
+
+  /** Closes the file and destroys the EmdReader */
+  ~EmdReader();
+
+  /** Copy constructor is disabled */
+  EmdReader(const EmdReader&) = delete;
+
+  /** Assignment operator is disabled */
+  EmdReader& operator=(const EmdReader&) = delete;
+
+  /** Whether the volume and its axes were opened successfully */
+  bool isValid() const;
+
+  /** The type of the volume in the file */
+  DataType type() const;
+
+  /** The dimensions of the volume in the file */
+  const std::vector<int>& dimensions() const;
+
+  /** The axes of the volume, one per dimension, in the order of the file */
+  const std::vector<EmdAxis>& axes() const;
+
+  /**
+   * The axes that match a readVolume() with @p options: the values are
+   * limited to the hyperslab, and the order is reversed if transposed.
+   */
+  std::vector<EmdAxis> axes(const EmdReadOptions& options) const;
+
+  /**
+   * Read the volume, converted to type T. The array is reshaped to the
+   * hyperslab of @p options, or to the dimensions of the volume, in
+   * reverse order if transposed.
+   * @param volume The array that will be set to the volume.
+   * @param options The hyperslab and order to read.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool readVolume(NDArray<T>& volume,
+                  const EmdReadOptions& options = EmdReadOptions());
+
+  /**
+   * Read the volume and the matching axes in one call.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool read(NDArray<T>& volume, std::vector<EmdAxis>& axes,
+            const EmdReadOptions& options = EmdReadOptions());
+
+private:
+  class EmdReaderImpl;
+  std::unique_ptr<EmdReaderImpl> m_impl;
+};
+
+} // namespace h5
+
+#endif // tomvizH5EmdReader_h
@@ -0,0 +1,233 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "h5filepool.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "h5capi.h"
+#include "h5wait.h"
+
+using std::cerr;
+using std::endl;
+
+using std::string;
+
+using Clock = std::chrono::steady_clock;
+
+namespace h5 {
+
+FilePool& FilePool::instance()
+{
+  static FilePool pool;
+  return pool;
+}
+
+FilePool::FilePool() : m_idleTimeout(30000)
+{
+  // Make sure that HDF5 is set up before the pool, so that the pool is
+  // destroyed, and its files closed, before HDF5 shuts down at exit
+  H5open();
+}
+
+FilePool::~FilePool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_changed.notify_all();
+
+  if (m_reaper.joinable())
+    m_reaper.join();
+
+  for (auto& entry : m_entries)
+    H5Fclose(entry.second.fileId);
+}
+
+void FilePool::setIdleTimeout(std::chrono::milliseconds timeout)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_idleTimeout = timeout;
+    closeExpired(Clock::now());
+  }
+  m_changed.notify_all();
+}
+
+std::chrono::milliseconds FilePool::idleTimeout() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_idleTimeout;
+}
+
+FilePool::Statistics FilePool::statistics() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Statistics statistics = m_statistics;
+  statistics.open = m_entries.size();
+  statistics.idle = 0;
+  for (auto& entry : m_entries) {
+    if (entry.second.users == 0)
+      ++statistics.idle;
+  }
+  return statistics;
+}
+
+void FilePool::resetStatistics()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_statistics = Statistics();
+}
+
+int64_t FilePool::acquire(const string& fileName, unsigned flags,
+                          const Opener& open)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+#ifndef H5_HAVE_THREADSAFE
+  closeExpired(Clock::now());
+#endif
+
+  Key key(fileName, flags);
+  auto it = m_entries.find(key);
+  if (it != m_entries.end()) {
+    ++it->second.users;
+    ++m_statistics.reuses;
+    return it->second.fileId;
+  }
+
+  // HDF5 cannot open a file for writing while it is open read-only
+  if (flags & H5F_ACC_RDWR)
+    closeIdleFile(fileName);
+
+  // Opening under the lock keeps two users from opening the same file at
+  // once. HDF5 serializes the opens anyway.
+  hid_t fileId = open();
+  if (fileId < 0)
+    return fileId;
+
+  Entry entry;
+  entry.fileId = fileId;
+  entry.users = 1;
+  m_entries.emplace(key, entry);
+  ++m_statistics.opens;
+  return fileId;
+}
+
+void FilePool::release(int64_t fileId)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = std::find_if(m_entries.begin(), m_entries.end(),
+                         [fileId](const EntryMap::value_type& entry) {
+                           return entry.second.fileId == fileId;
+                         });
+  if (it == m_entries.end()) {
+    cerr << "File id " << fileId << " is not in the pool\n";
+    return;
+  }
+
+  Entry& entry = it->second;
+  if (--entry.users > 0)
+    return;
+
+  // Other processes should see the changes without waiting for the close
+  if (it->first.second & H5F_ACC_RDWR) {
+    if (H5Fflush(entry.fileId, H5F_SCOPE_GLOBAL) < 0)
+      cerr << "Failed to flush " << it->first.first << endl;
+  }
+
+  entry.idleSince = Clock::now();
+  if (m_idleTimeout.count() <= 0) {
+    close(it);
+    return;
+  }
+
+  // Only a thread-safe HDF5 may be called from the background thread.
+  // Otherwise, idle files are closed by the calls that follow their
+  // expiry.
+#ifdef H5_HAVE_THREADSAFE
+  if (!m_reaper.joinable())
+    m_reaper = std::thread(&FilePool::run, this);
+  m_changed.notify_all();
+#else
+  closeExpired(entry.idleSince);
+#endif
+}
+
+void FilePool::closeIdle()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto it = m_entries.begin(); it != m_entries.end();) {
+    auto current = it++;
+    if (current->second.users == 0)
+      close(current);
+  }
+}
+
+void FilePool::closeIdle(const string& fileName)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  closeIdleFile(fileName);
+}
+
+void FilePool::closeIdleFile(const string& fileName)
+{
+  for (auto it = m_entries.lower_bound(Key(fileName, 0));
+       it != m_entries.end() && it->first.first == fileName;) {
+    auto current = it++;
+    if (current->second.users == 0)
+      close(current);
+  }
+}
+
+void FilePool::close(EntryMap::iterator it)
+{
+  if (H5Fclose(it->second.fileId) < 0)
+    cerr << "Failed to close " << it->first.first << endl;
+
+  m_entries.erase(it);
+  ++m_statistics.closes;
+}
+
+// Close the files that have been idle for the timeout at @p now. Returns
+// when the next of the other idle files expires, or the largest time
+// point if there are none.
+Clock::time_point FilePool::closeExpired(Clock::time_point now)
+{
+  Clock::time_point next = Clock::time_point::max();
+  for (auto it = m_entries.begin(); it != m_entries.end();) {
+    auto current = it++;
+    if (current->second.users > 0)
+      continue;
+
+    Clock::time_point expiry = current->second.idleSince + m_idleTimeout;
+    if (expiry <= now)
+      close(current);
+    else
+      next = std::min(next, expiry);
+  }
+  return next;
+}
+
+// The background thread: close the files that have been idle too long. It
+// sleeps until there is an idle file, and then until the file expires.
+void FilePool::run()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (!m_stop) {
+    Clock::time_point next = closeExpired(Clock::now());
+    if (next == Clock::time_point::max()) {
+      waitUntil(m_changed, lock, [this]() {
+        return m_stop || std::any_of(m_entries.begin(), m_entries.end(),
+                                     [](const EntryMap::value_type& entry) {
+                                       return entry.second.users == 0;
+                                     });
+      });
+    } else {
+      m_changed.wait_until(lock, next);
+    }
+  }
+}
+
+} // namespace h5
@@ -0,0 +1,130 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5FilePool_h
+#define tomvizH5FilePool_h
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace h5 {
+
+/**
+ * A process-wide pool of open HDF5 files, used by the H5ReadWrite
+ * instances that are opened with OpenOptions::pooled. Instances of the
+ * same file and mode share one reference-counted file id, so the
+ * superblock is read once and the metadata cache stays warm between them.
+ *
+ * When the last instance of a file is destroyed, the file stays open for
+ * the idle timeout in case it is opened again. It is then closed by a
+ * background thread if HDF5 is thread-safe, or else by the first
+ * acquire() or release() after it expires.
+ */
+class FilePool
+{
+public:
+  /** Counters since the last resetStatistics(), and the current usage */
+  struct Statistics
+  {
+    /** Calls to H5Fopen() */
+    size_t opens = 0;
+    /** Acquisitions that were served by a file that was already open */
+    size_t reuses = 0;
+    /** Files that were closed */
+    size_t closes = 0;
+    /** Files that are open, and how many of them have no users */
+    size_t open = 0;
+    size_t idle = 0;
+  };
+
+  /** Opens a file, and returns its id, or a negative value on failure */
+  using Opener = std::function<int64_t()>;
+
+  /** The pool of the process */
+  static FilePool& instance();
+
+  /** Closes the files that are still open */
+  ~FilePool();
+
+  /**
+   * Set how long a file without users stays open. The default is 30 s.
+   * With a timeout of 0, files are closed when their last user releases
+   * them.
+   */
+  void setIdleTimeout(std::chrono::milliseconds timeout);
+
+  /** How long a file without users stays open */
+  std::chrono::milliseconds idleTimeout() const;
+
+  /** The open, reuse and close counters, and the usage */
+  Statistics statistics() const;
+
+  /** Reset the counters */
+  void resetStatistics();
+
+  /**
+   * Get the shared id of @p fileName opened with @p flags, and add a user
+   * to it. If the file is not open in the pool yet, @p open is called to
+   * open it.
+   * @return The file id, or a negative value on failure.
+   */
+  int64_t acquire(const std::string& fileName, unsigned flags,
+                  const Opener& open);
+
+  /**
+   * Remove a user from a file id returned by acquire(). Changes to a
+   * writable file are flushed when its last user is removed.
+   */
+  void release(int64_t fileId);
+
+  /** Close every file that has no users */
+  void closeIdle();
+
+  /**
+   * Close the files of @p fileName that have no users, such as before the
+   * file is created again.
+   */
+  void closeIdle(const std::string& fileName);
+
+private:
+  FilePool();
+
+  // The path and the open flags
+  using Key = std::pair<std::string, unsigned>;
+
+  struct Entry
+  {
+    int64_t fileId = -1;
+    int users = 0;
+    std::chrono::steady_clock::time_point idleSince;
+  };
+
+  using EntryMap = std::map<Key, Entry>;
+
+  void close(EntryMap::iterator it);
+  void closeIdleFile(const std::string& fileName);
+  std::chrono::steady_clock::time_point closeExpired(
+    std::chrono::steady_clock::time_point now);
+  void run();
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_changed;
+  std::thread m_reaper;
+  bool m_stop = false;
+
+  std::chrono::milliseconds m_idleTimeout;
+  EntryMap m_entries;
+  Statistics m_statistics;
+};
+
+} // namespace h5
+
+#endif // tomvizH5FilePool_h
@@ -0,0 +1,288 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "h5filters.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+#include "h5capi.h"
+#include "h5trace.h"
+
+#ifdef H5CPP_USE_LZ4
+#include <lz4.h>
+#endif
+
+#ifdef H5CPP_USE_ZSTD
+#include <zstd.h>
+#endif
+
+using std::cerr;
+using std::endl;
+
+namespace h5 {
+
+namespace {
+
+#if defined(H5CPP_USE_LZ4) || defined(H5CPP_USE_ZSTD)
+// The category of the trace spans of a filter call
+const char* filterPhase(unsigned flags)
+{
+  return flags & H5Z_FLAG_REVERSE ? "decompress" : "compress";
+}
+#endif
+
+// The filters follow the formats of the reference HDF5 filter plugins of
+// the same ids, so that other programs can read the data with them.
+
+#ifdef H5CPP_USE_LZ4
+
+// The chunk starts with its size as a big-endian 64-bit integer and the
+// block size as a 32-bit one. Each block follows, after its compressed
+// size. A block that does not compress is stored as it is.
+const uint32_t DefaultLZ4BlockSize = 1 << 30;
+
+void storeBigEndian(unsigned char* bytes, uint64_t value, int count)
+{
+  for (int i = count - 1; i >= 0; --i) {
+    bytes[i] = static_cast<unsigned char>(value & 0xff);
+    value >>= 8;
+  }
+}
+
+uint64_t loadBigEndian(const unsigned char* bytes, int count)
+{
+  uint64_t value = 0;
+  for (int i = 0; i < count; ++i)
+    value = (value << 8) | bytes[i];
+  return value;
+}
+
+size_t lz4Filter(unsigned flags, size_t cdCount, const unsigned cdValues[],
+                 size_t bytes, size_t* bufferSize, void** buffer)
+{
+  const unsigned char* input = static_cast<const unsigned char*>(*buffer);
+  unsigned char* output = nullptr;
+  size_t outputSize = 0;
+
+  TraceSpan span("lz4", filterPhase(flags));
+
+  if (flags & H5Z_FLAG_REVERSE) {
+    if (bytes < 12)
+      return 0;
+
+    const uint64_t size = loadBigEndian(input, 8);
+    uint64_t blockSize = loadBigEndian(input + 8, 4);
+    if (blockSize > size)
+      blockSize = size;
+
+    output = static_cast<unsigned char*>(H5allocate_memory(size, false));
+    if (!output && size > 0)
+      return 0;
+
+    const unsigned char* read = input + 12;
+    const unsigned char* end = input + bytes;
+    uint64_t done = 0;
+    while (done < size) {
+      const uint64_t length = std::min<uint64_t>(blockSize, size - done);
+      if (end - read < 4)
+        break;
+
+      const uint64_t compressed = loadBigEndian(read, 4);
+      read += 4;
+      if (compressed > static_cast<uint64_t>(end - read))
+        break;
+
+      if (compressed == length) {
+        std::memcpy(output + done, read, length);
+      } else if (LZ4_decompress_safe(
+                   reinterpret_cast<const char*>(read),
+                   reinterpret_cast<char*>(output + done),
+                   static_cast<int>(compressed),
+                   static_cast<int>(length)) != static_cast<int>(length)) {
+        break;
+      }
+
+      read += compressed;
+      done += length;
+    }
+
+    if (done != size) {
+      H5free_memory(output);
+      return 0;
+    }
+
+    outputSize = size;
+  } else {
+    uint64_t blockSize =
+      cdCount > 0 && cdValues[0] > 0 ? cdValues[0] : DefaultLZ4BlockSize;
+    blockSize = std::min<uint64_t>(blockSize, std::max<size_t>(bytes, 1));
+    blockSize = std::min<uint64_t>(blockSize, LZ4_MAX_INPUT_SIZE);
+
+    const size_t blocks = bytes == 0 ? 0 : (bytes - 1) / blockSize + 1;
+    const size_t capacity =
+      12 + blocks * (4 + LZ4_compressBound(static_cast<int>(blockSize)));
+    output = static_cast<unsigned char*>(H5allocate_memory(capacity, false));
+    if (!output)
+      return 0;
+
+    storeBigEndian(output, bytes, 8);
+    storeBigEndian(output + 8, blockSize, 4);
+    unsigned char* write = output + 12;
+    for (size_t done = 0; done < bytes; done += blockSize) {
+      const int length =
+        static_cast<int>(std::min<uint64_t>(blockSize, bytes - done));
+      int compressed = LZ4_compress_default(
+        reinterpret_cast<const char*>(input + done),
+        reinterpret_cast<char*>(write + 4), length,
+        LZ4_compressBound(length));
+      if (compressed <= 0 || compressed >= length) {
+        std::memcpy(write + 4, input + done, length);
+        compressed = length;
+      }
+
+      storeBigEndian(write, compressed, 4);
+      write += 4 + compressed;
+    }
+
+    outputSize = write - output;
+  }
+
+  // The bytes of the data, before compression or after decompression
+  span.setBytes(flags & H5Z_FLAG_REVERSE ? outputSize : bytes);
+
+  H5free_memory(*buffer);
+  *buffer = output;
+  *bufferSize = outputSize;
+  return outputSize;
+}
+
+const H5Z_class2_t LZ4FilterClass = {
+  H5Z_CLASS_T_VERS,
+  static_cast<H5Z_filter_t>(LZ4FilterId),
+  1, // The encoder is present
+  1, // The decoder is present
+  "lz4",
+  nullptr,
+  nullptr,
+  lz4Filter
+};
+
+#endif // H5CPP_USE_LZ4
+
+#ifdef H5CPP_USE_ZSTD
+
+// The chunk is a single Zstandard frame, which records its own size. The
+// first filter parameter is the compression level.
+size_t zstdFilter(unsigned flags, size_t cdCount, const unsigned cdValues[],
+                  size_t bytes, size_t* bufferSize, void** buffer)
+{
+  void* output = nullptr;
+  size_t outputSize = 0;
+
+  TraceSpan span("zstd", filterPhase(flags));
+
+  if (flags & H5Z_FLAG_REVERSE) {
+    unsigned long long size = ZSTD_getFrameContentSize(*buffer, bytes);
+    if (size == ZSTD_CONTENTSIZE_ERROR || size == ZSTD_CONTENTSIZE_UNKNOWN)
+      return 0;
+
+    output = H5allocate_memory(size, false);
+    if (!output && size > 0)
+      return 0;
+
+    outputSize = ZSTD_decompress(output, size, *buffer, bytes);
+    if (ZSTD_isError(outputSize) || outputSize != size) {
+      H5free_memory(output);
+      return 0;
+    }
+  } else {
+    const int level = cdCount > 0 ? static_cast<int>(cdValues[0]) : 0;
+    const size_t capacity = ZSTD_compressBound(bytes);
+    output = H5allocate_memory(capacity, false);
+    if (!output)
+      return 0;
+
+    outputSize = ZSTD_compress(output, capacity, *buffer, bytes, level);
+    if (ZSTD_isError(outputSize)) {
+      H5free_memory(output);
+      return 0;
+    }
+  }
+
+  // The bytes of the data, before compression or after decompression
+  span.setBytes(flags & H5Z_FLAG_REVERSE ? outputSize : bytes);
+
+  H5free_memory(*buffer);
+  *buffer = output;
+  *bufferSize = outputSize;
+  return outputSize;
+}
+
+const H5Z_class2_t ZstdFilterClass = {
+  H5Z_CLASS_T_VERS,
+  static_cast<H5Z_filter_t>(ZstdFilterId),
+  1, // The encoder is present
+  1, // The decoder is present
+  "zstd",
+  nullptr,
+  nullptr,
+  zstdFilter
+};
+
+#endif // H5CPP_USE_ZSTD
+
+} // end namespace
+
+void registerFilters()
+{
+  static std::once_flag registered;
+  std::call_once(registered, []() {
+#ifdef H5CPP_USE_LZ4
+    if (H5Zregister(&LZ4FilterClass) < 0)
+      cerr << "Failed to register the LZ4 filter" << endl;
+#endif
+
+#ifdef H5CPP_USE_ZSTD
+    if (H5Zregister(&ZstdFilterClass) < 0)
+      cerr << "Failed to register the Zstandard filter" << endl;
+#endif
+  });
+}
+
+bool compressionAvailable(WriteOptions::Compression compression)
+{
+  using Compression = WriteOptions::Compression;
+
+  registerFilters();
+
+  H5Z_filter_t id;
+  switch (compression) {
+    case Compression::None:
+      return true;
+    case Compression::Deflate:
+      id = H5Z_FILTER_DEFLATE;
+      break;
+    case Compression::LZ4:
+      id = LZ4FilterId;
+      break;
+    case Compression::Zstd:
+      id = ZstdFilterId;
+      break;
+    default:
+      return false;
+  }
+
+  // This also looks for a plugin
+  htri_t available;
+  H5E_BEGIN_TRY {
+    available = H5Zfilter_avail(id);
+  } H5E_END_TRY;
+
+  return available > 0;
+}
+
+} // namespace h5
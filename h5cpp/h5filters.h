@@ -0,0 +1,31 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5Filters_h
+#define tomvizH5Filters_h
+
+#include "h5writeoptions.h"
+
+namespace h5 {
+
+/** The registered HDF5 filter ids of the codecs that can be built in */
+const int LZ4FilterId = 32004;
+const int ZstdFilterId = 32015;
+
+/**
+ * Register the compression filters that were built into h5cpp with HDF5,
+ * so that data sets that use them are written and read without an
+ * HDF5_PLUGIN_PATH. H5ReadWrite calls this when it opens a file, so it is
+ * only needed before calling HDF5 directly. Calling it again does nothing.
+ */
+void registerFilters();
+
+/**
+ * Whether data sets can be written with @p compression, with a built-in
+ * filter or an HDF5 filter plugin.
+ */
+bool compressionAvailable(WriteOptions::Compression compression);
+
+} // namespace h5
+
+#endif // tomvizH5Filters_h
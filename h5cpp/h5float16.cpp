@@ -0,0 +1,27 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "h5float16.h"
+
+namespace h5 {
+
+// float16 is a plain wrapper of its bits, so arrays of it can be handed
+// to HDF5 and converted in place of arrays of uint16_t
+static_assert(sizeof(float16) == sizeof(uint16_t),
+              "float16 must have the size of its bits");
+
+void convertFloat16ToFloat(const float16* source, float* target,
+                           size_t count)
+{
+  for (size_t i = 0; i < count; ++i)
+    target[i] = halfBitsToFloat(source[i].bits);
+}
+
+void convertFloatToFloat16(const float* source, float16* target,
+                           size_t count)
+{
+  for (size_t i = 0; i < count; ++i)
+    target[i].bits = floatToHalfBits(source[i]);
+}
+
+} // namespace h5
@@ -0,0 +1,139 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5Float16_h
+#define tomvizH5Float16_h
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace h5 {
+
+namespace detail {
+
+// @p a if @p condition, else @p b, with bit masks rather than a branch so
+// that loops of conversions vectorize
+inline uint32_t selectBits(bool condition, uint32_t a, uint32_t b)
+{
+  const uint32_t mask = 0u - static_cast<uint32_t>(condition);
+  return (a & mask) | (b & ~mask);
+}
+
+} // end namespace detail
+
+/**
+ * Convert the bits of an IEEE 754 half-precision value to a float. This
+ * is exact, including subnormals, infinities and NaNs.
+ */
+inline float halfBitsToFloat(uint16_t half)
+{
+  const uint32_t magic = 113u << 23; // 2^-14, the smallest normal half
+  const uint32_t shiftedExponent = 0x7c00u << 13;
+
+  uint32_t bits = (half & 0x7fffu) << 13;
+  const uint32_t exponent = bits & shiftedExponent;
+  bits += (127u - 15u) << 23;
+
+  // Infinities and NaNs keep an all-ones exponent
+  const uint32_t special = bits + ((128u - 16u) << 23);
+
+  // Subnormals are renormalized by a float subtraction
+  float subnormal;
+  uint32_t raised = bits + (1u << 23);
+  std::memcpy(&subnormal, &raised, sizeof(subnormal));
+  float magicValue;
+  std::memcpy(&magicValue, &magic, sizeof(magicValue));
+  subnormal -= magicValue;
+  uint32_t subnormalBits;
+  std::memcpy(&subnormalBits, &subnormal, sizeof(subnormalBits));
+
+  bits = detail::selectBits(exponent == 0, subnormalBits, bits);
+  bits = detail::selectBits(exponent == shiftedExponent, special, bits);
+  bits |= static_cast<uint32_t>(half & 0x8000u) << 16;
+
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+/**
+ * Convert a float to the bits of the nearest IEEE 754 half-precision
+ * value, rounding to even. Values beyond the range of half become
+ * infinities, and NaNs stay NaNs.
+ */
+inline uint16_t floatToHalfBits(float value)
+{
+  const uint32_t infinity = 255u << 23;
+  const uint32_t halfMax = (127u + 16u) << 23;
+  const uint32_t denormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const uint32_t sign = bits & 0x80000000u;
+  bits ^= sign;
+
+  // Infinities and NaNs, including values too large for half
+  const uint32_t special = detail::selectBits(bits > infinity, 0x7e00u,
+                                              0x7c00u);
+
+  // Subnormal results are rounded by a float addition, which aligns the
+  // mantissa bits at the bottom of the float
+  float magnitude, magic;
+  std::memcpy(&magnitude, &bits, sizeof(magnitude));
+  std::memcpy(&magic, &denormMagic, sizeof(magic));
+  magnitude += magic;
+  uint32_t subnormal;
+  std::memcpy(&subnormal, &magnitude, sizeof(subnormal));
+  subnormal -= denormMagic;
+
+  // Normal results drop 13 mantissa bits, rounding to even
+  const uint32_t odd = (bits >> 13) & 1u;
+  const uint32_t normal =
+    (bits + ((15u - 127u) << 23) + 0xfffu + odd) >> 13;
+
+  uint32_t half = detail::selectBits(bits < (113u << 23), subnormal, normal);
+  half = detail::selectBits(bits >= halfMax, special, half);
+  return static_cast<uint16_t>(half | (sign >> 16));
+}
+
+/**
+ * An IEEE 754 half-precision floating-point value, the C++ type of
+ * DataType::Float16. It only stores the value: convert it to float to
+ * compute with it. Use convertFloat16ToFloat() and
+ * convertFloatToFloat16() for arrays.
+ */
+struct float16
+{
+  uint16_t bits = 0;
+
+  float16() = default;
+  float16(float value) : bits(floatToHalfBits(value)) {}
+  operator float() const { return halfBitsToFloat(bits); }
+
+  /** A value with the given bits */
+  static float16 fromBits(uint16_t bits)
+  {
+    float16 result;
+    result.bits = bits;
+    return result;
+  }
+};
+
+/**
+ * Convert @p count half-precision values to floats. The loop has no
+ * branches, so that compilers vectorize it.
+ */
+void convertFloat16ToFloat(const float16* source, float* target,
+                           size_t count);
+
+/**
+ * Convert @p count floats to half precision, rounding to even. The loop
+ * has no branches, so that compilers vectorize it.
+ */
+void convertFloatToFloat16(const float* source, float16* target,
+                           size_t count);
+
+} // namespace h5
+
+#endif // tomvizH5Float16_h
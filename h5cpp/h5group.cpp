@@ -0,0 +1,315 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "h5group.h"
+
+#include <iostream>
+
+#include "h5capi.h"
+#include "h5dispatch.h"
+#include "h5typemaps.h"
+#include "h5utils.h"
+#include "hidcloser.h"
+
+using std::cerr;
+using std::endl;
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// Just a convenience function. Only sets "ok" if it is not nullptr.
+void setOk(bool* ok, bool status)
+{
+  if (ok)
+    *ok = status;
+}
+
+} // end namespace
+
+namespace h5 {
+
+class Group::GroupImpl {
+public:
+  GroupImpl(hid_t groupId, hid_t transferId, const string& path)
+    : m_group(groupId, H5Gclose), m_transfer(transferId, H5Pclose),
+      m_path(path)
+  {
+  }
+
+  // The path of a child, for error messages and the child's path()
+  string childPath(const string& name) const
+  {
+    if (m_path.empty() || m_path.back() == '/')
+      return m_path + name;
+
+    return m_path + "/" + name;
+  }
+
+  // Child handles get their own copy of the transfer property list
+  hid_t copyTransfer()
+  {
+    return m_transfer.valueIsValid() ? H5Pcopy(m_transfer.value()) : -1;
+  }
+
+  hid_t id() { return m_group.value(); }
+
+  hid_t transfer()
+  {
+    return m_transfer.valueIsValid() ? m_transfer.value() : H5P_DEFAULT;
+  }
+
+  HIDCloser m_group;
+  HIDCloser m_transfer;
+  string m_path;
+};
+
+Group::Group() = default;
+
+Group::Group(int64_t groupId, int64_t transferId, const string& path)
+  : m_impl(new GroupImpl(groupId, transferId, path))
+{
+}
+
+Group::~Group() = default;
+
+Group::Group(Group&& other) noexcept = default;
+
+Group& Group::operator=(Group&& other) noexcept = default;
+
+bool Group::isValid() const
+{
+  return m_impl && m_impl->m_group.valueIsValid();
+}
+
+const string& Group::path() const
+{
+  static const string empty;
+  return m_impl ? m_impl->m_path : empty;
+}
+
+vector<string> Group::children(bool* ok)
+{
+  setOk(ok, false);
+  vector<string> result;
+
+  if (!isValid()) {
+    cerr << "Group is not valid\n";
+    return result;
+  }
+
+  if (groupChildren(m_impl->id(), result))
+    setOk(ok, true);
+
+  return result;
+}
+
+DataSet Group::openDataSet(const string& name)
+{
+  if (!isValid()) {
+    cerr << "Group is not valid\n";
+    return DataSet();
+  }
+
+  hid_t dataSetId = H5Dopen(m_impl->id(), name.c_str(), H5P_DEFAULT);
+  if (dataSetId < 0) {
+    cerr << "Failed to open data set: " << m_impl->childPath(name) << endl;
+    return DataSet();
+  }
+
+  return DataSet(dataSetId, m_impl->copyTransfer(), m_impl->childPath(name));
+}
+
+Group Group::openGroup(const string& name)
+{
+  if (!isValid()) {
+    cerr << "Group is not valid\n";
+    return Group();
+  }
+
+  hid_t groupId = H5Gopen(m_impl->id(), name.c_str(), H5P_DEFAULT);
+  if (groupId < 0) {
+    cerr << "Failed to open group: " << m_impl->childPath(name) << endl;
+    return Group();
+  }
+
+  return Group(groupId, m_impl->copyTransfer(), m_impl->childPath(name));
+}
+
+Group Group::createGroup(const string& name)
+{
+  if (!isValid()) {
+    cerr << "Group is not valid\n";
+    return Group();
+  }
+
+  hid_t groupId = H5Gcreate(m_impl->id(), name.c_str(), H5P_DEFAULT,
+                            H5P_DEFAULT, H5P_DEFAULT);
+  if (groupId < 0) {
+    cerr << "Failed to create group: " << m_impl->childPath(name) << endl;
+    return Group();
+  }
+
+  return Group(groupId, m_impl->copyTransfer(), m_impl->childPath(name));
+}
+
+DataSet Group::createDataSet(const string& name,
+                             const vector<int>& dimensions,
+                             const DataType& type,
+                             const WriteOptions& options)
+{
+  if (!isValid()) {
+    cerr << "Group is not valid\n";
+    return DataSet();
+  }
+
+  hid_t dataSetId =
+    createEmptyDataSet(m_impl->id(), name, dimensions, type, options);
+  if (dataSetId < 0)
+    return DataSet();
+
+  return DataSet(dataSetId, m_impl->copyTransfer(), m_impl->childPath(name));
+}
+
+template <typename T>
+bool Group::writeData(const string& name, const vector<int>& dimensions,
+                      const T* data, const WriteOptions& options)
+{
+  if (!isValid()) {
+    cerr << "Group is not valid\n";
+    return false;
+  }
+
+  const hid_t dataTypeId = BasicTypeToH5<T>::dataTypeId();
+  const hid_t memTypeId = BasicTypeToH5<T>::memTypeId();
+
+  return writeDataSet(m_impl->id(), name, dimensions, dataTypeId, memTypeId,
+                      m_impl->transfer(), data, options);
+}
+
+template <typename T>
+bool Group::writeData(const string& name, const NDArray<T>& array,
+                      const WriteOptions& options)
+{
+  return writeData(name, array.shape(), array.data(), options);
+}
+
+bool Group::writeData(const string& name, const vector<int>& dimensions,
+                      const DataType& type, const void* data,
+                      const WriteOptions& options)
+{
+  if (!isValid()) {
+    cerr << "Group is not valid\n";
+    return false;
+  }
+
+  hid_t dataTypeId, memTypeId;
+  if (!h5TypeIds(type, dataTypeId, memTypeId)) {
+    cerr << "Failed to get H5 types for "
+         << H5ReadWrite::dataTypeToString(type) << "\n";
+    return false;
+  }
+
+  return writeDataSet(m_impl->id(), name, dimensions, dataTypeId, memTypeId,
+                      m_impl->transfer(), data, options);
+}
+
+bool Group::hasAttribute(const string& name)
+{
+  if (!isValid())
+    return false;
+
+  return H5Aexists(m_impl->id(), name.c_str()) > 0;
+}
+
+template <typename T>
+T Group::attribute(const string& name, bool* ok)
+{
+  setOk(ok, false);
+  T result = T();
+
+  if (!isValid()) {
+    cerr << "Group is not valid\n";
+    return result;
+  }
+
+  const DataType dataType = DataTypeOf<T>::value;
+  const hid_t memTypeId = BasicTypeToH5<T>::memTypeId();
+
+  if (readAttribute(m_impl->id(), ".", name, dataType, memTypeId, &result))
+    setOk(ok, true);
+
+  return result;
+}
+
+// We have a specialization for std::string
+template <>
+string Group::attribute<string>(const string& name, bool* ok)
+{
+  setOk(ok, false);
+  string result;
+
+  if (!isValid()) {
+    cerr << "Group is not valid\n";
+    return result;
+  }
+
+  if (readStringAttribute(m_impl->id(), ".", name, result))
+    setOk(ok, true);
+
+  return result;
+}
+
+template <typename T>
+bool Group::setAttribute(const string& name, T value)
+{
+  if (!isValid()) {
+    cerr << "Group is not valid\n";
+    return false;
+  }
+
+  const hid_t dataTypeId = BasicTypeToH5<T>::dataTypeId();
+  const hid_t memTypeId = BasicTypeToH5<T>::memTypeId();
+
+  return writeAttribute(m_impl->id(), name, dataTypeId, memTypeId, &value);
+}
+
+// Specialization for string
+template <>
+bool Group::setAttribute<const string&>(const string& name,
+                                        const string& value)
+{
+  if (!isValid()) {
+    cerr << "Group is not valid\n";
+    return false;
+  }
+
+  return writeStringAttribute(m_impl->id(), name, value);
+}
+
+template <>
+bool Group::setAttribute<const char*>(const string& name, const char* value)
+{
+  return setAttribute<const string&>(name, value);
+}
+
+// Instantiate our allowable templates here
+#define INSTANTIATE_GROUP_TEMPLATES(T, E)                                     \
+  template bool Group::writeData(const string&, const vector<int>&,           \
+                                 const T*, const WriteOptions&);              \
+  template bool Group::writeData(const string&, const NDArray<T>&,            \
+                                 const WriteOptions&);                        \
+  template T Group::attribute(const string&, bool*);                          \
+  template bool Group::setAttribute(const string&, T);
+
+H5CPP_FOR_EACH_BASIC_TYPE(INSTANTIATE_GROUP_TEMPLATES)
+H5CPP_FOR_EACH_EXTENDED_TYPE(INSTANTIATE_GROUP_TEMPLATES)
+
+#undef INSTANTIATE_GROUP_TEMPLATES
+
+template string Group::attribute(const string&, bool*);
+template bool Group::setAttribute(const string&, const string&);
+template bool Group::setAttribute(const string&, const char*);
+
+} // namespace h5
@@ -0,0 +1,139 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5Group_h
+#define tomvizH5Group_h
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "h5dataset.h"
+#include "h5ndarray.h"
+#include "h5readwrite.h"
+#include "h5writeoptions.h"
+
+namespace h5 {
+
+/**
+ * A handle to an open group, obtained from H5ReadWrite::openGroup() or
+ * Group::openGroup(). Names passed to its methods are relative to the
+ * group, which stays open for the lifetime of the handle.
+ */
+class Group
+{
+public:
+  using DataType = H5ReadWrite::DataType;
+
+  /** Creates an invalid handle */
+  Group();
+
+  /** Closes the group */
+  ~Group();
+
+  Group(Group&& other) noexcept;
+  Group& operator=(Group&& other) noexcept;
+
+  /** Copy constructor is disabled */
+  Group(const Group&) = delete;
+
+  /** Assignment operator is disabled */
+  Group& operator=(const Group&) = delete;
+
+  /** Whether the group was opened successfully */
+  bool isValid() const;
+
+  /** The path the group was opened with */
+  const std::string& path() const;
+
+  /**
+   * Get the names of the children of the group.
+   * @param ok If used, set to true on success and false on failure.
+   */
+  std::vector<std::string> children(bool* ok = nullptr);
+
+  /** Open a data set relative to this group */
+  DataSet openDataSet(const std::string& name);
+
+  /** Open a group relative to this group */
+  Group openGroup(const std::string& name);
+
+  /**
+   * Create a group relative to this group.
+   * @return A handle to the new group, which is invalid on failure.
+   */
+  Group createGroup(const std::string& name);
+
+  /**
+   * Create a data set in this group and write data to it.
+   * @param name The name of the data set.
+   * @param dimensions The dimensions of the data.
+   * @param data The data to write.
+   * @param options How to lay out the data set.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool writeData(const std::string& name, const std::vector<int>& dimensions,
+                 const T* data, const WriteOptions& options = WriteOptions());
+
+  /**
+   * Create a data set in this group and write @p array to it.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool writeData(const std::string& name, const NDArray<T>& array,
+                 const WriteOptions& options = WriteOptions());
+
+  /**
+   * Create a data set of type @p type in this group and write data to it.
+   * @return True on success, false on failure.
+   */
+  bool writeData(const std::string& name, const std::vector<int>& dimensions,
+                 const DataType& type, const void* data,
+                 const WriteOptions& options = WriteOptions());
+
+  /**
+   * Create a data set in this group without writing to it, see
+   * H5ReadWrite::createDataSet().
+   * @return A handle to the new data set, which is invalid on failure.
+   */
+  DataSet createDataSet(const std::string& name,
+                        const std::vector<int>& dimensions,
+                        const DataType& type,
+                        const WriteOptions& options = WriteOptions());
+
+  /** Check if the group has an attribute with a given name */
+  bool hasAttribute(const std::string& name);
+
+  /**
+   * Read an attribute of the group and interpret it as type T.
+   * @param name The name of the attribute.
+   * @param ok If used, set to true on success and false on failure.
+   * @return The attribute.
+   */
+  template <typename T>
+  T attribute(const std::string& name, bool* ok = nullptr);
+
+  /**
+   * Set an attribute on the group.
+   * @param name The name of the attribute.
+   * @param value The value of the attribute.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool setAttribute(const std::string& name, T value);
+
+private:
+  friend class H5ReadWrite;
+
+  // Takes ownership of the HDF5 group and transfer property list ids.
+  Group(int64_t groupId, int64_t transferId, const std::string& path);
+
+  class GroupImpl;
+  std::unique_ptr<GroupImpl> m_impl;
+};
+
+} // namespace h5
+
+#endif // tomvizH5Group_h
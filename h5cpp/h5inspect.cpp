@@ -0,0 +1,341 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "h5inspect.h"
+
+#include <iostream>
+
+#include "h5capi.h"
+#include "h5utils.h"
+#include "hidcloser.h"
+
+using std::cerr;
+using std::endl;
+
+using std::string;
+using std::vector;
+
+namespace h5 {
+
+using DataType = H5ReadWrite::DataType;
+using Kind = ObjectInfo::Kind;
+using Layout = WriteOptions::Layout;
+
+namespace {
+
+const char* typeClassName(H5T_class_t typeClass)
+{
+  switch (typeClass) {
+    case H5T_INTEGER:
+      return "Integer";
+    case H5T_FLOAT:
+      return "FloatingPoint";
+    case H5T_TIME:
+      return "Time";
+    case H5T_STRING:
+      return "String";
+    case H5T_BITFIELD:
+      return "Bitfield";
+    case H5T_OPAQUE:
+      return "Opaque";
+    case H5T_COMPOUND:
+      return "Compound";
+    case H5T_REFERENCE:
+      return "Reference";
+    case H5T_ENUM:
+      return "Enum";
+    case H5T_VLEN:
+      return "VLen";
+    case H5T_ARRAY:
+      return "Array";
+    default:
+      return "Unknown";
+  }
+}
+
+// The type of the elements, and its name. Only the classes that h5cpp
+// reads are converted, so that other types are named without errors.
+void describeType(hid_t typeId, DataType& type, string& name)
+{
+  const H5T_class_t typeClass = H5Tget_class(typeId);
+  type = DataType::None;
+  switch (typeClass) {
+    case H5T_INTEGER:
+    case H5T_FLOAT:
+    case H5T_STRING:
+    case H5T_COMPOUND:
+      type = h5ToDataType(typeId);
+      break;
+    default:
+      break;
+  }
+
+  if (type != DataType::None) {
+    name = H5ReadWrite::dataTypeToString(type);
+    return;
+  }
+
+  name = typeClassName(typeClass);
+  name += " (" + std::to_string(H5Tget_size(typeId)) + " bytes)";
+}
+
+bool describeSpace(hid_t spaceId, vector<int>& dimensions)
+{
+  const int rank = H5Sget_simple_extent_ndims(spaceId);
+  if (rank < 0)
+    return false;
+
+  vector<hsize_t> dims(rank);
+  if (rank > 0 && H5Sget_simple_extent_dims(spaceId, dims.data(), nullptr) < 0)
+    return false;
+
+  dimensions.assign(dims.begin(), dims.end());
+  return true;
+}
+
+class Inspector
+{
+public:
+  Inspector(hid_t fileId, const string& path, const InspectOptions& options)
+    : m_fileId(fileId), m_path(path), m_options(options)
+  {
+  }
+
+  static herr_t visitObject(hid_t /*o_id*/, const char* name,
+                            const H5O_info_t* info, void* op_data)
+  {
+    auto* self = static_cast<Inspector*>(op_data);
+    self->addObject(name, *info);
+    return 0;
+  }
+
+  static herr_t visitAttribute(hid_t location_id, const char* name,
+                               const H5A_info_t* /*ainfo*/, void* op_data)
+  {
+    auto* self = static_cast<Inspector*>(op_data);
+    if (!self->addAttribute(location_id, name))
+      self->ok = false;
+    return 0;
+  }
+
+  vector<ObjectInfo> objects;
+  bool ok = true;
+
+private:
+  void addObject(const char* name, const H5O_info_t& info)
+  {
+    objects.emplace_back();
+    ObjectInfo& object = objects.back();
+
+    // The names are relative to the visited object, which is "."
+    if (string(name) == ".")
+      object.path = m_path;
+    else if (m_path == "/")
+      object.path = m_path + name;
+    else
+      object.path = m_path + '/' + name;
+
+    switch (info.type) {
+      case H5O_TYPE_GROUP:
+        object.kind = Kind::Group;
+        break;
+      case H5O_TYPE_DATASET:
+        object.kind = Kind::DataSet;
+        break;
+      case H5O_TYPE_NAMED_DATATYPE:
+        object.kind = Kind::NamedType;
+        break;
+      default:
+        object.kind = Kind::Unknown;
+        break;
+    }
+
+    const bool listAttributes = m_options.attributes && info.num_attrs > 0;
+    if (object.kind != Kind::DataSet && !listAttributes)
+      return;
+
+    // The address is found again without looking up the path
+    HIDCloser objectCloser(H5Oopen_by_addr(m_fileId, info.addr), H5Oclose);
+    if (!objectCloser.valueIsValid()) {
+      cerr << "Failed to open " << object.path << endl;
+      ok = false;
+      return;
+    }
+
+    if (object.kind == Kind::DataSet &&
+        !describeDataSet(objectCloser.value(), object)) {
+      cerr << "Failed to describe the data set " << object.path << endl;
+      ok = false;
+    }
+
+    if (listAttributes) {
+      m_attributes = &object.attributes;
+      if (H5Aiterate2(objectCloser.value(), H5_INDEX_NAME, H5_ITER_INC,
+                      nullptr, &visitAttribute, this) < 0) {
+        cerr << "Failed to list the attributes of " << object.path << endl;
+        ok = false;
+      }
+      m_attributes = nullptr;
+    }
+  }
+
+  bool describeDataSet(hid_t dataSetId, ObjectInfo& object)
+  {
+    HIDCloser typeCloser(H5Dget_type(dataSetId), H5Tclose);
+    HIDCloser spaceCloser(H5Dget_space(dataSetId), H5Sclose);
+    HIDCloser createCloser(H5Dget_create_plist(dataSetId), H5Pclose);
+    if (!typeCloser.valueIsValid() || !spaceCloser.valueIsValid() ||
+        !createCloser.valueIsValid()) {
+      return false;
+    }
+
+    describeType(typeCloser.value(), object.type, object.typeName);
+    if (!describeSpace(spaceCloser.value(), object.dimensions))
+      return false;
+
+    const hssize_t count = H5Sget_simple_extent_npoints(spaceCloser.value());
+    object.logicalBytes = static_cast<uint64_t>(count > 0 ? count : 0) *
+                          H5Tget_size(typeCloser.value());
+    object.storedBytes = H5Dget_storage_size(dataSetId);
+
+    hid_t createId = createCloser.value();
+    switch (H5Pget_layout(createId)) {
+      case H5D_COMPACT:
+        object.layout = Layout::Compact;
+        break;
+      case H5D_CONTIGUOUS:
+        object.layout = Layout::Contiguous;
+        break;
+      case H5D_CHUNKED:
+        object.layout = Layout::Chunked;
+        break;
+      default:
+        object.layout = Layout::Automatic;
+        break;
+    }
+
+    if (object.layout == Layout::Chunked) {
+      vector<hsize_t> chunks(object.dimensions.size());
+      const int rank =
+        H5Pget_chunk(createId, static_cast<int>(chunks.size()), chunks.data());
+      if (rank < 0)
+        return false;
+
+      object.chunkDimensions.assign(chunks.begin(), chunks.begin() + rank);
+    }
+
+    const int filterCount = H5Pget_nfilters(createId);
+    for (int i = 0; i < filterCount; ++i) {
+      unsigned flags = 0;
+      size_t valueCount = 0;
+      unsigned config = 0;
+      char name[256] = "";
+      H5Z_filter_t id = H5Pget_filter2(createId, i, &flags, &valueCount,
+                                       nullptr, sizeof(name), name, &config);
+      if (id < 0)
+        return false;
+
+      object.filters.push_back(name[0] ? string(name)
+                                       : "filter " + std::to_string(id));
+    }
+
+    return true;
+  }
+
+  bool addAttribute(hid_t objectId, const char* name)
+  {
+    m_attributes->emplace_back();
+    AttributeInfo& attribute = m_attributes->back();
+    attribute.name = name;
+
+    HIDCloser attributeCloser(H5Aopen(objectId, name, H5P_DEFAULT),
+                              H5Aclose);
+    if (!attributeCloser.valueIsValid())
+      return false;
+
+    hid_t attributeId = attributeCloser.value();
+    HIDCloser typeCloser(H5Aget_type(attributeId), H5Tclose);
+    HIDCloser spaceCloser(H5Aget_space(attributeId), H5Sclose);
+    if (!typeCloser.valueIsValid() || !spaceCloser.valueIsValid())
+      return false;
+
+    describeType(typeCloser.value(), attribute.type, attribute.typeName);
+    if (!describeSpace(spaceCloser.value(), attribute.dimensions))
+      return false;
+
+    const hssize_t count = H5Sget_simple_extent_npoints(spaceCloser.value());
+    if (count <= 0 || static_cast<size_t>(count) > m_options.maxAttributeValues)
+      return true;
+
+    switch (H5Tget_class(typeCloser.value())) {
+      case H5T_INTEGER:
+      case H5T_FLOAT:
+        // HDF5 converts every integer and floating point type to double
+        attribute.numbers.resize(static_cast<size_t>(count));
+        return H5Aread(attributeId, H5T_NATIVE_DOUBLE,
+                       attribute.numbers.data()) >= 0;
+      case H5T_STRING:
+        return readStringAttributeValues(objectId, name, attribute.strings);
+      default:
+        return true;
+    }
+  }
+
+  hid_t m_fileId;
+  string m_path;
+  const InspectOptions& m_options;
+  vector<AttributeInfo>* m_attributes = nullptr;
+};
+
+} // end namespace
+
+vector<ObjectInfo> inspect(H5ReadWrite& file, const string& path,
+                           const InspectOptions& options, bool* ok)
+{
+  if (ok)
+    *ok = false;
+
+  hid_t fileId = file.fileId();
+  if (fileId < 0) {
+    cerr << "The file is not open\n";
+    return vector<ObjectInfo>();
+  }
+
+  HIDCloser objectCloser(H5Oopen(fileId, path.c_str(), H5P_DEFAULT),
+                         H5Oclose);
+  if (!objectCloser.valueIsValid()) {
+    cerr << "Failed to open " << path << endl;
+    return vector<ObjectInfo>();
+  }
+
+  // Only the fields that are used are read, which spares decoding the
+  // header messages of every object for the times and the header sizes
+  Inspector inspector(fileId, path, options);
+  if (H5Ovisit2(objectCloser.value(), H5_INDEX_NAME, H5_ITER_INC,
+                &Inspector::visitObject, &inspector,
+                H5O_INFO_BASIC | H5O_INFO_NUM_ATTRS) < 0) {
+    cerr << "Failed to visit the objects under " << path << endl;
+    return inspector.objects;
+  }
+
+  if (ok)
+    *ok = inspector.ok;
+
+  return inspector.objects;
+}
+
+string kindToString(ObjectInfo::Kind kind)
+{
+  switch (kind) {
+    case Kind::Group:
+      return "Group";
+    case Kind::DataSet:
+      return "DataSet";
+    case Kind::NamedType:
+      return "NamedType";
+    default:
+      return "Unknown";
+  }
+}
+
+} // namespace h5
@@ -0,0 +1,117 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5Inspect_h
+#define tomvizH5Inspect_h
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "h5readwrite.h"
+#include "h5writeoptions.h"
+
+namespace h5 {
+
+/** What inspect() reads besides the structure */
+struct InspectOptions
+{
+  /** Whether the attributes of the objects are listed */
+  bool attributes = true;
+
+  /**
+   * The values of numeric and string attributes with at most this many
+   * elements are read. Larger attributes only have their type and
+   * dimensions listed.
+   */
+  size_t maxAttributeValues = 16;
+};
+
+/** An attribute, as listed by inspect() */
+struct AttributeInfo
+{
+  std::string name;
+
+  /** The type, or None for types that h5cpp does not read */
+  H5ReadWrite::DataType type = H5ReadWrite::DataType::None;
+
+  /** The name of the type, such as "Float" or "Enum" */
+  std::string typeName;
+
+  /** The dimensions, which are empty for scalars */
+  std::vector<int> dimensions;
+
+  /** The values, if they were read, in numbers or in strings */
+  std::vector<double> numbers;
+  std::vector<std::string> strings;
+};
+
+/** A group, data set or named data type, as listed by inspect() */
+struct ObjectInfo
+{
+  /** Enumeration of the kinds of objects */
+  enum class Kind {
+    Group,
+    DataSet,
+    NamedType,
+    Unknown
+  };
+
+  /** The absolute path, such as "/data/volume" */
+  std::string path;
+
+  Kind kind = Kind::Unknown;
+
+  std::vector<AttributeInfo> attributes;
+
+  // The rest describes data sets only
+
+  /** The type, or None for types that h5cpp does not read */
+  H5ReadWrite::DataType type = H5ReadWrite::DataType::None;
+
+  /** The name of the type, such as "Float" or "Enum" */
+  std::string typeName;
+
+  /** The dimensions, which are empty for scalars */
+  std::vector<int> dimensions;
+
+  /** The layout, or Automatic for layouts such as virtual data sets */
+  WriteOptions::Layout layout = WriteOptions::Layout::Automatic;
+
+  /** The dimensions of the chunks of chunked data sets */
+  std::vector<int> chunkDimensions;
+
+  /** The names of the filters, in the order they are applied */
+  std::vector<std::string> filters;
+
+  /** The size of the elements, and the space allocated for them */
+  uint64_t logicalBytes = 0;
+  uint64_t storedBytes = 0;
+};
+
+/**
+ * List every object under @p path, in one pass over the metadata: each
+ * object is visited once, in depth-first order, with the children of a
+ * group in the order of their names. Groups are only opened if they have
+ * attributes, and data are never read.
+ * @param file The file.
+ * @param path The group, or data set, to list. It is listed first.
+ * @param options What is read besides the structure.
+ * @param ok If used, set to false if an object could not be described,
+ *           or if nothing could be listed, and to true otherwise. The
+ *           objects that could be described are listed either way.
+ * @return The objects.
+ */
+std::vector<ObjectInfo> inspect(H5ReadWrite& file,
+                                const std::string& path = "/",
+                                const InspectOptions& options =
+                                  InspectOptions(),
+                                bool* ok = nullptr);
+
+/** Get a string representation of the enum ObjectInfo::Kind */
+std::string kindToString(ObjectInfo::Kind kind);
+
+} // namespace h5
+
+#endif // tomvizH5Inspect_h
@@ -0,0 +1,236 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "h5ioactor.h"
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+#include "h5dataset.h"
+#include "h5dispatch.h"
+#include "h5mpscqueue.h"
+#include "h5wait.h"
+
+using std::cerr;
+using std::endl;
+
+using std::string;
+using std::vector;
+
+namespace h5 {
+
+using DataType = H5ReadWrite::DataType;
+
+namespace {
+
+struct ElementSizeVisitor
+{
+  size_t& size;
+
+  template <typename T>
+  void operator()(TypeTag<T>) const
+  {
+    size = sizeof(T);
+  }
+};
+
+template <typename T>
+struct ConvertVisitor
+{
+  const void* source;
+  T* target;
+  size_t count;
+
+  template <typename S>
+  void operator()(TypeTag<S>) const
+  {
+    const S* values = static_cast<const S*>(source);
+    for (size_t i = 0; i < count; ++i)
+      target[i] = static_cast<T>(values[i]);
+  }
+};
+
+// Read a hyperslab, or the whole data set if @p start is null, into
+// @p array. The I/O thread reads the data set in its own type, straight
+// into the array if it is of type T, and the calling thread converts it
+// otherwise.
+template <typename T>
+bool readArray(IOActor& actor, const string& path, const vector<int>* start,
+               const vector<int>* counts, NDArray<T>& array)
+{
+  DataType type = DataType::None;
+  vector<unsigned char> buffer;
+
+  auto read = [&](H5ReadWrite& file) {
+    DataSet dataSet = file.openDataSet(path);
+    if (!dataSet.isValid())
+      return false;
+
+    type = dataSet.type();
+
+    // Float16 is widened to float as it is read. Quantized data sets are
+    // read in the requested type, so that they are restored as float and
+    // rejected as any other type, as DataSet::readData() does.
+    if (type == DataType::Float16)
+      type = DataType::Float;
+    else if (dataSet.isQuantized())
+      type = DataTypeOf<T>::value;
+
+    size_t elementSize = 0;
+    if (!dispatch(type, ElementSizeVisitor{ elementSize })) {
+      cerr << path << " does not hold a basic type\n";
+      return false;
+    }
+
+    vector<int> slabStart =
+      start ? *start : vector<int>(dataSet.dimensionCount(), 0);
+    vector<int> slabCounts = counts ? *counts : dataSet.dimensions();
+    array.resize(slabCounts);
+    if (type == DataTypeOf<T>::value)
+      return dataSet.readSlab(slabStart, slabCounts, type, array.data());
+
+    buffer.resize(array.size() * elementSize);
+    return dataSet.readSlab(slabStart, slabCounts, type, buffer.data());
+  };
+
+  if (!actor.submit(read).get())
+    return false;
+
+  if (type != DataTypeOf<T>::value)
+    dispatch(type, ConvertVisitor<T>{ buffer.data(), array.data(),
+                                      array.size() });
+
+  return true;
+}
+
+} // end namespace
+
+class IOActor::IOActorImpl {
+public:
+  IOActorImpl(const string& fileName, OpenMode mode,
+              const OpenOptions& options)
+  {
+    std::promise<bool> opened;
+    std::future<bool> valid = opened.get_future();
+    m_thread = std::thread(&IOActorImpl::run, this, fileName, mode, options,
+                           std::ref(opened));
+    m_valid = valid.get();
+  }
+
+  ~IOActorImpl()
+  {
+    m_stop = true;
+    wake();
+    m_thread.join();
+  }
+
+  void post(Task task)
+  {
+    m_queue.push(std::move(task));
+    wake();
+  }
+
+  // Producers only take the lock when the I/O thread is asleep
+  void wake()
+  {
+    if (m_sleeping) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_changed.notify_one();
+    }
+  }
+
+  // The I/O thread: the file lives and dies on it
+  void run(string fileName, OpenMode mode, OpenOptions options,
+           std::promise<bool>& opened)
+  {
+    H5ReadWrite file(fileName, mode, options);
+    opened.set_value(file.fileId() >= 0);
+
+    Task task;
+    while (true) {
+      while (m_queue.pop(task))
+        task(file);
+
+      if (m_stop && m_queue.empty())
+        return;
+
+      // Announce the sleep before the last look at the queue, so that a
+      // producer either sees it, or its task is seen here
+      m_sleeping = true;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        waitUntil(m_changed, lock,
+                  [this]() { return m_stop || !m_queue.empty(); });
+      }
+      m_sleeping = false;
+    }
+  }
+
+  MPSCQueue<Task> m_queue;
+  std::atomic<bool> m_sleeping{ false };
+  std::atomic<bool> m_stop{ false };
+  bool m_valid = false;
+
+  std::mutex m_mutex;
+  std::condition_variable m_changed;
+  std::thread m_thread;
+};
+
+IOActor::IOActor(const string& fileName, OpenMode mode,
+                 const OpenOptions& options)
+  : m_impl(new IOActorImpl(fileName, mode, options))
+{
+}
+
+IOActor::~IOActor() = default;
+
+bool IOActor::isValid() const
+{
+  return m_impl->m_valid;
+}
+
+void IOActor::post(Task task)
+{
+  m_impl->post(std::move(task));
+}
+
+template <typename T>
+bool IOActor::readData(const string& path, NDArray<T>& array)
+{
+  if (!isValid()) {
+    cerr << "IO actor is not valid\n";
+    return false;
+  }
+
+  return readArray(*this, path, nullptr, nullptr, array);
+}
+
+template <typename T>
+bool IOActor::readSlab(const string& path, const vector<int>& start,
+                       const vector<int>& counts, NDArray<T>& array)
+{
+  if (!isValid()) {
+    cerr << "IO actor is not valid\n";
+    return false;
+  }
+
+  if (start.size() != counts.size()) {
+    cerr << "The start and counts of " << path << " differ in size" << endl;
+    return false;
+  }
+
+  return readArray(*this, path, &start, &counts, array);
+}
+
+// Instantiate our allowable templates here
+#define INSTANTIATE_IOACTOR_TEMPLATES(T, E)                                    \
+  template bool IOActor::readData(const string&, NDArray<T>&);                 \
+  template bool IOActor::readSlab(const string&, const vector<int>&,           \
+                                  const vector<int>&, NDArray<T>&);
+
+H5CPP_FOR_EACH_BASIC_TYPE(INSTANTIATE_IOACTOR_TEMPLATES)
+
+#undef INSTANTIATE_IOACTOR_TEMPLATES
+
+} // namespace h5
@@ -0,0 +1,118 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5IOActor_h
+#define tomvizH5IOActor_h
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "h5ndarray.h"
+#include "h5readwrite.h"
+
+namespace h5 {
+
+/**
+ * A front-end that lets many threads share one file. The file is owned
+ * by a dedicated I/O thread, and every HDF5 call is sent to that thread
+ * through a lock-free queue, so the calling threads never contend on a
+ * lock and HDF5 is only ever used from one thread, whether or not it was
+ * built thread-safe:
+ *
+ *   IOActor actor("volume.h5");
+ *   // From any number of threads
+ *   NDArray<float> slab;
+ *   actor.readSlab("/data", start, counts, slab);
+ *
+ * The convenience reads only do the HDF5 part on the I/O thread, which
+ * reads the data set in its own type. The conversion to the requested
+ * type runs on the calling thread, so it scales with the callers. Any
+ * other call can be sent with submit().
+ *
+ * Other H5ReadWrite instances in the process still call HDF5 from their
+ * own threads, so without a thread-safe HDF5 all access should go
+ * through actors.
+ */
+class IOActor
+{
+public:
+  using OpenMode = H5ReadWrite::OpenMode;
+
+  /** A call to run on the I/O thread */
+  using Task = std::function<void(H5ReadWrite&)>;
+
+  /**
+   * Start the I/O thread and open a file on it.
+   * @param fileName The file to open.
+   * @param mode The mode to open the file with.
+   * @param options The tuning of the file.
+   */
+  explicit IOActor(const std::string& fileName,
+                   OpenMode mode = OpenMode::ReadOnly,
+                   const OpenOptions& options = OpenOptions());
+
+  /** Runs the calls that are still queued, then closes the file */
+  ~IOActor();
+
+  /** Copy constructor is disabled */
+  IOActor(const IOActor&) = delete;
+
+  /** Assignment operator is disabled */
+  IOActor& operator=(const IOActor&) = delete;
+
+  /** Whether the file was opened successfully */
+  bool isValid() const;
+
+  /**
+   * Queue a call on the I/O thread. It may be called from any thread.
+   * The calls run one at a time, in the order they were queued.
+   */
+  void post(Task task);
+
+  /**
+   * Queue a call on the I/O thread, and get a future of its result.
+   * @param function Called with the H5ReadWrite of the file.
+   */
+  template <typename Function>
+  auto submit(Function function)
+    -> std::future<decltype(function(std::declval<H5ReadWrite&>()))>
+  {
+    using Result = decltype(function(std::declval<H5ReadWrite&>()));
+    auto task =
+      std::make_shared<std::packaged_task<Result(H5ReadWrite&)>>(function);
+    std::future<Result> result = task->get_future();
+    post([task](H5ReadWrite& file) { (*task)(file); });
+    return result;
+  }
+
+  /**
+   * Read a whole data set of any basic type into @p array, converted to
+   * type T on the calling thread. The array is reshaped to the dimensions
+   * of the data set.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool readData(const std::string& path, NDArray<T>& array);
+
+  /**
+   * Read a hyperslab of a data set of any basic type into @p array,
+   * converted to type T on the calling thread. The array is reshaped to
+   * @p counts.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool readSlab(const std::string& path, const std::vector<int>& start,
+                const std::vector<int>& counts, NDArray<T>& array);
+
+private:
+  class IOActorImpl;
+  std::unique_ptr<IOActorImpl> m_impl;
+};
+
+} // namespace h5
+
+#endif // tomvizH5IOActor_h
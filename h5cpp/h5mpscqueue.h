@@ -0,0 +1,78 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5MPSCQueue_h
+#define tomvizH5MPSCQueue_h
+
+// Internal helper for the classes that hand work between threads.
+
+#include <atomic>
+#include <utility>
+
+namespace h5 {
+
+/**
+ * An unbounded, lock-free queue with many producers and a single
+ * consumer. push() may be called from any thread; pop() and empty() only
+ * from the consumer. A producer swaps itself in as the newest node with a
+ * single exchange, so producers never wait for each other or for the
+ * consumer.
+ */
+template <typename T>
+class MPSCQueue
+{
+public:
+  MPSCQueue() : m_head(new Node), m_tail(m_head.load()) {}
+
+  ~MPSCQueue()
+  {
+    T value;
+    while (pop(value)) {
+    }
+    delete m_tail;
+  }
+
+  MPSCQueue(const MPSCQueue&) = delete;
+  MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+  void push(T value)
+  {
+    Node* node = new Node(std::move(value));
+    Node* previous = m_head.exchange(node, std::memory_order_acq_rel);
+    // Until this store, the consumer sees the queue end at previous
+    previous->next.store(node);
+  }
+
+  bool pop(T& value)
+  {
+    Node* next = m_tail->next.load();
+    if (!next)
+      return false;
+
+    // The node after the tail holds the value, and becomes the new tail
+    value = std::move(next->value);
+    delete m_tail;
+    m_tail = next;
+    return true;
+  }
+
+  bool empty() const { return m_tail->next.load() == nullptr; }
+
+private:
+  struct Node
+  {
+    Node() = default;
+    explicit Node(T v) : value(std::move(v)) {}
+
+    std::atomic<Node*> next{ nullptr };
+    T value;
+  };
+
+  std::atomic<Node*> m_head;
+  // Only the consumer touches the tail, which is an empty node
+  Node* m_tail;
+};
+
+} // namespace h5
+
+#endif // tomvizH5MPSCQueue_h
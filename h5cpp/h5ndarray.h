@@ -0,0 +1,132 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5NDArray_h
+#define tomvizH5NDArray_h
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+namespace h5 {
+
+/**
+ * An owning, row-major N-dimensional array. The buffer is not initialized
+ * when it is allocated, so that reading into it touches the memory only
+ * once. NDArray is move-only: copies of large volumes must be explicit.
+ */
+template <typename T>
+class NDArray
+{
+public:
+  NDArray() = default;
+
+  /** Allocate an array of the given shape. The data is uninitialized. */
+  explicit NDArray(const std::vector<int>& shape) { resize(shape); }
+
+  NDArray(NDArray&& other) noexcept { *this = std::move(other); }
+
+  NDArray& operator=(NDArray&& other) noexcept
+  {
+    if (this != &other) {
+      m_data = std::move(other.m_data);
+      m_capacity = other.m_capacity;
+      m_shape = std::move(other.m_shape);
+      m_strides = std::move(other.m_strides);
+      other.m_capacity = 0;
+      other.m_shape.clear();
+      other.m_strides.clear();
+    }
+    return *this;
+  }
+
+  /** Copy constructor is disabled */
+  NDArray(const NDArray&) = delete;
+
+  /** Assignment operator is disabled */
+  NDArray& operator=(const NDArray&) = delete;
+
+  /**
+   * Change the shape of the array. The buffer is only reallocated if it
+   * is too small, so repeated reads of the same size reuse it. The
+   * contents are unspecified afterwards.
+   */
+  void resize(const std::vector<int>& shape)
+  {
+    size_t newSize = sizeFor(shape);
+    if (newSize > m_capacity) {
+      m_data.reset(new T[newSize]);
+      m_capacity = newSize;
+    }
+
+    m_shape = shape;
+    m_strides.assign(shape.size(), 1);
+    for (size_t i = shape.size(); i > 1; --i)
+      m_strides[i - 2] = m_strides[i - 1] * static_cast<size_t>(shape[i - 1]);
+  }
+
+  /** The dimensions of the array */
+  const std::vector<int>& shape() const { return m_shape; }
+
+  /** The distance between neighbors along each dimension, in elements */
+  const std::vector<size_t>& strides() const { return m_strides; }
+
+  /** The number of dimensions */
+  size_t dimensionCount() const { return m_shape.size(); }
+
+  /** The total number of elements */
+  size_t size() const { return m_shape.empty() ? 0 : sizeFor(m_shape); }
+
+  bool empty() const { return size() == 0; }
+
+  T* data() { return m_data.get(); }
+  const T* data() const { return m_data.get(); }
+
+  T& operator[](size_t i) { return m_data[i]; }
+  const T& operator[](size_t i) const { return m_data[i]; }
+
+  /**
+   * Access an element by its index along each dimension. There must be
+   * one index per dimension.
+   */
+  template <typename... Index>
+  T& operator()(Index... index)
+  {
+    assert(sizeof...(Index) == m_shape.size());
+    return m_data[offset(0, index...)];
+  }
+
+  template <typename... Index>
+  const T& operator()(Index... index) const
+  {
+    assert(sizeof...(Index) == m_shape.size());
+    return m_data[offset(0, index...)];
+  }
+
+private:
+  static size_t sizeFor(const std::vector<int>& shape)
+  {
+    return std::accumulate(shape.cbegin(), shape.cend(), size_t(1),
+                           std::multiplies<size_t>());
+  }
+
+  size_t offset(size_t) const { return 0; }
+
+  template <typename... Rest>
+  size_t offset(size_t dim, size_t first, Rest... rest) const
+  {
+    return first * m_strides[dim] + offset(dim + 1, rest...);
+  }
+
+  std::unique_ptr<T[]> m_data;
+  size_t m_capacity = 0;
+  std::vector<int> m_shape;
+  std::vector<size_t> m_strides;
+};
+
+} // namespace h5
+
+#endif // tomvizH5NDArray_h
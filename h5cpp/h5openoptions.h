@@ -0,0 +1,112 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5OpenOptions_h
+#define tomvizH5OpenOptions_h
+
+#include <cstddef>
+
+namespace h5 {
+
+/**
+ * Tuning of the file creation and file access property lists used when
+ * opening or creating a file. A value of zero leaves the corresponding
+ * setting at the HDF5 default, so a default constructed OpenOptions
+ * behaves exactly like H5P_DEFAULT.
+ */
+struct OpenOptions
+{
+  /** Use the latest file format for new objects (libver bounds). */
+  bool latestFormat = false;
+
+  /**
+   * The file space page size in bytes. Only used when creating a file.
+   * If non-zero, the paged file space strategy is used.
+   */
+  size_t pageSize = 0;
+
+  /**
+   * The size of the page buffer in bytes. Only has an effect on files
+   * that were created with a page size, and must be at least as large
+   * as the page size. It is ignored for files that are not paged.
+   */
+  size_t pageBufferSize = 0;
+
+  /** The initial and maximum size of the metadata cache in bytes. */
+  size_t metadataCacheSize = 0;
+
+  /** The minimum size in bytes of blocks allocated for metadata. */
+  size_t metadataBlockSize = 0;
+
+  /**
+   * Objects of at least alignmentThreshold bytes are aligned on
+   * addresses that are multiples of alignment, such as the stripe size.
+   */
+  size_t alignmentThreshold = 0;
+  size_t alignment = 0;
+
+  /** The size of the data sieve buffer in bytes. */
+  size_t sieveBufferSize = 0;
+
+  /** The size of the raw data chunk cache of each data set in bytes. */
+  size_t chunkCacheSize = 0;
+
+  /**
+   * Share the file id with the other pooled instances of the same file
+   * and mode, and keep it open for a while after the last one is closed
+   * (see FilePool). Only used when opening an existing file. The options
+   * of the instance that opens the file apply to all of them.
+   */
+  bool pooled = false;
+
+  /**
+   * Preset for parallel file systems such as Lustre or GPFS: aligns
+   * large objects on 1 MiB stripes and aggregates metadata into large
+   * blocks, so that opens issue few, large requests.
+   */
+  static OpenOptions parallelFilesystem()
+  {
+    OpenOptions options;
+    options.latestFormat = true;
+    options.metadataCacheSize = 32 * 1024 * 1024;
+    options.metadataBlockSize = 1024 * 1024;
+    options.alignmentThreshold = 64 * 1024;
+    options.alignment = 1024 * 1024;
+    options.sieveBufferSize = 4 * 1024 * 1024;
+    options.chunkCacheSize = 64 * 1024 * 1024;
+    return options;
+  }
+
+  /**
+   * Preset for local NVMe drives, where latency is low and alignment
+   * does not matter, but larger caches still avoid repeated reads.
+   */
+  static OpenOptions localNVMe()
+  {
+    OpenOptions options;
+    options.latestFormat = true;
+    options.sieveBufferSize = 1024 * 1024;
+    options.chunkCacheSize = 32 * 1024 * 1024;
+    return options;
+  }
+
+  /**
+   * Preset for files with many small groups, data sets and attributes:
+   * paged file space with a page buffer keeps the metadata together and
+   * in memory.
+   */
+  static OpenOptions manySmallObjects()
+  {
+    OpenOptions options;
+    options.latestFormat = true;
+    options.pageSize = 64 * 1024;
+    options.pageBufferSize = 4 * 1024 * 1024;
+    options.metadataCacheSize = 16 * 1024 * 1024;
+    options.metadataBlockSize = 64 * 1024;
+    return options;
+  }
+};
+
+} // namespace h5
+
+#endif // tomvizH5OpenOptions_h
@@ -0,0 +1,611 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "h5openpmdreader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "h5capi.h"
+#include "h5dispatch.h"
+#include "h5typemaps.h"
+#include "h5utils.h"
+#include "hidcloser.h"
+
+using std::cerr;
+using std::endl;
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// Just a convenience function. Only sets "ok" if it is not nullptr.
+void setOk(bool* ok, bool status)
+{
+  if (ok)
+    *ok = status;
+}
+
+// Split a path into its names, ignoring empty ones
+vector<string> splitPath(const string& path)
+{
+  vector<string> names;
+  size_t begin = 0;
+  while (begin <= path.size()) {
+    size_t end = path.find('/', begin);
+    if (end == string::npos)
+      end = path.size();
+
+    if (end > begin)
+      names.push_back(path.substr(begin, end - begin));
+
+    begin = end + 1;
+  }
+  return names;
+}
+
+// Iterations are named by their index, and nothing else is an iteration
+bool parseIndex(const string& name, long long& index)
+{
+  // Only ASCII digits, whatever the locale and the bytes of other names
+  if (name.empty() || name.size() > 18 ||
+      !std::all_of(name.begin(), name.end(),
+                   [](char c) { return c >= '0' && c <= '9'; })) {
+    return false;
+  }
+
+  index = std::stoll(name);
+  return true;
+}
+
+// Whether @p names starts with @p prefix
+bool startsWith(const vector<string>& names, const vector<string>& prefix)
+{
+  return names.size() >= prefix.size() &&
+         std::equal(prefix.begin(), prefix.end(), names.begin());
+}
+
+// Attributes are optional in the index, and missing ones keep a default.
+// Check that they exist first, so that HDF5 does not print errors.
+string stringAttribute(hid_t objectId, const char* name,
+                       const string& fallback = string())
+{
+  vector<string> values;
+  if (H5Aexists(objectId, name) <= 0 ||
+      !h5::readStringAttributeValues(objectId, name, values) ||
+      values.empty()) {
+    return fallback;
+  }
+
+  return values[0];
+}
+
+vector<string> stringsAttribute(hid_t objectId, const char* name)
+{
+  vector<string> values;
+  if (H5Aexists(objectId, name) > 0)
+    h5::readStringAttributeValues(objectId, name, values);
+
+  return values;
+}
+
+vector<double> numbersAttribute(hid_t objectId, const char* name)
+{
+  vector<double> values;
+  if (H5Aexists(objectId, name) > 0)
+    h5::readNumericAttribute(objectId, name, values);
+
+  return values;
+}
+
+double numberAttribute(hid_t objectId, const char* name, double fallback)
+{
+  vector<double> values = numbersAttribute(objectId, name);
+  return values.empty() ? fallback : values[0];
+}
+
+} // end namespace
+
+namespace h5 {
+
+using Component = OpenPMDReader::Component;
+using Iteration = OpenPMDReader::Iteration;
+using Mesh = OpenPMDReader::Mesh;
+using MeshGeometry = OpenPMDReader::MeshGeometry;
+using Record = OpenPMDReader::Record;
+using Species = OpenPMDReader::Species;
+
+namespace {
+
+template <typename T>
+T* findByName(vector<T>& items, const string& name)
+{
+  for (auto& item : items) {
+    if (item.name == name)
+      return &item;
+  }
+  return nullptr;
+}
+
+template <typename T>
+const T* findByName(const vector<T>& items, const string& name)
+{
+  for (auto& item : items) {
+    if (item.name == name)
+      return &item;
+  }
+  return nullptr;
+}
+
+// Find the item @p name, or add it if there is none
+template <typename T>
+T& itemNamed(vector<T>& items, const string& name, const string& path)
+{
+  T* item = findByName(items, name);
+  if (item)
+    return *item;
+
+  items.emplace_back();
+  items.back().name = name;
+  items.back().path = path;
+  return items.back();
+}
+
+// Builds the index of a file in one H5Lvisit() over its iterations. Each
+// object is opened once, and all of its attributes are read then.
+class IndexBuilder
+{
+public:
+  IndexBuilder(const string& basePath, const string& meshesPath,
+               const string& particlesPath)
+    : m_basePath(basePath), m_meshesPath(splitPath(meshesPath)),
+      m_particlesPath(splitPath(particlesPath))
+  {
+  }
+
+  static herr_t operation(hid_t groupId, const char* name,
+                          const H5L_info_t* info, void* data)
+  {
+    // Soft and external links would index their targets twice
+    if (info->type != H5L_TYPE_HARD)
+      return 0;
+
+    auto* self = reinterpret_cast<IndexBuilder*>(data);
+    return self->visit(groupId, name) ? 0 : -1;
+  }
+
+  vector<Iteration> iterations()
+  {
+    vector<Iteration> result;
+    result.reserve(m_iterations.size());
+    for (auto& entry : m_iterations) {
+      // The shape of a mesh is the shape of its components
+      for (Mesh& mesh : entry.second.meshes) {
+        if (!mesh.components.empty())
+          mesh.geometry.shape = mesh.components.front().shape;
+      }
+      result.push_back(std::move(entry.second));
+    }
+    return result;
+  }
+
+private:
+  bool visit(hid_t groupId, const string& name)
+  {
+    vector<string> names = splitPath(name);
+    long long index;
+    if (names.empty() || !parseIndex(names[0], index))
+      return true;
+
+    HIDCloser objectCloser(H5Oopen(groupId, name.c_str(), H5P_DEFAULT),
+                           H5Oclose);
+    hid_t objectId = objectCloser.value();
+    if (objectId < 0) {
+      cerr << "Failed to open " << childPath(name) << endl;
+      return false;
+    }
+
+    Iteration& iteration = m_iterations[index];
+    if (names.size() == 1) {
+      iteration.index = index;
+      iteration.path = childPath(names[0]);
+      iteration.time = numberAttribute(objectId, "time", 0);
+      iteration.dt = numberAttribute(objectId, "dt", 0);
+      iteration.timeUnitSI = numberAttribute(objectId, "timeUnitSI", 1);
+      return true;
+    }
+
+    vector<string> rest(names.begin() + 1, names.end());
+    if (!m_meshesPath.empty() && startsWith(rest, m_meshesPath)) {
+      rest.erase(rest.begin(), rest.begin() + m_meshesPath.size());
+      visitMesh(objectId, name, rest, iteration);
+    } else if (!m_particlesPath.empty() && startsWith(rest, m_particlesPath)) {
+      rest.erase(rest.begin(), rest.begin() + m_particlesPath.size());
+      visitParticles(objectId, name, rest, iteration);
+    }
+
+    return true;
+  }
+
+  // @p names is the path below the meshes path of the iteration
+  void visitMesh(hid_t objectId, const string& path,
+                 const vector<string>& names, Iteration& iteration)
+  {
+    if (names.empty() || names.size() > 2)
+      return;
+
+    string meshPath = childPath(path);
+    if (names.size() == 2)
+      meshPath = meshPath.substr(0, meshPath.rfind('/'));
+
+    Mesh& mesh = itemNamed(iteration.meshes, names[0], meshPath);
+    if (names.size() == 2) {
+      addComponent(objectId, names[1], childPath(path), true, mesh);
+      return;
+    }
+
+    mesh.unitDimension = numbersAttribute(objectId, "unitDimension");
+
+    MeshGeometry& geometry = mesh.geometry;
+    geometry.geometry = stringAttribute(objectId, "geometry");
+    geometry.dataOrder = stringAttribute(objectId, "dataOrder", "C");
+    geometry.axisLabels = stringsAttribute(objectId, "axisLabels");
+    geometry.gridSpacing = numbersAttribute(objectId, "gridSpacing");
+    geometry.gridGlobalOffset = numbersAttribute(objectId, "gridGlobalOffset");
+    geometry.gridUnitSI = numberAttribute(objectId, "gridUnitSI", 1);
+
+    // A scalar mesh is its own single component
+    if (isComponent(objectId))
+      addComponent(objectId, "", meshPath, true, mesh);
+  }
+
+  // @p names is the path below the particles path of the iteration
+  void visitParticles(hid_t objectId, const string& path,
+                      const vector<string>& names, Iteration& iteration)
+  {
+    if (names.empty() || names.size() > 3)
+      return;
+
+    // The path of the first @p count names
+    auto pathOf = [&](size_t count) {
+      string result = childPath(path);
+      for (size_t i = count; i < names.size(); ++i)
+        result = result.substr(0, result.rfind('/'));
+      return result;
+    };
+
+    Species& species = itemNamed(iteration.particles, names[0], pathOf(1));
+    if (names.size() == 1)
+      return;
+
+    // Patches describe the layout of the records, and are not records
+    if (names[1] == "particlePatches")
+      return;
+
+    Record& record = itemNamed(species.records, names[1], pathOf(2));
+    if (names.size() == 3) {
+      addComponent(objectId, names[2], pathOf(3), false, record);
+      return;
+    }
+
+    record.unitDimension = numbersAttribute(objectId, "unitDimension");
+
+    // A scalar record is its own single component
+    if (isComponent(objectId))
+      addComponent(objectId, "", record.path, false, record);
+  }
+
+  // Data sets are components, and so are groups of constant components
+  static bool isComponent(hid_t objectId)
+  {
+    return H5Iget_type(objectId) == H5I_DATASET ||
+           H5Aexists(objectId, "value") > 0;
+  }
+
+  static void addComponent(hid_t objectId, const string& name,
+                           const string& path, bool onMesh, Record& record)
+  {
+    Component& component = itemNamed(record.components, name, path);
+    component.unitSI = numberAttribute(objectId, "unitSI", 1);
+    if (onMesh)
+      component.position = numbersAttribute(objectId, "position");
+
+    if (H5Iget_type(objectId) == H5I_DATASET) {
+      HIDCloser typeCloser(H5Dget_type(objectId), H5Tclose);
+      component.type = h5ToDataType(typeCloser.value());
+
+      vector<hsize_t> dims;
+      if (dataSetDimensions(objectId, dims))
+        component.shape.assign(dims.begin(), dims.end());
+
+      // Scalar data sets hold one element
+      if (component.shape.empty())
+        component.shape.push_back(1);
+      return;
+    }
+
+    component.constant = true;
+    component.value = numberAttribute(objectId, "value", 0);
+    for (double dim : numbersAttribute(objectId, "shape"))
+      component.shape.push_back(static_cast<int>(dim));
+
+    HIDCloser attrCloser(H5Aopen(objectId, "value", H5P_DEFAULT), H5Aclose);
+    if (attrCloser.valueIsValid()) {
+      HIDCloser typeCloser(H5Aget_type(attrCloser.value()), H5Tclose);
+      component.type = h5ToDataType(typeCloser.value());
+    }
+  }
+
+  string childPath(const string& name) const
+  {
+    return m_basePath == "/" ? m_basePath + name : m_basePath + "/" + name;
+  }
+
+  string m_basePath;
+  vector<string> m_meshesPath;
+  vector<string> m_particlesPath;
+  std::map<long long, Iteration> m_iterations;
+};
+
+} // end namespace
+
+const Component* Record::component(const string& name) const
+{
+  return findByName(components, name);
+}
+
+const Record* Species::record(const string& name) const
+{
+  return findByName(records, name);
+}
+
+const Mesh* Iteration::mesh(const string& name) const
+{
+  return findByName(meshes, name);
+}
+
+const Species* Iteration::species(const string& name) const
+{
+  return findByName(particles, name);
+}
+
+class OpenPMDReader::OpenPMDReaderImpl {
+public:
+  OpenPMDReaderImpl(const string& fileName)
+    : m_file(fileName)
+  {
+  }
+
+  bool index()
+  {
+    HIDCloser rootCloser(H5Gopen(m_fileId, "/", H5P_DEFAULT), H5Gclose);
+    hid_t rootId = rootCloser.value();
+    if (rootId < 0)
+      return false;
+
+    m_version = stringAttribute(rootId, "openPMD");
+    if (m_version.empty()) {
+      cerr << "The file is not an openPMD file\n";
+      return false;
+    }
+
+    m_encoding = stringAttribute(rootId, "iterationEncoding");
+    string basePath = stringAttribute(rootId, "basePath", "/data/%T/");
+    string meshesPath = stringAttribute(rootId, "meshesPath");
+    string particlesPath = stringAttribute(rootId, "particlesPath");
+
+    // The iterations are the children of the part of the base path that
+    // comes before "%T"
+    basePath = basePath.substr(0, basePath.find("%T"));
+    while (basePath.size() > 1 && basePath.back() == '/')
+      basePath.pop_back();
+
+    if (basePath.empty())
+      basePath = "/";
+
+    HIDCloser baseCloser(H5Gopen(m_fileId, basePath.c_str(), H5P_DEFAULT),
+                         H5Gclose);
+    if (!baseCloser.valueIsValid()) {
+      cerr << "Failed to open the base path " << basePath << endl;
+      return false;
+    }
+
+    IndexBuilder builder(basePath, meshesPath, particlesPath);
+    if (H5Lvisit(baseCloser.value(), H5_INDEX_NAME, H5_ITER_INC,
+                 &IndexBuilder::operation, &builder) < 0) {
+      cerr << "Failed to index " << basePath << endl;
+      return false;
+    }
+
+    m_iterations = builder.iterations();
+    return true;
+  }
+
+  template <typename T>
+  bool read(const Component& component, NDArray<T>& array)
+  {
+    if (component.constant) {
+      array.resize(component.shape);
+      std::fill(array.data(), array.data() + array.size(),
+                static_cast<T>(component.value));
+      return true;
+    }
+
+    // HDF5 converts between all of the basic types, but not from strings
+    // or compound types
+    if (!isBasicType(component.type)) {
+      cerr << component.path << " is not numeric\n";
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    HIDCloser dataSetCloser(
+      H5Dopen(m_fileId, component.path.c_str(), H5P_DEFAULT), H5Dclose);
+    if (!dataSetCloser.valueIsValid()) {
+      cerr << "Failed to open data set: " << component.path << endl;
+      return false;
+    }
+
+    array.resize(component.shape);
+    if (!readElements(dataSetCloser.value(), BasicTypeToH5<T>::memTypeId(),
+                      H5S_ALL, H5S_ALL, m_transferId, array.data())) {
+      cerr << "Failed to read " << component.path << endl;
+      return false;
+    }
+
+    return true;
+  }
+
+  static bool isBasicType(DataType type)
+  {
+    return type != DataType::String && type != DataType::Compound &&
+           type != DataType::None;
+  }
+
+  H5ReadWrite m_file;
+  hid_t m_fileId = H5I_INVALID_HID;
+  hid_t m_transferId = H5P_DEFAULT;
+  bool m_valid = false;
+  string m_version;
+  string m_encoding;
+  vector<Iteration> m_iterations;
+
+  // HDF5 serializes its calls, but the transfer property list of the
+  // file is shared by every thread as well
+  std::mutex m_mutex;
+};
+
+OpenPMDReader::OpenPMDReader(const string& fileName)
+  : m_impl(new OpenPMDReaderImpl(fileName))
+{
+  m_impl->m_fileId = m_impl->m_file.fileId();
+  m_impl->m_transferId = m_impl->m_file.transferPropertyList();
+  if (m_impl->m_fileId < 0)
+    return;
+
+  m_impl->m_valid = m_impl->index();
+}
+
+OpenPMDReader::~OpenPMDReader() = default;
+
+bool OpenPMDReader::isValid() const
+{
+  return m_impl->m_valid;
+}
+
+const string& OpenPMDReader::version() const
+{
+  return m_impl->m_version;
+}
+
+const string& OpenPMDReader::iterationEncoding() const
+{
+  return m_impl->m_encoding;
+}
+
+const vector<Iteration>& OpenPMDReader::iterations() const
+{
+  return m_impl->m_iterations;
+}
+
+const Iteration* OpenPMDReader::iteration(long long index) const
+{
+  const auto& iterations = m_impl->m_iterations;
+  auto it = std::lower_bound(
+    iterations.begin(), iterations.end(), index,
+    [](const Iteration& iteration, long long i) { return iteration.index < i; });
+
+  if (it == iterations.end() || it->index != index)
+    return nullptr;
+
+  return &*it;
+}
+
+MeshGeometry OpenPMDReader::geometry(long long index, const string& name,
+                                     bool* ok) const
+{
+  setOk(ok, false);
+
+  const Iteration* found = iteration(index);
+  if (!found) {
+    cerr << "Iteration " << index << " not found\n";
+    return MeshGeometry();
+  }
+
+  const Mesh* mesh = found->mesh(name);
+  if (!mesh) {
+    cerr << "Mesh " << name << " not found in iteration " << index << "\n";
+    return MeshGeometry();
+  }
+
+  setOk(ok, true);
+  return mesh->geometry;
+}
+
+template <typename T>
+bool OpenPMDReader::readComponent(const Component& component,
+                                  NDArray<T>& array)
+{
+  if (!isValid()) {
+    cerr << "The openPMD file is not valid\n";
+    return false;
+  }
+
+  return m_impl->read(component, array);
+}
+
+bool OpenPMDReader::forEachIteration(
+  const vector<long long>& indices,
+  const std::function<bool(const Iteration&)>& function, int threads)
+{
+  vector<const Iteration*> selected;
+  for (long long index : indices) {
+    const Iteration* found = iteration(index);
+    if (!found) {
+      cerr << "Iteration " << index << " not found\n";
+      return false;
+    }
+    selected.push_back(found);
+  }
+
+  size_t threadCount = threads > 0 ? static_cast<size_t>(threads)
+                                   : std::thread::hardware_concurrency();
+  threadCount = std::max<size_t>(1, std::min(threadCount, selected.size()));
+
+  // Every thread takes the next iteration until there are none left
+  std::atomic<size_t> next(0);
+  std::atomic<bool> success(true);
+  auto work = [&]() {
+    for (size_t i = next++; i < selected.size(); i = next++) {
+      if (!function(*selected[i]))
+        success = false;
+    }
+  };
+
+  vector<std::thread> pool;
+  for (size_t i = 1; i < threadCount; ++i)
+    pool.emplace_back(work);
+
+  work();
+
+  for (auto& thread : pool)
+    thread.join();
+
+  return success;
+}
+
+// Instantiate our allowable templates here
+#define INSTANTIATE_OPENPMDREADER_TEMPLATES(T, E)                             \
+  template bool OpenPMDReader::readComponent(const Component&, NDArray<T>&);
+
+H5CPP_FOR_EACH_BASIC_TYPE(INSTANTIATE_OPENPMDREADER_TEMPLATES)
+
+#undef INSTANTIATE_OPENPMDREADER_TEMPLATES
+
+} // namespace h5
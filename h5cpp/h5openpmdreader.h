@@ -0,0 +1,184 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5OpenPMDReader_h
+#define tomvizH5OpenPMDReader_h
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "h5ndarray.h"
+#include "h5readwrite.h"
+
+namespace h5 {
+
+/**
+ * Reads openPMD files. All of the iterations, meshes, particle species
+ * and records of the file are indexed with their attributes in a single
+ * traversal when the reader is opened, so that looking them up afterwards
+ * does not touch the file. The data of the records is only read when it
+ * is asked for, with readComponent().
+ *
+ * Both the "groupBased" encoding, with every iteration in one file, and
+ * a single file of the "fileBased" encoding are supported.
+ */
+class OpenPMDReader
+{
+public:
+  using DataType = H5ReadWrite::DataType;
+
+  /**
+   * A component of a record, such as "x" of the electric field "E".
+   * Scalar records have a single component with an empty name.
+   */
+  struct Component
+  {
+    std::string name;
+    /** The path of the data set, or of the group of a constant component */
+    std::string path;
+    /** The type of the data set, or of the value of a constant component */
+    DataType type = DataType::None;
+    std::vector<int> shape;
+    /** Constant components have a single value for every element */
+    bool constant = false;
+    double value = 0;
+    double unitSI = 1;
+    /** For meshes, the position of the values within a cell */
+    std::vector<double> position;
+  };
+
+  /** A record, such as the electric field or the particle positions */
+  struct Record
+  {
+    std::string name;
+    std::string path;
+    std::vector<double> unitDimension;
+    std::vector<Component> components;
+
+    /** The component @p name, or nullptr if there is none */
+    const Component* component(const std::string& name) const;
+  };
+
+  /** The attributes that place a mesh in space */
+  struct MeshGeometry
+  {
+    std::string geometry;
+    std::string dataOrder;
+    std::vector<std::string> axisLabels;
+    std::vector<double> gridSpacing;
+    std::vector<double> gridGlobalOffset;
+    double gridUnitSI = 1;
+    /** The shape of the components of the mesh */
+    std::vector<int> shape;
+  };
+
+  /** A record on a grid */
+  struct Mesh : Record
+  {
+    MeshGeometry geometry;
+  };
+
+  /** The records of one particle species */
+  struct Species
+  {
+    std::string name;
+    std::string path;
+    std::vector<Record> records;
+
+    /** The record @p name, or nullptr if there is none */
+    const Record* record(const std::string& name) const;
+  };
+
+  struct Iteration
+  {
+    long long index = 0;
+    std::string path;
+    double time = 0;
+    double dt = 0;
+    double timeUnitSI = 1;
+    std::vector<Mesh> meshes;
+    std::vector<Species> particles;
+
+    /** The mesh @p name, or nullptr if there is none */
+    const Mesh* mesh(const std::string& name) const;
+
+    /** The particle species @p name, or nullptr if there is none */
+    const Species* species(const std::string& name) const;
+  };
+
+  /**
+   * Open an openPMD file and index it.
+   * @param fileName the file to open.
+   */
+  explicit OpenPMDReader(const std::string& fileName);
+
+  /** Closes the file and destroys the OpenPMDReader */
+  ~OpenPMDReader();
+
+  /** Copy constructor is disabled */
+  OpenPMDReader(const OpenPMDReader&) = delete;
+
+  /** Assignment operator is disabled */
+  OpenPMDReader& operator=(const OpenPMDReader&) = delete;
+
+  /** Whether the file was opened and indexed successfully */
+  bool isValid() const;
+
+  /** The version of the openPMD standard of the file */
+  const std::string& version() const;
+
+  /** The iteration encoding of the file, such as "fileBased" */
+  const std::string& iterationEncoding() const;
+
+  /** The iterations of the file, in increasing order of their index */
+  const std::vector<Iteration>& iterations() const;
+
+  /** The iteration @p index, or nullptr if there is none */
+  const Iteration* iteration(long long index) const;
+
+  /**
+   * Get the geometry of a mesh.
+   * @param iteration The index of the iteration.
+   * @param mesh The name of the mesh.
+   * @param ok If used, set to true on success and false on failure.
+   * @return The geometry of the mesh.
+   */
+  MeshGeometry geometry(long long iteration, const std::string& mesh,
+                        bool* ok = nullptr) const;
+
+  /**
+   * Read the data of a component, converted to type T. Constant
+   * components are filled with their value. The array is reshaped to the
+   * shape of the component. This may be called from several threads.
+   * @param component The component, from the index of this reader.
+   * @param array The array that will be set to the data.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool readComponent(const Component& component, NDArray<T>& array);
+
+  /**
+   * Call @p function for each of the iterations @p indices, on a pool of
+   * @p threads threads. The function may read components with
+   * readComponent(). HDF5 serializes the reads, while the rest of the
+   * work of @p function runs in parallel.
+   * @param indices The indices of the iterations.
+   * @param function The function to call. It returns false on failure.
+   * @param threads The number of threads, or 0 to use one per core.
+   * @return True if every index was found and @p function returned true
+   *         for every iteration, false otherwise.
+   */
+  bool forEachIteration(const std::vector<long long>& indices,
+                        const std::function<bool(const Iteration&)>& function,
+                        int threads = 0);
+
+private:
+  class OpenPMDReaderImpl;
+  std::unique_ptr<OpenPMDReaderImpl> m_impl;
+};
+
+} // namespace h5
+
+#endif // tomvizH5OpenPMDReader_h
@@ -0,0 +1,105 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "h5quantize.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+namespace h5 {
+
+namespace {
+
+// The largest float that is not above @p value
+float floatBelow(double value)
+{
+  float result = static_cast<float>(value);
+  if (result > value)
+    result = std::nextafter(result, -std::numeric_limits<float>::infinity());
+  return result;
+}
+
+} // end namespace
+
+Quantization chooseQuantization(const float* values, size_t count, int bits)
+{
+  float low = std::numeric_limits<float>::infinity();
+  float high = -low;
+  for (size_t i = 0; i < count; ++i) {
+    if (std::isfinite(values[i])) {
+      low = std::min(low, values[i]);
+      high = std::max(high, values[i]);
+    }
+  }
+
+  Quantization quantization;
+  if (low > high)
+    return quantization;
+
+  const double levels = std::ldexp(1.0, bits) - 1;
+  quantization.offset = low;
+  quantization.scale = static_cast<float>((high - low) / levels);
+
+  // Every value is the same, and is stored as code 0
+  if (!(quantization.scale > 0))
+    quantization.scale = 1;
+
+  return quantization;
+}
+
+template <typename T>
+void quantize(const float* values, T* codes, size_t count,
+              const Quantization& quantization, T lowest, T highest)
+{
+  // Small codes are converted through int, which vectorizes
+  using Wide =
+    typename std::conditional<(sizeof(T) < 4), int, long long>::type;
+
+  // Codes are computed as their distance from lowest, which is never
+  // negative, so that the truncation of value + 0.5 rounds them. The
+  // distance is kept in the range of Wide.
+  const double span = std::min<double>(static_cast<double>(highest) - lowest,
+                                       std::ldexp(1.0, 62));
+  const float range = floatBelow(span);
+  const float base = static_cast<float>(lowest);
+  const float inverse = 1.0f / quantization.scale;
+  const float offset = quantization.offset;
+  const Wide start = static_cast<Wide>(lowest);
+
+  for (size_t i = 0; i < count; ++i) {
+    float distance = (values[i] - offset) * inverse - base + 0.5f;
+    distance = distance > 0.0f ? distance : 0.0f;
+    distance = distance < range ? distance : range;
+    codes[i] = static_cast<T>(static_cast<Wide>(distance) + start);
+  }
+}
+
+template <typename T>
+void dequantize(const T* codes, float* values, size_t count,
+                const Quantization& quantization)
+{
+  const float scale = quantization.scale;
+  const float offset = quantization.offset;
+  for (size_t i = 0; i < count; ++i)
+    values[i] = static_cast<float>(codes[i]) * scale + offset;
+}
+
+#define INSTANTIATE_QUANTIZE_TEMPLATES(T)                                     \
+  template void quantize(const float*, T*, size_t, const Quantization&, T,    \
+                         T);                                                  \
+  template void dequantize(const T*, float*, size_t, const Quantization&);
+
+INSTANTIATE_QUANTIZE_TEMPLATES(char)
+INSTANTIATE_QUANTIZE_TEMPLATES(short)
+INSTANTIATE_QUANTIZE_TEMPLATES(int)
+INSTANTIATE_QUANTIZE_TEMPLATES(long long)
+INSTANTIATE_QUANTIZE_TEMPLATES(unsigned char)
+INSTANTIATE_QUANTIZE_TEMPLATES(unsigned short)
+INSTANTIATE_QUANTIZE_TEMPLATES(unsigned int)
+INSTANTIATE_QUANTIZE_TEMPLATES(unsigned long long)
+
+#undef INSTANTIATE_QUANTIZE_TEMPLATES
+
+} // namespace h5
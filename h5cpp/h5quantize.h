@@ -0,0 +1,50 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5Quantize_h
+#define tomvizH5Quantize_h
+
+#include <cstddef>
+
+namespace h5 {
+
+/**
+ * The mapping between floats and the integer codes that store them:
+ * value = code * scale + offset. Quantized data sets record it in the
+ * attributes scale_factor and add_offset, as the CF conventions pack
+ * data, so that netCDF and xarray readers restore the values too.
+ */
+struct Quantization
+{
+  float scale = 1;
+  float offset = 0;
+};
+
+/**
+ * The quantization that maps the range of the finite @p values to the
+ * codes 0 to 2^bits - 1. The values are restored to within scale / 2,
+ * plus the rounding of float arithmetic.
+ */
+Quantization chooseQuantization(const float* values, size_t count,
+                                int bits);
+
+/**
+ * Convert @p count values to the nearest codes, clamped to
+ * [@p lowest, @p highest]. NaNs become @p lowest. T is an integer type.
+ * The loop has no branches, so that compilers vectorize it.
+ */
+template <typename T>
+void quantize(const float* values, T* codes, size_t count,
+              const Quantization& quantization, T lowest, T highest);
+
+/**
+ * Restore @p count values from their codes. T is an integer type. The
+ * loop has no branches, so that compilers vectorize it.
+ */
+template <typename T>
+void dequantize(const T* codes, float* values, size_t count,
+                const Quantization& quantization);
+
+} // namespace h5
+
+#endif // tomvizH5Quantize_h
@@ -4,12 +4,22 @@
 #include "h5readwrite.h"
 
 #include <algorithm>
+#include <functional>
 #include <iostream>
 #include <map>
 #include <numeric>
 
+#include "h5batchwrite.h"
 #include "h5capi.h"
+#include "h5compound.h"
+#include "h5dataset.h"
+#include "h5dispatch.h"
+#include "h5filepool.h"
+#include "h5filters.h"
+#include "h5group.h"
+#include "h5trace.h"
 #include "h5typemaps.h"
+#include "h5utils.h"
 #include "hidcloser.h"
 
 using std::cout;
@@ -29,6 +39,18 @@ void setOk(bool* ok, bool status)
     *ok = status;
 }
 
+// Give a span of a trace the path of the child @p name of @p path
+void traceChild(h5::TraceSpan& span, const string& path, const string& name)
+{
+  if (!span.active())
+    return;
+
+  string childPath = path;
+  if (childPath.empty() || childPath.back() != '/')
+    childPath += '/';
+  span.setPath(childPath + name);
+}
+
 } // end namespace
 
 namespace h5 {
@@ -58,39 +80,280 @@ public:
   {
   }
 
-  H5ReadWriteImpl(const string& file, OpenMode mode)
+  H5ReadWriteImpl(const string& file, OpenMode mode,
+                  const OpenOptions& options)
+    : m_options(options)
+  {
+    open(file, mode);
+  }
+
+  explicit H5ReadWriteImpl(const OpenOptions& options)
+    : m_options(options)
+  {
+  }
+
+  ~H5ReadWriteImpl()
+  {
+    clear();
+  }
+
+  void open(const string& file, OpenMode mode)
   {
+    TraceSpan span("open", "open", file);
+
+    // The built-in filters are needed to read and write compressed data
+    registerFilters();
+
+    m_fileName = file;
+
     if (mode == OpenMode::ReadOnly) {
       if (!openFile(file))
         cerr << "Warning: failed to open file " << file << "\n";
     }
+    else if (mode == OpenMode::ReadWrite) {
+      if (!openFile(file, H5F_ACC_RDWR))
+        cerr << "Warning: failed to open file " << file << "\n";
+    }
     else if (mode == OpenMode::WriteOnly) {
       if (!createFile(file))
         cerr << "Warning: failed to create file " << file << "\n";
     }
+    else if (mode == OpenMode::SWMRWrite) {
+      // SWMR requires the latest file format
+      if (!createFile(file, true))
+        cerr << "Warning: failed to create file " << file << "\n";
+    }
+    else if (mode == OpenMode::SWMRRead) {
+      if (!openFile(file, H5F_ACC_RDONLY | H5F_ACC_SWMR_READ))
+        cerr << "Warning: failed to open file " << file << "\n";
+    }
     else {
       cerr << "Warning: open mode currently not implemented.\n";
     }
   }
 
-  ~H5ReadWriteImpl()
+#ifdef H5CPP_USE_MPI
+  // Must be called before open()
+  bool setCommunicator(MPI_Comm comm)
   {
-    clear();
+    m_communicator = comm;
+    m_parallel = true;
+
+    // Raw data transfers are collective: every rank must take part in
+    // each readSlab() and writeSlab() call.
+    m_transferId = H5Pcreate(H5P_DATASET_XFER);
+    if (m_transferId < 0 ||
+        H5Pset_dxpl_mpio(m_transferId, H5FD_MPIO_COLLECTIVE) < 0) {
+      cerr << "Failed to set up collective data transfers\n";
+      return false;
+    }
+
+    return true;
+  }
+#endif
+
+  hid_t transferPropertyList() const
+  {
+    return m_transferId >= 0 ? m_transferId : H5P_DEFAULT;
   }
 
-  bool openFile(const string& file)
+  // A copy for handles that outlive this call, or -1 if there is none
+  hid_t copyTransferPropertyList() const
   {
-    m_fileId = H5Fopen(file.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    return m_transferId >= 0 ? H5Pcopy(m_transferId) : -1;
+  }
+
+  bool openFile(const string& file, unsigned flags = H5F_ACC_RDONLY)
+  {
+    bool pooled = m_options.pooled;
+#ifdef H5CPP_USE_MPI
+    // Parallel opens are collective, and cannot be shared
+    pooled = pooled && !m_parallel;
+#endif
+
+    if (pooled) {
+      m_fileId = FilePool::instance().acquire(
+        file, flags, [this, &file, flags]() { return openFileId(file, flags); });
+      m_pooled = fileIsValid();
+      return fileIsValid();
+    }
+
+    // HDF5 cannot open a file for writing while the pool holds it open
+    if (flags & H5F_ACC_RDWR)
+      FilePool::instance().closeIdle(file);
+
+    m_fileId = openFileId(file, flags);
     return fileIsValid();
   }
 
-  bool createFile(const string& file)
+  // Returns a new file id, or a negative value on failure
+  hid_t openFileId(const string& file, unsigned flags)
+  {
+    HIDCloser accessCloser(createAccessPropertyList(false), H5Pclose);
+    if (!accessCloser.valueIsValid())
+      return H5I_INVALID_HID;
+
+    if (m_options.pageBufferSize == 0)
+      return H5Fopen(file.c_str(), flags, accessCloser.value());
+
+    // HDF5 refuses to open files that are not paged with a page buffer.
+    // Try again without one in that case.
+    hid_t fileId;
+    H5E_BEGIN_TRY {
+      fileId = H5Fopen(file.c_str(), flags, accessCloser.value());
+    } H5E_END_TRY;
+
+    if (fileId < 0 &&
+        H5Pset_page_buffer_size(accessCloser.value(), 0, 0, 0) >= 0) {
+      fileId = H5Fopen(file.c_str(), flags, accessCloser.value());
+    }
+    return fileId;
+  }
+
+  bool createFile(const string& file, bool latestFormat = false)
   {
-    m_fileId = H5Fcreate(file.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT,
-                         H5P_DEFAULT);
+    HIDCloser accessCloser(createAccessPropertyList(latestFormat), H5Pclose);
+    HIDCloser creationCloser(createCreationPropertyList(), H5Pclose);
+    if (!accessCloser.valueIsValid() || !creationCloser.valueIsValid())
+      return false;
+
+    // HDF5 cannot truncate a file while the pool holds it open
+    FilePool::instance().closeIdle(file);
+
+    m_fileId = H5Fcreate(file.c_str(), H5F_ACC_TRUNC, creationCloser.value(),
+                         accessCloser.value());
     return fileIsValid();
   }
 
+  // Returns a new file access property list for m_options, or a negative
+  // value on failure. The caller is responsible for closing it.
+  hid_t createAccessPropertyList(bool latestFormat)
+  {
+    hid_t accessId = H5Pcreate(H5P_FILE_ACCESS);
+    HIDCloser accessCloser(accessId, H5Pclose);
+    if (accessId < 0) {
+      cerr << "Failed to create the file access property list\n";
+      return H5I_INVALID_HID;
+    }
+
+#ifdef H5CPP_USE_MPI
+    if (m_parallel) {
+      if (H5Pset_fapl_mpio(accessId, m_communicator, MPI_INFO_NULL) < 0) {
+        cerr << "Failed to set the MPI-IO file driver\n";
+        return H5I_INVALID_HID;
+      }
+
+      // Metadata is read by one rank and broadcast, and written
+      // collectively, instead of every rank hitting the file system.
+      if (H5Pset_all_coll_metadata_ops(accessId, true) < 0 ||
+          H5Pset_coll_metadata_write(accessId, true) < 0) {
+        cerr << "Failed to set collective metadata operations\n";
+        return H5I_INVALID_HID;
+      }
+    }
+#endif
+
+    const OpenOptions& options = m_options;
+    if ((latestFormat || options.latestFormat) &&
+        H5Pset_libver_bounds(accessId, H5F_LIBVER_LATEST,
+                             H5F_LIBVER_LATEST) < 0) {
+      cerr << "Failed to set the library version bounds\n";
+      return H5I_INVALID_HID;
+    }
+
+    if (options.pageBufferSize > 0 &&
+        H5Pset_page_buffer_size(accessId, options.pageBufferSize, 0, 0) < 0) {
+      cerr << "Failed to set the page buffer size\n";
+      return H5I_INVALID_HID;
+    }
+
+    if (options.metadataCacheSize > 0) {
+      H5AC_cache_config_t config;
+      config.version = H5AC__CURR_CACHE_CONFIG_VERSION;
+      if (H5Pget_mdc_config(accessId, &config) < 0) {
+        cerr << "Failed to get the metadata cache configuration\n";
+        return H5I_INVALID_HID;
+      }
+
+      config.set_initial_size = true;
+      config.initial_size = options.metadataCacheSize;
+      config.max_size = std::max(config.max_size, config.initial_size);
+      config.min_size = std::min(config.min_size, config.initial_size);
+
+      if (H5Pset_mdc_config(accessId, &config) < 0) {
+        cerr << "Failed to set the metadata cache configuration\n";
+        return H5I_INVALID_HID;
+      }
+    }
+
+    if (options.metadataBlockSize > 0 &&
+        H5Pset_meta_block_size(accessId, options.metadataBlockSize) < 0) {
+      cerr << "Failed to set the metadata block size\n";
+      return H5I_INVALID_HID;
+    }
+
+    if (options.alignment > 0 &&
+        H5Pset_alignment(accessId, options.alignmentThreshold,
+                         options.alignment) < 0) {
+      cerr << "Failed to set the alignment\n";
+      return H5I_INVALID_HID;
+    }
+
+    if (options.sieveBufferSize > 0 &&
+        H5Pset_sieve_buf_size(accessId, options.sieveBufferSize) < 0) {
+      cerr << "Failed to set the sieve buffer size\n";
+      return H5I_INVALID_HID;
+    }
+
+    if (options.chunkCacheSize > 0) {
+      int elements;
+      size_t slots, bytes;
+      double preemption;
+      if (H5Pget_cache(accessId, &elements, &slots, &bytes,
+                       &preemption) < 0) {
+        cerr << "Failed to get the chunk cache configuration\n";
+        return H5I_INVALID_HID;
+      }
+
+      // The HDF5 documentation recommends about 100 hash slots per chunk
+      // that fits in the cache. Assume chunks of 64 KiB.
+      bytes = options.chunkCacheSize;
+      slots = std::max(slots, bytes / (64 * 1024) * 100 + 1);
+
+      if (H5Pset_cache(accessId, elements, slots, bytes, preemption) < 0) {
+        cerr << "Failed to set the chunk cache configuration\n";
+        return H5I_INVALID_HID;
+      }
+    }
+
+    // Release ownership to the caller
+    return accessCloser.release();
+  }
+
+  // Returns a new file creation property list for m_options, or a
+  // negative value on failure. The caller is responsible for closing it.
+  hid_t createCreationPropertyList()
+  {
+    hid_t creationId = H5Pcreate(H5P_FILE_CREATE);
+    HIDCloser creationCloser(creationId, H5Pclose);
+    if (creationId < 0) {
+      cerr << "Failed to create the file creation property list\n";
+      return H5I_INVALID_HID;
+    }
+
+    if (m_options.pageSize > 0) {
+      if (H5Pset_file_space_strategy(creationId, H5F_FSPACE_STRATEGY_PAGE,
+                                     true, 1) < 0 ||
+          H5Pset_file_space_page_size(creationId, m_options.pageSize) < 0) {
+        cerr << "Failed to set the paged file space strategy\n";
+        return H5I_INVALID_HID;
+      }
+    }
+
+    // Release ownership to the caller
+    return creationCloser.release();
+  }
+
   bool attributeExists(const string& path, const string& name)
   {
     if (!fileIsValid())
@@ -112,36 +375,16 @@ public:
   }
 
   bool attribute(const string& path, const string& name, void* value,
-                 hid_t dataTypeId, hid_t memTypeId)
+                 DataType dataType, hid_t memTypeId)
   {
-    if (!attributeExists(path, name)) {
-      cerr << "Attribute " << path << name << " not found!" << endl;
-      return false;
-    }
-
-    hid_t attr = H5Aopen_by_name(m_fileId, path.c_str(), name.c_str(),
-                                 H5P_DEFAULT, H5P_DEFAULT);
-    hid_t type = H5Aget_type(attr);
-
-    // For automatic closing upon leaving scope
-    HIDCloser attrCloser(attr, H5Aclose);
-    HIDCloser typeCloser(type, H5Tclose);
-
-    if (H5Tequal(type, dataTypeId) == 0) {
-      // The type of the attribute does not match the requested type.
-      cerr << "Type determined does not match that requested." << endl;
-      cerr << type << " -> " << dataTypeId << endl;
-      return false;
-    } else if (H5Tequal(type, dataTypeId) < 0) {
-      cerr << "Something went really wrong....\n\n";
+    if (!fileIsValid())
       return false;
-    }
 
-    return H5Aread(attr, memTypeId, value) >= 0;
+    return readAttribute(m_fileId, path, name, dataType, memTypeId, value);
   }
 
   bool setAttribute(const string& path, const string& name,
-                    void* value, hid_t fileTypeId, hid_t typeId, hsize_t dims)
+                    const void* value, hid_t fileTypeId, hid_t typeId)
   {
     if (!fileIsValid()) {
       cerr << "File is not valid\n";
@@ -162,49 +405,199 @@ public:
 
     HIDCloser parentCloser(parentId, closer);
 
-    hid_t dataspaceId = H5Screate_simple(1, &dims, NULL);
-    hid_t attributeId = H5Acreate2(parentId, name.c_str(), fileTypeId,
-                                   dataspaceId, H5P_DEFAULT, H5P_DEFAULT);
-
-    HIDCloser attributeCloser(attributeId, H5Aclose);
-    HIDCloser dataspaceCloser(dataspaceId, H5Sclose);
-
-    return H5Awrite(attributeId, typeId, value) >= 0;
+    return writeAttribute(parentId, name, fileTypeId, typeId, value);
   }
 
   bool writeData(const string& path, const string& name,
                  const std::vector<int>& dims, const void* data,
-                 hid_t dataTypeId, hid_t memTypeId)
+                 hid_t dataTypeId, hid_t memTypeId,
+                 const WriteOptions& options)
   {
     if (!fileIsValid()) {
       cerr << "File is invalid\n";
       return false;
     }
 
-    std::vector<hsize_t> h5dim;
-    for (size_t i = 0; i < dims.size(); ++i) {
-      h5dim.push_back(static_cast<hsize_t>(dims[i]));
-    }
     hid_t groupId = H5Gopen(m_fileId, path.c_str(), H5P_DEFAULT);
-    hid_t dataSpaceId =
-      H5Screate_simple(static_cast<int>(dims.size()), &h5dim[0], NULL);
-    hid_t dataId = H5Dcreate(groupId, name.c_str(), dataTypeId, dataSpaceId,
-                             H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    if (groupId < 0) {
+      cerr << "Failed to open group: " << path << "\n";
+      return false;
+    }
+
+    HIDCloser groupCloser(groupId, H5Gclose);
+
+    return writeDataSet(groupId, name, dims, dataTypeId, memTypeId,
+                        transferPropertyList(), data, options);
+  }
+
+  bool createAppendableDataSet(const string& path, const string& name,
+                               const vector<int>& frameDims,
+                               hid_t dataTypeId)
+  {
+    if (!fileIsValid()) {
+      cerr << "File is invalid\n";
+      return false;
+    }
 
+    // The first dimension starts empty and is unlimited
+    vector<hsize_t> h5dim(1, 0);
+    vector<hsize_t> maxDim(1, H5S_UNLIMITED);
+    vector<hsize_t> chunkDim(1, 1);
+    for (size_t i = 0; i < frameDims.size(); ++i) {
+      h5dim.push_back(static_cast<hsize_t>(frameDims[i]));
+      maxDim.push_back(static_cast<hsize_t>(frameDims[i]));
+      chunkDim.push_back(static_cast<hsize_t>(frameDims[i]));
+    }
+
+    hid_t groupId = H5Gopen(m_fileId, path.c_str(), H5P_DEFAULT);
     HIDCloser groupCloser(groupId, H5Gclose);
+    if (groupId < 0) {
+      cerr << "Failed to open group: " << path << "\n";
+      return false;
+    }
+
+    hid_t dataSpaceId = H5Screate_simple(static_cast<int>(h5dim.size()),
+                                         &h5dim[0], &maxDim[0]);
     HIDCloser spaceCloser(dataSpaceId, H5Sclose);
+
+    // Extendible data sets must be chunked. One frame per chunk.
+    hid_t createId = H5Pcreate(H5P_DATASET_CREATE);
+    HIDCloser createCloser(createId, H5Pclose);
+    if (H5Pset_chunk(createId, static_cast<int>(chunkDim.size()),
+                     &chunkDim[0]) < 0) {
+      cerr << "Failed to set the chunk dimensions\n";
+      return false;
+    }
+
+    hid_t dataId = H5Dcreate(groupId, name.c_str(), dataTypeId, dataSpaceId,
+                             H5P_DEFAULT, createId, H5P_DEFAULT);
     HIDCloser dataCloser(dataId, H5Dclose);
 
-    hid_t status = H5Dwrite(dataId, memTypeId, H5S_ALL, H5S_ALL,
-                            H5P_DEFAULT, data);
+    return dataId >= 0;
+  }
+
+  bool appendData(const string& path, const void* data, hid_t memTypeId)
+  {
+    if (!fileIsValid()) {
+      cerr << "File is invalid\n";
+      return false;
+    }
+
+    TraceSpan metadataSpan("metadata", "metadata", path);
+    hid_t dataSetId = H5Dopen(m_fileId, path.c_str(), H5P_DEFAULT);
+    if (dataSetId < 0) {
+      cerr << "Failed to get dataSetId\n";
+      return false;
+    }
+
+    HIDCloser dataSetCloser(dataSetId, H5Dclose);
+
+    vector<hsize_t> dims;
+    if (!dataSetDimensions(dataSetId, dims))
+      return false;
+
+    // Grow by one frame, and select the new frame in the file
+    vector<hsize_t> start(dims.size(), 0);
+    vector<hsize_t> counts = dims;
+    start[0] = dims[0];
+    counts[0] = 1;
+    ++dims[0];
+
+    if (H5Dset_extent(dataSetId, &dims[0]) < 0) {
+      cerr << "Failed to extend the data set " << path << "\n";
+      return false;
+    }
+    metadataSpan.end();
+
+    if (!writeHyperslab(dataSetId, start, counts, memTypeId,
+                        transferPropertyList(), data)) {
+      return false;
+    }
+
+    // Make the new frame visible to SWMR readers
+    if (m_swmrWriting && H5Dflush(dataSetId) < 0) {
+      cerr << "Failed to flush the data set " << path << "\n";
+      return false;
+    }
+
+    return true;
+  }
+
+  bool writeSlab(const string& path, const vector<int>& start,
+                 const vector<int>& counts, const void* data,
+                 hid_t memTypeId)
+  {
+    if (!fileIsValid()) {
+      cerr << "File is invalid\n";
+      return false;
+    }
+
+    TraceSpan metadataSpan("metadata", "metadata", path);
+    hid_t dataSetId = H5Dopen(m_fileId, path.c_str(), H5P_DEFAULT);
+    if (dataSetId < 0) {
+      cerr << "Failed to get dataSetId\n";
+      return false;
+    }
+
+    HIDCloser dataSetCloser(dataSetId, H5Dclose);
+    metadataSpan.end();
+
+    vector<hsize_t> h5start(start.begin(), start.end());
+    vector<hsize_t> h5counts(counts.begin(), counts.end());
+    return writeHyperslab(dataSetId, h5start, h5counts, memTypeId,
+                          transferPropertyList(), data);
+  }
+
+  // void* data needs to be of the appropiate type and size
+  bool readSlab(const string& path, const vector<int>& start,
+                const vector<int>& counts, DataType dataType,
+                hid_t memTypeId, void* data)
+  {
+    if (!fileIsValid()) {
+      cerr << "File is invalid\n";
+      return false;
+    }
+
+    TraceSpan metadataSpan("metadata", "metadata", path);
+    hid_t dataSetId = H5Dopen(m_fileId, path.c_str(), H5P_DEFAULT);
+    if (dataSetId < 0) {
+      cerr << "Failed to get dataSetId\n";
+      return false;
+    }
+
+    HIDCloser dataSetCloser(dataSetId, H5Dclose);
+
+    if (!dataSetTypeMatches(dataSetId, dataType))
+      return false;
+    metadataSpan.end();
+
+    vector<hsize_t> h5start(start.begin(), start.end());
+    vector<hsize_t> h5counts(counts.begin(), counts.end());
+    return readHyperslab(dataSetId, h5start, h5counts, memTypeId,
+                         transferPropertyList(), data);
+  }
+
+  bool startSWMRWrite()
+  {
+    if (!fileIsValid()) {
+      cerr << "File is invalid\n";
+      return false;
+    }
+
+    if (H5Fstart_swmr_write(m_fileId) < 0) {
+      cerr << "Failed to start SWMR writing\n";
+      return false;
+    }
 
-    return status >= 0;
+    m_swmrWriting = true;
+    return true;
   }
 
   // void* data needs to be of the appropiate type and size
-  bool readData(const string& path, hid_t dataTypeId, hid_t memTypeId,
+  bool readData(const string& path, DataType dataType, hid_t memTypeId,
                 void* data)
   {
+    TraceSpan metadataSpan("metadata", "metadata", path);
     hid_t dataSetId = H5Dopen(m_fileId, path.c_str(), H5P_DEFAULT);
     if (dataSetId < 0) {
       cerr << "Failed to get dataSetId\n";
@@ -222,21 +615,61 @@ public:
 
     HIDCloser dataSpaceCloser(dataSpaceId, H5Sclose);
 
-    hid_t typeId = H5Dget_type(dataSetId);
-    HIDCloser dataTypeCloser(typeId, H5Tclose);
+    if (!dataSetTypeMatches(dataSetId, dataType))
+      return false;
+    metadataSpan.end();
+
+    return readElements(dataSetId, memTypeId, H5S_ALL, dataSpaceId,
+                        transferPropertyList(), data);
+  }
+
+  // Read a whole data set into an array of its shape, opening it once.
+  // Scalar data sets have no dimensions, and are read as shape {1}.
+  template <typename T>
+  bool readArray(const string& path, NDArray<T>& array)
+  {
+    if (!fileIsValid()) {
+      cerr << "File is invalid\n";
+      return false;
+    }
+
+    TraceSpan metadataSpan("metadata", "metadata", path);
+    hid_t dataSetId = H5Dopen(m_fileId, path.c_str(), H5P_DEFAULT);
+    if (dataSetId < 0) {
+      cerr << "Failed to get dataSetId\n";
+      return false;
+    }
+
+    HIDCloser dataSetCloser(dataSetId, H5Dclose);
+
+    hid_t dataSpaceId = H5Dget_space(dataSetId);
+    if (dataSpaceId < 0) {
+      cerr << "Failed to get dataSpaceId\n";
+      return false;
+    }
+
+    HIDCloser dataSpaceCloser(dataSpaceId, H5Sclose);
 
-    if (H5Tequal(typeId, dataTypeId) == 0) {
-      // The type of the data does not match the requested type.
-      cerr << "Type determined does not match that requested." << endl;
-      cerr << typeId << " -> " << dataTypeId << endl;
+    int dimCount = H5Sget_simple_extent_ndims(dataSpaceId);
+    if (dimCount < 0) {
+      cerr << "Failed to get the dimensions\n";
       return false;
-    } else if (H5Tequal(typeId, dataTypeId) < 0) {
-      cerr << "Something went really wrong....\n\n";
+    }
+
+    vector<hsize_t> dims(std::max(dimCount, 1), 1);
+    if (dimCount > 0 &&
+        H5Sget_simple_extent_dims(dataSpaceId, &dims[0], nullptr) < 0) {
+      cerr << "Failed to get the dimensions\n";
       return false;
     }
 
-    return H5Dread(dataSetId, memTypeId, H5S_ALL, dataSpaceId, H5P_DEFAULT,
-                   data) >= 0;
+    if (!dataSetTypeMatches(dataSetId, DataTypeOf<T>::value))
+      return false;
+    metadataSpan.end();
+
+    array.resize(vector<int>(dims.begin(), dims.end()));
+    return readElements(dataSetId, BasicTypeToH5<T>::memTypeId(), H5S_ALL,
+                        dataSpaceId, transferPropertyList(), array.data());
   }
 
   bool getInfoByName(const string& path, H5O_info_t& info)
@@ -270,58 +703,79 @@ public:
     return info.type == H5O_TYPE_GROUP;
   }
 
-  DataType getH5ToDataType(hid_t h5type)
-  {
-    // Find the type
-    auto it = std::find_if(H5ToDataType.cbegin(), H5ToDataType.cend(),
-      [h5type](const std::pair<hid_t, DataType>& t)
-      {
-        return H5Tequal(t.first, h5type);
-      });
-
-    if (it == H5ToDataType.end()) {
-      cerr << "H5ToDataType map does not contain H5 type: " << h5type
-           << endl;
-      return DataType::None;
-    }
-
-    return it->second;
-  }
-
   bool fileIsValid() { return m_fileId >= 0; }
 
   void clear()
   {
     if (fileIsValid()) {
-      H5Fclose(m_fileId);
+      TraceSpan span("close", "close", m_fileName);
+      if (m_pooled)
+        FilePool::instance().release(m_fileId);
+      else
+        H5Fclose(m_fileId);
+
       m_fileId = H5I_INVALID_HID;
+      m_pooled = false;
+    }
+
+    if (m_transferId >= 0) {
+      H5Pclose(m_transferId);
+      m_transferId = H5I_INVALID_HID;
     }
   }
 
   hid_t fileId() const { return m_fileId; }
 
   hid_t m_fileId = H5I_INVALID_HID;
+  string m_fileName;
+  bool m_pooled = false;
+  bool m_swmrWriting = false;
+  OpenOptions m_options;
+  hid_t m_transferId = H5I_INVALID_HID;
+#ifdef H5CPP_USE_MPI
+  MPI_Comm m_communicator = MPI_COMM_NULL;
+  bool m_parallel = false;
+#endif
 };
 
 H5ReadWrite::H5ReadWrite(const string& file,
                    OpenMode mode)
-: m_impl(new H5ReadWriteImpl(file, mode))
+: m_impl(new H5ReadWriteImpl(file, mode, OpenOptions()))
+{
+}
+
+H5ReadWrite::H5ReadWrite(const string& file, OpenMode mode,
+                         const OpenOptions& options)
+: m_impl(new H5ReadWriteImpl(file, mode, options))
+{
+}
+
+#ifdef H5CPP_USE_MPI
+H5ReadWrite::H5ReadWrite(const string& file, OpenMode mode, MPI_Comm comm,
+                         const OpenOptions& options)
+: m_impl(new H5ReadWriteImpl(options))
 {
+  if (!m_impl->setCommunicator(comm)) {
+    cerr << "Warning: failed to set up parallel access for " << file << "\n";
+    return;
+  }
+
+  m_impl->open(file, mode);
 }
+#endif
 
 H5ReadWrite::~H5ReadWrite() = default;
 
 vector<string> H5ReadWrite::children(const string& path, bool* ok)
 {
+  TraceSpan span("children", "H5ReadWrite", path);
+
   setOk(ok, false);
   vector<string> result;
 
   if (!m_impl->fileIsValid())
     return result;
 
-  constexpr int maxNameSize = 2048;
-  char groupName[maxNameSize];
-
   hid_t groupId = H5Gopen(m_impl->fileId(), path.c_str(), H5P_DEFAULT);
   if (groupId < 0) {
     cerr << "Failed to open group: " << path << "\n";
@@ -331,13 +785,8 @@ vector<string> H5ReadWrite::children(const string& path, bool* ok)
   // For automatic closing upon leaving scope
   HIDCloser groupCloser(groupId, H5Gclose);
 
-  hsize_t objCount = 0;
-  H5Gget_num_objs(groupId, &objCount);
-
-  for (hsize_t i = 0; i < objCount; ++i) {
-    H5Gget_objname_by_idx(groupId, i, groupName, maxNameSize);
-    result.push_back(groupName);
-  }
+  if (!groupChildren(groupId, result))
+    return result;
 
   setOk(ok, true);
   return result;
@@ -346,13 +795,15 @@ vector<string> H5ReadWrite::children(const string& path, bool* ok)
 template <typename T>
 T H5ReadWrite::attribute(const string& path, const string& name, bool* ok)
 {
+  TraceSpan span("attribute", "H5ReadWrite", path);
+
   setOk(ok, false);
   T result;
 
-  const hid_t dataTypeId = BasicTypeToH5<T>::dataTypeId();
+  const DataType dataType = DataTypeOf<T>::value;
   const hid_t memTypeId = BasicTypeToH5<T>::memTypeId();
 
-  if (m_impl->attribute(path, name, &result, dataTypeId, memTypeId))
+  if (m_impl->attribute(path, name, &result, dataType, memTypeId))
     setOk(ok, true);
 
   return result;
@@ -363,74 +814,38 @@ template<>
 string H5ReadWrite::attribute<string>(const string& path, const string& name,
                                    bool* ok)
 {
+  TraceSpan span("attribute", "H5ReadWrite", path);
+
   setOk(ok, false);
   string result;
 
-  if (!m_impl->attributeExists(path, name)) {
-    cerr << "Attribute " << path << name << " not found!" << endl;
+  if (!m_impl->fileIsValid())
     return result;
-  }
-
-  hid_t fileId = m_impl->fileId();
 
-  hid_t attr = H5Aopen_by_name(fileId, path.c_str(), name.c_str(),
-                               H5P_DEFAULT, H5P_DEFAULT);
-  hid_t type = H5Aget_type(attr);
-
-  // For automatic closing upon leaving scope
-  HIDCloser attrCloser(attr, H5Aclose);
-  HIDCloser typeCloser(type, H5Tclose);
-
-  if (H5T_STRING != H5Tget_class(type)) {
-    cerr << path << name << " is not a string" << endl;
-    return result;
-  }
-  char* tmpString;
-  int is_var_str = H5Tis_variable_str(type);
-  if (is_var_str > 0) { // if it is a variable-length string
-    if (H5Aread(attr, type, &tmpString) < 0) {
-      cerr << "Failed to read attribute " << path << " " << name << endl;
-      return result;
-    }
-    result = tmpString;
-    free(tmpString);
-  } else if (is_var_str == 0) { // If it is not a variable-length string
-    // it must be fixed length since the "is a string" check earlier passed.
-    size_t size = H5Tget_size(type);
-    if (size == 0) {
-      cerr << "Unknown error occurred" << endl;
-      return result;
-    }
-    tmpString = new char[size + 1];
-    if (H5Aread(attr, type, tmpString) < 0) {
-      cerr << "Failed to read attribute " << path << " " << name << endl;
-      delete [] tmpString;
-      return result;
-    }
-    tmpString[size] = '\0'; // set null byte, hdf5 doesn't do this for you
-    result = tmpString;
-    delete [] tmpString;
-  } else {
-    cerr << "Unknown error occurred" << endl;
-    return result;
-  }
+  if (readStringAttribute(m_impl->fileId(), path, name, result))
+    setOk(ok, true);
 
-  setOk(ok, true);
   return result;
 }
 
 bool H5ReadWrite::hasAttribute(const string& path)
 {
+  TraceSpan span("hasAttribute", "H5ReadWrite", path);
+
   return m_impl->hasAttribute(path);
 }
 
 bool H5ReadWrite::hasAttribute(const string& path, const string& name)
 {
+  TraceSpan span("hasAttribute", "H5ReadWrite", path);
+
   return m_impl->attributeExists(path, name);
 }
 
 DataType H5ReadWrite::attributeType(const string& path, const string& name)
 {
+  TraceSpan span("attributeType", "H5ReadWrite", path);
+
   if (!m_impl->attributeExists(path, name)) {
     cerr << "Attribute " << path << name << " not found!" << endl;
     return DataType::None;
@@ -445,20 +860,20 @@ DataType H5ReadWrite::attributeType(const string& path, const string& name)
   HIDCloser attrCloser(attr, H5Aclose);
   HIDCloser typeCloser(h5type, H5Tclose);
 
-  // Special case for strings
-  if (H5T_STRING == H5Tget_class(h5type))
-    return DataType::String;
-
-  return m_impl->getH5ToDataType(h5type);
+  return h5ToDataType(h5type);
 }
 
 bool H5ReadWrite::isDataSet(const string& path)
 {
+  TraceSpan span("isDataSet", "H5ReadWrite", path);
+
   return m_impl->isDataSet(path);
 }
 
 vector<string> H5ReadWrite::allDataSets()
 {
+  TraceSpan span("allDataSets", "H5ReadWrite");
+
   if (!m_impl->fileIsValid())
     return vector<string>();
 
@@ -474,6 +889,8 @@ vector<string> H5ReadWrite::allDataSets()
 
 DataType H5ReadWrite::dataType(const string& path)
 {
+  TraceSpan span("dataType", "H5ReadWrite", path);
+
   if (!m_impl->isDataSet(path)) {
     cerr << path << " is not a data set.\n";
     return DataType::None;
@@ -491,11 +908,113 @@ DataType H5ReadWrite::dataType(const string& path)
   HIDCloser dataSetCloser(dataSetId, H5Dclose);
   HIDCloser dataTypeCloser(dataTypeId, H5Tclose);
 
-  return m_impl->getH5ToDataType(dataTypeId);
+  return h5ToDataType(dataTypeId);
+}
+
+vector<string> H5ReadWrite::compoundMembers(const string& path, bool* ok)
+{
+  TraceSpan span("compoundMembers", "H5ReadWrite", path);
+
+  setOk(ok, false);
+  vector<string> result;
+
+  if (!m_impl->isDataSet(path)) {
+    cerr << path << " is not a data set.\n";
+    return result;
+  }
+
+  HIDCloser dataSetCloser(
+    H5Dopen(m_impl->fileId(), path.c_str(), H5P_DEFAULT), H5Dclose);
+  HIDCloser typeCloser(H5Dget_type(dataSetCloser.value()), H5Tclose);
+  if (H5Tget_class(typeCloser.value()) != H5T_COMPOUND) {
+    cerr << path << " is not a compound data set.\n";
+    return result;
+  }
+
+  int count = H5Tget_nmembers(typeCloser.value());
+  for (int i = 0; i < count; ++i) {
+    char* name = H5Tget_member_name(typeCloser.value(), i);
+    result.push_back(name);
+    H5free_memory(name);
+  }
+
+  setOk(ok, true);
+  return result;
+}
+
+DataType H5ReadWrite::compoundMemberType(const string& path,
+                                         const string& member)
+{
+  TraceSpan span("compoundMemberType", "H5ReadWrite", path);
+
+  if (!m_impl->isDataSet(path)) {
+    cerr << path << " is not a data set.\n";
+    return DataType::None;
+  }
+
+  HIDCloser dataSetCloser(
+    H5Dopen(m_impl->fileId(), path.c_str(), H5P_DEFAULT), H5Dclose);
+  HIDCloser typeCloser(H5Dget_type(dataSetCloser.value()), H5Tclose);
+  if (H5Tget_class(typeCloser.value()) != H5T_COMPOUND) {
+    cerr << path << " is not a compound data set.\n";
+    return DataType::None;
+  }
+
+  int index = H5Tget_member_index(typeCloser.value(), member.c_str());
+  if (index < 0) {
+    cerr << "Compound member not found: " << member << "\n";
+    return DataType::None;
+  }
+
+  HIDCloser memberCloser(H5Tget_member_type(typeCloser.value(), index),
+                         H5Tclose);
+  DataType type = h5ToDataType(memberCloser.value());
+
+  // Nested compound types are not supported
+  return type == DataType::Compound ? DataType::None : type;
+}
+
+bool H5ReadWrite::readColumns(const string& path,
+                              const vector<Column>& columns)
+{
+  TraceSpan span("readColumns", "H5ReadWrite", path);
+
+  if (!m_impl->isDataSet(path)) {
+    cerr << path << " is not a data set.\n";
+    return false;
+  }
+
+  HIDCloser dataSetCloser(
+    H5Dopen(m_impl->fileId(), path.c_str(), H5P_DEFAULT), H5Dclose);
+  if (!dataSetCloser.valueIsValid()) {
+    cerr << "Failed to get dataSetId\n";
+    return false;
+  }
+
+  return readCompoundColumns(dataSetCloser.value(),
+                             m_impl->transferPropertyList(), columns);
+}
+
+template <typename T>
+vector<T> H5ReadWrite::readColumn(const string& path, const string& member)
+{
+  vector<int> dims = getDimensions(path);
+  if (dims.size() != 1) {
+    cerr << "Compound data sets must be 1-dimensional\n";
+    return vector<T>();
+  }
+
+  vector<T> result(dims[0]);
+  if (!readColumns(path, { column(member, result.data()) }))
+    return vector<T>();
+
+  return result;
 }
 
 vector<int> H5ReadWrite::getDimensions(const string& path)
 {
+  TraceSpan span("getDimensions", "H5ReadWrite", path);
+
   vector<int> result;
   if (!m_impl->isDataSet(path)) {
     cerr << path << " is not a data set.\n";
@@ -542,6 +1061,68 @@ vector<int> H5ReadWrite::getDimensions(const string& path)
   return result;
 }
 
+WriteOptions::Layout H5ReadWrite::storageLayout(const string& path)
+{
+  TraceSpan span("storageLayout", "H5ReadWrite", path);
+
+  using Layout = WriteOptions::Layout;
+
+  if (!m_impl->isDataSet(path)) {
+    cerr << path << " is not a data set.\n";
+    return Layout::Automatic;
+  }
+
+  hid_t dataSetId = H5Dopen(m_impl->fileId(), path.c_str(), H5P_DEFAULT);
+  HIDCloser dataSetCloser(dataSetId, H5Dclose);
+
+  hid_t createId = H5Dget_create_plist(dataSetId);
+  HIDCloser createCloser(createId, H5Pclose);
+  if (createId < 0) {
+    cerr << "Failed to get the data set creation property list\n";
+    return Layout::Automatic;
+  }
+
+  switch (H5Pget_layout(createId)) {
+    case H5D_COMPACT:
+      return Layout::Compact;
+    case H5D_CONTIGUOUS:
+      return Layout::Contiguous;
+    case H5D_CHUNKED:
+      return Layout::Chunked;
+    default:
+      return Layout::Automatic;
+  }
+}
+
+vector<int> H5ReadWrite::chunkDimensions(const string& path)
+{
+  TraceSpan span("chunkDimensions", "H5ReadWrite", path);
+
+  vector<int> result;
+  if (!m_impl->isDataSet(path)) {
+    cerr << path << " is not a data set.\n";
+    return result;
+  }
+
+  hid_t dataSetId = H5Dopen(m_impl->fileId(), path.c_str(), H5P_DEFAULT);
+  HIDCloser dataSetCloser(dataSetId, H5Dclose);
+
+  hid_t createId = H5Dget_create_plist(dataSetId);
+  HIDCloser createCloser(createId, H5Pclose);
+  if (createId < 0 || H5Pget_layout(createId) != H5D_CHUNKED)
+    return result;
+
+  hsize_t chunk[H5S_MAX_RANK];
+  int rank = H5Pget_chunk(createId, H5S_MAX_RANK, chunk);
+  if (rank < 0) {
+    cerr << "Failed to get the chunk dimensions\n";
+    return result;
+  }
+
+  result.assign(chunk, chunk + rank);
+  return result;
+}
+
 int H5ReadWrite::dimensionCount(const string& path)
 {
   vector<int> dims = getDimensions(path);
@@ -577,6 +1158,8 @@ vector<T> H5ReadWrite::readData(const string& path)
 template <typename T>
 vector<T> H5ReadWrite::readData(const string& path, vector<int>& dims)
 {
+  TraceSpan span("readData", "H5ReadWrite", path);
+
   vector<T> result;
 
   dims = getDimensions(path);
@@ -598,13 +1181,63 @@ vector<T> H5ReadWrite::readData(const string& path, vector<int>& dims)
   return result;
 }
 
+bool H5ReadWrite::readData(const string& path, StringTable& table)
+{
+  TraceSpan span("readData", "H5ReadWrite", path);
+
+  table.clear();
+
+  if (!m_impl->isDataSet(path)) {
+    cerr << path << " is not a data set.\n";
+    return false;
+  }
+
+  hid_t dataSetId = H5Dopen(m_impl->fileId(), path.c_str(), H5P_DEFAULT);
+  if (dataSetId < 0) {
+    cerr << "Failed to get dataSetId\n";
+    return false;
+  }
+
+  HIDCloser dataSetCloser(dataSetId, H5Dclose);
+
+  if (!readStringDataSet(dataSetId, m_impl->transferPropertyList(), table)) {
+    cerr << "Failed to read the data\n";
+    table.clear();
+    return false;
+  }
+
+  return true;
+}
+
+// We have a specialization for std::string, which copies the strings out
+// of a StringTable
+template <>
+vector<string> H5ReadWrite::readData<string>(const string& path,
+                                             vector<int>& dims)
+{
+  vector<string> result;
+
+  StringTable table;
+  if (!readData(path, table))
+    return result;
+
+  dims = table.shape();
+  result.reserve(table.size());
+  for (size_t i = 0; i < table.size(); ++i)
+    result.push_back(table.string(i));
+
+  return result;
+}
+
 template <typename T>
 bool H5ReadWrite::readData(const string& path, T* data)
 {
-  const hid_t dataTypeId = BasicTypeToH5<T>::dataTypeId();
+  TraceSpan span("readData", "H5ReadWrite", path);
+
+  const DataType dataType = DataTypeOf<T>::value;
   const hid_t memTypeId = BasicTypeToH5<T>::memTypeId();
 
-  if (!m_impl->readData(path, dataTypeId, memTypeId, data)) {
+  if (!m_impl->readData(path, dataType, memTypeId, data)) {
     cerr << "Failed to read the data\n";
     return false;
   }
@@ -612,27 +1245,31 @@ bool H5ReadWrite::readData(const string& path, T* data)
   return true;
 }
 
-bool H5ReadWrite::readData(const string& path, const DataType& type,
-                           void* data)
+template <typename T>
+bool H5ReadWrite::readData(const string& path, NDArray<T>& array)
 {
-  auto it = DataTypeToH5DataType.find(type);
-  if (it == DataTypeToH5DataType.end()) {
-    cerr << "Failed to get H5 data type for " << dataTypeToString(type)
-         << "\n";
+  TraceSpan span("readData", "H5ReadWrite", path);
+
+  if (!m_impl->readArray(path, array)) {
+    cerr << "Failed to read the data\n";
     return false;
   }
 
-  hid_t dataTypeId = it->second;
+  return true;
+}
+
+bool H5ReadWrite::readData(const string& path, const DataType& type,
+                           void* data)
+{
+  TraceSpan span("readData", "H5ReadWrite", path);
 
-  auto memIt = DataTypeToH5MemType.find(type);
-  if (memIt == DataTypeToH5MemType.end()) {
-    cerr << "Failed to get H5 mem type for " << dataTypeToString(type) << "\n";
+  hid_t dataTypeId, memTypeId;
+  if (!h5TypeIds(type, dataTypeId, memTypeId)) {
+    cerr << "Failed to get H5 types for " << dataTypeToString(type) << "\n";
     return false;
   }
 
-  hid_t memTypeId = memIt->second;
-
-  if (!m_impl->readData(path, dataTypeId, memTypeId, data)) {
+  if (!m_impl->readData(path, type, memTypeId, data)) {
     cerr << "Failed to read the data\n";
     return false;
   }
@@ -642,54 +1279,88 @@ bool H5ReadWrite::readData(const string& path, const DataType& type,
 
 template <typename T>
 bool H5ReadWrite::writeData(const string& path, const string& name,
-                            const vector<int>& dims, const vector<T>& data)
+                            const vector<int>& dims, const vector<T>& data,
+                            const WriteOptions& options)
+{
+  return writeData(path, name, dims, data.data(), options);
+}
+
+// Specialization for string
+template <>
+bool H5ReadWrite::writeData<string>(const string& path, const string& name,
+                                    const vector<int>& dims,
+                                    const vector<string>& data,
+                                    const WriteOptions& options)
 {
-  return writeData(path, name, dims, data.data());
+  TraceSpan span("writeData", "H5ReadWrite");
+  traceChild(span, path, name);
+
+  if (!m_impl->fileIsValid()) {
+    cerr << "File is invalid\n";
+    return false;
+  }
+
+  hid_t groupId = H5Gopen(m_impl->fileId(), path.c_str(), H5P_DEFAULT);
+  if (groupId < 0) {
+    cerr << "Failed to open group: " << path << "\n";
+    return false;
+  }
+
+  HIDCloser groupCloser(groupId, H5Gclose);
+
+  return writeStringDataSet(groupId, name, dims, data,
+                            m_impl->transferPropertyList(), options);
 }
 
 template <typename T>
 bool H5ReadWrite::writeData(const string& path, const string& name,
-                            const vector<int>& dims, const T* data)
+                            const vector<int>& dims, const T* data,
+                            const WriteOptions& options)
 {
+  TraceSpan span("writeData", "H5ReadWrite");
+  traceChild(span, path, name);
+
   const hid_t dataTypeId = BasicTypeToH5<T>::dataTypeId();
   const hid_t memTypeId = BasicTypeToH5<T>::memTypeId();
 
   return m_impl->writeData(path, name, dims, data,
-                           dataTypeId, memTypeId);
+                           dataTypeId, memTypeId, options);
 }
 
+template <typename T>
 bool H5ReadWrite::writeData(const string& path, const string& name,
-                            const vector<int>& dims, const DataType& type,
-                            const void* data)
+                            const NDArray<T>& array,
+                            const WriteOptions& options)
 {
-  auto it = DataTypeToH5DataType.find(type);
-  if (it == DataTypeToH5DataType.end()) {
-    cerr << "Failed to get H5 data type for " << dataTypeToString(type)
-         << "\n";
-    return false;
-  }
+  return writeData(path, name, array.shape(), array.data(), options);
+}
 
-  hid_t dataTypeId = it->second;
+bool H5ReadWrite::writeData(const string& path, const string& name,
+                            const vector<int>& dims, const DataType& type,
+                            const void* data, const WriteOptions& options)
+{
+  TraceSpan span("writeData", "H5ReadWrite");
+  traceChild(span, path, name);
 
-  auto memIt = DataTypeToH5MemType.find(type);
-  if (memIt == DataTypeToH5MemType.end()) {
-    cerr << "Failed to get H5 mem type for " << dataTypeToString(type) << "\n";
+  hid_t dataTypeId, memTypeId;
+  if (!h5TypeIds(type, dataTypeId, memTypeId)) {
+    cerr << "Failed to get H5 types for " << dataTypeToString(type) << "\n";
     return false;
   }
 
-  hid_t memTypeId = memIt->second;
-
   return m_impl->writeData(path, name, dims, data,
-                           dataTypeId, memTypeId);
+                           dataTypeId, memTypeId, options);
 }
 
 template<typename T>
 bool H5ReadWrite::setAttribute(const string& path, const string& name, T value)
 {
+  TraceSpan span("setAttribute", "H5ReadWrite", path);
+
   const hid_t dataTypeId = BasicTypeToH5<T>::dataTypeId();
   const hid_t memTypeId = BasicTypeToH5<T>::memTypeId();
 
-  return m_impl->setAttribute(path, name, &value, dataTypeId, memTypeId, 1);
+  return m_impl->setAttribute(path, name, &value, dataTypeId, memTypeId);
 }
 
 // Specialization for string
@@ -697,6 +1368,8 @@ template<>
 bool H5ReadWrite::setAttribute<const string&>(const string& path, const string& name,
                                               const string& value)
 {
+  TraceSpan span("setAttribute", "H5ReadWrite", path);
+
   if (!m_impl->fileIsValid()) {
     cerr << "File is not valid\n";
     return false;
@@ -717,42 +1390,305 @@ bool H5ReadWrite::setAttribute<const string&>(const string& path, const string&
 
   HIDCloser parentCloser(parentId, closer);
 
-  hsize_t dims = 1;
-  hid_t dataSpaceId = H5Screate_simple(1, &dims, nullptr);
-  hid_t dataType = H5Tcopy(H5T_C_S1);
-  herr_t status = H5Tset_size(dataType, H5T_VARIABLE);
+  return writeStringAttribute(parentId, name, value);
+}
+
+template<>
+bool H5ReadWrite::setAttribute<const char*>(const string& path, const string& name,
+                                            const char* value)
+{
+  return setAttribute<const string&>(path, name, value);
+}
+
+
+DataSet H5ReadWrite::openDataSet(const string& path)
+{
+  TraceSpan span("openDataSet", "H5ReadWrite", path);
+
+  if (!m_impl->fileIsValid()) {
+    cerr << "File is not valid\n";
+    return DataSet();
+  }
+
+  hid_t dataSetId = H5Dopen(m_impl->fileId(), path.c_str(), H5P_DEFAULT);
+  if (dataSetId < 0) {
+    cerr << "Failed to open data set: " << path << "\n";
+    return DataSet();
+  }
+
+  return DataSet(dataSetId, m_impl->copyTransferPropertyList(), path);
+}
+
+Group H5ReadWrite::openGroup(const string& path)
+{
+  TraceSpan span("openGroup", "H5ReadWrite", path);
+
+  if (!m_impl->fileIsValid()) {
+    cerr << "File is not valid\n";
+    return Group();
+  }
+
+  hid_t groupId = H5Gopen(m_impl->fileId(), path.c_str(), H5P_DEFAULT);
+  if (groupId < 0) {
+    cerr << "Failed to open group: " << path << "\n";
+    return Group();
+  }
+
+  return Group(groupId, m_impl->copyTransferPropertyList(), path);
+}
+
+DataSet H5ReadWrite::createDataSet(const string& path, const string& name,
+                                   const vector<int>& dimensions,
+                                   const DataType& type,
+                                   const WriteOptions& options)
+{
+  TraceSpan span("createDataSet", "H5ReadWrite");
+  traceChild(span, path, name);
+
+  if (!m_impl->fileIsValid()) {
+    cerr << "File is not valid\n";
+    return DataSet();
+  }
+
+  hid_t groupId = H5Gopen(m_impl->fileId(), path.c_str(), H5P_DEFAULT);
+  if (groupId < 0) {
+    cerr << "Failed to open group: " << path << "\n";
+    return DataSet();
+  }
+
+  HIDCloser groupCloser(groupId, H5Gclose);
 
-  if (status < 0) {
-    cerr << "Failed to set the size\n";
+  hid_t dataSetId =
+    createEmptyDataSet(groupId, name, dimensions, type, options);
+  if (dataSetId < 0)
+    return DataSet();
+
+  string dataSetPath = path;
+  if (dataSetPath.empty() || dataSetPath.back() != '/')
+    dataSetPath += '/';
+  dataSetPath += name;
+
+  return DataSet(dataSetId, m_impl->copyTransferPropertyList(), dataSetPath);
+}
+
+bool H5ReadWrite::createGroup(const string& path)
+{
+  TraceSpan span("createGroup", "H5ReadWrite", path);
+
+  if (!m_impl->fileIsValid()) {
+    cerr << "File is not valid\n";
     return false;
   }
 
-  hid_t attributeId = H5Acreate2(parentId, name.c_str(), dataType,
-                                 dataSpaceId, H5P_DEFAULT, H5P_DEFAULT);
+  hid_t groupId = H5Gcreate(m_impl->fileId(), path.c_str(), H5P_DEFAULT,
+                            H5P_DEFAULT, H5P_DEFAULT);
+  HIDCloser groupCloser(groupId, H5Gclose);
 
-  HIDCloser attributeCloser(attributeId, H5Aclose);
-  HIDCloser dataSpaceCloser(dataSpaceId, H5Sclose);
+  return groupId >= 0;
+}
+
+bool H5ReadWrite::writeColumns(const string& path, const string& name,
+                               int length, const vector<ConstColumn>& columns,
+                               const WriteOptions& options)
+{
+  TraceSpan span("writeColumns", "H5ReadWrite");
+  traceChild(span, path, name);
+
+  if (!m_impl->fileIsValid()) {
+    cerr << "File is invalid\n";
+    return false;
+  }
+
+  hid_t groupId = H5Gopen(m_impl->fileId(), path.c_str(), H5P_DEFAULT);
+  if (groupId < 0) {
+    cerr << "Failed to open group: " << path << "\n";
+    return false;
+  }
+
+  HIDCloser groupCloser(groupId, H5Gclose);
 
-  return H5Awrite(attributeId, dataType, value.c_str());
+  return writeCompoundDataSet(groupId, name, length, columns,
+                              m_impl->transferPropertyList(), options);
 }
 
-template<>
-bool H5ReadWrite::setAttribute<const char*>(const string& path, const string& name,
-                                            const char* value)
+bool H5ReadWrite::commit(const BatchWrite& batch)
 {
-  return setAttribute<const string&>(path, name, value);
+  TraceSpan span("commit", "H5ReadWrite");
+
+  if (!m_impl->fileIsValid()) {
+    cerr << "File is not valid\n";
+    return false;
+  }
+
+  return batch.commit(m_impl->fileId(), m_impl->transferPropertyList());
 }
 
+template <typename T>
+bool H5ReadWrite::writeSlab(const string& path, const vector<int>& start,
+                            const vector<int>& counts, const T* data)
+{
+  TraceSpan span("writeSlab", "H5ReadWrite", path);
 
-bool H5ReadWrite::createGroup(const string& path)
+  const hid_t memTypeId = BasicTypeToH5<T>::memTypeId();
+
+  return m_impl->writeSlab(path, start, counts, data, memTypeId);
+}
+
+template <typename T>
+bool H5ReadWrite::writeSlab(const string& path, const vector<int>& start,
+                            const NDArray<T>& array)
 {
+  return writeSlab(path, start, array.shape(), array.data());
+}
+
+bool H5ReadWrite::writeSlab(const string& path, const vector<int>& start,
+                            const vector<int>& counts, const DataType& type,
+                            const void* data)
+{
+  TraceSpan span("writeSlab", "H5ReadWrite", path);
+
+  hid_t dataTypeId, memTypeId;
+  if (!h5TypeIds(type, dataTypeId, memTypeId)) {
+    cerr << "Failed to get H5 types for " << dataTypeToString(type) << "\n";
+    return false;
+  }
+
+  return m_impl->writeSlab(path, start, counts, data, memTypeId);
+}
+
+template <typename T>
+bool H5ReadWrite::readSlab(const string& path, const vector<int>& start,
+                           const vector<int>& counts, T* data)
+{
+  TraceSpan span("readSlab", "H5ReadWrite", path);
+
+  const DataType dataType = DataTypeOf<T>::value;
+  const hid_t memTypeId = BasicTypeToH5<T>::memTypeId();
+
+  if (!m_impl->readSlab(path, start, counts, dataType, memTypeId, data)) {
+    cerr << "Failed to read the slab\n";
+    return false;
+  }
+
+  return true;
+}
+
+template <typename T>
+bool H5ReadWrite::readSlab(const string& path, const vector<int>& start,
+                           const vector<int>& counts, NDArray<T>& array)
+{
+  array.resize(counts);
+  return readSlab(path, start, counts, array.data());
+}
+
+bool H5ReadWrite::readSlab(const string& path, const vector<int>& start,
+                           const vector<int>& counts, const DataType& type,
+                           void* data)
+{
+  TraceSpan span("readSlab", "H5ReadWrite", path);
+
+  hid_t dataTypeId, memTypeId;
+  if (!h5TypeIds(type, dataTypeId, memTypeId)) {
+    cerr << "Failed to get H5 types for " << dataTypeToString(type) << "\n";
+    return false;
+  }
+
+  if (!m_impl->readSlab(path, start, counts, type, memTypeId, data)) {
+    cerr << "Failed to read the slab\n";
+    return false;
+  }
+
+  return true;
+}
+
+bool H5ReadWrite::createAppendableDataSet(const string& path,
+                                          const string& name,
+                                          const vector<int>& frameDims,
+                                          const DataType& type)
+{
+  TraceSpan span("createAppendableDataSet", "H5ReadWrite");
+  traceChild(span, path, name);
+
+  hid_t dataTypeId, memTypeId;
+  if (!h5TypeIds(type, dataTypeId, memTypeId)) {
+    cerr << "Failed to get H5 types for " << dataTypeToString(type) << "\n";
+    return false;
+  }
+
+  return m_impl->createAppendableDataSet(path, name, frameDims, dataTypeId);
+}
+
+template <typename T>
+bool H5ReadWrite::appendData(const string& path, const T* data)
+{
+  TraceSpan span("appendData", "H5ReadWrite", path);
+
+  const hid_t memTypeId = BasicTypeToH5<T>::memTypeId();
+
+  return m_impl->appendData(path, data, memTypeId);
+}
+
+bool H5ReadWrite::appendData(const string& path, const DataType& type,
+                             const void* data)
+{
+  TraceSpan span("appendData", "H5ReadWrite", path);
+
+  hid_t dataTypeId, memTypeId;
+  if (!h5TypeIds(type, dataTypeId, memTypeId)) {
+    cerr << "Failed to get H5 types for " << dataTypeToString(type) << "\n";
+    return false;
+  }
+
+  return m_impl->appendData(path, data, memTypeId);
+}
+
+bool H5ReadWrite::startSWMRWrite()
+{
+  TraceSpan span("startSWMRWrite", "H5ReadWrite");
+
+  return m_impl->startSWMRWrite();
+}
+
+bool H5ReadWrite::flush()
+{
+  TraceSpan span("flush", "H5ReadWrite");
+
+  if (!m_impl->fileIsValid()) {
+    cerr << "File is not valid\n";
+    return false;
+  }
+
+  return H5Fflush(m_impl->fileId(), H5F_SCOPE_GLOBAL) >= 0;
+}
+
+bool H5ReadWrite::refresh(const string& path)
+{
+  TraceSpan span("refresh", "H5ReadWrite", path);
+
   if (!m_impl->fileIsValid()) {
     cerr << "File is not valid\n";
     return false;
   }
 
-  return H5Gcreate(m_impl->fileId(), path.c_str(), H5P_DEFAULT, H5P_DEFAULT,
-                   H5P_DEFAULT);
+  hid_t dataSetId = H5Dopen(m_impl->fileId(), path.c_str(), H5P_DEFAULT);
+  if (dataSetId < 0) {
+    cerr << "Failed to get dataSetId\n";
+    return false;
+  }
+
+  HIDCloser dataSetCloser(dataSetId, H5Dclose);
+
+  return H5Drefresh(dataSetId) >= 0;
+}
+
+int64_t H5ReadWrite::fileId() const
+{
+  return m_impl->fileId();
+}
+
+int64_t H5ReadWrite::transferPropertyList() const
+{
+  return m_impl->transferPropertyList();
 }
 
 string H5ReadWrite::dataTypeToString(const DataType& type)
@@ -770,7 +1706,11 @@ string H5ReadWrite::dataTypeToString(const DataType& type)
     { DataType::UInt64, "UInt64" },
     { DataType::Float,  "Float"  },
     { DataType::Double, "Double" },
+    { DataType::Float16, "Float16" },
+    { DataType::Complex64, "Complex64" },
+    { DataType::Complex128, "Complex128" },
     { DataType::String, "String" },
+    { DataType::Compound, "Compound" },
     { DataType::None,   "None"   }
   };
 
@@ -782,99 +1722,49 @@ string H5ReadWrite::dataTypeToString(const DataType& type)
 }
 
 // Instantiate our allowable templates here
-// attribute()
-template char H5ReadWrite::attribute(const string&, const string&, bool*);
-template short H5ReadWrite::attribute(const string&, const string&, bool*);
-template int H5ReadWrite::attribute(const string&, const string&, bool*);
-template long long H5ReadWrite::attribute(const string&, const string&, bool*);
-template unsigned char H5ReadWrite::attribute(const string&, const string&,
-                                           bool*);
-template unsigned short H5ReadWrite::attribute(const string&, const string&,
-                                            bool*);
-template unsigned int H5ReadWrite::attribute(const string&, const string&, bool*);
-template unsigned long long H5ReadWrite::attribute(const string&, const string&,
-                                                bool*);
-template float H5ReadWrite::attribute(const string&, const string&, bool*);
-template double H5ReadWrite::attribute(const string&, const string&, bool*);
-template string H5ReadWrite::attribute(const string&, const string&, bool*);
+#define INSTANTIATE_H5READWRITE_TEMPLATES(T, E)                               \
+  template T H5ReadWrite::attribute(const string&, const string&, bool*);     \
+  template vector<T> H5ReadWrite::readData(const string&);                    \
+  template vector<T> H5ReadWrite::readData(const string&, vector<int>&);      \
+  template bool H5ReadWrite::readData(const string&, T*);                     \
+  template bool H5ReadWrite::readData(const string&, NDArray<T>&);            \
+  template bool H5ReadWrite::setAttribute(const string&, const string&, T);   \
+  template bool H5ReadWrite::writeData(const string&, const string&,          \
+                                       const vector<int>&, const vector<T>&,  \
+                                       const WriteOptions&);                  \
+  template bool H5ReadWrite::writeData(const string&, const string&,          \
+                                       const vector<int>&, const T*,          \
+                                       const WriteOptions&);                  \
+  template bool H5ReadWrite::writeData(const string&, const string&,          \
+                                       const NDArray<T>&,                     \
+                                       const WriteOptions&);                  \
+  template bool H5ReadWrite::writeSlab(const string&, const vector<int>&,     \
+                                       const vector<int>&, const T*);         \
+  template bool H5ReadWrite::writeSlab(const string&, const vector<int>&,     \
+                                       const NDArray<T>&);                    \
+  template bool H5ReadWrite::readSlab(const string&, const vector<int>&,      \
+                                      const vector<int>&, T*);                \
+  template bool H5ReadWrite::readSlab(const string&, const vector<int>&,      \
+                                      const vector<int>&, NDArray<T>&);       \
+  template bool H5ReadWrite::appendData(const string&, const T*);            \
+  template vector<T> H5ReadWrite::readColumn(const string&, const string&);
+
+H5CPP_FOR_EACH_BASIC_TYPE(INSTANTIATE_H5READWRITE_TEMPLATES)
+H5CPP_FOR_EACH_EXTENDED_TYPE(INSTANTIATE_H5READWRITE_TEMPLATES)
+
+#undef INSTANTIATE_H5READWRITE_TEMPLATES
 
-// readData(): single-dimensional
-template vector<char> H5ReadWrite::readData(const string&);
-template vector<short> H5ReadWrite::readData(const string&);
-template vector<int> H5ReadWrite::readData(const string&);
-template vector<long long> H5ReadWrite::readData(const string&);
-template vector<unsigned char> H5ReadWrite::readData(const string&);
-template vector<unsigned short> H5ReadWrite::readData(const string&);
-template vector<unsigned int> H5ReadWrite::readData(const string&);
-template vector<unsigned long long> H5ReadWrite::readData(const string&);
-template vector<float> H5ReadWrite::readData(const string&);
-template vector<double> H5ReadWrite::readData(const string&);
-
-// readData(): multi-dimensional
-template vector<char> H5ReadWrite::readData(const string&, vector<int>&);
-template vector<short> H5ReadWrite::readData(const string&, vector<int>&);
-template vector<int> H5ReadWrite::readData(const string&, vector<int>&);
-template vector<long long> H5ReadWrite::readData(const string&, vector<int>&);
-template vector<unsigned char> H5ReadWrite::readData(const string&, vector<int>&);
-template vector<unsigned short> H5ReadWrite::readData(const string&,
-                                                   vector<int>&);
-template vector<unsigned int> H5ReadWrite::readData(const string&, vector<int>&);
-template vector<unsigned long long> H5ReadWrite::readData(const string&,
-                                                       vector<int>&);
-template vector<float> H5ReadWrite::readData(const string&, vector<int>&);
-template vector<double> H5ReadWrite::readData(const string&, vector<int>&);
-
-// readData(): multi-dimensional
-template bool H5ReadWrite::readData(const string&, char*);
-template bool H5ReadWrite::readData(const string&, short*);
-template bool H5ReadWrite::readData(const string&, int*);
-template bool H5ReadWrite::readData(const string&, long long*);
-template bool H5ReadWrite::readData(const string&, unsigned char*);
-template bool H5ReadWrite::readData(const string&, unsigned short*);
-template bool H5ReadWrite::readData(const string&, unsigned int*);
-template bool H5ReadWrite::readData(const string&, unsigned long long*);
-template bool H5ReadWrite::readData(const string&, float*);
-template bool H5ReadWrite::readData(const string&, double*);
-
-// setAttribute
-template bool H5ReadWrite::setAttribute(const string&, const string&, char);
-template bool H5ReadWrite::setAttribute(const string&, const string&, short);
-template bool H5ReadWrite::setAttribute(const string&, const string&, int);
-template bool H5ReadWrite::setAttribute(const string&, const string&, long long);
-template bool H5ReadWrite::setAttribute(const string&, const string&, unsigned char);
-template bool H5ReadWrite::setAttribute(const string&, const string&, unsigned short);
-template bool H5ReadWrite::setAttribute(const string&, const string&, unsigned int);
-template bool H5ReadWrite::setAttribute(const string&, const string&, unsigned long long);
-template bool H5ReadWrite::setAttribute(const string&, const string&, float);
-template bool H5ReadWrite::setAttribute(const string&, const string&, double);
-template bool H5ReadWrite::setAttribute(const string&, const string&, const string&);
-template bool H5ReadWrite::setAttribute(const string&, const string&, const char*);
-
-// writeData
-template bool H5ReadWrite::writeData(const string&, const string&, const vector<int>&, const vector<char>&);
-template bool H5ReadWrite::writeData(const string&, const string&, const vector<int>&, const vector<short>&);
-template bool H5ReadWrite::writeData(const string&, const string&, const vector<int>&, const vector<int>&);
-template bool H5ReadWrite::writeData(const string&, const string&, const vector<int>&, const vector<long long>&);
-template bool H5ReadWrite::writeData(const string&, const string&, const vector<int>&, const vector<unsigned char>&);
-template bool H5ReadWrite::writeData(const string&, const string&, const vector<int>&, const vector<unsigned short>&);
-template bool H5ReadWrite::writeData(const string&, const string&, const vector<int>&, const vector<unsigned int>&);
-template bool H5ReadWrite::writeData(const string&, const string&, const vector<int>&, const vector<unsigned long long>&);
-template bool H5ReadWrite::writeData(const string&, const string&, const vector<int>&, const vector<float>&);
-template bool H5ReadWrite::writeData(const string&, const string&, const vector<int>&, const vector<double>&);
-
-template bool H5ReadWrite::writeData(const string&, const string&, const vector<int>&, const char*);
-template bool H5ReadWrite::writeData(const string&, const string&, const vector<int>&, const short*);
-template bool H5ReadWrite::writeData(const string&, const string&, const vector<int>&, const int*);
-template bool H5ReadWrite::writeData(const string&, const string&, const vector<int>&, const long long*);
-template bool H5ReadWrite::writeData(const string&, const string&, const vector<int>&, const unsigned char*);
-template bool H5ReadWrite::writeData(const string&, const string&, const vector<int>&, const unsigned short*);
-template bool H5ReadWrite::writeData(const string&, const string&, const vector<int>&, const unsigned int*);
-template bool H5ReadWrite::writeData(const string&, const string&, const vector<int>&, const unsigned long long*);
-template bool H5ReadWrite::writeData(const string&, const string&, const vector<int>&, const float*);
-template bool H5ReadWrite::writeData(const string&, const string&, const vector<int>&, const double*);
-
-// We need to create specializations for these
-//template vector<string> H5ReadWrite::readData(const string&);
-//template vector<string> H5ReadWrite::readData(const string&, vector<int>&);
+template string H5ReadWrite::attribute(const string&, const string&, bool*);
+template bool H5ReadWrite::setAttribute(const string&, const string&,
+                                        const string&);
+template bool H5ReadWrite::setAttribute(const string&, const string&,
+                                        const char*);
+
+template vector<string> H5ReadWrite::readData(const string&);
+template vector<string> H5ReadWrite::readData(const string&, vector<int>&);
+template bool H5ReadWrite::writeData(const string&, const string&,
+                                     const vector<int>&,
+                                     const vector<string>&,
+                                     const WriteOptions&);
 
 } // namespace h5
@@ -4,12 +4,39 @@
 #ifndef tomvizH5ReadWrite_h
 #define tomvizH5ReadWrite_h
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "h5ndarray.h"
+#include "h5openoptions.h"
+#include "h5stringtable.h"
+#include "h5writeoptions.h"
+
+#ifdef H5CPP_USE_MPI
+#include <mpi.h>
+#endif
+
 namespace h5 {
 
+class BatchWrite;
+class DataSet;
+class EmdReader;
+class Group;
+class IOActor;
+class OpenPMDReader;
+
+// Defined in h5inspect.h
+struct InspectOptions;
+struct ObjectInfo;
+
+// Defined in h5compound.h
+template <typename Pointer>
+struct BasicColumn;
+using Column = BasicColumn<void*>;
+using ConstColumn = BasicColumn<const void*>;
+
 class H5ReadWrite {
 public:
 
@@ -18,16 +45,52 @@ public:
    */
   enum class OpenMode {
     ReadOnly,
-    WriteOnly
+    WriteOnly,
+    ReadWrite, // Open an existing file for reading and writing
+    SWMRWrite, // Create a file that can be switched to SWMR writing
+    SWMRRead   // Open a file that is being written in SWMR mode
   };
 
   /**
-   * Open an HDF5 file for reading.
-   * @param fileName the file to open for reading.
+   * Open an HDF5 file.
+   * @param fileName the file to open.
+   * @param mode the mode to open the file with. SWMRWrite creates (and
+   *             truncates) the file using the latest file format, so that
+   *             startSWMRWrite() may be called once the layout is created.
+   *             SWMRRead opens a file for reading while another process
+   *             is writing to it in SWMR mode.
    */
   explicit H5ReadWrite(const std::string& fileName,
                     OpenMode mode = OpenMode::ReadOnly);
 
+  /**
+   * Open an HDF5 file with tuned file creation and access properties.
+   * @param fileName the file to open.
+   * @param mode the mode to open the file with.
+   * @param options the tuning to use, such as OpenOptions::localNVMe().
+   */
+  H5ReadWrite(const std::string& fileName, OpenMode mode,
+              const OpenOptions& options);
+
+#ifdef H5CPP_USE_MPI
+  /**
+   * Open an HDF5 file in parallel with the MPI-IO driver. This is a
+   * collective call: every rank in @p comm must construct an H5ReadWrite
+   * for the same file. Afterwards, calls that modify the file structure
+   * (createGroup(), writeData(), setAttribute()...) and the readSlab()
+   * and writeSlab() calls are collective too, and every rank must make
+   * them in the same order. Each rank passes its own hyperslab to
+   * readSlab() and writeSlab().
+   * @param fileName the file to open.
+   * @param mode the mode to open the file with.
+   * @param comm the communicator of the ranks that share the file.
+   * @param options the tuning to use, such as
+   *                OpenOptions::parallelFilesystem().
+   */
+  H5ReadWrite(const std::string& fileName, OpenMode mode, MPI_Comm comm,
+              const OpenOptions& options = OpenOptions());
+#endif
+
   /** Closes the file and destroys the H5ReadWrite */
   ~H5ReadWrite();
 
@@ -37,7 +100,13 @@ public:
   /** Assignment operator is disabled */
   H5ReadWrite& operator=(const H5ReadWrite&) = delete;
 
-  /** Enumeration of the data types */
+  /**
+   * Enumeration of the data types. Float16 is h5::float16, and Complex64
+   * and Complex128 are std::complex<float> and std::complex<double>,
+   * stored as compounds of the members "r" and "i" as by h5py. Float16
+   * data sets may also be read as float with readData() and readSlab(),
+   * which widen the values after the read.
+   */
   enum class DataType {
     Int8,
     Int16,
@@ -49,7 +118,11 @@ public:
     UInt64,
     Float,
     Double,
+    Float16,
+    Complex64,
+    Complex128,
     String,
+    Compound,
     None = -1
   };
 
@@ -64,6 +137,22 @@ public:
   std::vector<std::string> children(const std::string& path,
                                     bool* ok = nullptr);
 
+  /**
+   * Open a data set and keep it open for repeated reads and writes.
+   * Include "h5dataset.h" to use the returned handle.
+   * @param path The path to the data set.
+   * @return A handle to the data set, which is invalid on failure.
+   */
+  DataSet openDataSet(const std::string& path);
+
+  /**
+   * Open a group and keep it open, so that children can be created and
+   * opened relative to it. Include "h5group.h" to use the returned handle.
+   * @param path The path to the group.
+   * @return A handle to the group, which is invalid on failure.
+   */
+  Group openGroup(const std::string& path);
+
   /**
    * Check if a given path has at least one attribute.
    * @param path The path to the attribute.
@@ -122,6 +211,48 @@ public:
    */
   DataType dataType(const std::string& path);
 
+  /**
+   * Get the names of the members of a compound data set.
+   * @param path The path to the data set.
+   * @param ok If used, set to true on success and false on failure.
+   * @return The names of the members, in the order they are stored.
+   */
+  std::vector<std::string> compoundMembers(const std::string& path,
+                                           bool* ok = nullptr);
+
+  /**
+   * Get the type of a member of a compound data set.
+   * @param path The path to the data set.
+   * @param member The name of the member.
+   * @return The type of the member, or DataType::None on failure or if
+   *         the member is not a basic type or a string.
+   */
+  DataType compoundMemberType(const std::string& path,
+                              const std::string& member);
+
+  /**
+   * Read selected members of a 1-dimensional compound data set into
+   * separate contiguous columns. Only the requested members are
+   * converted and copied. Include "h5compound.h" to make the columns.
+   * @param path The path to the data set.
+   * @param columns The members to read. Each data pointer must hold as
+   *                many elements as the data set has records, and each
+   *                type must match the type of the member.
+   * @return True on success, false on failure.
+   */
+  bool readColumns(const std::string& path,
+                   const std::vector<Column>& columns);
+
+  /**
+   * Read one member of a 1-dimensional compound data set as a column.
+   * @param path The path to the data set.
+   * @param member The name of the member.
+   * @return The column, or an empty vector on failure.
+   */
+  template <typename T>
+  std::vector<T> readColumn(const std::string& path,
+                            const std::string& member);
+
   /**
    * Get the number of dimensions of a data set.
    * @param path The path to the data set.
@@ -136,10 +267,27 @@ public:
    */
   std::vector<int> getDimensions(const std::string& path);
 
+  /**
+   * Get the storage layout of a data set.
+   * @param path The path to the data set.
+   * @return The layout, or WriteOptions::Layout::Automatic on failure.
+   */
+  WriteOptions::Layout storageLayout(const std::string& path);
+
+  /**
+   * Get the chunk dimensions of a data set.
+   * @param path The path to the data set.
+   * @return A vector of the chunk dimensions, or an empty vector if the
+   *         data set is not chunked or on failure.
+   */
+  std::vector<int> chunkDimensions(const std::string& path);
+
   /**
    * Read a 1-dimensional data set and interpret it as type T. If @p path
    * is not a data set, @p path is not a 1-dimensional data set, or T is
-   * not the correct type of the data set, an error will occur.
+   * not the correct type of the data set, an error will occur. T may be
+   * std::string for fixed and variable-length string data sets, which
+   * are copied out of a StringTable.
    * @param path The path to the data set.
    * @return A vector of the data, or an empty vector on failure.
    */
@@ -149,7 +297,7 @@ public:
   /**
    * Read a multi-dimensional data set and interpret it as type T. If
    * @p path is not a data set, or T is not the correct type of the
-   * data set, an error will occur.
+   * data set, an error will occur. T may be std::string.
    * @param path The path to the data set.
    * @param dimensions Will be set to the dimensions of the data set.
    * @return A vector of the data, or an empty vector on failure.
@@ -171,6 +319,30 @@ public:
   template <typename T>
   bool readData(const std::string& path, T* data);
 
+  /**
+   * Read a multi-dimensional data set into an NDArray and interpret it as
+   * type T. The array is reshaped to the dimensions of the data set, and
+   * its buffer is reused if it is large enough. A scalar data set is read
+   * as shape {1}. If T is not the correct type of the data set, an error
+   * will occur.
+   * @param path The path to the data set.
+   * @param array The array that will be set to the data.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool readData(const std::string& path, NDArray<T>& array);
+
+  /**
+   * Read a fixed or variable-length string data set into one block of
+   * memory, without an allocation per string. The shape of @p table is
+   * set to the dimensions of the data set, and its memory is reused if it
+   * is large enough.
+   * @param path The path to the data set.
+   * @param table The table that will be set to the strings.
+   * @return True on success, false on failure.
+   */
+  bool readData(const std::string& path, StringTable& table);
+
   /**
    * Read a multi-dimensional data set and itnerpret it as type @p type.
    * If @p path is not a data set, or @p type is not the correct type
@@ -185,17 +357,21 @@ public:
   bool readData(const std::string& path, const DataType& type, void* data);
 
   /**
-   * Write data to a specified path.
+   * Write data to a specified path. T may be std::string, in which case
+   * the strings are written as variable-length strings, or as fixed-length
+   * strings if WriteOptions::fixedLengthStrings is set.
    * @param path The path where the data will be written.
    * @param name The name of the data.
    * @param dimensions The dimensions of the data.
    * @param data The data to write.
+   * @param options Options such as the storage layout of the data set.
    * @return True on success, false on failure.
    */
   template <typename T>
   bool writeData(const std::string& path, const std::string& name,
                  const std::vector<int>& dimensions,
-                 const std::vector<T>& data);
+                 const std::vector<T>& data,
+                 const WriteOptions& options = WriteOptions());
 
   /**
    * Write data to a specified path.
@@ -203,11 +379,27 @@ public:
    * @param name The name of the data.
    * @param dimensions The dimensions of the data.
    * @param data The data to write.
+   * @param options Options such as the storage layout of the data set.
    * @return True on success, false on failure.
    */
   template <typename T>
   bool writeData(const std::string& path, const std::string& name,
-                 const std::vector<int>& dimensions, const T* data);
+                 const std::vector<int>& dimensions, const T* data,
+                 const WriteOptions& options = WriteOptions());
+
+  /**
+   * Write an NDArray to a specified path. The data set has the shape of
+   * the array.
+   * @param path The path where the data will be written.
+   * @param name The name of the data.
+   * @param array The data to write.
+   * @param options Options such as the storage layout of the data set.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool writeData(const std::string& path, const std::string& name,
+                 const NDArray<T>& array,
+                 const WriteOptions& options = WriteOptions());
 
   /**
    * Write data to a specified path.
@@ -216,11 +408,110 @@ public:
    * @param dimensions The dimensions of the data.
    * @param type The type of data to write.
    * @param data The data to write.
+   * @param options Options such as the storage layout of the data set.
    * @return True on success, false on failure.
    */
   bool writeData(const std::string& path, const std::string& name,
                  const std::vector<int>& dimensions,
-                 const DataType& type, const void* data);
+                 const DataType& type, const void* data,
+                 const WriteOptions& options = WriteOptions());
+
+  /**
+   * Write columns as the members of a new 1-dimensional compound data
+   * set, one record per element. Include "h5compound.h" to make the
+   * columns.
+   * @param path The path where the data will be written.
+   * @param name The name of the data set.
+   * @param length The number of records, which is the number of elements
+   *               in each column.
+   * @param columns The members to write, in order.
+   * @param options Options such as the storage layout of the data set.
+   * @return True on success, false on failure.
+   */
+  bool writeColumns(const std::string& path, const std::string& name,
+                    int length, const std::vector<ConstColumn>& columns,
+                    const WriteOptions& options = WriteOptions());
+
+  /**
+   * Overwrite a hyperslab of an existing data set in place. The rest of
+   * the data set is left untouched. The file must have been opened with
+   * a mode that allows writing, such as OpenMode::ReadWrite.
+   * @param path The path to the data set.
+   * @param start The offset of the hyperslab in each dimension.
+   * @param counts The size of the hyperslab in each dimension.
+   * @param data The data to write (size >= count1 * count2 * count3...).
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool writeSlab(const std::string& path, const std::vector<int>& start,
+                 const std::vector<int>& counts, const T* data);
+
+  /**
+   * Overwrite a hyperslab of an existing data set in place. The size of
+   * the hyperslab is the shape of @p array.
+   * @param path The path to the data set.
+   * @param start The offset of the hyperslab in each dimension.
+   * @param array The data to write.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool writeSlab(const std::string& path, const std::vector<int>& start,
+                 const NDArray<T>& array);
+
+  /**
+   * Overwrite a hyperslab of an existing data set in place.
+   * @param path The path to the data set.
+   * @param start The offset of the hyperslab in each dimension.
+   * @param counts The size of the hyperslab in each dimension.
+   * @param type The type of the data to write.
+   * @param data The data to write (size >= count1 * count2 * count3...).
+   * @return True on success, false on failure.
+   */
+  bool writeSlab(const std::string& path, const std::vector<int>& start,
+                 const std::vector<int>& counts, const DataType& type,
+                 const void* data);
+
+  /**
+   * Read a hyperslab of a data set and interpret it as type T. If T is
+   * not the correct type of the data set, an error will occur.
+   * @param path The path to the data set.
+   * @param start The offset of the hyperslab in each dimension.
+   * @param counts The size of the hyperslab in each dimension.
+   * @param data A pointer to a block of memory with a size large enough
+   *             to hold the hyperslab (size >= count1 * count2 * ...).
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool readSlab(const std::string& path, const std::vector<int>& start,
+                const std::vector<int>& counts, T* data);
+
+  /**
+   * Read a hyperslab of a data set into an NDArray and interpret it as
+   * type T. The array is reshaped to @p counts, and its buffer is reused
+   * if it is large enough.
+   * @param path The path to the data set.
+   * @param start The offset of the hyperslab in each dimension.
+   * @param counts The size of the hyperslab in each dimension.
+   * @param array The array that will be set to the hyperslab.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool readSlab(const std::string& path, const std::vector<int>& start,
+                const std::vector<int>& counts, NDArray<T>& array);
+
+  /**
+   * Read a hyperslab of a data set and interpret it as type @p type.
+   * @param path The path to the data set.
+   * @param start The offset of the hyperslab in each dimension.
+   * @param counts The size of the hyperslab in each dimension.
+   * @param type The type of the data set.
+   * @param data A pointer to a block of memory with a size large enough
+   *             to hold the hyperslab (size >= count1 * count2 * ...).
+   * @return True on success, false on failure.
+   */
+  bool readSlab(const std::string& path, const std::vector<int>& start,
+                const std::vector<int>& counts, const DataType& type,
+                void* data);
 
   /**
    * Set an attribute on a specified path.
@@ -239,7 +530,108 @@ public:
    */
   bool createGroup(const std::string& path);
 
+  /**
+   * Create a data set without writing to it, to be written later with
+   * writeSlab(), and keep it open. No data is written until then, so a
+   * data set of any size is created immediately. Use
+   * WriteOptions::allocation and WriteOptions::fillTime to control when
+   * its space is allocated and filled. Include "h5dataset.h" to use the
+   * returned handle.
+   * @param path The path of the group of the data set.
+   * @param name The name of the data set.
+   * @param dimensions The dimensions of the data set.
+   * @param type The type of the data set.
+   * @param options How to lay out the data set. quantizeBits cannot be
+   *                used, since there is no data to quantize.
+   * @return A handle to the data set, which is invalid on failure.
+   */
+  DataSet createDataSet(const std::string& path, const std::string& name,
+                        const std::vector<int>& dimensions,
+                        const DataType& type,
+                        const WriteOptions& options = WriteOptions());
+
+  /**
+   * Write all of the groups, data sets and attributes of a batch in one
+   * ordered pass. Nothing is written if any operation of the batch is
+   * invalid. Otherwise, the batch stops at the first operation that fails,
+   * and the operations before it remain in the file.
+   * @param batch The operations to write.
+   * @return True on success, false on failure.
+   */
+  bool commit(const BatchWrite& batch);
+
+  /**
+   * Create an empty, chunked data set that can grow along its first
+   * dimension. Each call to appendData() adds one frame to it.
+   * @param path The path where the data set will be created.
+   * @param name The name of the data set.
+   * @param frameDimensions The dimensions of a single frame.
+   * @param type The type of the data set.
+   * @return True on success, false on failure.
+   */
+  bool createAppendableDataSet(const std::string& path,
+                               const std::string& name,
+                               const std::vector<int>& frameDimensions,
+                               const DataType& type);
+
+  /**
+   * Append one frame to a data set created by createAppendableDataSet().
+   * The first dimension of the data set is extended by one. When SWMR
+   * writing has been started, the data set is flushed so that readers
+   * can see the new frame.
+   * @param path The path to the data set.
+   * @param data The frame to append. It must hold a full frame.
+   * @return True on success, false on failure.
+   */
+  template <typename T>
+  bool appendData(const std::string& path, const T* data);
+
+  /**
+   * Append one frame to a data set created by createAppendableDataSet().
+   * @param path The path to the data set.
+   * @param type The type of the data.
+   * @param data The frame to append. It must hold a full frame.
+   * @return True on success, false on failure.
+   */
+  bool appendData(const std::string& path, const DataType& type,
+                  const void* data);
+
+  /**
+   * Switch the file to single-writer/multiple-reader mode. The file must
+   * have been opened with OpenMode::SWMRWrite, and all groups, data sets
+   * and attributes must already have been created: only writing to and
+   * extending existing data sets is allowed afterwards.
+   * @return True on success, false on failure.
+   */
+  bool startSWMRWrite();
+
+  /**
+   * Flush all buffers associated with the file to disk.
+   * @return True on success, false on failure.
+   */
+  bool flush();
+
+  /**
+   * Refresh the metadata of a data set, so that changes made by an SWMR
+   * writer (such as new frames) become visible. Only meaningful for files
+   * opened with OpenMode::SWMRRead.
+   * @param path The path to the data set.
+   * @return True on success, false on failure.
+   */
+  bool refresh(const std::string& path);
+
 private:
+  friend class EmdReader;
+  friend class IOActor;
+  friend class OpenPMDReader;
+  friend std::vector<ObjectInfo> inspect(H5ReadWrite&, const std::string&,
+                                         const InspectOptions&, bool*);
+
+  // The open file and its transfer property list, for the readers that
+  // are built on H5ReadWrite. The file id is negative if it is not open.
+  int64_t fileId() const;
+  int64_t transferPropertyList() const;
+
   class H5ReadWriteImpl;
   std::unique_ptr<H5ReadWriteImpl> m_impl;
 };
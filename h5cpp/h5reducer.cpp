@@ -0,0 +1,522 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "h5reducer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+#include "h5capi.h"
+#include "h5dataset.h"
+#include "h5dispatch.h"
+#include "h5typemaps.h"
+#include "h5utils.h"
+#include "hidcloser.h"
+
+using std::cerr;
+using std::endl;
+
+using std::string;
+using std::vector;
+
+namespace h5 {
+
+using DataType = H5ReadWrite::DataType;
+
+namespace {
+
+struct ElementSizeVisitor
+{
+  size_t& size;
+
+  template <typename T>
+  void operator()(TypeTag<T>) const
+  {
+    size = sizeof(T);
+  }
+};
+
+size_t product(const vector<int>& dims, int skip = -1)
+{
+  size_t result = 1;
+  for (size_t i = 0; i < dims.size(); ++i) {
+    if (static_cast<int>(i) != skip)
+      result *= dims[i];
+  }
+  return result;
+}
+
+// Fold a block, one position along the axis at a time. The values at
+// each position are gathered in the order of the accumulators, which is
+// the order of the block without the axis.
+struct FoldVisitor
+{
+  const void* block;
+  const vector<int>& counts;
+  int axis;
+  double* values;
+  double* accumulators;
+  const Reducer::Fold& fold;
+
+  template <typename T>
+  void operator()(TypeTag<T>) const
+  {
+    const T* data = static_cast<const T*>(block);
+    size_t outer = 1;
+    for (int i = 0; i < axis; ++i)
+      outer *= counts[i];
+
+    const size_t length = counts[axis];
+    const size_t inner = product(counts) / (outer * length);
+    for (size_t k = 0; k < length; ++k) {
+      for (size_t o = 0; o < outer; ++o) {
+        const T* row = data + (o * length + k) * inner;
+        double* target = values + o * inner;
+        for (size_t i = 0; i < inner; ++i)
+          target[i] = static_cast<double>(row[i]);
+      }
+      fold(accumulators, values, outer * inner);
+    }
+  }
+};
+
+// Copy the accumulators of a tile into its place in the result
+void copyTile(const double* tile, const vector<int>& start,
+              const vector<int>& counts, NDArray<double>& result)
+{
+  const vector<int>& shape = result.shape();
+  const size_t rank = shape.size();
+
+  vector<size_t> strides(rank, 1);
+  for (size_t i = rank - 1; i > 0; --i)
+    strides[i - 1] = strides[i] * shape[i];
+
+  const size_t rowLength = counts[rank - 1];
+  const size_t rows = product(counts) / std::max<size_t>(rowLength, 1);
+  vector<int> index(rank, 0);
+  for (size_t row = 0; row < rows; ++row) {
+    size_t offset = start[rank - 1];
+    for (size_t i = 0; i + 1 < rank; ++i)
+      offset += (start[i] + index[i]) * strides[i];
+
+    std::copy(tile + row * rowLength, tile + (row + 1) * rowLength,
+              result.data() + offset);
+
+    for (size_t i = rank - 1; i-- > 0;) {
+      if (++index[i] < counts[i])
+        break;
+      index[i] = 0;
+    }
+  }
+}
+
+int threadCount(const ReduceOptions& options)
+{
+  if (options.threads > 0)
+    return options.threads;
+
+  return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+// The type that a data set is read as. Float16 data sets are widened to
+// float as they are read, and quantized data sets are restored as float.
+DataType readType(DataSet& dataSet)
+{
+  if (dataSet.type() == DataType::Float16 || dataSet.isQuantized())
+    return DataType::Float;
+
+  return dataSet.type();
+}
+
+} // end namespace
+
+class Reducer::ReducerImpl {
+public:
+  ReducerImpl(DataSet&& dataSet, const vector<int>& chunk)
+    : m_dataSet(std::move(dataSet)), m_chunk(chunk),
+      m_readType(readType(m_dataSet))
+  {
+    dispatch(m_readType, ElementSizeVisitor{ m_elementSize });
+
+    hid_t dataTypeId, memTypeId;
+    m_storedElementSize = h5TypeIds(m_dataSet.type(), dataTypeId, memTypeId)
+                            ? H5Tget_size(memTypeId)
+                            : m_elementSize;
+  }
+
+  const vector<int>& dims() const { return m_dataSet.dimensions(); }
+
+  // The memory that one thread uses for a block, its gathered values and
+  // the accumulators of its tile
+  size_t cost(const vector<int>& block, int axis) const
+  {
+    return product(block) * m_elementSize +
+           2 * product(block, axis) * sizeof(double);
+  }
+
+  size_t tileCount(const vector<int>& block, int axis) const
+  {
+    size_t count = 1;
+    for (size_t i = 0; i < block.size(); ++i) {
+      if (static_cast<int>(i) != axis)
+        count *= (dims()[i] + block[i] - 1) / block[i];
+    }
+    return count;
+  }
+
+  vector<int> blockShape(int axis, const ReduceOptions& options) const
+  {
+    const vector<int>& dims = this->dims();
+    const size_t rank = dims.size();
+    const int threads = threadCount(options);
+    const size_t budget = options.memoryBytes / threads;
+
+    // Start from one chunk, or from one row of a contiguous data set
+    vector<int> base = m_chunk;
+    if (base.size() != rank) {
+      base.assign(rank, 1);
+      base[rank - 1] = dims[rank - 1];
+    }
+
+    for (size_t i = 0; i < rank; ++i)
+      base[i] = std::max(1, std::min(base[i], dims[i]));
+
+    // Split a chunk that does not fit, outermost dimension first. Its
+    // parts are read through a chunk cache that holds a chunk per thread,
+    // so that each chunk is decompressed once, and the cache counts
+    // against the budget. If the chunk and a part do not both fit, whole
+    // chunks are read.
+    vector<int> block = base;
+    if (cost(base, axis) > budget) {
+      const size_t cacheBytes = chunkCacheBytes(1);
+      if (cacheBytes >= budget)
+        return base;
+
+      const size_t partBudget = budget - cacheBytes;
+      for (size_t i = 0; i < rank && cost(block, axis) > partBudget; ++i) {
+        while (block[i] > 1 && cost(block, axis) > partBudget)
+          block[i] = (block[i] + 1) / 2;
+      }
+
+      return cost(block, axis) <= partBudget ? block : base;
+    }
+
+    // Grow by whole chunks along the axis first, which makes the reads
+    // larger, then along the other dimensions from the innermost one,
+    // while there is a tile for every thread
+    vector<int> order(1, axis);
+    for (size_t i = rank; i-- > 0;) {
+      if (static_cast<int>(i) != axis)
+        order.push_back(static_cast<int>(i));
+    }
+
+    for (int i : order) {
+      while (block[i] < dims[i]) {
+        vector<int> candidate = block;
+        candidate[i] = std::min(dims[i], block[i] * 2);
+        if (cost(candidate, axis) > budget)
+          break;
+
+        if (i != axis &&
+            tileCount(candidate, axis) < static_cast<size_t>(threads)) {
+          break;
+        }
+
+        block = candidate;
+      }
+    }
+
+    return block;
+  }
+
+  // The bytes of a chunk cache that holds a chunk for each of @p threads,
+  // or 0 if the data set is contiguous
+  size_t chunkCacheBytes(int threads) const
+  {
+    if (m_chunk.size() != dims().size())
+      return 0;
+
+    return product(m_chunk) * m_storedElementSize * threads;
+  }
+
+  // Whether blocks of @p block split the chunks of the data set
+  bool splitsChunks(const vector<int>& block) const
+  {
+    if (m_chunk.size() != block.size())
+      return false;
+
+    for (size_t i = 0; i < block.size(); ++i) {
+      if (block[i] < std::min(m_chunk[i], dims()[i]))
+        return true;
+    }
+    return false;
+  }
+
+  // Open the data set again with a chunk cache of @p bytes, or return a
+  // negative value on failure
+  hid_t openWithChunkCache(size_t bytes, int threads)
+  {
+    HIDCloser accessCloser(H5Pcreate(H5P_DATASET_ACCESS), H5Pclose);
+    if (!accessCloser.valueIsValid())
+      return H5I_INVALID_HID;
+
+    // The HDF5 documentation recommends about 100 hash slots per chunk
+    // that fits in the cache
+    const size_t slots = 100 * static_cast<size_t>(threads) + 1;
+    if (H5Pset_chunk_cache(accessCloser.value(), slots, bytes,
+                           H5D_CHUNK_CACHE_W0_DEFAULT) < 0) {
+      return H5I_INVALID_HID;
+    }
+
+    return H5Dopen(m_dataSet.id(), ".", accessCloser.value());
+  }
+
+  bool reduce(int axis, double initial, const Fold& fold,
+              NDArray<double>& result, const ReduceOptions& options)
+  {
+    const vector<int>& dims = this->dims();
+    if (axis < 0 || axis >= static_cast<int>(dims.size())) {
+      cerr << "Axis " << axis << " is out of range for "
+           << m_dataSet.path() << endl;
+      return false;
+    }
+
+    vector<int> resultShape;
+    for (size_t i = 0; i < dims.size(); ++i) {
+      if (static_cast<int>(i) != axis)
+        resultShape.push_back(dims[i]);
+    }
+
+    // Reducing a 1-dimensional data set gives a single value
+    if (resultShape.empty())
+      resultShape.push_back(1);
+
+    result.resize(resultShape);
+    std::fill(result.data(), result.data() + result.size(), initial);
+    if (product(dims) == 0)
+      return true;
+
+    const vector<int> block = blockShape(axis, options);
+    const size_t tiles = tileCount(block, axis);
+    const int threads =
+      std::max(1, std::min(threadCount(options), static_cast<int>(tiles)));
+
+    hid_t dataTypeId, memTypeId;
+    if (!h5TypeIds(m_readType, dataTypeId, memTypeId))
+      return false;
+
+    // The parts of a chunk are read through a handle whose chunk cache
+    // holds the chunk of every thread
+    HIDCloser cachedCloser(H5I_INVALID_HID, H5Dclose);
+    if (splitsChunks(block)) {
+      cachedCloser = HIDCloser(
+        openWithChunkCache(chunkCacheBytes(threads), threads), H5Dclose);
+      if (!cachedCloser.valueIsValid()) {
+        cerr << "Failed to set the chunk cache of " << m_dataSet.path()
+             << endl;
+        return false;
+      }
+    }
+
+    const hid_t dataSetId = cachedCloser.valueIsValid()
+                              ? cachedCloser.value()
+                              : m_dataSet.id();
+    const hid_t transferId = m_dataSet.transferPropertyList();
+
+    std::atomic<size_t> next(0);
+    std::atomic<bool> success(true);
+    auto work = [&]() {
+      vector<unsigned char> buffer(product(block) * m_elementSize);
+      vector<double> values(product(block, axis));
+      vector<double> accumulators(values.size());
+
+      for (size_t tile = next++; tile < tiles && success; tile = next++) {
+        // The position of the tile, with the first dimension slowest
+        vector<int> start(dims.size(), 0);
+        vector<int> counts = block;
+        size_t remainder = tile;
+        for (size_t i = dims.size(); i-- > 0;) {
+          if (static_cast<int>(i) == axis)
+            continue;
+
+          size_t steps = (dims[i] + block[i] - 1) / block[i];
+          start[i] = static_cast<int>(remainder % steps) * block[i];
+          counts[i] = std::min(block[i], dims[i] - start[i]);
+          remainder /= steps;
+        }
+
+        std::fill(accumulators.begin(), accumulators.end(), initial);
+        for (int position = 0; position < dims[axis];
+             position += block[axis]) {
+          start[axis] = position;
+          counts[axis] = std::min(block[axis], dims[axis] - position);
+
+          bool read;
+          {
+            std::lock_guard<std::mutex> lock(m_readMutex);
+            vector<hsize_t> h5start(start.begin(), start.end());
+            vector<hsize_t> h5counts(counts.begin(), counts.end());
+            read = readHyperslab(dataSetId, h5start, h5counts, memTypeId,
+                                 transferId, buffer.data());
+          }
+
+          if (!read) {
+            success = false;
+            return;
+          }
+
+          dispatch(m_readType,
+                   FoldVisitor{ buffer.data(), counts, axis, values.data(),
+                                accumulators.data(), fold });
+        }
+
+        vector<int> tileStart, tileCounts;
+        for (size_t i = 0; i < dims.size(); ++i) {
+          if (static_cast<int>(i) != axis) {
+            tileStart.push_back(start[i]);
+            tileCounts.push_back(counts[i]);
+          }
+        }
+
+        if (tileStart.empty()) {
+          tileStart.push_back(0);
+          tileCounts.push_back(1);
+        }
+
+        // Tiles do not overlap, so they are written without a lock
+        copyTile(accumulators.data(), tileStart, tileCounts, result);
+      }
+    };
+
+    vector<std::thread> pool;
+    for (int i = 1; i < threads; ++i)
+      pool.emplace_back(work);
+
+    work();
+
+    for (auto& thread : pool)
+      thread.join();
+
+    return success;
+  }
+
+  DataSet m_dataSet;
+  vector<int> m_chunk;
+  DataType m_readType;
+  // The sizes of an element in memory, and in the chunks of the file
+  size_t m_elementSize = 0;
+  size_t m_storedElementSize = 0;
+
+  // A data set handle is not safe to read from several threads at once
+  std::mutex m_readMutex;
+};
+
+Reducer::Reducer(H5ReadWrite& file, const string& path)
+{
+  DataSet dataSet = file.openDataSet(path);
+  if (!dataSet.isValid())
+    return;
+
+  size_t elementSize = 0;
+  if (!dispatch(readType(dataSet), ElementSizeVisitor{ elementSize })) {
+    cerr << path << " does not hold a basic type\n";
+    return;
+  }
+
+  if (dataSet.dimensionCount() < 1) {
+    cerr << path << " has no dimensions\n";
+    return;
+  }
+
+  vector<int> chunk = file.chunkDimensions(path);
+  m_impl.reset(new ReducerImpl(std::move(dataSet), chunk));
+}
+
+Reducer::~Reducer() = default;
+
+bool Reducer::isValid() const
+{
+  return m_impl != nullptr;
+}
+
+const vector<int>& Reducer::dimensions() const
+{
+  static const vector<int> empty;
+  return m_impl ? m_impl->dims() : empty;
+}
+
+vector<int> Reducer::blockShape(int axis, const ReduceOptions& options) const
+{
+  if (!m_impl || axis < 0 || axis >= static_cast<int>(dimensions().size()))
+    return vector<int>();
+
+  return m_impl->blockShape(axis, options);
+}
+
+bool Reducer::reduce(int axis, Operation operation, NDArray<double>& result,
+                     const ReduceOptions& options)
+{
+  if (!isValid()) {
+    cerr << "Reducer is not valid\n";
+    return false;
+  }
+
+  double initial = 0;
+  Fold fold;
+  switch (operation) {
+    case Operation::Sum:
+    case Operation::Mean:
+      fold = [](double* accumulators, const double* values, size_t count) {
+        for (size_t i = 0; i < count; ++i)
+          accumulators[i] += values[i];
+      };
+      break;
+    case Operation::Min:
+      initial = std::numeric_limits<double>::infinity();
+      fold = [](double* accumulators, const double* values, size_t count) {
+        for (size_t i = 0; i < count; ++i)
+          accumulators[i] = std::min(accumulators[i], values[i]);
+      };
+      break;
+    case Operation::Max:
+      initial = -std::numeric_limits<double>::infinity();
+      fold = [](double* accumulators, const double* values, size_t count) {
+        for (size_t i = 0; i < count; ++i)
+          accumulators[i] = std::max(accumulators[i], values[i]);
+      };
+      break;
+  }
+
+  if (!m_impl->reduce(axis, initial, fold, result, options))
+    return false;
+
+  if (operation == Operation::Mean) {
+    const double length = dimensions()[axis];
+    for (size_t i = 0; i < result.size(); ++i)
+      result.data()[i] /= length;
+  }
+
+  return true;
+}
+
+bool Reducer::reduce(int axis, double initial, const Fold& fold,
+                     NDArray<double>& result, const ReduceOptions& options)
+{
+  if (!isValid()) {
+    cerr << "Reducer is not valid\n";
+    return false;
+  }
+
+  if (!fold) {
+    cerr << "The fold is empty\n";
+    return false;
+  }
+
+  return m_impl->reduce(axis, initial, fold, result, options);
+}
+
+} // namespace h5
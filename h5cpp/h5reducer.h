@@ -0,0 +1,122 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5Reducer_h
+#define tomvizH5Reducer_h
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "h5ndarray.h"
+#include "h5readwrite.h"
+
+namespace h5 {
+
+/** How Reducer walks a data set */
+struct ReduceOptions
+{
+  /**
+   * The most memory, in bytes, that the blocks, accumulators and chunk
+   * caches of all threads may use at once. The result is not included.
+   */
+  size_t memoryBytes = 256 * 1024 * 1024;
+
+  /** The number of threads, or 0 to use one per core */
+  int threads = 0;
+};
+
+/**
+ * Reduces a data set along an axis without reading all of it into
+ * memory, such as to sum or project a volume that is larger than RAM.
+ *
+ * The result is split into tiles, and the data set is walked in blocks
+ * that are aligned to its chunks: each tile folds the blocks of its
+ * column along the axis, in order, into its own accumulators. The tiles
+ * are reduced in parallel on a pool of threads, and the block size is
+ * chosen so that the memory used stays within ReduceOptions::memoryBytes.
+ * HDF5 serializes the reads, while the folding runs in parallel.
+ */
+class Reducer
+{
+public:
+  using DataType = H5ReadWrite::DataType;
+
+  /** The built-in reductions */
+  enum class Operation {
+    Sum,
+    Mean,
+    Min,
+    Max
+  };
+
+  /**
+   * Folds @p count values into as many accumulators, element by element,
+   * as accumulators[i] = f(accumulators[i], values[i]). It is called from
+   * several threads at once, on different accumulators.
+   */
+  using Fold = std::function<void(double* accumulators, const double* values,
+                                  size_t count)>;
+
+  /**
+   * Open a data set for reduction.
+   * @param file The file of the data set.
+   * @param path The path to the data set. It must have a basic type, or
+   *             be Float16 or quantized, which are read as float.
+   */
+  Reducer(H5ReadWrite& file, const std::string& path);
+
+  /** Closes the data set */
+  ~Reducer();
+
+  /** Copy constructor is disabled */
+  Reducer(const Reducer&) = delete;
+
+  /** Assignment operator is disabled */
+  Reducer& operator=(const Reducer&) = delete;
+
+  /** Whether the data set was opened successfully */
+  bool isValid() const;
+
+  /** The dimensions of the data set */
+  const std::vector<int>& dimensions() const;
+
+  /**
+   * The shape of the blocks that a reduction along @p axis reads with
+   * @p options.
+   */
+  std::vector<int> blockShape(
+    int axis, const ReduceOptions& options = ReduceOptions()) const;
+
+  /**
+   * Reduce the data set along @p axis with a built-in operation.
+   * @param axis The dimension to reduce.
+   * @param operation The reduction.
+   * @param result Set to the reduction. Its shape is the dimensions of
+   *               the data set without @p axis.
+   * @param options The memory bound and number of threads.
+   * @return True on success, false on failure.
+   */
+  bool reduce(int axis, Operation operation, NDArray<double>& result,
+              const ReduceOptions& options = ReduceOptions());
+
+  /**
+   * Reduce the data set along @p axis with a custom fold. Each element of
+   * the result starts at @p initial, and the values along the axis are
+   * folded into it in order.
+   * @return True on success, false on failure.
+   */
+  bool reduce(int axis, double initial, const Fold& fold,
+              NDArray<double>& result,
+              const ReduceOptions& options = ReduceOptions());
+
+private:
+  class ReducerImpl;
+  std::unique_ptr<ReducerImpl> m_impl;
+};
+
+} // namespace h5
+
+#endif // tomvizH5Reducer_h
@@ -0,0 +1,271 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "h5slabcache.h"
+
+#include <cstring>
+#include <tuple>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+using std::string;
+using std::vector;
+
+namespace h5 {
+
+namespace {
+
+// Whether the box of @p outer holds the box of @p inner
+bool contains(const SlabCache::Key& outer, const SlabCache::Key& inner)
+{
+  if (outer.counts.size() != inner.counts.size())
+    return false;
+
+  for (size_t i = 0; i < inner.counts.size(); ++i) {
+    if (inner.start[i] < outer.start[i] ||
+        inner.start[i] + inner.counts[i] > outer.start[i] + outer.counts[i])
+      return false;
+  }
+
+  return true;
+}
+
+// Copy the box of @p box out of the data of the larger box @p source, one
+// row of the last dimension at a time
+void copyBox(const SlabCache::Key& source, const unsigned char* sourceData,
+             const SlabCache::Key& box, size_t elementSize,
+             unsigned char* data)
+{
+  const size_t rank = box.counts.size();
+  if (rank == 0) {
+    std::memcpy(data, sourceData, elementSize);
+    return;
+  }
+
+  // The strides of the source, in elements
+  vector<uint64_t> strides(rank, 1);
+  for (size_t i = rank - 1; i > 0; --i)
+    strides[i - 1] = strides[i] * source.counts[i];
+
+  size_t rows = 1;
+  for (size_t i = 0; i + 1 < rank; ++i)
+    rows *= box.counts[i];
+
+  const size_t rowBytes = box.counts[rank - 1] * elementSize;
+  vector<uint64_t> index(rank, 0);
+  for (size_t row = 0; row < rows; ++row) {
+    uint64_t offset = 0;
+    for (size_t i = 0; i < rank; ++i)
+      offset += (box.start[i] - source.start[i] + index[i]) * strides[i];
+
+    std::memcpy(data, sourceData + offset * elementSize, rowBytes);
+    data += rowBytes;
+
+    for (size_t i = rank - 1; i > 0; --i) {
+      if (++index[i - 1] < box.counts[i - 1])
+        break;
+      index[i - 1] = 0;
+    }
+  }
+}
+
+} // end namespace
+
+bool SlabCache::Key::operator<(const Key& other) const
+{
+  return std::tie(file, path, type, start, counts) <
+         std::tie(other.file, other.path, other.type, other.start,
+                  other.counts);
+}
+
+SlabCache& SlabCache::instance()
+{
+  static SlabCache cache;
+  return cache;
+}
+
+void SlabCache::setCapacity(size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_capacity = bytes;
+  evict(0);
+}
+
+size_t SlabCache::capacity() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_capacity;
+}
+
+bool SlabCache::enabled() const
+{
+  return capacity() > 0;
+}
+
+SlabCache::Statistics SlabCache::statistics() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_statistics;
+}
+
+void SlabCache::resetStatistics()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Statistics usage;
+  usage.entries = m_statistics.entries;
+  usage.bytes = m_statistics.bytes;
+  m_statistics = usage;
+}
+
+void SlabCache::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.clear();
+  m_index.clear();
+  m_statistics.entries = 0;
+  m_statistics.bytes = 0;
+}
+
+bool SlabCache::identify(const string& fileName, string& identity,
+                         Version& version)
+{
+  struct stat info;
+  if (stat(fileName.c_str(), &info) != 0)
+    return false;
+
+  // Several paths may lead to the same file. Where there are no inodes,
+  // fall back to the path.
+  if (info.st_ino != 0) {
+    identity = std::to_string(static_cast<long long>(info.st_dev)) + ":" +
+               std::to_string(static_cast<long long>(info.st_ino));
+  } else {
+    identity = fileName;
+  }
+
+  version.modified = static_cast<long long>(info.st_mtime) * 1000000000LL;
+#ifdef __linux__
+  version.modified += info.st_mtim.tv_nsec;
+#endif
+  version.size = static_cast<long long>(info.st_size);
+  return true;
+}
+
+bool SlabCache::lookup(const Key& key, const Version& version,
+                       size_t elementSize, void* data)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  // The entries of a file all have the version it had when they were
+  // read, so the first one tells whether the file changed since
+  Key first;
+  first.file = key.file;
+  auto it = m_index.lower_bound(first);
+  if (it != m_index.end() && it->first.file == key.file &&
+      !(it->second->version == version)) {
+    invalidate(key.file);
+  }
+
+  it = find(key);
+  if (it == m_index.end()) {
+    ++m_statistics.misses;
+    return false;
+  }
+
+  Entry& entry = *it->second;
+
+  // Move it to the front, as the most recently used
+  m_entries.splice(m_entries.begin(), m_entries, it->second);
+  if (entry.key.start == key.start && entry.key.counts == key.counts) {
+    if (!entry.data.empty())
+      std::memcpy(data, entry.data.data(), entry.data.size());
+  } else {
+    copyBox(entry.key, entry.data.data(), key, elementSize,
+            static_cast<unsigned char*>(data));
+  }
+
+  ++m_statistics.hits;
+  return true;
+}
+
+void SlabCache::insert(const Key& key, const Version& version,
+                       const void* data, size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (bytes > m_capacity)
+    return;
+
+  auto it = m_index.find(key);
+  if (it != m_index.end())
+    erase(it);
+
+  evict(bytes);
+
+  Entry entry;
+  entry.key = key;
+  entry.version = version;
+  const unsigned char* begin = static_cast<const unsigned char*>(data);
+  entry.data.assign(begin, begin + bytes);
+
+  m_entries.push_front(std::move(entry));
+  m_index.emplace(key, m_entries.begin());
+  ++m_statistics.entries;
+  m_statistics.bytes += bytes;
+}
+
+// The entry of @p key, or else of a box that holds it. The boxes of a
+// data set are contiguous in the index, since they are ordered by file,
+// path and type first.
+SlabCache::Index::iterator SlabCache::find(const Key& key)
+{
+  auto it = m_index.find(key);
+  if (it != m_index.end())
+    return it;
+
+  Key first;
+  first.file = key.file;
+  first.path = key.path;
+  first.type = key.type;
+  for (it = m_index.lower_bound(first);
+       it != m_index.end() && it->first.file == key.file &&
+       it->first.path == key.path && it->first.type == key.type;
+       ++it) {
+    if (contains(it->first, key))
+      return it;
+  }
+
+  return m_index.end();
+}
+
+void SlabCache::erase(Index::iterator it)
+{
+  m_statistics.bytes -= it->second->data.size();
+  --m_statistics.entries;
+  m_entries.erase(it->second);
+  m_index.erase(it);
+}
+
+// Evict the least recently used entries until @p bytes more fit
+void SlabCache::evict(size_t bytes)
+{
+  while (!m_entries.empty() && m_statistics.bytes + bytes > m_capacity) {
+    erase(m_index.find(m_entries.back().key));
+    ++m_statistics.evictions;
+  }
+}
+
+// Drop every entry of a file. The keys of a file are contiguous in the
+// index, since they are ordered by file first.
+void SlabCache::invalidate(const string& file)
+{
+  Key first;
+  first.file = file;
+  auto it = m_index.lower_bound(first);
+  while (it != m_index.end() && it->first.file == file) {
+    auto current = it++;
+    erase(current);
+    ++m_statistics.invalidations;
+  }
+}
+
+} // namespace h5
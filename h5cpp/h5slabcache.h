@@ -0,0 +1,151 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5SlabCache_h
+#define tomvizH5SlabCache_h
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace h5 {
+
+/**
+ * A process-wide cache of decoded data, shared by every reader of a file
+ * that is opened read-only: H5ReadWrite, DataSet, and the readers built
+ * on them. Whole data sets and hyperslabs are kept after they are read
+ * and decompressed, so reading them again, or any region inside them,
+ * copies it from memory.
+ *
+ * The cache is disabled until it is given a capacity:
+ *
+ *   h5::SlabCache::instance().setCapacity(512 * 1024 * 1024);
+ *
+ * The least recently used entries are evicted when the capacity would be
+ * exceeded. Files are identified by device and inode, and the entries of
+ * a file are dropped when its modification time or size changes.
+ */
+class SlabCache
+{
+public:
+  /** Counters since the last resetStatistics(), and the current usage */
+  struct Statistics
+  {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t invalidations = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+  };
+
+  /**
+   * The identity of a box of a data set in a file, read as a type. A
+   * whole data set is the box of its extent.
+   */
+  struct Key
+  {
+    std::string file;
+    std::string path;
+    int type = -1;
+    std::vector<uint64_t> start;
+    std::vector<uint64_t> counts;
+
+    bool operator<(const Key& other) const;
+  };
+
+  /** The version of a file's contents, from its modification time */
+  struct Version
+  {
+    long long modified = 0;
+    long long size = 0;
+
+    bool operator==(const Version& other) const
+    {
+      return modified == other.modified && size == other.size;
+    }
+  };
+
+  /** The cache of the process */
+  static SlabCache& instance();
+
+  /**
+   * Set the memory budget in bytes. Entries are evicted until they fit.
+   * A capacity of 0, the default, disables the cache and empties it.
+   */
+  void setCapacity(size_t bytes);
+
+  /** The memory budget in bytes */
+  size_t capacity() const;
+
+  /** Whether the cache has a capacity */
+  bool enabled() const;
+
+  /** The hit, miss, eviction and invalidation counters, and the usage */
+  Statistics statistics() const;
+
+  /** Reset the counters */
+  void resetStatistics();
+
+  /** Remove every entry */
+  void clear();
+
+  /**
+   * Identify a file for the keys of the cache, and get the version of its
+   * contents.
+   * @return True on success, false if the file cannot be found.
+   */
+  static bool identify(const std::string& fileName, std::string& identity,
+                       Version& version);
+
+  /**
+   * Copy the data of the box @p key into @p data, if it is cached with
+   * @p version, or lies inside a box that is. Cached entries of an older
+   * version of the file are dropped.
+   * @param elementSize The size in bytes of an element of the type.
+   * @return True on a hit, false on a miss.
+   */
+  bool lookup(const Key& key, const Version& version, size_t elementSize,
+              void* data);
+
+  /**
+   * Cache a copy of @p bytes bytes of @p data for @p key. Data that is
+   * larger than the capacity is not cached.
+   */
+  void insert(const Key& key, const Version& version, const void* data,
+              size_t bytes);
+
+private:
+  SlabCache() = default;
+
+  struct Entry
+  {
+    Key key;
+    Version version;
+    std::vector<unsigned char> data;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  using Index = std::map<Key, EntryList::iterator>;
+
+  Index::iterator find(const Key& key);
+  void erase(Index::iterator it);
+  void evict(size_t bytes);
+  void invalidate(const std::string& file);
+
+  mutable std::mutex m_mutex;
+  size_t m_capacity = 0;
+  // Most recently used first
+  EntryList m_entries;
+  Index m_index;
+  Statistics m_statistics;
+};
+
+} // namespace h5
+
+#endif // tomvizH5SlabCache_h
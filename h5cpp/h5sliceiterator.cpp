@@ -0,0 +1,292 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "h5sliceiterator.h"
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <thread>
+
+#include "h5capi.h"
+#include "h5dataset.h"
+#include "h5dispatch.h"
+#include "h5utils.h"
+#include "h5wait.h"
+
+using std::cerr;
+using std::endl;
+
+using std::string;
+using std::vector;
+
+namespace h5 {
+
+template <typename T>
+class SliceIterator<T>::SliceIteratorImpl {
+public:
+  SliceIteratorImpl(DataSet&& dataSet, int axis, int prefetch)
+    : m_dataSet(std::move(dataSet)), m_axis(axis),
+      m_slots(std::max(prefetch, 1) + 1)
+  {
+    const vector<int>& dims = m_dataSet.dimensions();
+    m_count = dims[axis];
+    for (size_t i = 0; i < dims.size(); ++i) {
+      if (static_cast<int>(i) != axis)
+        m_sliceShape.push_back(dims[i]);
+    }
+
+    // A slice of a 1-dimensional data set is a single value
+    if (m_sliceShape.empty())
+      m_sliceShape.push_back(1);
+
+    for (size_t i = 0; i < m_slots.size(); ++i)
+      m_free.push_back(static_cast<int>(i));
+
+#ifdef H5_HAVE_THREADSAFE
+    m_worker = std::thread(&SliceIteratorImpl::run, this);
+#endif
+  }
+
+  ~SliceIteratorImpl()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_changed.notify_all();
+
+    if (m_worker.joinable())
+      m_worker.join();
+  }
+
+  bool readSlice(int index, NDArray<T>& array)
+  {
+    vector<int> start(m_dataSet.dimensionCount(), 0);
+    vector<int> counts = m_dataSet.dimensions();
+    start[m_axis] = index;
+    counts[m_axis] = 1;
+
+    array.resize(m_sliceShape);
+    return m_dataSet.readSlab(start, counts, array.data());
+  }
+
+  // The background thread: fill free slots with the upcoming slices
+  void run()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+      waitUntil(m_changed, lock, [this]() {
+        return m_stop || (!m_free.empty() && m_nextRead < m_count);
+      });
+
+      if (m_stop)
+        return;
+
+      int slot = m_free.back();
+      m_free.pop_back();
+      int index = m_nextRead++;
+      unsigned generation = m_generation;
+
+      // Only this thread touches a slot between taking it and queueing it
+      lock.unlock();
+      bool ok = readSlice(index, m_slots[slot].array);
+      lock.lock();
+
+      // The consumer moved elsewhere with seek() during the read
+      if (generation != m_generation) {
+        m_free.push_back(slot);
+        continue;
+      }
+
+      m_slots[slot].index = index;
+      m_slots[slot].ok = ok;
+      m_ready.push_back(slot);
+      m_changed.notify_all();
+    }
+  }
+
+  bool next()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // The current slice goes back to the background thread
+    if (m_current >= 0) {
+      m_free.push_back(m_current);
+      m_current = -1;
+      m_changed.notify_all();
+    }
+
+    if (m_nextIndex >= m_count)
+      return false;
+
+    if (!m_worker.joinable()) {
+      // Without a thread-safe HDF5, read in the calling thread
+      int slot = m_free.back();
+      m_free.pop_back();
+      m_slots[slot].index = m_nextIndex;
+      m_slots[slot].ok = readSlice(m_nextIndex, m_slots[slot].array);
+      m_ready.push_back(slot);
+    }
+
+    waitUntil(m_changed, lock, [this]() { return !m_ready.empty(); });
+
+    m_current = m_ready.front();
+    m_ready.pop_front();
+    m_nextIndex = m_slots[m_current].index + 1;
+    return m_slots[m_current].ok;
+  }
+
+  bool seek(int index)
+  {
+    if (index < 0 || index >= m_count) {
+      cerr << "Slice " << index << " is out of range\n";
+      return false;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      ++m_generation;
+      m_free.insert(m_free.end(), m_ready.begin(), m_ready.end());
+      m_ready.clear();
+      m_nextRead = index;
+      m_nextIndex = index;
+    }
+    m_changed.notify_all();
+    return true;
+  }
+
+  struct Slot
+  {
+    NDArray<T> array;
+    int index = -1;
+    bool ok = false;
+  };
+
+  DataSet m_dataSet;
+  int m_axis;
+  int m_count = 0;
+  vector<int> m_sliceShape;
+
+  // Every slot is either free, being read, ready, or the current slice
+  vector<Slot> m_slots;
+  vector<int> m_free;
+  std::deque<int> m_ready;
+  int m_current = -1;
+
+  // The next slice to read, and the next slice the consumer expects
+  int m_nextRead = 0;
+  int m_nextIndex = 0;
+
+  // Incremented by seek(), to discard the reads that were in flight
+  unsigned m_generation = 0;
+  bool m_stop = false;
+
+  std::mutex m_mutex;
+  std::condition_variable m_changed;
+  std::thread m_worker;
+};
+
+template <typename T>
+SliceIterator<T>::SliceIterator(H5ReadWrite& file, const string& path,
+                                int axis, int prefetch)
+{
+  DataSet dataSet = file.openDataSet(path);
+  if (!dataSet.isValid())
+    return;
+
+  // Float16 data sets are widened, and quantized data sets are restored,
+  // when they are read as float
+  const bool restored = DataTypeOf<T>::value == H5ReadWrite::DataType::Float &&
+                        dataSet.isQuantized();
+  if (!readableAs(dataSet.type(), DataTypeOf<T>::value) && !restored) {
+    cerr << "Type mismatch: " << path << " holds "
+         << H5ReadWrite::dataTypeToString(dataSet.type()) << ", not "
+         << H5ReadWrite::dataTypeToString(DataTypeOf<T>::value) << endl;
+    return;
+  }
+
+  if (axis < 0 || axis >= dataSet.dimensionCount()) {
+    cerr << "Axis " << axis << " is out of range for " << path << endl;
+    return;
+  }
+
+  m_impl.reset(new SliceIteratorImpl(std::move(dataSet), axis, prefetch));
+}
+
+template <typename T>
+SliceIterator<T>::~SliceIterator() = default;
+
+template <typename T>
+bool SliceIterator<T>::isValid() const
+{
+  return m_impl != nullptr;
+}
+
+template <typename T>
+int SliceIterator<T>::count() const
+{
+  return m_impl ? m_impl->m_count : 0;
+}
+
+template <typename T>
+int SliceIterator<T>::index() const
+{
+  if (!m_impl)
+    return -1;
+
+  std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+  int current = m_impl->m_current;
+  return current >= 0 ? m_impl->m_slots[current].index : -1;
+}
+
+template <typename T>
+const vector<int>& SliceIterator<T>::sliceShape() const
+{
+  static const vector<int> empty;
+  return m_impl ? m_impl->m_sliceShape : empty;
+}
+
+template <typename T>
+bool SliceIterator<T>::next()
+{
+  if (!m_impl) {
+    cerr << "Slice iterator is not valid\n";
+    return false;
+  }
+
+  return m_impl->next();
+}
+
+template <typename T>
+const NDArray<T>& SliceIterator<T>::slice() const
+{
+  static const NDArray<T> empty;
+  if (!m_impl)
+    return empty;
+
+  // Only the consumer changes the current slot, so no lock is needed
+  int current = m_impl->m_current;
+  return current >= 0 ? m_impl->m_slots[current].array : empty;
+}
+
+template <typename T>
+bool SliceIterator<T>::seek(int index)
+{
+  if (!m_impl) {
+    cerr << "Slice iterator is not valid\n";
+    return false;
+  }
+
+  return m_impl->seek(index);
+}
+
+// Instantiate our allowable templates here
+#define INSTANTIATE_SLICEITERATOR_TEMPLATES(T, E)                             \
+  template class SliceIterator<T>;
+
+H5CPP_FOR_EACH_BASIC_TYPE(INSTANTIATE_SLICEITERATOR_TEMPLATES)
+
+#undef INSTANTIATE_SLICEITERATOR_TEMPLATES
+
+} // namespace h5
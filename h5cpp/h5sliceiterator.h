@@ -0,0 +1,91 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5SliceIterator_h
+#define tomvizH5SliceIterator_h
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "h5ndarray.h"
+#include "h5readwrite.h"
+
+namespace h5 {
+
+/**
+ * Walks through a data set one slice at a time along an axis. A
+ * background thread reads the upcoming slices ahead of the consumer, so
+ * that the disk and decompression time of a slice overlaps with the
+ * processing of the previous ones:
+ *
+ *   SliceIterator<float> slices(file, "/data/tomography/data", 0);
+ *   while (slices.next())
+ *     process(slices.slice());
+ *
+ * The slice returned by slice() stays valid until the next call to
+ * next() or seek(), and the background thread never writes to it. T must
+ * be the type of the data set, or float for a Float16 or quantized data
+ * set. If HDF5 was not built thread-safe, the slices are read
+ * synchronously in next().
+ */
+template <typename T>
+class SliceIterator
+{
+public:
+  /**
+   * Open a data set for iteration. The first slice is read right away.
+   * @param file The file of the data set.
+   * @param path The path to the data set.
+   * @param axis The dimension to step along.
+   * @param prefetch The number of slices to keep read ahead of the
+   *                 current one. At least one is used.
+   */
+  SliceIterator(H5ReadWrite& file, const std::string& path, int axis,
+                int prefetch = 2);
+
+  /** Stops the background thread */
+  ~SliceIterator();
+
+  /** Copy constructor is disabled */
+  SliceIterator(const SliceIterator&) = delete;
+
+  /** Assignment operator is disabled */
+  SliceIterator& operator=(const SliceIterator&) = delete;
+
+  /** Whether the data set was opened successfully */
+  bool isValid() const;
+
+  /** The number of slices along the axis */
+  int count() const;
+
+  /** The index of the current slice, or -1 before the first next() */
+  int index() const;
+
+  /** The shape of a slice: the dimensions of the data set without the axis */
+  const std::vector<int>& sliceShape() const;
+
+  /**
+   * Move to the next slice, waiting for it if it is not read yet.
+   * @return True on success, false at the end or if the read failed.
+   */
+  bool next();
+
+  /** The current slice. It is empty before the first next(). */
+  const NDArray<T>& slice() const;
+
+  /**
+   * Restart the iteration, so that the next call to next() moves to
+   * slice @p index. The slices read ahead are discarded.
+   * @return True on success, false if @p index is out of range.
+   */
+  bool seek(int index);
+
+private:
+  class SliceIteratorImpl;
+  std::unique_ptr<SliceIteratorImpl> m_impl;
+};
+
+} // namespace h5
+
+#endif // tomvizH5SliceIterator_h
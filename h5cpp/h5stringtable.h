@@ -0,0 +1,79 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5StringTable_h
+#define tomvizH5StringTable_h
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace h5 {
+
+/**
+ * The strings of a data set, stored back to back in one block of memory
+ * rather than allocated one by one. Each string is followed by a NUL, so
+ * that data() can be used as a C string, and its length is known without
+ * a scan. The strings are in row-major order of shape().
+ */
+class StringTable
+{
+public:
+  /** The number of strings */
+  size_t size() const { return m_offsets.size() - 1; }
+
+  bool empty() const { return size() == 0; }
+
+  /** The dimensions of the data set that the strings were read from */
+  const std::vector<int>& shape() const { return m_shape; }
+
+  /** The NUL-terminated string at @p i */
+  const char* data(size_t i) const { return m_bytes.data() + m_offsets[i]; }
+
+  /** The length of the string at @p i, without its NUL */
+  size_t length(size_t i) const
+  {
+    return m_offsets[i + 1] - m_offsets[i] - 1;
+  }
+
+  /** A copy of the string at @p i */
+  std::string string(size_t i) const
+  {
+    return std::string(data(i), length(i));
+  }
+
+  /** Remove the strings, and keep the memory for the next read */
+  void clear()
+  {
+    m_bytes.clear();
+    m_offsets.assign(1, 0);
+    m_shape.clear();
+  }
+
+  /** Reserve room for @p count strings of @p bytes in total */
+  void reserve(size_t count, size_t bytes)
+  {
+    m_offsets.reserve(count + 1);
+    m_bytes.reserve(bytes + count);
+  }
+
+  /** Add a copy of the @p length characters at @p value */
+  void append(const char* value, size_t length)
+  {
+    m_bytes.insert(m_bytes.end(), value, value + length);
+    m_bytes.push_back('\0');
+    m_offsets.push_back(m_bytes.size());
+  }
+
+  void setShape(const std::vector<int>& shape) { m_shape = shape; }
+
+private:
+  std::vector<char> m_bytes;
+  // The start of each string, and one past the NUL of the last one
+  std::vector<size_t> m_offsets = std::vector<size_t>(1, 0);
+  std::vector<int> m_shape;
+};
+
+} // namespace h5
+
+#endif // tomvizH5StringTable_h
@@ -0,0 +1,225 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "h5trace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+using std::cerr;
+using std::endl;
+
+using std::string;
+using std::vector;
+
+using Clock = std::chrono::steady_clock;
+
+namespace h5 {
+
+namespace {
+
+int64_t clockNanoseconds()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           Clock::now().time_since_epoch())
+    .count();
+}
+
+int processId()
+{
+#ifdef _WIN32
+  return _getpid();
+#else
+  return static_cast<int>(getpid());
+#endif
+}
+
+void writeQuoted(std::ostream& stream, const string& value)
+{
+  stream << '"';
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      stream << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[8];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      stream << escaped;
+    } else {
+      stream << c;
+    }
+  }
+  stream << '"';
+}
+
+// Microseconds, which is the unit of Chrome traces, from nanoseconds
+void writeMicroseconds(std::ostream& stream, int64_t nanoseconds)
+{
+  char text[32];
+  std::snprintf(text, sizeof(text), "%lld.%03lld",
+                static_cast<long long>(nanoseconds / 1000),
+                static_cast<long long>(nanoseconds % 1000));
+  stream << text;
+}
+
+// The file to write at exit when H5CPP_TRACE is set
+string environmentFileName;
+
+void writeEnvironmentTrace()
+{
+  Tracer& tracer = Tracer::instance();
+  tracer.stop();
+  if (!tracer.write(environmentFileName))
+    cerr << "Failed to write the trace to " << environmentFileName << endl;
+}
+
+struct EnvironmentTrace
+{
+  EnvironmentTrace()
+  {
+    const char* fileName = std::getenv("H5CPP_TRACE");
+    if (fileName == nullptr || fileName[0] == '\0')
+      return;
+
+    environmentFileName = fileName;
+
+    // The tracer is constructed first, so that it is destroyed after the
+    // trace is written
+    Tracer::instance().start();
+    std::atexit(&writeEnvironmentTrace);
+  }
+};
+
+const EnvironmentTrace environmentTrace;
+
+} // end namespace
+
+Tracer::Tracer()
+  : m_origin(clockNanoseconds())
+{
+}
+
+Tracer& Tracer::instance()
+{
+  static Tracer tracer;
+  return tracer;
+}
+
+void Tracer::start()
+{
+  clear();
+  m_enabled.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::stop()
+{
+  m_enabled.store(false, std::memory_order_relaxed);
+}
+
+vector<Tracer::Span> Tracer::spans() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_spans;
+}
+
+void Tracer::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_spans.clear();
+}
+
+int64_t Tracer::now() const
+{
+  return clockNanoseconds() - m_origin;
+}
+
+int Tracer::threadNumber()
+{
+  static std::atomic<int> threadCount{ 0 };
+  thread_local int number = ++threadCount;
+  return number;
+}
+
+void Tracer::record(Span&& span)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_spans.push_back(std::move(span));
+}
+
+bool Tracer::write(const string& fileName) const
+{
+  vector<Span> copy = spans();
+
+  std::ofstream file(fileName);
+  if (!file) {
+    cerr << "Failed to open " << fileName << " for writing" << endl;
+    return false;
+  }
+
+  const int pid = processId();
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+       << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+       << ",\"tid\":0,\"args\":{\"name\":\"h5cpp\"}}";
+
+  // Complete events, which have a start and a duration
+  for (const Span& span : copy) {
+    file << ",\n{\"name\":";
+    writeQuoted(file, span.name);
+    file << ",\"cat\":";
+    writeQuoted(file, span.category);
+    file << ",\"ph\":\"X\",\"ts\":";
+    writeMicroseconds(file, span.start);
+    file << ",\"dur\":";
+    writeMicroseconds(file, span.duration);
+    file << ",\"pid\":" << pid << ",\"tid\":" << span.thread
+         << ",\"args\":{";
+
+    const char* separator = "";
+    if (!span.path.empty()) {
+      file << "\"path\":";
+      writeQuoted(file, span.path);
+      separator = ",";
+    }
+
+    if (span.bytes >= 0)
+      file << separator << "\"bytes\":" << span.bytes;
+
+    file << "}}";
+  }
+  file << "\n]}\n";
+
+  if (!file) {
+    cerr << "Failed to write " << fileName << endl;
+    return false;
+  }
+
+  return true;
+}
+
+void TraceSpan::begin(const char* name, const char* category)
+{
+  m_active = true;
+  m_span.name = name;
+  m_span.category = category;
+  m_span.thread = Tracer::threadNumber();
+  m_span.start = Tracer::instance().now();
+}
+
+void TraceSpan::finish()
+{
+  m_active = false;
+
+  Tracer& tracer = Tracer::instance();
+  m_span.duration = tracer.now() - m_span.start;
+  tracer.record(std::move(m_span));
+}
+
+} // namespace h5
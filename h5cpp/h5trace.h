@@ -0,0 +1,153 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5Trace_h
+#define tomvizH5Trace_h
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace h5 {
+
+/**
+ * A process-wide recorder of timed spans of I/O, to see how I/O overlaps
+ * with the rest of a program. Every H5ReadWrite call is a span, and so
+ * are the phases within it: open, metadata, read, decompress, convert,
+ * compress and write. Each span has its thread, and where they apply, the
+ * path and the number of bytes. The spans are written as Chrome
+ * trace-event JSON, which ui.perfetto.dev and chrome://tracing load.
+ *
+ * Tracing is off until it is started:
+ *
+ *   h5::Tracer::instance().start();
+ *   ...
+ *   h5::Tracer::instance().write("trace.json");
+ *
+ * A whole run is traced by setting the environment variable H5CPP_TRACE
+ * to the file to write when the program exits.
+ *
+ * When tracing is off, a span only checks a relaxed atomic flag.
+ * Compression inside HDF5, such as deflate, is part of the read and write
+ * spans; only the built-in LZ4 and Zstandard filters have decompress and
+ * compress spans.
+ */
+class Tracer
+{
+public:
+  /** A recorded span. Times are in nanoseconds since the tracer began. */
+  struct Span
+  {
+    const char* name = "";
+    const char* category = "";
+    std::string path;
+    int64_t bytes = -1; // Negative if unknown
+    int thread = 0;
+    int64_t start = 0;
+    int64_t duration = 0;
+  };
+
+  /** The tracer of the process */
+  static Tracer& instance();
+
+  /** Discard the recorded spans, and record new ones */
+  void start();
+
+  /** Stop recording. The recorded spans are kept. */
+  void stop();
+
+  /** Whether spans are being recorded */
+  bool enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+  /** A copy of the recorded spans, in the order they ended */
+  std::vector<Span> spans() const;
+
+  /** Discard the recorded spans */
+  void clear();
+
+  /**
+   * Write the recorded spans as a Chrome trace-event JSON file.
+   * @return True on success, false on failure.
+   */
+  bool write(const std::string& fileName) const;
+
+  /** The time in nanoseconds since the tracer began */
+  int64_t now() const;
+
+  /** A small number that identifies the calling thread in the trace */
+  static int threadNumber();
+
+  /** Add a span that has ended. TraceSpan calls this. */
+  void record(Span&& span);
+
+private:
+  Tracer();
+
+  std::atomic<bool> m_enabled{ false };
+  const int64_t m_origin;
+  mutable std::mutex m_mutex;
+  std::vector<Span> m_spans;
+};
+
+/**
+ * A span from its construction to its destruction, or to end(). It is
+ * only recorded if tracing is on when it is constructed. The name and the
+ * category must be string literals, or otherwise outlive the tracer.
+ */
+class TraceSpan
+{
+public:
+  TraceSpan(const char* name, const char* category)
+  {
+    if (Tracer::instance().enabled())
+      begin(name, category);
+  }
+
+  TraceSpan(const char* name, const char* category, const std::string& path)
+  {
+    if (Tracer::instance().enabled()) {
+      begin(name, category);
+      m_span.path = path;
+    }
+  }
+
+  ~TraceSpan() { end(); }
+
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+  /** Whether the span is recorded. Use it to skip computing its details. */
+  bool active() const { return m_active; }
+
+  void setPath(const std::string& path)
+  {
+    if (m_active)
+      m_span.path = path;
+  }
+
+  void setBytes(int64_t bytes)
+  {
+    if (m_active)
+      m_span.bytes = bytes;
+  }
+
+  /** End the span before its destruction. Calling it again does nothing. */
+  void end()
+  {
+    if (m_active)
+      finish();
+  }
+
+private:
+  void begin(const char* name, const char* category);
+  void finish();
+
+  bool m_active = false;
+  Tracer::Span m_span;
+};
+
+} // namespace h5
+
+#endif // tomvizH5Trace_h
@@ -4,9 +4,8 @@
 #ifndef tomvizH5TypeMaps_h
 #define tomvizH5TypeMaps_h
 
-#include <map>
-
 #include "h5capi.h"
+#include "h5dispatch.h"
 #include "h5readwrite.h" // This is included only for the "DataType" enum
 
 namespace h5 {
@@ -87,50 +86,115 @@ struct BasicTypeToH5<double>
   static hid_t memTypeId() { return H5T_NATIVE_DOUBLE; }
 };
 
-// Map of H5 types to our own enum class DataType
-// Key comparison must be done with H5Tequal
-static const std::map<hid_t, H5ReadWrite::DataType> H5ToDataType =
-{
-  { H5T_STD_I8LE,   H5ReadWrite::DataType::Int8 },
-  { H5T_STD_I16LE,  H5ReadWrite::DataType::Int16 },
-  { H5T_STD_I32LE,  H5ReadWrite::DataType::Int32 },
-  { H5T_STD_I64LE,  H5ReadWrite::DataType::Int64 },
-  { H5T_STD_U8LE,   H5ReadWrite::DataType::UInt8 },
-  { H5T_STD_U16LE,  H5ReadWrite::DataType::UInt16 },
-  { H5T_STD_U32LE,  H5ReadWrite::DataType::UInt32 },
-  { H5T_STD_U64LE,  H5ReadWrite::DataType::UInt64 },
-  { H5T_IEEE_F32LE, H5ReadWrite::DataType::Float },
-  { H5T_IEEE_F64LE, H5ReadWrite::DataType::Double }
+namespace detail {
+
+// IEEE 754 half precision, made from a single-precision type of the byte
+// order of @p base, with the same fields as h5py and NumPy use
+inline hid_t createFloat16Type(hid_t base)
+{
+  hid_t type = H5Tcopy(base);
+  H5Tset_fields(type, 15, 10, 5, 0, 10);
+  H5Tset_size(type, 2);
+  H5Tset_ebias(type, 15);
+  return type;
+}
+
+// A complex number as a compound of the real part "r" and the imaginary
+// part "i", as h5py stores them
+inline hid_t createComplexType(hid_t partType)
+{
+  const size_t partSize = H5Tget_size(partType);
+  hid_t type = H5Tcreate(H5T_COMPOUND, 2 * partSize);
+  H5Tinsert(type, "r", 0, partType);
+  H5Tinsert(type, "i", partSize, partType);
+  return type;
+}
+
+} // end namespace detail
+
+// These types are created once, and live as long as the HDF5 library.
+template<>
+struct BasicTypeToH5<float16>
+{
+  static hid_t dataTypeId()
+  {
+    static const hid_t id = detail::createFloat16Type(H5T_IEEE_F32LE);
+    return id;
+  }
+  static hid_t memTypeId()
+  {
+    static const hid_t id = detail::createFloat16Type(H5T_NATIVE_FLOAT);
+    return id;
+  }
 };
 
-static const std::map<H5ReadWrite::DataType, hid_t> DataTypeToH5DataType =
-{
-  { H5ReadWrite::DataType::Int8,   H5T_STD_I8LE  },
-  { H5ReadWrite::DataType::Int16,  H5T_STD_I16LE },
-  { H5ReadWrite::DataType::Int32,  H5T_STD_I32LE },
-  { H5ReadWrite::DataType::Int64,  H5T_STD_I64LE },
-  { H5ReadWrite::DataType::UInt8,  H5T_STD_U8LE  },
-  { H5ReadWrite::DataType::UInt16, H5T_STD_U16LE },
-  { H5ReadWrite::DataType::UInt32, H5T_STD_U32LE },
-  { H5ReadWrite::DataType::UInt64, H5T_STD_U64LE },
-  { H5ReadWrite::DataType::Float,  H5T_IEEE_F32LE},
-  { H5ReadWrite::DataType::Double, H5T_IEEE_F64LE}
+template<>
+struct BasicTypeToH5<std::complex<float>>
+{
+  static hid_t dataTypeId()
+  {
+    static const hid_t id = detail::createComplexType(H5T_IEEE_F32LE);
+    return id;
+  }
+  static hid_t memTypeId()
+  {
+    static const hid_t id = detail::createComplexType(H5T_NATIVE_FLOAT);
+    return id;
+  }
 };
 
-static const std::map<H5ReadWrite::DataType, hid_t> DataTypeToH5MemType =
-{
-  { H5ReadWrite::DataType::Int8,   H5T_NATIVE_CHAR   },
-  { H5ReadWrite::DataType::Int16,  H5T_NATIVE_SHORT  },
-  { H5ReadWrite::DataType::Int32,  H5T_NATIVE_INT    },
-  { H5ReadWrite::DataType::Int64,  H5T_NATIVE_LLONG  },
-  { H5ReadWrite::DataType::UInt8,  H5T_NATIVE_UCHAR  },
-  { H5ReadWrite::DataType::UInt16, H5T_NATIVE_USHORT },
-  { H5ReadWrite::DataType::UInt32, H5T_NATIVE_UINT   },
-  { H5ReadWrite::DataType::UInt64, H5T_NATIVE_ULLONG },
-  { H5ReadWrite::DataType::Float,  H5T_NATIVE_FLOAT  },
-  { H5ReadWrite::DataType::Double, H5T_NATIVE_DOUBLE }
+template<>
+struct BasicTypeToH5<std::complex<double>>
+{
+  static hid_t dataTypeId()
+  {
+    static const hid_t id = detail::createComplexType(H5T_IEEE_F64LE);
+    return id;
+  }
+  static hid_t memTypeId()
+  {
+    static const hid_t id = detail::createComplexType(H5T_NATIVE_DOUBLE);
+    return id;
+  }
 };
 
+namespace detail {
+
+struct H5TypeIdsVisitor
+{
+  hid_t& dataTypeId;
+  hid_t& memTypeId;
+
+  template <typename T>
+  void operator()(TypeTag<T>) const
+  {
+    dataTypeId = BasicTypeToH5<T>::dataTypeId();
+    memTypeId = BasicTypeToH5<T>::memTypeId();
+  }
+};
+
+} // end namespace detail
+
+// Get the file and memory H5 types of a DataType. Returns false if the
+// DataType has no C++ type.
+inline bool h5TypeIds(H5ReadWrite::DataType type, hid_t& dataTypeId,
+                      hid_t& memTypeId)
+{
+  detail::H5TypeIdsVisitor visitor{ dataTypeId, memTypeId };
+  switch (type) {
+#define H5CPP_TYPE_IDS_CASE(T, E)                                              \
+  case H5ReadWrite::DataType::E:                                               \
+    visitor(TypeTag<T>());                                                     \
+    return true;
+
+    H5CPP_FOR_EACH_EXTENDED_TYPE(H5CPP_TYPE_IDS_CASE)
+
+#undef H5CPP_TYPE_IDS_CASE
+    default:
+      return dispatch(type, visitor);
+  }
+}
+
 } // end namespace h5
 
 #endif // tomvizH5TypeMaps
@@ -0,0 +1,1719 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "h5utils.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+
+#include "h5compound.h"
+#include "h5filters.h"
+#include "h5float16.h"
+#include "h5quantize.h"
+#include "h5slabcache.h"
+#include "h5trace.h"
+#include "h5typemaps.h"
+#include "hidcloser.h"
+
+using std::cerr;
+using std::endl;
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// Choose chunk dimensions of about targetBytes for a data set of
+// dimensions dims. Chunks are one element thick along sliceAxis (if it is
+// valid), and the largest remaining dimension is halved until the chunk
+// is small enough, which gives roughly cubic chunks otherwise.
+vector<hsize_t> chooseChunkDimensions(const vector<hsize_t>& dims,
+                                      size_t elementSize, int sliceAxis,
+                                      size_t targetBytes)
+{
+  vector<hsize_t> chunk(dims.size());
+  for (size_t i = 0; i < dims.size(); ++i)
+    chunk[i] = std::max<hsize_t>(dims[i], 1);
+
+  if (sliceAxis >= 0 && static_cast<size_t>(sliceAxis) < chunk.size())
+    chunk[sliceAxis] = 1;
+
+  auto chunkBytes = [&chunk, elementSize]() {
+    return std::accumulate(chunk.cbegin(), chunk.cend(),
+                           static_cast<hsize_t>(elementSize),
+                           std::multiplies<hsize_t>());
+  };
+
+  while (chunkBytes() > targetBytes) {
+    auto largest = std::max_element(chunk.begin(), chunk.end());
+    if (*largest <= 1)
+      break;
+
+    *largest = (*largest + 1) / 2;
+  }
+
+  return chunk;
+}
+
+} // end namespace
+
+namespace h5 {
+
+using DataType = H5ReadWrite::DataType;
+
+namespace {
+
+// Basic types by class (signed integer, unsigned integer, float) and
+// log2 of their size in bytes. The byte order does not matter, since
+// HDF5 converts to the native order on read.
+constexpr int signedClass = 0;
+constexpr int unsignedClass = 1;
+constexpr int floatClass = 2;
+constexpr DataType basicTypeTable[3][4] = {
+  { DataType::Int8, DataType::Int16, DataType::Int32, DataType::Int64 },
+  { DataType::UInt8, DataType::UInt16, DataType::UInt32, DataType::UInt64 },
+  { DataType::None, DataType::Float16, DataType::Float, DataType::Double }
+};
+
+int sizeIndex(size_t size)
+{
+  switch (size) {
+    case 1:
+      return 0;
+    case 2:
+      return 1;
+    case 4:
+      return 2;
+    case 8:
+      return 3;
+    default:
+      return -1;
+  }
+}
+
+const char* compressionName(WriteOptions::Compression compression)
+{
+  switch (compression) {
+    case WriteOptions::Compression::Deflate:
+      return "Deflate";
+    case WriteOptions::Compression::LZ4:
+      return "LZ4";
+    case WriteOptions::Compression::Zstd:
+      return "Zstandard";
+    default:
+      return "No";
+  }
+}
+
+// The CMake option that builds in a filter, or nullptr if there is none
+const char* filterOption(H5Z_filter_t id)
+{
+  if (id == LZ4FilterId)
+    return "H5CPP_USE_LZ4";
+  if (id == ZstdFilterId)
+    return "H5CPP_USE_ZSTD";
+  return nullptr;
+}
+
+// Add the shuffle and compression filters of @p options to a chunked
+// data set creation property list
+bool setCompression(hid_t createId, size_t elementSize,
+                    const WriteOptions& options)
+{
+  using Compression = WriteOptions::Compression;
+
+  if (options.compression == Compression::None)
+    return true;
+
+  if (!compressionAvailable(options.compression)) {
+    cerr << "Error: " << compressionName(options.compression)
+         << " compression is not available. ";
+    if (options.compression == Compression::Deflate) {
+      // Deflate is built into HDF5, unless it was built without zlib
+      cerr << "Use a build of HDF5 with zlib\n";
+    } else {
+      cerr << "Build h5cpp with "
+           << (options.compression == Compression::LZ4 ? "H5CPP_USE_LZ4"
+                                                        : "H5CPP_USE_ZSTD")
+           << ", or put its HDF5 filter plugin on HDF5_PLUGIN_PATH\n";
+    }
+    return false;
+  }
+
+  // Shuffling single bytes does nothing
+  if (options.shuffle && elementSize > 1 && H5Pset_shuffle(createId) < 0) {
+    cerr << "Failed to set the shuffle filter\n";
+    return false;
+  }
+
+  herr_t status = -1;
+  if (options.compression == Compression::Deflate) {
+    int level = options.compressionLevel > 0 ? options.compressionLevel : 6;
+    status = H5Pset_deflate(createId, std::min(level, 9));
+  } else if (options.compression == Compression::LZ4) {
+    // The default block size: one block per chunk
+    status = H5Pset_filter(createId, LZ4FilterId, H5Z_FLAG_MANDATORY, 0,
+                           nullptr);
+  } else if (options.compression == Compression::Zstd) {
+    const unsigned level = std::max(options.compressionLevel, 0);
+    status = H5Pset_filter(createId, ZstdFilterId, H5Z_FLAG_MANDATORY, 1,
+                           &level);
+  }
+
+  if (status < 0) {
+    cerr << "Failed to set the " << compressionName(options.compression)
+         << " filter\n";
+    return false;
+  }
+
+  return true;
+}
+
+// Whether a compound type has the member @p name at @p index
+bool memberNamed(hid_t h5type, unsigned index, const char* name)
+{
+  char* memberName = H5Tget_member_name(h5type, index);
+  if (!memberName)
+    return false;
+
+  bool matches = std::strcmp(memberName, name) == 0;
+  H5free_memory(memberName);
+  return matches;
+}
+
+// Classify a compound type as Complex64 or Complex128 if it has the
+// floating point members "r" and "i" of the same size, as h5py writes
+// complex numbers, and as Compound otherwise
+DataType compoundDataType(hid_t h5type)
+{
+  if (H5Tget_nmembers(h5type) != 2 || !memberNamed(h5type, 0, "r") ||
+      !memberNamed(h5type, 1, "i")) {
+    return DataType::Compound;
+  }
+
+  size_t sizes[2];
+  for (unsigned i = 0; i < 2; ++i) {
+    HIDCloser memberCloser(H5Tget_member_type(h5type, i), H5Tclose);
+    if (!memberCloser.valueIsValid() ||
+        H5Tget_class(memberCloser.value()) != H5T_FLOAT) {
+      return DataType::Compound;
+    }
+
+    sizes[i] = H5Tget_size(memberCloser.value());
+  }
+
+  if (sizes[0] != sizes[1])
+    return DataType::Compound;
+
+  switch (sizes[0]) {
+    case 4:
+      return DataType::Complex64;
+    case 8:
+      return DataType::Complex128;
+    default:
+      return DataType::Compound;
+  }
+}
+
+// The number of elements that a read or write with these spaces moves
+hssize_t selectedCount(hid_t dataSetId, hid_t memSpaceId)
+{
+  if (memSpaceId != H5S_ALL)
+    return H5Sget_select_npoints(memSpaceId);
+
+  HIDCloser spaceCloser(H5Dget_space(dataSetId), H5Sclose);
+  if (!spaceCloser.valueIsValid())
+    return -1;
+
+  return H5Sget_select_npoints(spaceCloser.value());
+}
+
+// Give a span of a trace the path of an object
+void traceObject(TraceSpan& span, hid_t objectId)
+{
+  if (!span.active())
+    return;
+
+  char path[1024] = "";
+  H5Iget_name(objectId, path, sizeof(path));
+  span.setPath(path);
+}
+
+// Give a span of a trace the path of the child @p name of a group
+void traceChild(TraceSpan& span, hid_t groupId, const string& name)
+{
+  if (!span.active())
+    return;
+
+  char path[1024] = "";
+  H5Iget_name(groupId, path, sizeof(path));
+  string childPath = path;
+  if (childPath.empty() || childPath.back() != '/')
+    childPath += '/';
+  span.setPath(childPath + name);
+}
+
+// Give a span of a trace the path of a data set, and the bytes that a
+// read or write of it moves in memory
+void traceTransfer(TraceSpan& span, hid_t dataSetId, hid_t memSpaceId,
+                   hid_t memTypeId)
+{
+  if (!span.active())
+    return;
+
+  traceObject(span, dataSetId);
+  hssize_t count = selectedCount(dataSetId, memSpaceId);
+  if (count >= 0)
+    span.setBytes(count * static_cast<int64_t>(H5Tget_size(memTypeId)));
+}
+
+struct DequantizeVisitor
+{
+  const void* codes;
+  float* values;
+  size_t count;
+  Quantization quantization;
+
+  template <typename T>
+  typename std::enable_if<std::is_integral<T>::value>::type operator()(
+    TypeTag<T>) const
+  {
+    dequantize(static_cast<const T*>(codes), values, count, quantization);
+  }
+
+  template <typename T>
+  typename std::enable_if<!std::is_integral<T>::value>::type operator()(
+    TypeTag<T>) const
+  {
+  }
+};
+
+struct QuantizeVisitor
+{
+  const float* values;
+  void* codes;
+  size_t count;
+  Quantization quantization;
+  int precision;
+
+  template <typename T>
+  typename std::enable_if<std::is_integral<T>::value>::type operator()(
+    TypeTag<T>) const
+  {
+    // Packed codes have fewer bits than their type
+    T lowest = std::numeric_limits<T>::min();
+    T highest = std::numeric_limits<T>::max();
+    if (precision < std::numeric_limits<T>::digits) {
+      highest = static_cast<T>((1ull << precision) - 1);
+      if (std::is_signed<T>::value) {
+        highest = static_cast<T>(highest >> 1);
+        lowest = static_cast<T>(-highest - 1);
+      }
+    }
+
+    quantize(values, static_cast<T*>(codes), count, quantization, lowest,
+             highest);
+  }
+
+  template <typename T>
+  typename std::enable_if<!std::is_integral<T>::value>::type operator()(
+    TypeTag<T>) const
+  {
+  }
+};
+
+// A read or write of float memory that h5cpp converts itself, rather than
+// HDF5: Float16 data sets are widened and narrowed with a vectorized
+// conversion, since HDF5 converts half precision one element at a time,
+// and the integers of quantized data sets are restored and quantized.
+struct FloatConversion
+{
+  enum class Kind { None, Float16, Quantized };
+
+  FloatConversion(hid_t dataSetId, hid_t memTypeId)
+  {
+    if (H5Tequal(memTypeId, H5T_NATIVE_FLOAT) <= 0)
+      return;
+
+    HIDCloser typeCloser(H5Dget_type(dataSetId), H5Tclose);
+    if (!typeCloser.valueIsValid())
+      return;
+
+    hid_t fileType = typeCloser.value();
+    if (H5Tget_class(fileType) == H5T_FLOAT && H5Tget_size(fileType) == 2) {
+      kind = Kind::Float16;
+    } else if (quantization(dataSetId, m_quantization)) {
+      kind = Kind::Quantized;
+      m_codeType = h5ToDataType(fileType);
+      m_precision = static_cast<int>(H5Tget_precision(fileType));
+
+      // The codes of packed data sets keep their bits, so that HDF5 copies
+      // them rather than converting them
+      if (H5Tget_sign(fileType) == H5T_SGN_NONE &&
+          m_precision < 8 * static_cast<int>(H5Tget_size(fileType))) {
+        m_memType = HIDCloser(H5Tcopy(fileType), H5Tclose);
+        H5Tset_order(m_memType.value(), H5Tget_order(H5T_NATIVE_INT));
+      } else {
+        m_memType = HIDCloser(
+          H5Tget_native_type(fileType, H5T_DIR_ASCEND), H5Tclose);
+      }
+
+      if (!m_memType.valueIsValid())
+        kind = Kind::None;
+    }
+  }
+
+  // The memory type of the elements that are converted
+  hid_t memType()
+  {
+    return kind == Kind::Float16 ? BasicTypeToH5<float16>::memTypeId()
+                                 : m_memType.value();
+  }
+
+  void toFloat(const void* elements, float* values, size_t count)
+  {
+    if (kind == Kind::Float16) {
+      convertFloat16ToFloat(static_cast<const float16*>(elements), values,
+                            count);
+    } else {
+      dispatch(m_codeType,
+               DequantizeVisitor{ elements, values, count, m_quantization });
+    }
+  }
+
+  void fromFloat(const float* values, void* elements, size_t count)
+  {
+    if (kind == Kind::Float16) {
+      convertFloatToFloat16(values, static_cast<float16*>(elements), count);
+    } else {
+      dispatch(m_codeType, QuantizeVisitor{ values, elements, count,
+                                            m_quantization, m_precision });
+    }
+  }
+
+  Kind kind = Kind::None;
+
+private:
+  Quantization m_quantization;
+  DataType m_codeType = DataType::None;
+  int m_precision = 0;
+  HIDCloser m_memType{ H5I_INVALID_HID, H5Tclose };
+};
+
+// The box that a read selects in a data set, if it is one box read into
+// contiguous memory
+bool selectedBox(hid_t dataSetId, hid_t memSpaceId, hid_t fileSpaceId,
+                 vector<uint64_t>& start, vector<uint64_t>& counts)
+{
+  HIDCloser extentCloser(H5I_INVALID_HID, H5Sclose);
+  hid_t spaceId = fileSpaceId;
+  if (fileSpaceId == H5S_ALL) {
+    extentCloser = HIDCloser(H5Dget_space(dataSetId), H5Sclose);
+    spaceId = extentCloser.value();
+  }
+
+  int rank = H5Sget_simple_extent_ndims(spaceId);
+  if (rank < 0)
+    return false;
+
+  vector<hsize_t> dims(rank);
+  if (rank > 0 && H5Sget_simple_extent_dims(spaceId, &dims[0], nullptr) < 0)
+    return false;
+
+  H5S_sel_type selection =
+    fileSpaceId == H5S_ALL ? H5S_SEL_ALL : H5Sget_select_type(fileSpaceId);
+  if (selection == H5S_SEL_ALL) {
+    start.assign(rank, 0);
+    counts.assign(dims.begin(), dims.end());
+  } else if (selection == H5S_SEL_HYPERSLABS &&
+             H5Sis_regular_hyperslab(fileSpaceId) > 0) {
+    vector<hsize_t> h5start(rank), stride(rank), count(rank), block(rank);
+    if (H5Sget_regular_hyperslab(fileSpaceId, &h5start[0], &stride[0],
+                                 &count[0], &block[0]) < 0) {
+      return false;
+    }
+
+    start.assign(h5start.begin(), h5start.end());
+    counts.resize(rank);
+    for (int i = 0; i < rank; ++i) {
+      if (count[i] > 1 && stride[i] != block[i])
+        return false;
+      counts[i] = count[i] * block[i];
+    }
+  } else {
+    return false;
+  }
+
+  // Memory of the shape of the data set holds a selection in place
+  if (memSpaceId == H5S_ALL)
+    return selection == H5S_SEL_ALL;
+
+  uint64_t size = std::accumulate(counts.cbegin(), counts.cend(),
+                                  static_cast<uint64_t>(1),
+                                  std::multiplies<uint64_t>());
+  return H5Sget_select_type(memSpaceId) == H5S_SEL_ALL &&
+         H5Sget_select_npoints(memSpaceId) == static_cast<hssize_t>(size);
+}
+
+// A read that the shared SlabCache serves: of a box of a data set in a
+// file that is opened read-only, into contiguous memory of a basic type
+struct CachedRead
+{
+  CachedRead(hid_t dataSetId, hid_t memTypeId, hid_t memSpaceId,
+             hid_t fileSpaceId)
+  {
+    if (!SlabCache::instance().enabled())
+      return;
+
+    // Files that are written, or that a SWMR writer changes, are not
+    // cached
+    HIDCloser fileCloser(H5Iget_file_id(dataSetId), H5Fclose);
+    unsigned intent = 0;
+    if (!fileCloser.valueIsValid() ||
+        H5Fget_intent(fileCloser.value(), &intent) < 0 ||
+        intent != H5F_ACC_RDONLY) {
+      return;
+    }
+
+#ifdef H5CPP_USE_MPI
+    // Each process of a parallel file reads its own part
+    HIDCloser accessCloser(H5Fget_access_plist(fileCloser.value()),
+                           H5Pclose);
+    if (!accessCloser.valueIsValid() ||
+        H5Pget_driver(accessCloser.value()) == H5FD_MPIO) {
+      return;
+    }
+#endif
+
+    H5T_class_t typeClass = H5Tget_class(memTypeId);
+    if (typeClass != H5T_INTEGER && typeClass != H5T_FLOAT &&
+        typeClass != H5T_COMPOUND) {
+      return;
+    }
+
+    DataType type = h5ToDataType(memTypeId);
+    if (type == DataType::None || type == DataType::Compound)
+      return;
+
+    if (!selectedBox(dataSetId, memSpaceId, fileSpaceId, m_key.start,
+                     m_key.counts)) {
+      return;
+    }
+
+    char path[1024] = "";
+    ssize_t pathLength = H5Iget_name(dataSetId, path, sizeof(path));
+    char fileName[4096] = "";
+    ssize_t fileNameLength =
+      H5Fget_name(dataSetId, fileName, sizeof(fileName));
+    if (pathLength <= 0 || static_cast<size_t>(pathLength) >= sizeof(path) ||
+        fileNameLength <= 0 ||
+        static_cast<size_t>(fileNameLength) >= sizeof(fileName) ||
+        !SlabCache::identify(fileName, m_key.file, m_version)) {
+      return;
+    }
+
+    m_key.path = path;
+    m_key.type = static_cast<int>(type);
+    m_elementSize = H5Tget_size(memTypeId);
+    m_enabled = true;
+  }
+
+  // Copy the data from the cache. Returns false on a miss.
+  bool lookup(void* data)
+  {
+    return m_enabled &&
+           SlabCache::instance().lookup(m_key, m_version, m_elementSize,
+                                        data);
+  }
+
+  void insert(const void* data)
+  {
+    if (!m_enabled)
+      return;
+
+    size_t bytes = std::accumulate(m_key.counts.cbegin(),
+                                   m_key.counts.cend(), m_elementSize,
+                                   std::multiplies<size_t>());
+    SlabCache::instance().insert(m_key, m_version, data, bytes);
+  }
+
+private:
+  bool m_enabled = false;
+  SlabCache::Key m_key;
+  SlabCache::Version m_version;
+  size_t m_elementSize = 0;
+};
+
+// H5Dread, with the conversions of readElements()
+bool readConverted(hid_t dataSetId, hid_t memTypeId, hid_t memSpaceId,
+                   hid_t fileSpaceId, hid_t transferId, void* data)
+{
+  FloatConversion conversion(dataSetId, memTypeId);
+  if (conversion.kind == FloatConversion::Kind::None) {
+    TraceSpan span("read", "read");
+    traceTransfer(span, dataSetId, memSpaceId, memTypeId);
+    if (H5Dread(dataSetId, memTypeId, memSpaceId, fileSpaceId, transferId,
+                data) < 0) {
+      reportUnavailableFilters(dataSetId);
+      return false;
+    }
+
+    return true;
+  }
+
+  hssize_t count = selectedCount(dataSetId, memSpaceId);
+  if (count < 0) {
+    cerr << "Failed to count the selected elements\n";
+    return false;
+  }
+
+  vector<unsigned char> buffer(count * H5Tget_size(conversion.memType()));
+  TraceSpan readSpan("read", "read");
+  traceTransfer(readSpan, dataSetId, memSpaceId, conversion.memType());
+  if (H5Dread(dataSetId, conversion.memType(), memSpaceId, fileSpaceId,
+              transferId, buffer.data()) < 0) {
+    reportUnavailableFilters(dataSetId);
+    return false;
+  }
+  readSpan.end();
+
+  TraceSpan convertSpan("convert", "convert");
+  traceTransfer(convertSpan, dataSetId, memSpaceId, memTypeId);
+  conversion.toFloat(buffer.data(), static_cast<float*>(data), count);
+  return true;
+}
+
+// Set when the space of a data set is allocated and filled
+bool setAllocation(hid_t createId, WriteOptions::Layout layout,
+                   const WriteOptions& options)
+{
+  using Allocation = WriteOptions::Allocation;
+  using FillTime = WriteOptions::FillTime;
+
+  // HDF5 only allows compact data sets to be allocated early
+  if (options.allocation != Allocation::Default &&
+      layout != WriteOptions::Layout::Compact) {
+    H5D_alloc_time_t time = H5D_ALLOC_TIME_LATE;
+    if (options.allocation == Allocation::Early)
+      time = H5D_ALLOC_TIME_EARLY;
+    else if (options.allocation == Allocation::Incremental)
+      time = H5D_ALLOC_TIME_INCR;
+
+    if (H5Pset_alloc_time(createId, time) < 0) {
+      cerr << "Failed to set the allocation time\n";
+      return false;
+    }
+  }
+
+  if (options.fillTime != FillTime::Default) {
+    H5D_fill_time_t time = options.fillTime == FillTime::Always
+                             ? H5D_FILL_TIME_ALLOC
+                             : H5D_FILL_TIME_NEVER;
+    if (H5Pset_fill_time(createId, time) < 0) {
+      cerr << "Failed to set the fill time\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+} // end namespace
+
+DataType h5ToDataType(hid_t h5type)
+{
+  int typeClass;
+  switch (H5Tget_class(h5type)) {
+    case H5T_COMPOUND:
+      return compoundDataType(h5type);
+    case H5T_INTEGER:
+      typeClass =
+        H5Tget_sign(h5type) == H5T_SGN_NONE ? unsignedClass : signedClass;
+      break;
+    case H5T_FLOAT:
+      typeClass = floatClass;
+      if (H5Tget_size(h5type) == 2) {
+        // Only IEEE half precision, not other 16-bit formats like bfloat16
+        size_t signPosition, exponentPosition, exponentSize, mantissaPosition,
+          mantissaSize;
+        if (H5Tget_fields(h5type, &signPosition, &exponentPosition,
+                          &exponentSize, &mantissaPosition,
+                          &mantissaSize) < 0 ||
+            exponentSize != 5 || mantissaSize != 10) {
+          cerr << "Unsupported 16-bit floating point H5 type: " << h5type
+               << endl;
+          return DataType::None;
+        }
+      }
+      break;
+    case H5T_STRING:
+      return DataType::String;
+    default:
+      cerr << "Unsupported H5 type class for H5 type: " << h5type << endl;
+      return DataType::None;
+  }
+
+  int index = sizeIndex(H5Tget_size(h5type));
+  if (index < 0) {
+    cerr << "Unsupported size for H5 type: " << h5type << endl;
+    return DataType::None;
+  }
+
+  return basicTypeTable[typeClass][index];
+}
+
+bool readableAs(DataType stored, DataType requested)
+{
+  return stored == requested ||
+         (stored == DataType::Float16 && requested == DataType::Float);
+}
+
+bool typeMatches(hid_t typeId, DataType expected)
+{
+  DataType type = h5ToDataType(typeId);
+  if (!readableAs(type, expected)) {
+    // The type of the data does not match the requested type.
+    cerr << "Type determined does not match that requested." << endl;
+    cerr << H5ReadWrite::dataTypeToString(type) << " -> "
+         << H5ReadWrite::dataTypeToString(expected) << endl;
+    return false;
+  }
+
+  return true;
+}
+
+bool dataSetDimensions(hid_t dataSetId, vector<hsize_t>& dims)
+{
+  hid_t dataSpaceId = H5Dget_space(dataSetId);
+  if (dataSpaceId < 0) {
+    cerr << "Failed to get dataSpaceId\n";
+    return false;
+  }
+
+  HIDCloser dataSpaceCloser(dataSpaceId, H5Sclose);
+
+  int dimCount = H5Sget_simple_extent_ndims(dataSpaceId);
+  if (dimCount < 1) {
+    cerr << "Error: number of dimensions is less than 1\n";
+    return false;
+  }
+
+  dims.resize(dimCount);
+  return H5Sget_simple_extent_dims(dataSpaceId, &dims[0], nullptr) ==
+         dimCount;
+}
+
+bool dataSetTypeMatches(hid_t dataSetId, DataType expected)
+{
+  // Quantized data sets are restored as they are read as float
+  Quantization unused;
+  if (expected == DataType::Float && quantization(dataSetId, unused))
+    return true;
+
+  hid_t typeId = H5Dget_type(dataSetId);
+  HIDCloser dataTypeCloser(typeId, H5Tclose);
+
+  return typeMatches(typeId, expected);
+}
+
+bool selectHyperslab(hid_t dataSpaceId, const vector<hsize_t>& start,
+                     const vector<hsize_t>& counts)
+{
+  int dimCount = H5Sget_simple_extent_ndims(dataSpaceId);
+  if (dimCount < 1 || static_cast<size_t>(dimCount) != start.size() ||
+      start.size() != counts.size()) {
+    cerr << "Error: the hyperslab does not match the number of "
+         << "dimensions of the data set\n";
+    return false;
+  }
+
+  if (H5Sselect_hyperslab(dataSpaceId, H5S_SELECT_SET, &start[0], nullptr,
+                          &counts[0], nullptr) < 0 ||
+      H5Sselect_valid(dataSpaceId) <= 0) {
+    cerr << "Failed to select the hyperslab\n";
+    return false;
+  }
+
+  return true;
+}
+
+bool readHyperslab(hid_t dataSetId, const vector<hsize_t>& start,
+                   const vector<hsize_t>& counts, hid_t memTypeId,
+                   hid_t transferId, void* data)
+{
+  hid_t fileSpaceId = H5Dget_space(dataSetId);
+  if (fileSpaceId < 0) {
+    cerr << "Failed to get dataSpaceId\n";
+    return false;
+  }
+
+  HIDCloser fileSpaceCloser(fileSpaceId, H5Sclose);
+
+  if (!selectHyperslab(fileSpaceId, start, counts))
+    return false;
+
+  hid_t memSpaceId = H5Screate_simple(static_cast<int>(counts.size()),
+                                      &counts[0], nullptr);
+  HIDCloser memSpaceCloser(memSpaceId, H5Sclose);
+
+  return readElements(dataSetId, memTypeId, memSpaceId, fileSpaceId,
+                      transferId, data);
+}
+
+bool writeHyperslab(hid_t dataSetId, const vector<hsize_t>& start,
+                    const vector<hsize_t>& counts, hid_t memTypeId,
+                    hid_t transferId, const void* data)
+{
+  hid_t fileSpaceId = H5Dget_space(dataSetId);
+  if (fileSpaceId < 0) {
+    cerr << "Failed to get dataSpaceId\n";
+    return false;
+  }
+
+  HIDCloser fileSpaceCloser(fileSpaceId, H5Sclose);
+
+  if (!selectHyperslab(fileSpaceId, start, counts))
+    return false;
+
+  hid_t memSpaceId = H5Screate_simple(static_cast<int>(counts.size()),
+                                      &counts[0], nullptr);
+  HIDCloser memSpaceCloser(memSpaceId, H5Sclose);
+
+  return writeElements(dataSetId, memTypeId, memSpaceId, fileSpaceId,
+                       transferId, data);
+}
+
+bool quantization(hid_t dataSetId, Quantization& quantization)
+{
+  HIDCloser typeCloser(H5Dget_type(dataSetId), H5Tclose);
+  if (!typeCloser.valueIsValid() ||
+      H5Tget_class(typeCloser.value()) != H5T_INTEGER ||
+      H5Aexists(dataSetId, "scale_factor") <= 0) {
+    return false;
+  }
+
+  vector<double> values;
+  if (!readNumericAttribute(dataSetId, "scale_factor", values) ||
+      values.size() != 1) {
+    return false;
+  }
+
+  quantization.scale = static_cast<float>(values[0]);
+  quantization.offset = 0;
+  if (H5Aexists(dataSetId, "add_offset") > 0) {
+    if (!readNumericAttribute(dataSetId, "add_offset", values) ||
+        values.size() != 1) {
+      return false;
+    }
+
+    quantization.offset = static_cast<float>(values[0]);
+  }
+
+  return true;
+}
+
+bool readElements(hid_t dataSetId, hid_t memTypeId, hid_t memSpaceId,
+                  hid_t fileSpaceId, hid_t transferId, void* data)
+{
+  CachedRead cached(dataSetId, memTypeId, memSpaceId, fileSpaceId);
+  if (cached.lookup(data))
+    return true;
+
+  if (!readConverted(dataSetId, memTypeId, memSpaceId, fileSpaceId,
+                     transferId, data)) {
+    return false;
+  }
+
+  cached.insert(data);
+  return true;
+}
+
+bool writeElements(hid_t dataSetId, hid_t memTypeId, hid_t memSpaceId,
+                   hid_t fileSpaceId, hid_t transferId, const void* data)
+{
+  FloatConversion conversion(dataSetId, memTypeId);
+  if (conversion.kind == FloatConversion::Kind::None) {
+    TraceSpan span("write", "write");
+    traceTransfer(span, dataSetId, memSpaceId, memTypeId);
+    return H5Dwrite(dataSetId, memTypeId, memSpaceId, fileSpaceId,
+                    transferId, data) >= 0;
+  }
+
+  hssize_t count = selectedCount(dataSetId, memSpaceId);
+  if (count < 0) {
+    cerr << "Failed to count the selected elements\n";
+    return false;
+  }
+
+  vector<unsigned char> buffer(count * H5Tget_size(conversion.memType()));
+  TraceSpan convertSpan("convert", "convert");
+  traceTransfer(convertSpan, dataSetId, memSpaceId, memTypeId);
+  conversion.fromFloat(static_cast<const float*>(data), buffer.data(),
+                       count);
+  convertSpan.end();
+
+  TraceSpan writeSpan("write", "write");
+  traceTransfer(writeSpan, dataSetId, memSpaceId, conversion.memType());
+  return H5Dwrite(dataSetId, conversion.memType(), memSpaceId, fileSpaceId,
+                  transferId, buffer.data()) >= 0;
+}
+
+void reportUnavailableFilters(hid_t dataSetId)
+{
+  HIDCloser createCloser(H5Dget_create_plist(dataSetId), H5Pclose);
+  if (!createCloser.valueIsValid())
+    return;
+
+  const int count = H5Pget_nfilters(createCloser.value());
+  for (int i = 0; i < count; ++i) {
+    unsigned flags = 0;
+    size_t valueCount = 0;
+    unsigned config = 0;
+    char name[256] = "";
+    H5Z_filter_t id = H5Pget_filter2(createCloser.value(), i, &flags,
+                                     &valueCount, nullptr, sizeof(name), name,
+                                     &config);
+    if (id < 0)
+      continue;
+
+    htri_t available;
+    H5E_BEGIN_TRY {
+      available = H5Zfilter_avail(id);
+    } H5E_END_TRY;
+
+    if (available > 0)
+      continue;
+
+    char path[1024] = "";
+    H5Iget_name(dataSetId, path, sizeof(path));
+    cerr << "Error: " << path << " needs the HDF5 filter " << id;
+    if (name[0])
+      cerr << " (" << name << ")";
+
+    cerr << ", which is not available. ";
+    if (const char* option = filterOption(id))
+      cerr << "Build h5cpp with " << option << ", or put";
+    else
+      cerr << "Put";
+
+    cerr << " its filter plugin on HDF5_PLUGIN_PATH\n";
+  }
+}
+
+WriteOptions::Layout chooseLayout(const vector<hsize_t>& dims,
+                                  size_t elementSize,
+                                  const WriteOptions& options)
+{
+  using Layout = WriteOptions::Layout;
+
+  size_t bytes = std::accumulate(dims.cbegin(), dims.cend(), elementSize,
+                                 std::multiplies<size_t>());
+
+  const bool compressed =
+    options.compression != WriteOptions::Compression::None;
+
+  Layout layout = options.layout;
+  if (layout == Layout::Automatic) {
+    if (!options.chunkDimensions.empty() || compressed ||
+        bytes >= options.chunkedLimit)
+      layout = Layout::Chunked;
+    else if (bytes < options.compactLimit)
+      layout = Layout::Compact;
+    else
+      layout = Layout::Contiguous;
+  }
+
+  // Chunks cannot be larger than the data set, and HDF5 does not allow
+  // chunking data sets without any elements.
+  if (layout == Layout::Chunked && bytes == 0)
+    layout = Layout::Contiguous;
+
+  return layout;
+}
+
+hid_t createDataSetPropertyList(const vector<hsize_t>& dims,
+                                size_t elementSize,
+                                const WriteOptions& options)
+{
+  using Layout = WriteOptions::Layout;
+
+  hid_t createId = H5Pcreate(H5P_DATASET_CREATE);
+  HIDCloser createCloser(createId, H5Pclose);
+  if (createId < 0) {
+    cerr << "Failed to create the data set creation property list\n";
+    return H5I_INVALID_HID;
+  }
+
+  if (options.compression != WriteOptions::Compression::None &&
+      (options.layout == Layout::Compact ||
+       options.layout == Layout::Contiguous)) {
+    cerr << "Error: compression requires the chunked layout\n";
+    return H5I_INVALID_HID;
+  }
+
+  Layout layout = chooseLayout(dims, elementSize, options);
+  if (layout == Layout::Compact) {
+    if (H5Pset_layout(createId, H5D_COMPACT) < 0) {
+      cerr << "Failed to set the compact layout\n";
+      return H5I_INVALID_HID;
+    }
+  } else if (layout == Layout::Chunked) {
+    vector<hsize_t> chunk;
+    if (options.chunkDimensions.empty()) {
+      chunk = chooseChunkDimensions(dims, elementSize, options.sliceAxis,
+                                    options.chunkBytes);
+    } else if (options.chunkDimensions.size() == dims.size()) {
+      for (size_t i = 0; i < dims.size(); ++i) {
+        chunk.push_back(std::min<hsize_t>(
+          std::max(options.chunkDimensions[i], 1), dims[i]));
+      }
+    } else {
+      cerr << "Error: the chunk dimensions do not match the number of "
+           << "dimensions of the data set\n";
+      return H5I_INVALID_HID;
+    }
+
+    if (H5Pset_chunk(createId, static_cast<int>(chunk.size()),
+                     &chunk[0]) < 0) {
+      cerr << "Failed to set the chunk dimensions\n";
+      return H5I_INVALID_HID;
+    }
+
+    if (!setCompression(createId, elementSize, options))
+      return H5I_INVALID_HID;
+  }
+
+  if (!setAllocation(createId, layout, options))
+    return H5I_INVALID_HID;
+
+  // Release ownership to the caller
+  return createCloser.release();
+}
+
+bool writeDataSet(hid_t groupId, const string& name, const vector<int>& dims,
+                  hid_t dataTypeId, hid_t memTypeId, hid_t transferId,
+                  const void* data, const WriteOptions& options)
+{
+  if (options.quantizeBits > 0 && H5Tequal(memTypeId, H5T_NATIVE_FLOAT) > 0) {
+    HIDCloser dataCloser(
+      createQuantizedDataSet(groupId, name, dims,
+                             static_cast<const float*>(data), transferId,
+                             options),
+      H5Dclose);
+    return dataCloser.valueIsValid();
+  }
+
+  vector<hsize_t> h5dim(dims.begin(), dims.end());
+
+  // The values are narrowed by writeElements()
+  if (options.storeFloat16 && H5Tequal(memTypeId, H5T_NATIVE_FLOAT) > 0)
+    dataTypeId = BasicTypeToH5<float16>::dataTypeId();
+
+  HIDCloser createCloser(
+    createDataSetPropertyList(h5dim, H5Tget_size(dataTypeId), options),
+    H5Pclose);
+  if (!createCloser.valueIsValid())
+    return false;
+
+  HIDCloser dataCloser(createDataSet(groupId, name, dims, dataTypeId,
+                                     createCloser.value()),
+                       H5Dclose);
+  if (!dataCloser.valueIsValid())
+    return false;
+
+  return writeElements(dataCloser.value(), memTypeId, H5S_ALL, H5S_ALL,
+                       transferId, data);
+}
+
+hid_t createEmptyDataSet(hid_t groupId, const string& name,
+                         const vector<int>& dims, DataType type,
+                         const WriteOptions& options)
+{
+  hid_t dataTypeId, memTypeId;
+  if (!h5TypeIds(type, dataTypeId, memTypeId)) {
+    cerr << "Failed to get H5 types for "
+         << H5ReadWrite::dataTypeToString(type) << "\n";
+    return H5I_INVALID_HID;
+  }
+
+  if (type == DataType::Float && options.quantizeBits > 0) {
+    cerr << "Error: a quantized data set cannot be created empty, since "
+         << "its quantization is chosen from its data\n";
+    return H5I_INVALID_HID;
+  }
+
+  if (type == DataType::Float && options.storeFloat16)
+    dataTypeId = BasicTypeToH5<float16>::dataTypeId();
+
+  vector<hsize_t> h5dim(dims.begin(), dims.end());
+  HIDCloser createCloser(
+    createDataSetPropertyList(h5dim, H5Tget_size(dataTypeId), options),
+    H5Pclose);
+  if (!createCloser.valueIsValid())
+    return H5I_INVALID_HID;
+
+  return createDataSet(groupId, name, dims, dataTypeId, createCloser.value());
+}
+
+hid_t createQuantizedDataSet(hid_t groupId, const string& name,
+                             const vector<int>& dims, const float* data,
+                             hid_t transferId, const WriteOptions& options)
+{
+  const int bits = options.quantizeBits;
+  if (bits < 1 || bits > 16) {
+    cerr << "Error: quantizeBits must be from 1 to 16\n";
+    return H5I_INVALID_HID;
+  }
+
+  vector<hsize_t> h5dim(dims.begin(), dims.end());
+  const size_t count =
+    std::accumulate(h5dim.cbegin(), h5dim.cend(), static_cast<size_t>(1),
+                    std::multiplies<size_t>());
+  Quantization quantization = chooseQuantization(data, count, bits);
+
+  HIDCloser typeCloser(H5Tcopy(bits > 8 ? H5T_STD_U16LE : H5T_STD_U8LE),
+                       H5Tclose);
+  hid_t typeId = typeCloser.value();
+
+  HIDCloser createCloser(
+    createDataSetPropertyList(h5dim, H5Tget_size(typeId), options),
+    H5Pclose);
+  if (!createCloser.valueIsValid())
+    return H5I_INVALID_HID;
+
+  // The codes of uncompressed chunks are packed to their bits. Compressed
+  // chunks are not, since the codecs remove the unused bits anyway, and
+  // compress whole bytes better.
+  hid_t createId = createCloser.value();
+  if (bits % 8 != 0 &&
+      options.compression == WriteOptions::Compression::None &&
+      H5Pget_layout(createId) == H5D_CHUNKED) {
+    if (H5Tset_precision(typeId, bits) < 0 || H5Pset_nbit(createId) < 0) {
+      cerr << "Failed to set the n-bit filter\n";
+      return H5I_INVALID_HID;
+    }
+  }
+
+  HIDCloser dataCloser(createDataSet(groupId, name, dims, typeId, createId),
+                       H5Dclose);
+  if (!dataCloser.valueIsValid())
+    return H5I_INVALID_HID;
+
+  // The attributes come first, since writeElements() quantizes with them
+  hid_t dataSetId = dataCloser.value();
+  if (!writeAttribute(dataSetId, "scale_factor", H5T_IEEE_F32LE,
+                      H5T_NATIVE_FLOAT, &quantization.scale) ||
+      !writeAttribute(dataSetId, "add_offset", H5T_IEEE_F32LE,
+                      H5T_NATIVE_FLOAT, &quantization.offset)) {
+    cerr << "Failed to write the quantization of " << name << "\n";
+    return H5I_INVALID_HID;
+  }
+
+  if (!writeElements(dataSetId, H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL,
+                     transferId, data)) {
+    return H5I_INVALID_HID;
+  }
+
+  // Release ownership to the caller
+  return dataCloser.release();
+}
+
+hid_t createDataSet(hid_t groupId, const string& name,
+                    const vector<int>& dims, hid_t dataTypeId,
+                    hid_t createId)
+{
+  TraceSpan span("metadata", "metadata");
+  traceChild(span, groupId, name);
+
+  vector<hsize_t> h5dim(dims.begin(), dims.end());
+
+  hid_t dataSpaceId =
+    H5Screate_simple(static_cast<int>(dims.size()), h5dim.data(), NULL);
+  HIDCloser spaceCloser(dataSpaceId, H5Sclose);
+
+  hid_t dataId = H5Dcreate(groupId, name.c_str(), dataTypeId, dataSpaceId,
+                           H5P_DEFAULT, createId, H5P_DEFAULT);
+  if (dataId < 0)
+    cerr << "Failed to create data set: " << name << "\n";
+
+  return dataId;
+}
+
+bool readStringDataSet(hid_t dataSetId, hid_t transferId,
+                       StringTable& table)
+{
+  table.clear();
+
+  HIDCloser typeCloser(H5Dget_type(dataSetId), H5Tclose);
+  hid_t fileType = typeCloser.value();
+  if (fileType < 0 || H5Tget_class(fileType) != H5T_STRING) {
+    cerr << "The data set does not contain strings\n";
+    return false;
+  }
+
+  vector<hsize_t> h5dims;
+  if (!dataSetDimensions(dataSetId, h5dims))
+    return false;
+
+  size_t count = std::accumulate(h5dims.cbegin(), h5dims.cend(),
+                                 static_cast<size_t>(1),
+                                 std::multiplies<size_t>());
+
+  // Read with the type of the file, which is in memory format already
+  HIDCloser memTypeCloser(H5Tcopy(fileType), H5Tclose);
+  hid_t memType = memTypeCloser.value();
+
+  if (H5Tis_variable_str(fileType) > 0) {
+    // HDF5 allocates every string, and they are all freed at once below
+    vector<char*> pointers(count, nullptr);
+    TraceSpan span("read", "read");
+    traceObject(span, dataSetId);
+    if (H5Dread(dataSetId, memType, H5S_ALL, H5S_ALL, transferId,
+                pointers.data()) < 0) {
+      cerr << "Failed to read the strings\n";
+      return false;
+    }
+    span.end();
+
+    // Measure the strings first, so that the table is allocated once
+    vector<size_t> lengths(count, 0);
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; ++i) {
+      if (pointers[i])
+        lengths[i] = std::strlen(pointers[i]);
+      bytes += lengths[i];
+    }
+
+    table.reserve(count, bytes);
+    for (size_t i = 0; i < count; ++i)
+      table.append(pointers[i], lengths[i]);
+
+    HIDCloser spaceCloser(H5Dget_space(dataSetId), H5Sclose);
+    H5Dvlen_reclaim(memType, spaceCloser.value(), H5P_DEFAULT,
+                    pointers.data());
+    table.setShape(vector<int>(h5dims.begin(), h5dims.end()));
+    return true;
+  }
+
+  // Fixed-length strings are read into one contiguous block
+  size_t length = H5Tget_size(fileType);
+  vector<char> block(count * length);
+  TraceSpan span("read", "read");
+  traceTransfer(span, dataSetId, H5S_ALL, memType);
+  if (H5Dread(dataSetId, memType, H5S_ALL, H5S_ALL, transferId,
+              block.data()) < 0) {
+    cerr << "Failed to read the strings\n";
+    return false;
+  }
+  span.end();
+
+  table.reserve(count, block.size());
+  bool spacePadded = H5Tget_strpad(fileType) == H5T_STR_SPACEPAD;
+  for (size_t i = 0; i < count; ++i) {
+    const char* begin = block.data() + i * length;
+    const char* end = std::find(begin, begin + length, '\0');
+    if (spacePadded) {
+      while (end > begin && *(end - 1) == ' ')
+        --end;
+    }
+    table.append(begin, end - begin);
+  }
+
+  table.setShape(vector<int>(h5dims.begin(), h5dims.end()));
+  return true;
+}
+
+bool writeStringDataSet(hid_t groupId, const string& name,
+                        const vector<int>& dims, const vector<string>& values,
+                        hid_t transferId, const WriteOptions& options)
+{
+  size_t count = std::accumulate(dims.cbegin(), dims.cend(),
+                                 static_cast<size_t>(1),
+                                 std::multiplies<size_t>());
+  if (count != values.size()) {
+    cerr << "The number of strings (" << values.size() << ") does not "
+         << "match the dimensions (" << count << ")\n";
+    return false;
+  }
+
+  HIDCloser typeCloser(H5I_INVALID_HID, H5Tclose);
+  vector<char> block;
+  vector<const char*> pointers;
+  const void* data;
+
+  if (options.fixedLengthStrings) {
+    size_t length = 1;
+    for (const string& value : values)
+      length = std::max(length, value.size());
+
+    typeCloser = HIDCloser(H5Tcopy(H5T_C_S1), H5Tclose);
+    if (H5Tset_size(typeCloser.value(), length) < 0 ||
+        H5Tset_strpad(typeCloser.value(), H5T_STR_NULLPAD) < 0) {
+      cerr << "Failed to create the string type\n";
+      return false;
+    }
+
+    block.resize(count * length, '\0');
+    for (size_t i = 0; i < count; ++i)
+      std::copy(values[i].begin(), values[i].end(), &block[i * length]);
+
+    data = block.data();
+  } else {
+    typeCloser = HIDCloser(createVariableStringType(), H5Tclose);
+    if (!typeCloser.valueIsValid())
+      return false;
+
+    // Variable-length strings are written from an array of pointers
+    pointers.reserve(count);
+    for (const string& value : values)
+      pointers.push_back(value.c_str());
+
+    data = pointers.data();
+  }
+
+  hid_t type = typeCloser.value();
+  vector<hsize_t> h5dims(dims.begin(), dims.end());
+
+  HIDCloser createCloser(
+    createDataSetPropertyList(h5dims, H5Tget_size(type), options), H5Pclose);
+  if (!createCloser.valueIsValid())
+    return false;
+
+  HIDCloser dataCloser(
+    createDataSet(groupId, name, dims, type, createCloser.value()), H5Dclose);
+  if (!dataCloser.valueIsValid())
+    return false;
+
+  // Nothing to write to an empty data set
+  if (count == 0)
+    return true;
+
+  // The bytes of variable-length strings are not counted
+  TraceSpan span("write", "write");
+  traceObject(span, dataCloser.value());
+  if (options.fixedLengthStrings)
+    span.setBytes(block.size());
+
+  return H5Dwrite(dataCloser.value(), type, H5S_ALL, H5S_ALL, transferId,
+                  data) >= 0;
+}
+
+bool readCompoundColumns(hid_t dataSetId, hid_t transferId,
+                         const vector<Column>& columns)
+{
+  HIDCloser typeCloser(H5Dget_type(dataSetId), H5Tclose);
+  hid_t fileType = typeCloser.value();
+  if (fileType < 0 || H5Tget_class(fileType) != H5T_COMPOUND) {
+    cerr << "The data set is not a compound data set\n";
+    return false;
+  }
+
+  vector<hsize_t> dims;
+  if (!dataSetDimensions(dataSetId, dims) || dims.size() != 1) {
+    cerr << "Compound data sets must be 1-dimensional\n";
+    return false;
+  }
+
+  if (columns.empty())
+    return true;
+
+  // Find the memory types and sizes of the requested members
+  vector<hid_t> memTypes;
+  vector<size_t> sizes;
+  size_t recordSize = 0;
+  for (const Column& column : columns) {
+    int index = H5Tget_member_index(fileType, column.member.c_str());
+    if (index < 0) {
+      cerr << "Compound member not found: " << column.member << endl;
+      return false;
+    }
+
+    HIDCloser memberCloser(H5Tget_member_type(fileType, index), H5Tclose);
+    if (!typeMatches(memberCloser.value(), column.type))
+      return false;
+
+    hid_t dataTypeId, memTypeId;
+    if (!h5TypeIds(column.type, dataTypeId, memTypeId)) {
+      cerr << "Unsupported type for compound member " << column.member
+           << endl;
+      return false;
+    }
+
+    memTypes.push_back(memTypeId);
+    sizes.push_back(H5Tget_size(memTypeId));
+    recordSize += sizes.back();
+  }
+
+  // A partial, packed compound type of only the requested members. HDF5
+  // matches members by name, and skips the others.
+  HIDCloser memTypeCloser(H5Tcreate(H5T_COMPOUND, recordSize), H5Tclose);
+  hid_t memType = memTypeCloser.value();
+  size_t offset = 0;
+  for (size_t i = 0; i < columns.size(); ++i) {
+    if (H5Tinsert(memType, columns[i].member.c_str(), offset,
+                  memTypes[i]) < 0) {
+      cerr << "Failed to build the compound type\n";
+      return false;
+    }
+    offset += sizes[i];
+  }
+
+  size_t count = dims[0];
+  if (count == 0)
+    return true;
+
+  TraceSpan span("read", "read");
+  traceTransfer(span, dataSetId, H5S_ALL, memType);
+
+  // With one member, the packed records are the column itself
+  if (columns.size() == 1) {
+    return H5Dread(dataSetId, memType, H5S_ALL, H5S_ALL, transferId,
+                   columns[0].data) >= 0;
+  }
+
+  vector<unsigned char> records(count * recordSize);
+  if (H5Dread(dataSetId, memType, H5S_ALL, H5S_ALL, transferId,
+              records.data()) < 0) {
+    cerr << "Failed to read the compound data set\n";
+    return false;
+  }
+  span.end();
+
+  // Scatter the records into the columns
+  offset = 0;
+  for (size_t i = 0; i < columns.size(); ++i) {
+    const unsigned char* source = records.data() + offset;
+    unsigned char* destination = static_cast<unsigned char*>(columns[i].data);
+    for (size_t j = 0; j < count; ++j) {
+      std::copy(source, source + sizes[i], destination);
+      source += recordSize;
+      destination += sizes[i];
+    }
+    offset += sizes[i];
+  }
+
+  return true;
+}
+
+bool writeCompoundDataSet(hid_t groupId, const string& name, int length,
+                          const vector<ConstColumn>& columns,
+                          hid_t transferId, const WriteOptions& options)
+{
+  if (columns.empty() || length < 0) {
+    cerr << "A compound data set needs columns and a valid length\n";
+    return false;
+  }
+
+  // The file type uses the standard little-endian types, like writeData()
+  vector<hid_t> fileTypes;
+  vector<hid_t> memTypes;
+  size_t fileSize = 0;
+  size_t memSize = 0;
+  for (const ConstColumn& column : columns) {
+    hid_t dataTypeId, memTypeId;
+    if (!h5TypeIds(column.type, dataTypeId, memTypeId)) {
+      cerr << "Unsupported type for compound member " << column.member
+           << endl;
+      return false;
+    }
+
+    fileTypes.push_back(dataTypeId);
+    memTypes.push_back(memTypeId);
+    fileSize += H5Tget_size(dataTypeId);
+    memSize += H5Tget_size(memTypeId);
+  }
+
+  HIDCloser fileTypeCloser(H5Tcreate(H5T_COMPOUND, fileSize), H5Tclose);
+  HIDCloser memTypeCloser(H5Tcreate(H5T_COMPOUND, memSize), H5Tclose);
+  size_t fileOffset = 0;
+  size_t memOffset = 0;
+  for (size_t i = 0; i < columns.size(); ++i) {
+    const char* member = columns[i].member.c_str();
+    if (H5Tinsert(fileTypeCloser.value(), member, fileOffset,
+                  fileTypes[i]) < 0 ||
+        H5Tinsert(memTypeCloser.value(), member, memOffset, memTypes[i]) < 0) {
+      cerr << "Failed to build the compound type\n";
+      return false;
+    }
+    fileOffset += H5Tget_size(fileTypes[i]);
+    memOffset += H5Tget_size(memTypes[i]);
+  }
+
+  // Gather the columns into packed records
+  size_t count = static_cast<size_t>(length);
+  vector<unsigned char> records(count * memSize);
+  memOffset = 0;
+  for (size_t i = 0; i < columns.size(); ++i) {
+    size_t size = H5Tget_size(memTypes[i]);
+    const unsigned char* source =
+      static_cast<const unsigned char*>(columns[i].data);
+    unsigned char* destination = records.data() + memOffset;
+    for (size_t j = 0; j < count; ++j) {
+      std::copy(source, source + size, destination);
+      source += size;
+      destination += memSize;
+    }
+    memOffset += size;
+  }
+
+  vector<int> dims(1, length);
+  vector<hsize_t> h5dims(1, count);
+  HIDCloser createCloser(
+    createDataSetPropertyList(h5dims, fileSize, options), H5Pclose);
+  if (!createCloser.valueIsValid())
+    return false;
+
+  HIDCloser dataCloser(createDataSet(groupId, name, dims,
+                                     fileTypeCloser.value(),
+                                     createCloser.value()),
+                       H5Dclose);
+  if (!dataCloser.valueIsValid())
+    return false;
+
+  // Nothing to write to an empty data set
+  if (count == 0)
+    return true;
+
+  TraceSpan span("write", "write");
+  traceTransfer(span, dataCloser.value(), H5S_ALL, memTypeCloser.value());
+  return H5Dwrite(dataCloser.value(), memTypeCloser.value(), H5S_ALL,
+                  H5S_ALL, transferId, records.data()) >= 0;
+}
+
+bool groupChildren(hid_t groupId, vector<string>& names)
+{
+  constexpr int maxNameSize = 2048;
+  char name[maxNameSize];
+
+  hsize_t objCount = 0;
+  if (H5Gget_num_objs(groupId, &objCount) < 0)
+    return false;
+
+  names.clear();
+  for (hsize_t i = 0; i < objCount; ++i) {
+    H5Gget_objname_by_idx(groupId, i, name, maxNameSize);
+    names.push_back(name);
+  }
+
+  return true;
+}
+
+bool readAttribute(hid_t locationId, const string& path, const string& name,
+                   DataType expected, hid_t memTypeId, void* value)
+{
+  if (H5Aexists_by_name(locationId, path.c_str(), name.c_str(),
+                        H5P_DEFAULT) <= 0) {
+    cerr << "Attribute " << path << name << " not found!" << endl;
+    return false;
+  }
+
+  hid_t attr = H5Aopen_by_name(locationId, path.c_str(), name.c_str(),
+                               H5P_DEFAULT, H5P_DEFAULT);
+  hid_t type = H5Aget_type(attr);
+
+  // For automatic closing upon leaving scope
+  HIDCloser attrCloser(attr, H5Aclose);
+  HIDCloser typeCloser(type, H5Tclose);
+
+  if (!typeMatches(type, expected))
+    return false;
+
+  return H5Aread(attr, memTypeId, value) >= 0;
+}
+
+bool readStringAttribute(hid_t locationId, const string& path,
+                         const string& name, string& value)
+{
+  if (H5Aexists_by_name(locationId, path.c_str(), name.c_str(),
+                        H5P_DEFAULT) <= 0) {
+    cerr << "Attribute " << path << name << " not found!" << endl;
+    return false;
+  }
+
+  hid_t attr = H5Aopen_by_name(locationId, path.c_str(), name.c_str(),
+                               H5P_DEFAULT, H5P_DEFAULT);
+  hid_t type = H5Aget_type(attr);
+
+  // For automatic closing upon leaving scope
+  HIDCloser attrCloser(attr, H5Aclose);
+  HIDCloser typeCloser(type, H5Tclose);
+
+  if (H5T_STRING != H5Tget_class(type)) {
+    cerr << path << name << " is not a string" << endl;
+    return false;
+  }
+  char* tmpString;
+  int is_var_str = H5Tis_variable_str(type);
+  if (is_var_str > 0) { // if it is a variable-length string
+    if (H5Aread(attr, type, &tmpString) < 0) {
+      cerr << "Failed to read attribute " << path << " " << name << endl;
+      return false;
+    }
+    value = tmpString;
+    free(tmpString);
+  } else if (is_var_str == 0) { // If it is not a variable-length string
+    // it must be fixed length since the "is a string" check earlier passed.
+    size_t size = H5Tget_size(type);
+    if (size == 0) {
+      cerr << "Unknown error occurred" << endl;
+      return false;
+    }
+    tmpString = new char[size + 1];
+    if (H5Aread(attr, type, tmpString) < 0) {
+      cerr << "Failed to read attribute " << path << " " << name << endl;
+      delete [] tmpString;
+      return false;
+    }
+    tmpString[size] = '\0'; // set null byte, hdf5 doesn't do this for you
+    value = tmpString;
+    delete [] tmpString;
+  } else {
+    cerr << "Unknown error occurred" << endl;
+    return false;
+  }
+
+  return true;
+}
+
+bool readNumericAttribute(hid_t objectId, const string& name,
+                          vector<double>& values)
+{
+  HIDCloser attrCloser(H5Aopen(objectId, name.c_str(), H5P_DEFAULT),
+                       H5Aclose);
+  if (!attrCloser.valueIsValid()) {
+    cerr << "Failed to open attribute " << name << endl;
+    return false;
+  }
+
+  hid_t attr = attrCloser.value();
+  HIDCloser typeCloser(H5Aget_type(attr), H5Tclose);
+  H5T_class_t typeClass = H5Tget_class(typeCloser.value());
+  if (typeClass != H5T_INTEGER && typeClass != H5T_FLOAT) {
+    cerr << "Attribute " << name << " is not numeric" << endl;
+    return false;
+  }
+
+  HIDCloser spaceCloser(H5Aget_space(attr), H5Sclose);
+  hssize_t count = H5Sget_simple_extent_npoints(spaceCloser.value());
+  if (count < 0)
+    return false;
+
+  // HDF5 converts every integer and floating point type to double
+  values.resize(static_cast<size_t>(count));
+  if (count > 0 && H5Aread(attr, H5T_NATIVE_DOUBLE, values.data()) < 0) {
+    cerr << "Failed to read attribute " << name << endl;
+    return false;
+  }
+
+  return true;
+}
+
+bool readStringAttributeValues(hid_t objectId, const string& name,
+                               vector<string>& values)
+{
+  HIDCloser attrCloser(H5Aopen(objectId, name.c_str(), H5P_DEFAULT),
+                       H5Aclose);
+  if (!attrCloser.valueIsValid()) {
+    cerr << "Failed to open attribute " << name << endl;
+    return false;
+  }
+
+  hid_t attr = attrCloser.value();
+  HIDCloser typeCloser(H5Aget_type(attr), H5Tclose);
+  hid_t type = typeCloser.value();
+  if (H5Tget_class(type) != H5T_STRING) {
+    cerr << "Attribute " << name << " is not a string" << endl;
+    return false;
+  }
+
+  HIDCloser spaceCloser(H5Aget_space(attr), H5Sclose);
+  hssize_t count = H5Sget_simple_extent_npoints(spaceCloser.value());
+  if (count < 0)
+    return false;
+
+  values.clear();
+  values.reserve(static_cast<size_t>(count));
+
+  if (H5Tis_variable_str(type) > 0) {
+    vector<char*> pointers(static_cast<size_t>(count), nullptr);
+    if (H5Aread(attr, type, pointers.data()) < 0) {
+      cerr << "Failed to read attribute " << name << endl;
+      return false;
+    }
+
+    for (char* pointer : pointers)
+      values.emplace_back(pointer ? pointer : "");
+
+    H5Dvlen_reclaim(type, spaceCloser.value(), H5P_DEFAULT,
+                    pointers.data());
+    return true;
+  }
+
+  // Fixed-length strings are read into one contiguous block
+  size_t length = H5Tget_size(type);
+  vector<char> block(static_cast<size_t>(count) * length);
+  if (!block.empty() && H5Aread(attr, type, block.data()) < 0) {
+    cerr << "Failed to read attribute " << name << endl;
+    return false;
+  }
+
+  bool spacePadded = H5Tget_strpad(type) == H5T_STR_SPACEPAD;
+  for (size_t i = 0; i < static_cast<size_t>(count); ++i) {
+    const char* begin = block.data() + i * length;
+    const char* end = std::find(begin, begin + length, '\0');
+    if (spacePadded) {
+      while (end > begin && *(end - 1) == ' ')
+        --end;
+    }
+    values.emplace_back(begin, end);
+  }
+
+  return true;
+}
+
+bool writeAttribute(hid_t objectId, const string& name, hid_t fileTypeId,
+                    hid_t memTypeId, const void* value)
+{
+  hsize_t dims = 1;
+  hid_t dataspaceId = H5Screate_simple(1, &dims, NULL);
+  hid_t attributeId = H5Acreate2(objectId, name.c_str(), fileTypeId,
+                                 dataspaceId, H5P_DEFAULT, H5P_DEFAULT);
+
+  HIDCloser attributeCloser(attributeId, H5Aclose);
+  HIDCloser dataspaceCloser(dataspaceId, H5Sclose);
+
+  return H5Awrite(attributeId, memTypeId, value) >= 0;
+}
+
+hid_t createVariableStringType()
+{
+  hid_t dataType = H5Tcopy(H5T_C_S1);
+  HIDCloser dataTypeCloser(dataType, H5Tclose);
+
+  if (H5Tset_size(dataType, H5T_VARIABLE) < 0) {
+    cerr << "Failed to set the size\n";
+    return H5I_INVALID_HID;
+  }
+
+  return dataTypeCloser.release();
+}
+
+bool writeStringAttribute(hid_t objectId, const string& name,
+                          const string& value)
+{
+  HIDCloser dataTypeCloser(createVariableStringType(), H5Tclose);
+  if (!dataTypeCloser.valueIsValid())
+    return false;
+
+  // Variable-length strings are written from an array of pointers
+  hid_t dataType = dataTypeCloser.value();
+  const char* str = value.c_str();
+  return writeAttribute(objectId, name, dataType, dataType, &str);
+}
+
+} // namespace h5
@@ -0,0 +1,225 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5Utils_h
+#define tomvizH5Utils_h
+
+// Internal helpers shared by H5ReadWrite, DataSet and Group. They operate
+// on open HDF5 identifiers rather than paths.
+
+#include <string>
+#include <vector>
+
+#include "h5capi.h"
+#include "h5quantize.h"
+#include "h5readwrite.h"
+#include "h5writeoptions.h"
+
+namespace h5 {
+
+/**
+ * Convert an H5 type to our DataType, or DataType::None if unknown. The
+ * type is classified by its class, size and sign, in either byte order.
+ */
+H5ReadWrite::DataType h5ToDataType(hid_t h5type);
+
+/**
+ * Whether data of the type @p stored can be read as @p requested: the
+ * types are the same, or Float16 data is read as Float.
+ */
+bool readableAs(H5ReadWrite::DataType stored,
+                H5ReadWrite::DataType requested);
+
+/** Check that an H5 type is classified as @p expected, or readable as it */
+bool typeMatches(hid_t typeId, H5ReadWrite::DataType expected);
+
+/** Get the dimensions of an open data set */
+bool dataSetDimensions(hid_t dataSetId, std::vector<hsize_t>& dims);
+
+/**
+ * Check that the type of an open data set is @p expected, or readable as
+ * it. Quantized data sets are readable as Float.
+ */
+bool dataSetTypeMatches(hid_t dataSetId, H5ReadWrite::DataType expected);
+
+/** Select a hyperslab in a data space, checking it against the extents */
+bool selectHyperslab(hid_t dataSpaceId, const std::vector<hsize_t>& start,
+                     const std::vector<hsize_t>& counts);
+
+/** Read a hyperslab of an open data set into contiguous memory */
+bool readHyperslab(hid_t dataSetId, const std::vector<hsize_t>& start,
+                   const std::vector<hsize_t>& counts, hid_t memTypeId,
+                   hid_t transferId, void* data);
+
+/** Write contiguous memory to a hyperslab of an open data set */
+bool writeHyperslab(hid_t dataSetId, const std::vector<hsize_t>& start,
+                    const std::vector<hsize_t>& counts, hid_t memTypeId,
+                    hid_t transferId, const void* data);
+
+/**
+ * Get the quantization of an open data set, if it holds quantized floats:
+ * integers with a scale_factor attribute, and optionally add_offset.
+ * @return True if the data set is quantized.
+ */
+bool quantization(hid_t dataSetId, Quantization& quantization);
+
+/**
+ * H5Dread, except that h5cpp converts float memory itself: Float16 data
+ * sets are widened with a vectorized conversion, since HDF5 converts half
+ * precision one element at a time, and quantized data sets are restored
+ * from their integers. Boxes of files that are opened read-only are
+ * served from, and kept in, the SlabCache when it is enabled.
+ */
+bool readElements(hid_t dataSetId, hid_t memTypeId, hid_t memSpaceId,
+                  hid_t fileSpaceId, hid_t transferId, void* data);
+
+/**
+ * H5Dwrite, except that float memory is narrowed for Float16 data sets,
+ * and quantized for quantized data sets, like readElements().
+ */
+bool writeElements(hid_t dataSetId, hid_t memTypeId, hid_t memSpaceId,
+                   hid_t fileSpaceId, hid_t transferId, const void* data);
+
+/**
+ * Print an error for each filter of an open data set that HDF5 does not
+ * have, such as after a read failed.
+ */
+void reportUnavailableFilters(hid_t dataSetId);
+
+/** The storage layout that @p options resolves to for a data set */
+WriteOptions::Layout chooseLayout(const std::vector<hsize_t>& dims,
+                                  size_t elementSize,
+                                  const WriteOptions& options);
+
+/**
+ * Returns a new data set creation property list with the storage layout
+ * chosen from @p options, or a negative value on failure. The caller is
+ * responsible for closing it.
+ */
+hid_t createDataSetPropertyList(const std::vector<hsize_t>& dims,
+                                size_t elementSize,
+                                const WriteOptions& options);
+
+/**
+ * Create the data set @p name in an open group and write @p data to it.
+ * The storage layout is chosen from @p options. Float data is quantized if
+ * WriteOptions::quantizeBits is set, or stored as Float16 if
+ * WriteOptions::storeFloat16 is.
+ */
+bool writeDataSet(hid_t groupId, const std::string& name,
+                  const std::vector<int>& dims, hid_t dataTypeId,
+                  hid_t memTypeId, hid_t transferId, const void* data,
+                  const WriteOptions& options);
+
+/**
+ * Create the data set @p name in an open group with the creation property
+ * list @p createId. Returns the new data set, or a negative value on
+ * failure. The caller is responsible for closing it.
+ */
+hid_t createDataSet(hid_t groupId, const std::string& name,
+                    const std::vector<int>& dims, hid_t dataTypeId,
+                    hid_t createId);
+
+/**
+ * Create the data set @p name of type @p type in an open group, without
+ * writing to it. The storage layout and the allocation are chosen from
+ * @p options. Returns the new data set, or a negative value on failure.
+ * The caller is responsible for closing it.
+ */
+hid_t createEmptyDataSet(hid_t groupId, const std::string& name,
+                         const std::vector<int>& dims,
+                         H5ReadWrite::DataType type,
+                         const WriteOptions& options);
+
+/**
+ * Create the data set @p name in an open group with the integers that
+ * quantize @p data to WriteOptions::quantizeBits bits, see
+ * chooseQuantization(), and the attributes scale_factor and add_offset
+ * that restore it. Returns the new data set, or a negative value on
+ * failure. The caller is responsible for closing it.
+ */
+hid_t createQuantizedDataSet(hid_t groupId, const std::string& name,
+                             const std::vector<int>& dims, const float* data,
+                             hid_t transferId, const WriteOptions& options);
+
+/**
+ * Read a fixed or variable-length string data set with a single H5Dread,
+ * into one block of memory. The shape of @p table is set to the
+ * dimensions of the data set.
+ */
+bool readStringDataSet(hid_t dataSetId, hid_t transferId,
+                       StringTable& table);
+
+/**
+ * Create the string data set @p name in an open group and write
+ * @p values to it, as variable-length strings unless
+ * WriteOptions::fixedLengthStrings is set.
+ */
+bool writeStringDataSet(hid_t groupId, const std::string& name,
+                        const std::vector<int>& dims,
+                        const std::vector<std::string>& values,
+                        hid_t transferId, const WriteOptions& options);
+
+/**
+ * Read members of a 1-dimensional compound data set into columns, with a
+ * memory type that holds only those members.
+ */
+bool readCompoundColumns(hid_t dataSetId, hid_t transferId,
+                         const std::vector<Column>& columns);
+
+/**
+ * Create the 1-dimensional compound data set @p name in an open group,
+ * with one member per column, and write the columns to it.
+ */
+bool writeCompoundDataSet(hid_t groupId, const std::string& name,
+                          int length, const std::vector<ConstColumn>& columns,
+                          hid_t transferId, const WriteOptions& options);
+
+/** Get the names of the children of an open group */
+bool groupChildren(hid_t groupId, std::vector<std::string>& names);
+
+/**
+ * Read the attribute @p name of the object at @p path, relative to
+ * @p locationId (use "." for the location itself). The type of the
+ * attribute must be @p expected.
+ */
+bool readAttribute(hid_t locationId, const std::string& path,
+                   const std::string& name, H5ReadWrite::DataType expected,
+                   hid_t memTypeId, void* value);
+
+/** Read a fixed or variable-length string attribute */
+bool readStringAttribute(hid_t locationId, const std::string& path,
+                         const std::string& name, std::string& value);
+
+/**
+ * Read every element of the attribute @p name of an open object,
+ * converted to double. The attribute may have any integer or floating
+ * point type.
+ */
+bool readNumericAttribute(hid_t objectId, const std::string& name,
+                          std::vector<double>& values);
+
+/**
+ * Read every element of a fixed or variable-length string attribute of
+ * an open object.
+ */
+bool readStringAttributeValues(hid_t objectId, const std::string& name,
+                               std::vector<std::string>& values);
+
+/** Create a scalar-like (1 element) attribute on an open object */
+bool writeAttribute(hid_t objectId, const std::string& name,
+                    hid_t fileTypeId, hid_t memTypeId, const void* value);
+
+/**
+ * Returns a new variable-length string type, or a negative value on
+ * failure. The caller is responsible for closing it.
+ */
+hid_t createVariableStringType();
+
+/** Create a variable-length string attribute on an open object */
+bool writeStringAttribute(hid_t objectId, const std::string& name,
+                          const std::string& value);
+
+} // namespace h5
+
+#endif // tomvizH5Utils_h
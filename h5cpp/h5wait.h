@@ -0,0 +1,32 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5Wait_h
+#define tomvizH5Wait_h
+
+// Internal helper for the classes that hand work between threads.
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace h5 {
+
+/**
+ * Wait on @p condition until @p predicate is true, like
+ * std::condition_variable::wait(). libstdc++ 12 gave wait() a new symbol
+ * version, and the older runtimes that ship with some Python
+ * distributions lack it, so this waits in timed steps instead. The timed
+ * waits are inline, and notifications still wake them right away.
+ */
+template <typename Predicate>
+void waitUntil(std::condition_variable& condition,
+               std::unique_lock<std::mutex>& lock, Predicate predicate)
+{
+  while (!predicate())
+    condition.wait_for(lock, std::chrono::milliseconds(100));
+}
+
+} // namespace h5
+
+#endif // tomvizH5Wait_h
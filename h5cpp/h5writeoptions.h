@@ -0,0 +1,150 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizH5WriteOptions_h
+#define tomvizH5WriteOptions_h
+
+#include <cstddef>
+#include <vector>
+
+namespace h5 {
+
+/**
+ * Options controlling how data sets are created by writeData(). A default
+ * constructed WriteOptions picks the storage layout automatically.
+ */
+struct WriteOptions
+{
+  /** Enumeration of the storage layouts */
+  enum class Layout {
+    Automatic,  // Chosen from the size of the data set, see below
+    Compact,    // Stored inline in the object header (< 64 KiB only)
+    Contiguous, // Stored in one block in the file
+    Chunked     // Stored in chunks of chunkDimensions
+  };
+
+  /** Enumeration of the compression codecs */
+  enum class Compression {
+    None,
+    Deflate, // Built into HDF5. Slow, but every reader has it.
+    LZ4,     // HDF5 filter 32004, built in with H5CPP_USE_LZ4
+    Zstd     // HDF5 filter 32015, built in with H5CPP_USE_ZSTD
+  };
+
+  /** Enumeration of the times at which the space of data is allocated */
+  enum class Allocation {
+    Default,     // Early for compact, late for contiguous, incremental
+                 // for chunked data sets (early for parallel files)
+    Early,       // All of it when the data set is created
+    Incremental, // Each chunk when it is first written (late if not chunked)
+    Late         // All of it when the data set is first written
+  };
+
+  /** Enumeration of the times at which fill values are written */
+  enum class FillTime {
+    Default, // When the space is allocated, if a fill value is defined
+    Always,  // When the space is allocated
+    Never    // Never: unwritten elements hold whatever the file held
+  };
+
+  /**
+   * The storage layout. With Layout::Automatic, data sets smaller than
+   * compactLimit bytes are compact, data sets of at least chunkedLimit
+   * bytes are chunked, and everything in between is contiguous.
+   */
+  Layout layout = Layout::Automatic;
+
+  /**
+   * Access pattern hint: the axis along which the data set will be read
+   * one slice at a time, or -1 if unknown. Chunks that are chosen
+   * automatically are one element thick along this axis, so that reading
+   * a slice does not read any data outside of it.
+   */
+  int sliceAxis = -1;
+
+  /**
+   * The chunk dimensions. If empty, they are chosen automatically from
+   * sliceAxis and chunkBytes. Setting them implies Layout::Chunked when
+   * the layout is Automatic.
+   */
+  std::vector<int> chunkDimensions;
+
+  /** The target size of automatically chosen chunks in bytes. */
+  size_t chunkBytes = 1024 * 1024;
+
+  /** Data sets smaller than this are compact in Automatic layout. */
+  size_t compactLimit = 16 * 1024;
+
+  /** Data sets at least this large are chunked in Automatic layout. */
+  size_t chunkedLimit = 64 * 1024 * 1024;
+
+  /**
+   * The compression of the chunks. Compression implies Layout::Chunked
+   * when the layout is Automatic, and cannot be used with the other
+   * layouts. Files that use LZ4 or Zstd can be read by any program that
+   * has the HDF5 filter plugin of the same id.
+   */
+  Compression compression = Compression::None;
+
+  /**
+   * The compression level, or 0 for the default of the codec (6 for
+   * Deflate, 3 for Zstd). LZ4 has no levels.
+   */
+  int compressionLevel = 0;
+
+  /**
+   * Shuffle the bytes of the elements of each chunk before it is
+   * compressed, so that bytes of equal significance are next to each
+   * other. Numeric data usually compresses much better, for little cost.
+   * It is ignored without compression.
+   */
+  bool shuffle = true;
+
+  /**
+   * Store float data as Float16, halving its size. The values are rounded
+   * to the nearest half-precision value: about 3 significant digits
+   * remain, and magnitudes beyond 65504 become infinite. It is ignored for
+   * other types.
+   */
+  bool storeFloat16 = false;
+
+  /**
+   * Quantize float data to integers of this many bits, from 1 to 16, or 0
+   * to store the floats. The range of the finite values is divided into
+   * 2^bits - 1 steps, and each value is restored to within about half a
+   * step. NaNs become the smallest value, and infinities are clamped. The
+   * codes are stored as 8 or 16-bit unsigned integers, with the attributes
+   * scale_factor and add_offset of the CF conventions, and reading the
+   * data set as float restores the values. Uncompressed chunks are packed
+   * to exactly these bits. It takes precedence over storeFloat16, and is
+   * ignored for other types.
+   */
+  int quantizeBits = 0;
+
+  /**
+   * Write strings with a fixed length, that of the longest string, rather
+   * than as variable-length strings. Fixed-length strings take more space
+   * when the lengths vary a lot, but can be compressed and are read
+   * without any per-string allocations by HDF5.
+   */
+  bool fixedLengthStrings = false;
+
+  /**
+   * When the space of the data set is allocated in the file. Compact data
+   * sets are always allocated early.
+   */
+  Allocation allocation = Allocation::Default;
+
+  /**
+   * When fill values are written. HDF5 fills the space of contiguous data
+   * sets that are written in slabs before the first slab is written, so a
+   * large data set that is created empty with createDataSet() and filled
+   * slab by slab is written twice by default. FillTime::Never writes it
+   * once, for data sets that will be written completely.
+   */
+  FillTime fillTime = FillTime::Default;
+};
+
+} // namespace h5
+
+#endif // tomvizH5WriteOptions_h
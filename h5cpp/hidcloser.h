@@ -4,6 +4,8 @@
 #ifndef tomvizHIDCloser_h
 #define tomvizHIDCloser_h
 
+#include <utility>
+
 #include "h5capi.h"
 
 namespace h5 {
@@ -21,6 +23,14 @@ public:
 
   hid_t value() { return m_value; }
 
+  // Give up ownership of the value without closing it
+  hid_t release()
+  {
+    hid_t result = m_value;
+    m_value = H5I_INVALID_HID;
+    return result;
+  }
+
   herr_t close()
   {
     herr_t result = 0;
@@ -44,6 +54,7 @@ public:
     if (this != &other) {
       close();
       m_value = other.m_value;
+      m_closer = other.m_closer;
       other.m_value = H5I_INVALID_HID;
     }
     return *this;
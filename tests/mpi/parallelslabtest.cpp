@@ -0,0 +1,55 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::H5ReadWrite;
+
+static const string test_file = "parallel_slab_test.h5";
+
+TEST(ParallelSlabTest, collectiveWriteAndRead)
+{
+  int rank = 0, size = 1;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  // Each rank owns rowsPerRank rows of the volume
+  const int rowsPerRank = 3;
+  const int columns = 4;
+
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly,
+                       MPI_COMM_WORLD);
+
+    // Creating the data set is collective, so every rank passes the same
+    // arguments. Then every rank overwrites its own rows.
+    vector<int> empty(size * rowsPerRank * columns, -1);
+    EXPECT_TRUE(writer.writeData("/", "volume",
+                                 { size * rowsPerRank, columns }, empty));
+
+    vector<int> rows(rowsPerRank * columns, rank);
+    EXPECT_TRUE(writer.writeSlab("/volume", { rank * rowsPerRank, 0 },
+                                 { rowsPerRank, columns }, rows.data()));
+  }
+
+  H5ReadWrite reader(test_file, H5ReadWrite::OpenMode::ReadOnly,
+                     MPI_COMM_WORLD);
+
+  // Every rank reads the rows of the next rank
+  int next = (rank + 1) % size;
+  vector<int> rows(rowsPerRank * columns);
+  EXPECT_TRUE(reader.readSlab("/volume", { next * rowsPerRank, 0 },
+                              { rowsPerRank, columns }, rows.data()));
+  for (int value : rows)
+    EXPECT_EQ(value, next);
+}
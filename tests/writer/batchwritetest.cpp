@@ -0,0 +1,126 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <complex>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5batchwrite.h>
+#include <h5cpp/h5float16.h>
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::BatchWrite;
+using h5::float16;
+using h5::H5ReadWrite;
+using h5::WriteOptions;
+
+static const string test_file = "batchwrite_test.h5";
+
+TEST(BatchWriteTest, commit)
+{
+  BatchWrite batch;
+  batch.createGroup("/data/tomography");
+
+  {
+    // The data is copied when it is added
+    vector<float> angles = { -60.f, 0.f, 60.f };
+    batch.writeData("/data/tomography", "angles", { 3 }, angles.data());
+  }
+
+  vector<int> volume(4 * 4 * 4, 7);
+  WriteOptions chunked;
+  chunked.layout = WriteOptions::Layout::Chunked;
+  batch.writeData("/data/tomography", "volume", { 4, 4, 4 }, volume.data(),
+                  chunked);
+
+  // Intermediate groups are created on demand
+  for (int i = 0; i < 100; ++i) {
+    string name = "value" + std::to_string(i);
+    batch.writeData("metadata/values/", name, { 1 }, &i);
+    batch.setAttribute("/metadata/values/" + name, "index", i);
+  }
+
+  batch.setAttribute("/data/tomography", "units", "nm")
+    .setAttribute("/data/tomography/angles", "scale", 0.5)
+    .setAttribute("/", "version", "1.0");
+
+  EXPECT_EQ(batch.size(), 206);
+
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(writer.commit(batch));
+  }
+
+  H5ReadWrite reader(test_file);
+  EXPECT_EQ(reader.readData<float>("/data/tomography/angles"),
+            vector<float>({ -60.f, 0.f, 60.f }));
+  vector<int> dims;
+  EXPECT_EQ(reader.readData<int>("/data/tomography/volume", dims), volume);
+  EXPECT_EQ(dims, vector<int>({ 4, 4, 4 }));
+  EXPECT_EQ(reader.storageLayout("/data/tomography/volume"),
+            WriteOptions::Layout::Chunked);
+  EXPECT_EQ(reader.storageLayout("/data/tomography/angles"),
+            WriteOptions::Layout::Compact);
+
+  EXPECT_EQ(reader.children("/metadata/values").size(), 100);
+  EXPECT_EQ(reader.readData<int>("/metadata/values/value42"),
+            vector<int>({ 42 }));
+  EXPECT_EQ(reader.attribute<int>("/metadata/values/value42", "index"), 42);
+
+  EXPECT_EQ(reader.attribute<string>("/data/tomography", "units"), "nm");
+  EXPECT_EQ(reader.attribute<double>("/data/tomography/angles", "scale"), 0.5);
+  EXPECT_EQ(reader.attribute<string>("/", "version"), "1.0");
+}
+
+TEST(BatchWriteTest, extendedTypes)
+{
+  vector<float16> halves = { float16(1.5f), float16(-2.0f) };
+  vector<std::complex<float>> complexes = { { 1.f, 2.f }, { -3.f, 4.f } };
+  vector<std::complex<double>> wide = { { 0.5, -0.25 } };
+
+  BatchWrite batch;
+  batch.writeData("/", "halves", { 2 }, halves.data())
+    .writeData("/", "complexes", { 2 }, complexes.data())
+    .writeData("/", "wide", { 1 }, H5ReadWrite::DataType::Complex128,
+               wide.data())
+    .setAttribute("/halves", "scale", float16(0.5f));
+
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(writer.commit(batch));
+  }
+
+  H5ReadWrite reader(test_file);
+  EXPECT_EQ(reader.dataType("/halves"), H5ReadWrite::DataType::Float16);
+  EXPECT_EQ(reader.readData<float>("/halves"), vector<float>({ 1.5f, -2.f }));
+  EXPECT_EQ(reader.attribute<float16>("/halves", "scale").bits,
+            float16(0.5f).bits);
+  EXPECT_EQ(reader.readData<std::complex<float>>("/complexes"), complexes);
+  EXPECT_EQ(reader.readData<std::complex<double>>("/wide"), wide);
+}
+
+TEST(BatchWriteTest, invalidBatchWritesNothing)
+{
+  BatchWrite batch;
+  batch.createGroup("/first");
+  batch.writeData("/first", "strings", { 1 }, H5ReadWrite::DataType::String,
+                  "x");
+
+  H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+  EXPECT_FALSE(writer.commit(batch));
+  EXPECT_TRUE(writer.children("/").empty());
+
+  // A failure part way stops the batch
+  BatchWrite failing;
+  failing.createGroup("/second")
+    .setAttribute("/missing", "value", 1)
+    .createGroup("/third");
+
+  EXPECT_FALSE(writer.commit(failing));
+  EXPECT_EQ(writer.children("/"), vector<string>({ "second" }));
+}
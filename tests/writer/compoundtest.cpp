@@ -0,0 +1,62 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5compound.h>
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::H5ReadWrite;
+using h5::column;
+
+using DataType = H5ReadWrite::DataType;
+
+static const string test_file = "compound_test.h5";
+
+TEST(CompoundTest, columns)
+{
+  vector<double> x = { 0.5, 1.5, 2.5, 3.5 };
+  vector<float> weight = { 1.f, 2.f, 3.f, 4.f };
+  vector<long long> id = { 10, 11, 12, 13 };
+
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(writer.writeColumns("/", "particles", 4,
+                                    { column("x", x.data()),
+                                      column("weight", weight.data()),
+                                      column("id", id.data()) }));
+  }
+
+  H5ReadWrite reader(test_file);
+  EXPECT_EQ(reader.dataType("/particles"), DataType::Compound);
+
+  bool ok = false;
+  EXPECT_EQ(reader.compoundMembers("/particles", &ok),
+            vector<string>({ "x", "weight", "id" }));
+  EXPECT_TRUE(ok);
+  EXPECT_EQ(reader.compoundMemberType("/particles", "weight"),
+            DataType::Float);
+  EXPECT_EQ(reader.compoundMemberType("/particles", "id"), DataType::Int64);
+  EXPECT_EQ(reader.compoundMemberType("/particles", "missing"),
+            DataType::None);
+
+  // Two of the three members, in a different order
+  vector<long long> ids(4);
+  vector<double> xs(4);
+  ASSERT_TRUE(reader.readColumns(
+    "/particles", { column("id", ids.data()), column("x", xs.data()) }));
+  EXPECT_EQ(ids, id);
+  EXPECT_EQ(xs, x);
+
+  EXPECT_EQ(reader.readColumn<float>("/particles", "weight"), weight);
+
+  // The types must match
+  EXPECT_TRUE(reader.readColumn<int>("/particles", "id").empty());
+  EXPECT_TRUE(reader.readColumn<float>("/particles", "missing").empty());
+}
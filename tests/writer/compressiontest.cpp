@@ -0,0 +1,203 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5capi.h>
+#include <h5cpp/h5filters.h>
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::H5ReadWrite;
+using h5::WriteOptions;
+
+using Compression = WriteOptions::Compression;
+using Layout = WriteOptions::Layout;
+
+static const string test_file = "compression_test.h5";
+
+static size_t fileSize(const string& fileName)
+{
+  std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+  return static_cast<size_t>(file.tellg());
+}
+
+// A smooth 64^3 volume of 16-bit values, which compresses well
+static vector<unsigned short> volume()
+{
+  vector<unsigned short> data(64 * 64 * 64);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<unsigned short>(1000 + (i / 64) % 512);
+  return data;
+}
+
+static void roundTrip(Compression compression, bool shuffle)
+{
+  vector<unsigned short> data = volume();
+  WriteOptions options;
+  options.compression = compression;
+  options.shuffle = shuffle;
+
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(writer.writeData("/", "data", { 64, 64, 64 }, data,
+                                 options));
+
+    // Compression implies chunking
+    EXPECT_EQ(writer.storageLayout("/data"), Layout::Chunked);
+  }
+
+  EXPECT_LT(fileSize(test_file), data.size() * sizeof(data[0]) / 4);
+
+  H5ReadWrite reader(test_file);
+  vector<int> dims;
+  EXPECT_EQ(reader.readData<unsigned short>("/data", dims), data);
+
+  vector<unsigned short> slab(2 * 3 * 4);
+  ASSERT_TRUE(reader.readSlab("/data", { 10, 20, 30 }, { 2, 3, 4 },
+                              slab.data()));
+  EXPECT_EQ(slab[0], data[(10 * 64 + 20) * 64 + 30]);
+}
+
+TEST(CompressionTest, deflate)
+{
+  ASSERT_TRUE(h5::compressionAvailable(Compression::Deflate));
+  roundTrip(Compression::Deflate, true);
+  roundTrip(Compression::Deflate, false);
+}
+
+TEST(CompressionTest, lz4)
+{
+  if (!h5::compressionAvailable(Compression::LZ4))
+    GTEST_SKIP() << "LZ4 is not built in";
+
+  roundTrip(Compression::LZ4, true);
+  roundTrip(Compression::LZ4, false);
+}
+
+TEST(CompressionTest, zstd)
+{
+  if (!h5::compressionAvailable(Compression::Zstd))
+    GTEST_SKIP() << "Zstandard is not built in";
+
+  roundTrip(Compression::Zstd, true);
+  roundTrip(Compression::Zstd, false);
+}
+
+TEST(CompressionTest, incompressible)
+{
+  if (!h5::compressionAvailable(Compression::LZ4))
+    GTEST_SKIP() << "LZ4 is not built in";
+
+  // Blocks that do not compress are stored as they are
+  vector<unsigned int> noise(4096);
+  unsigned int state = 12345;
+  for (auto& value : noise) {
+    state = state * 1664525u + 1013904223u;
+    value = state;
+  }
+
+  WriteOptions options;
+  options.compression = Compression::LZ4;
+  options.shuffle = false;
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(writer.writeData("/", "noise", { 4096 }, noise, options));
+  }
+
+  H5ReadWrite reader(test_file);
+  EXPECT_EQ(reader.readData<unsigned int>("/noise"), noise);
+}
+
+TEST(CompressionTest, layouts)
+{
+  H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+  vector<int> data(100, 1);
+
+  WriteOptions options;
+  options.compression = Compression::Deflate;
+  options.layout = Layout::Contiguous;
+  EXPECT_FALSE(writer.writeData("/", "contiguous", { 100 }, data, options));
+
+  options.layout = Layout::Compact;
+  EXPECT_FALSE(writer.writeData("/", "compact", { 100 }, data, options));
+
+  // Small data sets are chunked too when they are compressed
+  options.layout = Layout::Automatic;
+  EXPECT_TRUE(writer.writeData("/", "small", { 100 }, data, options));
+  EXPECT_EQ(writer.storageLayout("/small"), Layout::Chunked);
+  EXPECT_EQ(writer.readData<int>("/small"), data);
+}
+
+// Write a data set whose chunk claims to use the filter @p filterId, read
+// it and return what the read reported. Optional filters can be added to
+// a data set although they are not registered, and chunks that are
+// written directly skip the pipeline.
+static string readWithFilter(H5Z_filter_t filterId)
+{
+  vector<unsigned short> data(16, 7);
+  {
+    hid_t fileId = H5Fcreate(test_file.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT,
+                             H5P_DEFAULT);
+    EXPECT_GE(fileId, 0);
+
+    hsize_t dims[] = { 16 };
+    hid_t spaceId = H5Screate_simple(1, dims, nullptr);
+    hid_t createId = H5Pcreate(H5P_DATASET_CREATE);
+    H5Pset_chunk(createId, 1, dims);
+    EXPECT_GE(H5Pset_filter(createId, filterId, H5Z_FLAG_OPTIONAL, 0,
+                            nullptr),
+              0);
+    hid_t dataSetId = H5Dcreate(fileId, "/data", H5T_NATIVE_USHORT, spaceId,
+                                H5P_DEFAULT, createId, H5P_DEFAULT);
+    EXPECT_GE(dataSetId, 0);
+
+    hsize_t offset[] = { 0 };
+    EXPECT_GE(H5Dwrite_chunk(dataSetId, H5P_DEFAULT, 0, offset,
+                             data.size() * sizeof(data[0]), data.data()),
+              0);
+
+    H5Dclose(dataSetId);
+    H5Pclose(createId);
+    H5Sclose(spaceId);
+    H5Fclose(fileId);
+  }
+
+  H5ReadWrite reader(test_file);
+
+  std::stringstream errors;
+  std::streambuf* previous = std::cerr.rdbuf(errors.rdbuf());
+  vector<unsigned short> result(data.size());
+  bool read = reader.readData("/data", result.data());
+  std::cerr.rdbuf(previous);
+
+  EXPECT_FALSE(read);
+  return errors.str();
+}
+
+TEST(CompressionTest, unavailableFilter)
+{
+  // A filter id that no library registers
+  const H5Z_filter_t filterId = 32499;
+  string message = readWithFilter(filterId);
+  EXPECT_NE(message.find("/data needs the HDF5 filter 32499, which is not "
+                         "available. Put its filter plugin on "
+                         "HDF5_PLUGIN_PATH"),
+            string::npos)
+    << message;
+
+  // The filters that h5cpp can build in name their build option
+  if (!h5::compressionAvailable(Compression::LZ4)) {
+    message = readWithFilter(h5::LZ4FilterId);
+    EXPECT_NE(message.find("Build h5cpp with H5CPP_USE_LZ4"), string::npos)
+      << message;
+  }
+}
@@ -0,0 +1,109 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5compressiontuner.h>
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::H5ReadWrite;
+using h5::TuneOptions;
+using h5::TuneResult;
+using h5::WriteOptions;
+
+using Compression = WriteOptions::Compression;
+using Goal = TuneOptions::Goal;
+
+static const string test_file = "compressiontuner_test.h5";
+
+// A smooth volume of 16-bit values, which compresses well
+static vector<unsigned short> volume(int size)
+{
+  vector<unsigned short> data(size * size * size);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<unsigned short>(1000 + (i / size) % 512);
+  return data;
+}
+
+// Keep the test quick with a small sample
+static TuneOptions smallOptions(Goal goal)
+{
+  TuneOptions options;
+  options.goal = goal;
+  options.sampleBytes = 256 * 1024;
+  options.chunkBytes = { 16 * 1024, 64 * 1024 };
+  return options;
+}
+
+TEST(CompressionTunerTest, size)
+{
+  vector<unsigned short> data = volume(64);
+  TuneResult result =
+    h5::tuneCompression(data.data(), { 64, 64, 64 }, smallOptions(Goal::Size));
+
+  ASSERT_TRUE(result.valid);
+  EXPECT_NE(result.options.compression, Compression::None);
+  EXPECT_EQ(result.options.layout, WriteOptions::Layout::Chunked);
+  EXPECT_EQ(result.options.chunkDimensions.size(), 3u);
+  EXPECT_LE(result.sampleBytes, 256u * 1024);
+  EXPECT_GT(result.ratio, 2.0);
+  EXPECT_GT(result.writeMBps, 0.0);
+  EXPECT_GT(result.readMBps, 0.0);
+}
+
+TEST(CompressionTunerTest, sliceAxis)
+{
+  vector<unsigned short> data = volume(64);
+  TuneOptions options = smallOptions(Goal::SliceReadSpeed);
+  options.sliceAxis = 2;
+
+  TuneResult result =
+    h5::tuneCompression(data.data(), { 64, 64, 64 }, options);
+  ASSERT_TRUE(result.valid);
+
+  // Every candidate chunk is one slice thick
+  EXPECT_EQ(result.options.chunkDimensions[2], 1);
+}
+
+TEST(CompressionTunerTest, writeTuned)
+{
+  vector<unsigned short> data = volume(32);
+  TuneResult result;
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(h5::writeTuned(writer, "/", "data", { 32, 32, 32 },
+                               data.data(), smallOptions(Goal::WriteSpeed),
+                               &result));
+  }
+
+  H5ReadWrite reader(test_file);
+  vector<int> dims;
+  EXPECT_EQ(reader.readData<unsigned short>("/data", dims), data);
+  EXPECT_EQ(reader.chunkDimensions("/data"), result.options.chunkDimensions);
+
+  // The choice and the measurements are recorded
+  EXPECT_EQ(reader.attribute<string>("/data", "tuning_goal"), "write speed");
+  EXPECT_TRUE(reader.hasAttribute("/data", "tuning_compression"));
+  EXPECT_EQ(reader.attribute<int>("/data", "tuning_compression_level"),
+            result.options.compressionLevel);
+  EXPECT_DOUBLE_EQ(reader.attribute<double>("/data", "tuning_ratio"),
+                   result.ratio);
+  EXPECT_DOUBLE_EQ(reader.attribute<double>("/data", "tuning_write_mbps"),
+                   result.writeMBps);
+  EXPECT_EQ(reader.attribute<unsigned long long>("/data",
+                                                 "tuning_sample_bytes"),
+            result.sampleBytes);
+}
+
+TEST(CompressionTunerTest, empty)
+{
+  vector<float> data;
+  TuneResult result = h5::tuneCompression(data.data(), { 0, 10 });
+  EXPECT_FALSE(result.valid);
+}
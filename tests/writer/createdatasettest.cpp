@@ -0,0 +1,187 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5batchwrite.h>
+#include <h5cpp/h5dataset.h>
+#include <h5cpp/h5group.h>
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::BatchWrite;
+using h5::DataSet;
+using h5::Group;
+using h5::H5ReadWrite;
+using h5::WriteOptions;
+
+using Allocation = WriteOptions::Allocation;
+using DataType = H5ReadWrite::DataType;
+using FillTime = WriteOptions::FillTime;
+using Layout = WriteOptions::Layout;
+
+static const string test_file = "createdataset_test.h5";
+
+static size_t fileSize(const string& fileName)
+{
+  std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+  return static_cast<size_t>(file.tellg());
+}
+
+TEST(CreateDataSetTest, fillBySlabs)
+{
+  WriteOptions options;
+  options.layout = Layout::Contiguous;
+  options.fillTime = FillTime::Never;
+
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    DataSet dataSet =
+      writer.createDataSet("/", "volume", { 8, 16, 16 }, DataType::Int32,
+                           options);
+    ASSERT_TRUE(dataSet.isValid());
+    EXPECT_EQ(dataSet.path(), "/volume");
+    EXPECT_EQ(dataSet.dimensions(), vector<int>({ 8, 16, 16 }));
+    EXPECT_EQ(dataSet.type(), DataType::Int32);
+
+    vector<int> slice(16 * 16);
+    for (int i = 0; i < 8; ++i) {
+      std::iota(slice.begin(), slice.end(), i * 256);
+      ASSERT_TRUE(dataSet.writeSlab({ i, 0, 0 }, { 1, 16, 16 },
+                                    slice.data()));
+    }
+  }
+
+  H5ReadWrite reader(test_file);
+  EXPECT_EQ(reader.storageLayout("/volume"), Layout::Contiguous);
+
+  vector<int> dims;
+  vector<int> values = reader.readData<int>("/volume", dims);
+  vector<int> expected(8 * 16 * 16);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_EQ(values, expected);
+}
+
+TEST(CreateDataSetTest, largeDataSet)
+{
+  // 1 GiB is created without writing it, whether its space is allocated
+  // late, or early without filling it
+  for (Allocation allocation : { Allocation::Default, Allocation::Early }) {
+    WriteOptions options;
+    options.layout = Layout::Contiguous;
+    options.allocation = allocation;
+    options.fillTime = FillTime::Never;
+
+    auto start = std::chrono::steady_clock::now();
+    {
+      H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+      DataSet dataSet = writer.createDataSet(
+        "/", "large", { 256, 1024, 1024 }, DataType::Float, options);
+      ASSERT_TRUE(dataSet.isValid());
+
+      vector<float> row(1024, 2.5f);
+      ASSERT_TRUE(dataSet.writeSlab({ 200, 3, 0 }, { 1, 1, 1024 },
+                                    row.data()));
+    }
+    auto seconds = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+    EXPECT_LT(seconds, 5.0);
+
+    H5ReadWrite reader(test_file);
+    vector<float> row(1024);
+    ASSERT_TRUE(reader.readSlab("/large", { 200, 3, 0 }, { 1, 1, 1024 },
+                                row.data()));
+    EXPECT_EQ(row, vector<float>(1024, 2.5f));
+  }
+
+  std::remove(test_file.c_str());
+}
+
+TEST(CreateDataSetTest, chunked)
+{
+  WriteOptions options;
+  options.chunkDimensions = { 1, 32, 32 };
+  options.allocation = Allocation::Incremental;
+  options.fillTime = FillTime::Always;
+
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    Group root = writer.openGroup("/");
+    DataSet dataSet =
+      root.createDataSet("chunks", { 64, 32, 32 }, DataType::UInt16, options);
+    ASSERT_TRUE(dataSet.isValid());
+    EXPECT_EQ(dataSet.path(), "/chunks");
+
+    vector<unsigned short> slice(32 * 32, 7);
+    ASSERT_TRUE(dataSet.writeSlab({ 10, 0, 0 }, { 1, 32, 32 },
+                                  slice.data()));
+  }
+
+  // Only the written chunk is allocated
+  EXPECT_LT(fileSize(test_file), 64 * 32 * 32 * 2 / 4);
+
+  H5ReadWrite reader(test_file);
+  EXPECT_EQ(reader.storageLayout("/chunks"), Layout::Chunked);
+
+  vector<int> dims;
+  vector<unsigned short> values =
+    reader.readData<unsigned short>("/chunks", dims);
+  ASSERT_EQ(values.size(), 64u * 32 * 32);
+  for (size_t i = 0; i < values.size(); ++i)
+    ASSERT_EQ(values[i], i / (32 * 32) == 10 ? 7 : 0);
+}
+
+TEST(CreateDataSetTest, options)
+{
+  H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+
+  // Compact data sets are allocated early whatever the allocation
+  WriteOptions options;
+  options.layout = Layout::Compact;
+  options.allocation = Allocation::Late;
+  EXPECT_TRUE(
+    writer.createDataSet("/", "compact", { 4, 4 }, DataType::Double, options)
+      .isValid());
+
+  options = WriteOptions();
+  options.storeFloat16 = true;
+  DataSet half =
+    writer.createDataSet("/", "half", { 4, 4 }, DataType::Float, options);
+  ASSERT_TRUE(half.isValid());
+  EXPECT_EQ(half.type(), DataType::Float16);
+
+  // There is no data to quantize
+  options = WriteOptions();
+  options.quantizeBits = 8;
+  EXPECT_FALSE(
+    writer.createDataSet("/", "quantized", { 4, 4 }, DataType::Float, options)
+      .isValid());
+
+  EXPECT_FALSE(writer.createDataSet("/missing", "data", { 4, 4 },
+                                    DataType::Float)
+                 .isValid());
+
+  // Batches honor the allocation too
+  options = WriteOptions();
+  options.layout = Layout::Contiguous;
+  options.allocation = Allocation::Early;
+  options.fillTime = FillTime::Never;
+  vector<double> values(100, 1.5);
+  BatchWrite batch;
+  batch.writeData("/batch", "values", { 100 }, values.data(), options);
+  ASSERT_TRUE(writer.commit(batch));
+  EXPECT_EQ(writer.readData<double>("/batch/values"), values);
+
+  // Run this last
+  std::remove(test_file.c_str());
+}
@@ -0,0 +1,135 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5dataset.h>
+#include <h5cpp/h5group.h>
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::DataSet;
+using h5::Group;
+using h5::H5ReadWrite;
+using h5::NDArray;
+
+static const string test_file = "dataset_test.h5";
+
+TEST(DataSetTest, groupHandles)
+{
+  H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+
+  Group root = writer.openGroup("/");
+  ASSERT_TRUE(root.isValid());
+
+  Group data = root.createGroup("data");
+  ASSERT_TRUE(data.isValid());
+  EXPECT_EQ(data.path(), "/data");
+
+  Group nested = data.createGroup("nested");
+  ASSERT_TRUE(nested.isValid());
+  EXPECT_EQ(nested.path(), "/data/nested");
+
+  vector<int> values(6 * 4);
+  std::iota(values.begin(), values.end(), 0);
+  EXPECT_TRUE(data.writeData("values", { 6, 4 }, values.data()));
+
+  NDArray<double> array({ 3 });
+  array[0] = 1.5;
+  array[1] = 2.5;
+  array[2] = 3.5;
+  EXPECT_TRUE(nested.writeData("array", array));
+
+  EXPECT_TRUE(data.setAttribute("units", "nm"));
+  EXPECT_TRUE(data.setAttribute("scale", 0.25f));
+
+  bool ok = false;
+  vector<string> children = data.children(&ok);
+  EXPECT_TRUE(ok);
+  EXPECT_EQ(children, vector<string>({ "nested", "values" }));
+
+  EXPECT_TRUE(data.hasAttribute("units"));
+  EXPECT_FALSE(data.hasAttribute("missing"));
+  EXPECT_EQ(data.attribute<string>("units", &ok), "nm");
+  EXPECT_TRUE(ok);
+  EXPECT_EQ(data.attribute<float>("scale", &ok), 0.25f);
+  EXPECT_TRUE(ok);
+
+  // Wrong type
+  data.attribute<int>("scale", &ok);
+  EXPECT_FALSE(ok);
+
+  // The path-based API sees the same file
+  EXPECT_EQ(writer.attribute<string>("/data", "units"), "nm");
+
+  // Missing children give invalid handles
+  EXPECT_FALSE(root.openGroup("missing").isValid());
+  EXPECT_FALSE(root.openDataSet("missing").isValid());
+  EXPECT_FALSE(Group().isValid());
+}
+
+TEST(DataSetTest, dataSetHandle)
+{
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    vector<int> values(6 * 4);
+    std::iota(values.begin(), values.end(), 0);
+    ASSERT_TRUE(writer.writeData("/", "values", { 6, 4 }, values.data()));
+  }
+
+  H5ReadWrite file(test_file, H5ReadWrite::OpenMode::ReadWrite);
+  DataSet dataSet = file.openDataSet("/values");
+  ASSERT_TRUE(dataSet.isValid());
+  EXPECT_EQ(dataSet.path(), "/values");
+  EXPECT_EQ(dataSet.type(), H5ReadWrite::DataType::Int32);
+  EXPECT_EQ(dataSet.dimensionCount(), 2);
+  EXPECT_EQ(dataSet.dimensions(), vector<int>({ 6, 4 }));
+
+  NDArray<int> all;
+  ASSERT_TRUE(dataSet.readData(all));
+  EXPECT_EQ(all.shape(), vector<int>({ 6, 4 }));
+  EXPECT_EQ(all(5, 3), 23);
+
+  // The type is checked
+  vector<float> wrong(6 * 4);
+  EXPECT_FALSE(dataSet.readData(wrong.data()));
+
+  NDArray<int> slab;
+  ASSERT_TRUE(dataSet.readSlab({ 2, 1 }, { 2, 2 }, slab));
+  EXPECT_EQ(slab(0, 0), 9);
+  EXPECT_EQ(slab(1, 1), 14);
+
+  // Write through the handle, and read back through the handle
+  vector<int> block = { -1, -2, -3, -4 };
+  ASSERT_TRUE(dataSet.writeSlab({ 0, 0 }, { 2, 2 }, block.data()));
+  ASSERT_TRUE(dataSet.readSlab({ 0, 0 }, { 2, 2 }, slab));
+  EXPECT_EQ(slab(0, 0), -1);
+  EXPECT_EQ(slab(1, 1), -4);
+
+  vector<int> generic(4);
+  ASSERT_TRUE(dataSet.readSlab({ 1, 0 }, { 1, 4 },
+                               H5ReadWrite::DataType::Int32, generic.data()));
+  EXPECT_EQ(generic, vector<int>({ -3, -4, 6, 7 }));
+
+  EXPECT_TRUE(dataSet.setAttribute("count", 24));
+  EXPECT_TRUE(dataSet.hasAttribute("count"));
+  EXPECT_EQ(dataSet.attribute<int>("count"), 24);
+
+  // Handles can be moved
+  DataSet moved = std::move(dataSet);
+  EXPECT_FALSE(dataSet.isValid());
+  ASSERT_TRUE(moved.isValid());
+  EXPECT_EQ(moved.dimensions(), vector<int>({ 6, 4 }));
+
+  vector<int> zeros(6 * 4, 0);
+  ASSERT_TRUE(moved.writeData(zeros.data()));
+  ASSERT_TRUE(moved.readData(all));
+  EXPECT_EQ(all(0, 0), 0);
+  EXPECT_EQ(all(5, 3), 0);
+}
@@ -0,0 +1,117 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5capi.h>
+#include <h5cpp/h5dataset.h>
+#include <h5cpp/h5dispatch.h>
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::DataSet;
+using h5::DataTypeOf;
+using h5::H5ReadWrite;
+using h5::TypeTag;
+
+using DataType = H5ReadWrite::DataType;
+
+static const string test_file = "dispatch_test.h5";
+
+namespace {
+
+struct SizeVisitor
+{
+  size_t& size;
+
+  template <typename T>
+  void operator()(TypeTag<T>) const
+  {
+    size = sizeof(T);
+  }
+};
+
+// Write a data set with an explicit file type through the C API
+void writeRaw(hid_t fileId, const char* name, hid_t fileType, hid_t memType,
+              const void* data, hsize_t size)
+{
+  hid_t space = H5Screate_simple(1, &size, nullptr);
+  hid_t dataSet = H5Dcreate(fileId, name, fileType, space, H5P_DEFAULT,
+                            H5P_DEFAULT, H5P_DEFAULT);
+  H5Dwrite(dataSet, memType, H5S_ALL, H5S_ALL, H5P_DEFAULT, data);
+  H5Dclose(dataSet);
+  H5Sclose(space);
+}
+
+} // end namespace
+
+TEST(DispatchTest, dataTypeOf)
+{
+  static_assert(DataTypeOf<char>::value == DataType::Int8, "");
+  static_assert(DataTypeOf<unsigned short>::value == DataType::UInt16, "");
+  static_assert(DataTypeOf<long long>::value == DataType::Int64, "");
+  static_assert(DataTypeOf<double>::value == DataType::Double, "");
+}
+
+TEST(DispatchTest, dispatch)
+{
+  size_t size = 0;
+  EXPECT_TRUE(h5::dispatch(DataType::Int16, SizeVisitor{ size }));
+  EXPECT_EQ(size, sizeof(short));
+  EXPECT_TRUE(h5::dispatch(DataType::Double, SizeVisitor{ size }));
+  EXPECT_EQ(size, sizeof(double));
+
+  // Generic lambdas work as visitors too
+  bool isFloat = false;
+  EXPECT_TRUE(h5::dispatch(DataType::Float, [&](auto tag) {
+    using T = typename decltype(tag)::type;
+    isFloat = std::is_same<T, float>::value;
+  }));
+  EXPECT_TRUE(isFloat);
+
+  size = 0;
+  EXPECT_FALSE(h5::dispatch(DataType::String, SizeVisitor{ size }));
+  EXPECT_FALSE(h5::dispatch(DataType::None, SizeVisitor{ size }));
+  EXPECT_EQ(size, 0);
+}
+
+TEST(DispatchTest, classifyBigEndian)
+{
+  vector<int> ints = { 1, -2, 300000 };
+  vector<unsigned short> ushorts = { 1, 2, 65535 };
+  vector<double> doubles = { 0.5, -1.25, 1e10 };
+
+  hid_t fileId =
+    H5Fcreate(test_file.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+  ASSERT_GE(fileId, 0);
+  writeRaw(fileId, "ints", H5T_STD_I32BE, H5T_NATIVE_INT, ints.data(), 3);
+  writeRaw(fileId, "ushorts", H5T_STD_U16BE, H5T_NATIVE_USHORT,
+           ushorts.data(), 3);
+  writeRaw(fileId, "doubles", H5T_IEEE_F64BE, H5T_NATIVE_DOUBLE,
+           doubles.data(), 3);
+  H5Fclose(fileId);
+
+  H5ReadWrite reader(test_file);
+  EXPECT_EQ(reader.dataType("/ints"), DataType::Int32);
+  EXPECT_EQ(reader.dataType("/ushorts"), DataType::UInt16);
+  EXPECT_EQ(reader.dataType("/doubles"), DataType::Double);
+
+  // Big-endian data is converted to the native byte order on read
+  EXPECT_EQ(reader.readData<int>("/ints"), ints);
+  EXPECT_EQ(reader.readData<unsigned short>("/ushorts"), ushorts);
+
+  DataSet dataSet = reader.openDataSet("/doubles");
+  vector<double> result(3);
+  ASSERT_TRUE(dataSet.readData(result.data()));
+  EXPECT_EQ(result, doubles);
+
+  // The sign is part of the type
+  vector<unsigned int> wrong(3);
+  EXPECT_FALSE(reader.readData("/ints", wrong.data()));
+}
@@ -0,0 +1,158 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5emdreader.h>
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::EmdAxis;
+using h5::EmdReader;
+using h5::EmdReadOptions;
+using h5::H5ReadWrite;
+using h5::NDArray;
+
+static const string test_file = "emdreader_test.h5";
+
+// A Tomviz style EMD file, with a 4 x 3 x 2 volume where each value is
+// its linear index
+static void writeEmdFile()
+{
+  const vector<int> dims = { 4, 3, 2 };
+  vector<unsigned char> volume(24);
+  for (size_t i = 0; i < volume.size(); ++i)
+    volume[i] = static_cast<unsigned char>(i);
+
+  H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+  ASSERT_TRUE(writer.createGroup("/data"));
+  ASSERT_TRUE(writer.createGroup("/data/tomography"));
+  writer.setAttribute("/data/tomography", "emd_group_type", 1);
+  ASSERT_TRUE(writer.writeData("/data/tomography", "data", dims, volume));
+
+  const char* names[] = { "angles", "x", "y" };
+  const char* units[] = { "[deg]", "[n_m]", "[n_m]" };
+  for (size_t i = 0; i < dims.size(); ++i) {
+    vector<float> values(dims[i]);
+    for (int j = 0; j < dims[i]; ++j)
+      values[j] = j * 1.5f + i;
+
+    string name = "dim" + std::to_string(i + 1);
+    ASSERT_TRUE(writer.writeData("/data/tomography", name, { dims[i] },
+                                 values));
+    writer.setAttribute("/data/tomography/" + name, "name", names[i]);
+    writer.setAttribute("/data/tomography/" + name, "units", units[i]);
+  }
+}
+
+TEST(EmdReaderTest, axesOnly)
+{
+  writeEmdFile();
+
+  EmdReader reader(test_file);
+  ASSERT_TRUE(reader.isValid());
+  EXPECT_EQ(reader.type(), H5ReadWrite::DataType::UInt8);
+  EXPECT_EQ(reader.dimensions(), vector<int>({ 4, 3, 2 }));
+
+  const vector<EmdAxis>& axes = reader.axes();
+  ASSERT_EQ(axes.size(), 3u);
+  EXPECT_EQ(axes[0].name, "angles");
+  EXPECT_EQ(axes[0].units, "[deg]");
+  EXPECT_EQ(axes[0].values, vector<double>({ 0.0, 1.5, 3.0, 4.5 }));
+  EXPECT_EQ(axes[2].name, "y");
+  EXPECT_EQ(axes[2].values, vector<double>({ 2.0, 3.5 }));
+
+  EmdReader missing(test_file, "/data/missing");
+  EXPECT_FALSE(missing.isValid());
+}
+
+TEST(EmdReaderTest, readVolume)
+{
+  writeEmdFile();
+
+  EmdReader reader(test_file);
+  ASSERT_TRUE(reader.isValid());
+
+  NDArray<unsigned char> volume;
+  vector<EmdAxis> axes;
+  ASSERT_TRUE(reader.read(volume, axes));
+  EXPECT_EQ(volume.shape(), vector<int>({ 4, 3, 2 }));
+  for (size_t i = 0; i < volume.size(); ++i)
+    EXPECT_EQ(volume.data()[i], i);
+  EXPECT_EQ(axes.size(), 3u);
+
+  // The volume is converted to the type of the array
+  NDArray<float> converted;
+  ASSERT_TRUE(reader.readVolume(converted));
+  EXPECT_EQ(converted.shape(), vector<int>({ 4, 3, 2 }));
+  EXPECT_FLOAT_EQ(converted.data()[23], 23.0f);
+}
+
+TEST(EmdReaderTest, hyperslab)
+{
+  writeEmdFile();
+
+  EmdReader reader(test_file);
+  ASSERT_TRUE(reader.isValid());
+
+  EmdReadOptions options;
+  options.start = { 1, 1, 0 };
+  options.counts = { 2, 2, 2 };
+
+  NDArray<int> volume;
+  vector<EmdAxis> axes;
+  ASSERT_TRUE(reader.read(volume, axes, options));
+  EXPECT_EQ(volume.shape(), vector<int>({ 2, 2, 2 }));
+  EXPECT_EQ(volume(0, 0, 0), 8);
+  EXPECT_EQ(volume(1, 1, 1), 17);
+
+  // The axes are limited to the hyperslab
+  ASSERT_EQ(axes.size(), 3u);
+  EXPECT_EQ(axes[0].values, vector<double>({ 1.5, 3.0 }));
+  EXPECT_EQ(axes[1].values, vector<double>({ 2.5, 4.0 }));
+
+  options.counts = { 4, 4, 2 };
+  EXPECT_FALSE(reader.readVolume(volume, options));
+  options.counts = { 2, 2 };
+  EXPECT_FALSE(reader.readVolume(volume, options));
+}
+
+TEST(EmdReaderTest, transpose)
+{
+  writeEmdFile();
+
+  EmdReader reader(test_file);
+  ASSERT_TRUE(reader.isValid());
+
+  EmdReadOptions options;
+  options.transpose = true;
+
+  NDArray<short> volume;
+  vector<EmdAxis> axes;
+  ASSERT_TRUE(reader.read(volume, axes, options));
+  ASSERT_EQ(volume.shape(), vector<int>({ 2, 3, 4 }));
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      for (int k = 0; k < 2; ++k)
+        EXPECT_EQ(volume(k, j, i), i * 6 + j * 2 + k);
+    }
+  }
+
+  ASSERT_EQ(axes.size(), 3u);
+  EXPECT_EQ(axes[0].name, "y");
+  EXPECT_EQ(axes[2].name, "angles");
+
+  // A transposed hyperslab
+  options.start = { 2, 0, 1 };
+  options.counts = { 2, 3, 1 };
+  ASSERT_TRUE(reader.readVolume(volume, options));
+  ASSERT_EQ(volume.shape(), vector<int>({ 1, 3, 2 }));
+  EXPECT_EQ(volume(0, 0, 0), 13);
+  EXPECT_EQ(volume(0, 0, 1), 19);
+  EXPECT_EQ(volume(0, 2, 1), 23);
+}
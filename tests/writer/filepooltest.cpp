@@ -0,0 +1,189 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5capi.h>
+#include <h5cpp/h5filepool.h>
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::FilePool;
+using h5::H5ReadWrite;
+using h5::OpenOptions;
+
+static const string test_file = "filepool_test.h5";
+
+static void writeFile(int value)
+{
+  H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+  ASSERT_TRUE(writer.writeData("/", "data", { 3 }, vector<int>(3, value)));
+}
+
+static OpenOptions pooledOptions()
+{
+  OpenOptions options;
+  options.pooled = true;
+  return options;
+}
+
+class FilePoolTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    FilePool::instance().closeIdle();
+    FilePool::instance().resetStatistics();
+  }
+
+  void TearDown() override
+  {
+    FilePool::instance().setIdleTimeout(std::chrono::seconds(30));
+    FilePool::instance().closeIdle();
+  }
+};
+
+TEST_F(FilePoolTest, shared)
+{
+  writeFile(1);
+  FilePool& pool = FilePool::instance();
+
+  {
+    H5ReadWrite first(test_file, H5ReadWrite::OpenMode::ReadOnly,
+                      pooledOptions());
+    H5ReadWrite second(test_file, H5ReadWrite::OpenMode::ReadOnly,
+                       pooledOptions());
+    EXPECT_EQ(first.readData<int>("/data"), vector<int>(3, 1));
+    EXPECT_EQ(second.readData<int>("/data"), vector<int>(3, 1));
+    EXPECT_EQ(pool.statistics().opens, 1u);
+    EXPECT_EQ(pool.statistics().reuses, 1u);
+    EXPECT_EQ(pool.statistics().idle, 0u);
+  }
+
+  // The file stays open without users
+  EXPECT_EQ(pool.statistics().open, 1u);
+  EXPECT_EQ(pool.statistics().idle, 1u);
+
+  {
+    H5ReadWrite third(test_file, H5ReadWrite::OpenMode::ReadOnly,
+                      pooledOptions());
+    EXPECT_EQ(third.readData<int>("/data"), vector<int>(3, 1));
+    EXPECT_EQ(pool.statistics().opens, 1u);
+    EXPECT_EQ(pool.statistics().reuses, 2u);
+  }
+
+  // Other modes have their own file ids. The idle read-only one is closed
+  // first, since HDF5 cannot open a file for writing while it is open
+  // read-only.
+  H5ReadWrite writable(test_file, H5ReadWrite::OpenMode::ReadWrite,
+                       pooledOptions());
+  EXPECT_EQ(pool.statistics().opens, 2u);
+  EXPECT_EQ(pool.statistics().closes, 1u);
+  EXPECT_EQ(pool.statistics().open, 1u);
+}
+
+TEST_F(FilePoolTest, idleTimeout)
+{
+  writeFile(1);
+  FilePool& pool = FilePool::instance();
+  pool.setIdleTimeout(std::chrono::milliseconds(50));
+
+  {
+    H5ReadWrite reader(test_file, H5ReadWrite::OpenMode::ReadOnly,
+                       pooledOptions());
+  }
+  EXPECT_EQ(pool.statistics().open, 1u);
+
+#ifdef H5_HAVE_THREADSAFE
+  // The background thread closes it
+  for (int i = 0; i < 100 && pool.statistics().open > 0; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  EXPECT_EQ(pool.statistics().open, 0u);
+  EXPECT_EQ(pool.statistics().closes, 1u);
+#else
+  // The next use of the pool closes it
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(pool.statistics().open, 1u);
+  {
+    H5ReadWrite reader(test_file, H5ReadWrite::OpenMode::ReadOnly,
+                       pooledOptions());
+  }
+  EXPECT_EQ(pool.statistics().closes, 1u);
+  EXPECT_EQ(pool.statistics().opens, 2u);
+#endif
+}
+
+TEST_F(FilePoolTest, zeroTimeout)
+{
+  writeFile(1);
+  FilePool& pool = FilePool::instance();
+
+  {
+    H5ReadWrite reader(test_file, H5ReadWrite::OpenMode::ReadOnly,
+                       pooledOptions());
+  }
+  EXPECT_EQ(pool.statistics().idle, 1u);
+
+  // Idle files are closed at once, and later ones on their last release
+  pool.setIdleTimeout(std::chrono::milliseconds(0));
+  EXPECT_EQ(pool.statistics().open, 0u);
+
+  {
+    H5ReadWrite first(test_file, H5ReadWrite::OpenMode::ReadOnly,
+                      pooledOptions());
+    {
+      H5ReadWrite second(test_file, H5ReadWrite::OpenMode::ReadOnly,
+                         pooledOptions());
+    }
+    EXPECT_EQ(pool.statistics().open, 1u);
+  }
+  EXPECT_EQ(pool.statistics().open, 0u);
+  EXPECT_EQ(pool.statistics().closes, 2u);
+}
+
+TEST_F(FilePoolTest, rewrite)
+{
+  writeFile(1);
+  FilePool& pool = FilePool::instance();
+
+  {
+    H5ReadWrite reader(test_file, H5ReadWrite::OpenMode::ReadOnly,
+                       pooledOptions());
+    EXPECT_EQ(reader.readData<int>("/data"), vector<int>(3, 1));
+  }
+
+  // Creating the file again closes the idle file id first
+  writeFile(2);
+  EXPECT_EQ(pool.statistics().open, 0u);
+
+  H5ReadWrite reader(test_file, H5ReadWrite::OpenMode::ReadOnly,
+                     pooledOptions());
+  EXPECT_EQ(reader.readData<int>("/data"), vector<int>(3, 2));
+}
+
+TEST_F(FilePoolTest, writesAreFlushed)
+{
+  writeFile(1);
+
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::ReadWrite,
+                       pooledOptions());
+    ASSERT_TRUE(writer.writeData("/", "more", { 2 }, vector<int>(2, 5)));
+  }
+
+  // The writable file id is still open in the pool
+  EXPECT_EQ(FilePool::instance().statistics().idle, 1u);
+
+  H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::ReadWrite,
+                     pooledOptions());
+  EXPECT_EQ(writer.readData<int>("/more"), vector<int>(2, 5));
+  EXPECT_EQ(FilePool::instance().statistics().reuses, 1u);
+}
@@ -0,0 +1,218 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5batchwrite.h>
+#include <h5cpp/h5capi.h>
+#include <h5cpp/h5inspect.h>
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::AttributeInfo;
+using h5::BatchWrite;
+using h5::H5ReadWrite;
+using h5::InspectOptions;
+using h5::ObjectInfo;
+using h5::WriteOptions;
+
+using DataType = H5ReadWrite::DataType;
+using Kind = ObjectInfo::Kind;
+using Layout = WriteOptions::Layout;
+
+static const string test_file = "inspect_test.h5";
+
+static const ObjectInfo* find(const vector<ObjectInfo>& objects,
+                              const string& path)
+{
+  for (const ObjectInfo& object : objects) {
+    if (object.path == path)
+      return &object;
+  }
+  return nullptr;
+}
+
+static const AttributeInfo* find(const vector<AttributeInfo>& attributes,
+                                 const string& name)
+{
+  for (const AttributeInfo& attribute : attributes) {
+    if (attribute.name == name)
+      return &attribute;
+  }
+  return nullptr;
+}
+
+TEST(InspectTest, structure)
+{
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(writer.createGroup("/data"));
+    ASSERT_TRUE(writer.createGroup("/data/empty"));
+
+    WriteOptions options;
+    options.chunkDimensions = { 4, 32, 32 };
+    options.compression = WriteOptions::Compression::Deflate;
+    options.shuffle = true;
+    vector<float> volume(16 * 32 * 32, 1.0f);
+    ASSERT_TRUE(writer.writeData("/data", "volume", { 16, 32, 32 }, volume,
+                                 options));
+    ASSERT_TRUE(writer.setAttribute("/data/volume", "units", "nm"));
+    ASSERT_TRUE(writer.setAttribute("/data/volume", "spacing", 0.5));
+
+    options = WriteOptions();
+    options.layout = Layout::Contiguous;
+    vector<int> labels(100, 3);
+    ASSERT_TRUE(writer.writeData("/", "labels", { 10, 10 }, labels, options));
+    ASSERT_TRUE(writer.setAttribute("/", "version", 2));
+  }
+
+  H5ReadWrite reader(test_file);
+  bool ok = false;
+  vector<ObjectInfo> objects = h5::inspect(reader, "/", InspectOptions(), &ok);
+  EXPECT_TRUE(ok);
+
+  // Depth first, with the children in the order of their names
+  vector<string> paths;
+  for (const ObjectInfo& object : objects)
+    paths.push_back(object.path);
+  EXPECT_EQ(paths, vector<string>({ "/", "/data", "/data/empty",
+                                    "/data/volume", "/labels" }));
+
+  const ObjectInfo* root = find(objects, "/");
+  ASSERT_NE(root, nullptr);
+  EXPECT_EQ(root->kind, Kind::Group);
+  ASSERT_EQ(root->attributes.size(), 1u);
+  EXPECT_EQ(root->attributes[0].name, "version");
+  EXPECT_EQ(root->attributes[0].type, DataType::Int32);
+  EXPECT_EQ(root->attributes[0].dimensions, vector<int>({ 1 }));
+  EXPECT_EQ(root->attributes[0].numbers, vector<double>({ 2 }));
+
+  const ObjectInfo* volume = find(objects, "/data/volume");
+  ASSERT_NE(volume, nullptr);
+  EXPECT_EQ(volume->kind, Kind::DataSet);
+  EXPECT_EQ(volume->type, DataType::Float);
+  EXPECT_EQ(volume->typeName, "Float");
+  EXPECT_EQ(volume->dimensions, vector<int>({ 16, 32, 32 }));
+  EXPECT_EQ(volume->layout, Layout::Chunked);
+  EXPECT_EQ(volume->chunkDimensions, vector<int>({ 4, 32, 32 }));
+  EXPECT_EQ(volume->filters, vector<string>({ "shuffle", "deflate" }));
+  EXPECT_EQ(volume->logicalBytes, 16u * 32 * 32 * 4);
+  EXPECT_GT(volume->storedBytes, 0u);
+  EXPECT_LT(volume->storedBytes, volume->logicalBytes / 10);
+
+  const AttributeInfo* units = find(volume->attributes, "units");
+  ASSERT_NE(units, nullptr);
+  EXPECT_EQ(units->type, DataType::String);
+  EXPECT_EQ(units->strings, vector<string>({ "nm" }));
+  const AttributeInfo* spacing = find(volume->attributes, "spacing");
+  ASSERT_NE(spacing, nullptr);
+  EXPECT_EQ(spacing->numbers, vector<double>({ 0.5 }));
+
+  const ObjectInfo* labels = find(objects, "/labels");
+  ASSERT_NE(labels, nullptr);
+  EXPECT_EQ(labels->type, DataType::Int32);
+  EXPECT_EQ(labels->layout, Layout::Contiguous);
+  EXPECT_TRUE(labels->chunkDimensions.empty());
+  EXPECT_TRUE(labels->filters.empty());
+  EXPECT_EQ(labels->storedBytes, labels->logicalBytes);
+
+  // A subtree, without attributes
+  InspectOptions options;
+  options.attributes = false;
+  objects = h5::inspect(reader, "/data", options, &ok);
+  EXPECT_TRUE(ok);
+  ASSERT_EQ(objects.size(), 3u);
+  EXPECT_EQ(objects[0].path, "/data");
+  EXPECT_EQ(objects[2].path, "/data/volume");
+  EXPECT_TRUE(objects[2].attributes.empty());
+
+  objects = h5::inspect(reader, "/missing", options, &ok);
+  EXPECT_FALSE(ok);
+  EXPECT_TRUE(objects.empty());
+}
+
+// Write a 1-D int attribute, which H5ReadWrite does not write
+static void writeArrayAttribute(hid_t objectId, const char* name,
+                                const vector<int>& values)
+{
+  hsize_t size = values.size();
+  hid_t space = H5Screate_simple(1, &size, nullptr);
+  hid_t attribute = H5Acreate2(objectId, name, H5T_STD_I32LE, space,
+                               H5P_DEFAULT, H5P_DEFAULT);
+  H5Awrite(attribute, H5T_NATIVE_INT, values.data());
+  H5Aclose(attribute);
+  H5Sclose(space);
+}
+
+TEST(InspectTest, attributeValues)
+{
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    vector<double> values(4, 1.0);
+    ASSERT_TRUE(writer.writeData("/", "values", { 4 }, values));
+  }
+
+  hid_t fileId = H5Fopen(test_file.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+  ASSERT_GE(fileId, 0);
+  hid_t dataSet = H5Dopen(fileId, "/values", H5P_DEFAULT);
+  writeArrayAttribute(dataSet, "small", { 1, 2, 3 });
+  writeArrayAttribute(dataSet, "large", vector<int>(100, 7));
+  H5Dclose(dataSet);
+  H5Fclose(fileId);
+
+  H5ReadWrite reader(test_file);
+  vector<ObjectInfo> objects = h5::inspect(reader, "/values");
+  ASSERT_EQ(objects.size(), 1u);
+
+  // Large attributes only have their type and dimensions listed
+  const AttributeInfo* small = find(objects[0].attributes, "small");
+  ASSERT_NE(small, nullptr);
+  EXPECT_EQ(small->dimensions, vector<int>({ 3 }));
+  EXPECT_EQ(small->numbers, vector<double>({ 1, 2, 3 }));
+
+  const AttributeInfo* large = find(objects[0].attributes, "large");
+  ASSERT_NE(large, nullptr);
+  EXPECT_EQ(large->type, DataType::Int32);
+  EXPECT_EQ(large->dimensions, vector<int>({ 100 }));
+  EXPECT_TRUE(large->numbers.empty());
+}
+
+TEST(InspectTest, manyObjects)
+{
+  const int groupCount = 100;
+  const int dataSetCount = 100;
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    BatchWrite batch;
+    vector<float> values(8, 1.0f);
+    for (int i = 0; i < groupCount; ++i) {
+      const string group = "/group" + std::to_string(i);
+      for (int j = 0; j < dataSetCount; ++j) {
+        batch.writeData(group, "data" + std::to_string(j), { 8 },
+                        values.data());
+      }
+    }
+    ASSERT_TRUE(writer.commit(batch));
+  }
+
+  H5ReadWrite reader(test_file);
+  auto start = std::chrono::steady_clock::now();
+  bool ok = false;
+  vector<ObjectInfo> objects = h5::inspect(reader, "/", InspectOptions(), &ok);
+  auto seconds = std::chrono::duration<double>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+  EXPECT_TRUE(ok);
+  EXPECT_EQ(objects.size(), 1u + groupCount * (1 + dataSetCount));
+  EXPECT_LT(seconds, 5.0);
+
+  // Run this last
+  std::remove(test_file.c_str());
+}
@@ -0,0 +1,145 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5ioactor.h>
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::H5ReadWrite;
+using h5::IOActor;
+using h5::NDArray;
+using h5::WriteOptions;
+
+static const string test_file = "ioactor_test.h5";
+
+// A 3D data set of shorts, with value i at position i
+static void writeFile()
+{
+  vector<short> data(4 * 5 * 6);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<short>(i);
+
+  H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+  ASSERT_TRUE(writer.writeData("/", "data", { 4, 5, 6 }, data));
+}
+
+TEST(IOActorTest, reads)
+{
+  writeFile();
+  IOActor actor(test_file);
+  ASSERT_TRUE(actor.isValid());
+
+  // Read in the type of the data set
+  NDArray<short> same;
+  ASSERT_TRUE(actor.readData("/data", same));
+  EXPECT_EQ(same.shape(), vector<int>({ 4, 5, 6 }));
+  EXPECT_EQ(same.data()[119], 119);
+
+  // Converted on the calling thread
+  NDArray<double> slab;
+  ASSERT_TRUE(actor.readSlab("/data", { 1, 2, 3 }, { 2, 1, 2 }, slab));
+  EXPECT_EQ(slab.shape(), vector<int>({ 2, 1, 2 }));
+  EXPECT_DOUBLE_EQ(slab.data()[0], 30 + 12 + 3);
+  EXPECT_DOUBLE_EQ(slab.data()[3], 60 + 12 + 4);
+
+  EXPECT_FALSE(actor.readData("/missing", slab));
+
+  // Any other call
+  std::future<vector<int>> dims =
+    actor.submit([](H5ReadWrite& file) { return file.getDimensions("/data"); });
+  EXPECT_EQ(dims.get(), vector<int>({ 4, 5, 6 }));
+}
+
+TEST(IOActorTest, manyThreads)
+{
+  writeFile();
+  IOActor actor(test_file);
+  ASSERT_TRUE(actor.isValid());
+
+  std::atomic<int> failures(0);
+  vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&actor, &failures, t]() {
+      for (int i = 0; i < 50; ++i) {
+        int x = (t + i) % 4;
+        NDArray<float> slab;
+        if (!actor.readSlab("/data", { x, 0, 0 }, { 1, 5, 6 }, slab) ||
+            slab.data()[0] != x * 30 || slab.data()[29] != x * 30 + 29) {
+          ++failures;
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(failures, 0);
+}
+
+TEST(IOActorTest, order)
+{
+  vector<int> order;
+  {
+    IOActor actor(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(actor.isValid());
+
+    for (int i = 0; i < 100; ++i)
+      actor.post([&order, i](H5ReadWrite&) { order.push_back(i); });
+
+    actor.post([](H5ReadWrite& file) {
+      file.writeData("/", "data", { 2 }, vector<int>({ 7, 8 }));
+    });
+  }
+
+  // The queued calls ran before the file was closed
+  ASSERT_EQ(order.size(), 100u);
+  for (int i = 0; i < 100; ++i)
+    EXPECT_EQ(order[i], i);
+
+  H5ReadWrite reader(test_file);
+  EXPECT_EQ(reader.readData<int>("/data"), vector<int>({ 7, 8 }));
+}
+
+TEST(IOActorTest, quantized)
+{
+  vector<float> values = { -1.0f, 0.0f, 0.5f, 2.0f };
+  {
+    WriteOptions options;
+    options.quantizeBits = 8;
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(writer.writeData("/", "packed", { 4 }, values, options));
+  }
+
+  IOActor actor(test_file);
+  ASSERT_TRUE(actor.isValid());
+
+  // Restored as float, like every other read path
+  NDArray<float> restored;
+  ASSERT_TRUE(actor.readData("/packed", restored));
+  ASSERT_EQ(restored.shape(), vector<int>({ 4 }));
+  for (size_t i = 0; i < values.size(); ++i)
+    EXPECT_NEAR(restored.data()[i], values[i], 3.0f / 255);
+
+  // The codes are not handed out as if they were the values
+  NDArray<double> codes;
+  EXPECT_FALSE(actor.readData("/packed", codes));
+}
+
+TEST(IOActorTest, invalid)
+{
+  IOActor actor("ioactor_missing.h5");
+  EXPECT_FALSE(actor.isValid());
+
+  NDArray<int> array;
+  EXPECT_FALSE(actor.readData("/data", array));
+}
@@ -0,0 +1,82 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::H5ReadWrite;
+using h5::WriteOptions;
+
+using Layout = WriteOptions::Layout;
+
+static const string test_file = "layout_test.h5";
+
+TEST(LayoutTest, automaticLayout)
+{
+  H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+
+  // Tiny axis vectors are compact
+  vector<float> axis(256, 1.0f);
+  EXPECT_TRUE(writer.writeData("/", "dim1", { 256 }, axis));
+  EXPECT_EQ(writer.storageLayout("/dim1"), Layout::Compact);
+  EXPECT_TRUE(writer.chunkDimensions("/dim1").empty());
+
+  // Medium data sets stay contiguous
+  vector<unsigned char> medium(64 * 64 * 64);
+  EXPECT_TRUE(writer.writeData("/", "medium", { 64, 64, 64 }, medium));
+  EXPECT_EQ(writer.storageLayout("/medium"), Layout::Contiguous);
+
+  // Large data sets are chunked. Lower the limit to keep the test small.
+  WriteOptions options;
+  options.chunkedLimit = 128 * 1024;
+  options.chunkBytes = 16 * 1024;
+  options.sliceAxis = 0;
+  vector<short> large(8 * 128 * 128);
+  EXPECT_TRUE(writer.writeData("/", "large", { 8, 128, 128 }, large,
+                               options));
+  EXPECT_EQ(writer.storageLayout("/large"), Layout::Chunked);
+
+  // One slice thick along axis 0, and 16 KiB in total
+  vector<int> chunk = writer.chunkDimensions("/large");
+  EXPECT_EQ(chunk, vector<int>({ 1, 64, 128 }));
+
+  // Without a hint, the chunks are about cubic
+  options.sliceAxis = -1;
+  EXPECT_TRUE(writer.writeData("/", "cubic", { 8, 128, 128 }, large,
+                               options));
+  chunk = writer.chunkDimensions("/cubic");
+  EXPECT_EQ(chunk, vector<int>({ 8, 32, 32 }));
+
+  vector<int> dims;
+  EXPECT_EQ(writer.readData<short>("/large", dims).size(), large.size());
+}
+
+TEST(LayoutTest, explicitLayout)
+{
+  H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+
+  vector<double> data(100, 2.0);
+  WriteOptions options;
+  options.layout = Layout::Contiguous;
+  EXPECT_TRUE(writer.writeData("/", "contiguous", { 10, 10 }, data,
+                               options));
+  EXPECT_EQ(writer.storageLayout("/contiguous"), Layout::Contiguous);
+
+  options.layout = Layout::Automatic;
+  options.chunkDimensions = { 5, 20 };
+  EXPECT_TRUE(writer.writeData("/", "chunked", { 10, 10 }, data, options));
+  EXPECT_EQ(writer.storageLayout("/chunked"), Layout::Chunked);
+
+  // Chunks are clamped to the data set
+  EXPECT_EQ(writer.chunkDimensions("/chunked"), vector<int>({ 5, 10 }));
+
+  vector<int> dims;
+  EXPECT_EQ(writer.readData<double>("/chunked", dims), data);
+}
@@ -0,0 +1,103 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5capi.h>
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::H5ReadWrite;
+using h5::NDArray;
+
+static const string test_file = "ndarray_test.h5";
+
+TEST(NDArrayTest, shapeAndStrides)
+{
+  NDArray<int> array({ 2, 3, 4 });
+  EXPECT_EQ(array.size(), 24);
+  EXPECT_EQ(array.dimensionCount(), 3);
+  EXPECT_EQ(array.strides(), vector<size_t>({ 12, 4, 1 }));
+
+  array(1, 2, 3) = 5;
+  EXPECT_EQ(array[23], 5);
+
+  // Moving transfers the buffer
+  const int* data = array.data();
+  NDArray<int> moved(std::move(array));
+  EXPECT_EQ(moved.data(), data);
+  EXPECT_TRUE(array.empty());
+
+  // Shrinking reuses the buffer
+  moved.resize({ 4, 5 });
+  EXPECT_EQ(moved.data(), data);
+  EXPECT_EQ(moved.strides(), vector<size_t>({ 5, 1 }));
+}
+
+TEST(NDArrayTest, readAndWrite)
+{
+  NDArray<double> volume({ 3, 4, 5 });
+  for (size_t i = 0; i < volume.size(); ++i)
+    volume[i] = static_cast<double>(i);
+
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    EXPECT_TRUE(writer.writeData("/", "volume", volume));
+
+    NDArray<double> slab({ 1, 2, 2 });
+    for (size_t i = 0; i < slab.size(); ++i)
+      slab[i] = -1.0;
+    EXPECT_TRUE(writer.writeSlab("/volume", { 2, 1, 1 }, slab));
+  }
+
+  H5ReadWrite reader(test_file);
+  NDArray<double> result;
+  EXPECT_TRUE(reader.readData("/volume", result));
+  EXPECT_EQ(result.shape(), vector<int>({ 3, 4, 5 }));
+  EXPECT_DOUBLE_EQ(result(0, 1, 2), 7.0);
+  EXPECT_DOUBLE_EQ(result(2, 1, 1), -1.0);
+  EXPECT_DOUBLE_EQ(result(2, 2, 2), -1.0);
+  EXPECT_DOUBLE_EQ(result(2, 3, 4), 59.0);
+
+  NDArray<double> slab;
+  EXPECT_TRUE(reader.readSlab("/volume", { 1, 0, 0 }, { 1, 4, 5 }, slab));
+  EXPECT_EQ(slab.shape(), vector<int>({ 1, 4, 5 }));
+  EXPECT_DOUBLE_EQ(slab(0, 0, 0), 20.0);
+
+  // Wrong type
+  NDArray<float> wrong;
+  EXPECT_FALSE(reader.readData("/volume", wrong));
+}
+
+TEST(NDArrayTest, scalar)
+{
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+  }
+
+  // H5ReadWrite writes no scalar data sets, so create one directly
+  hid_t fileId = H5Fopen(test_file.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+  ASSERT_GE(fileId, 0);
+  hid_t spaceId = H5Screate(H5S_SCALAR);
+  hid_t dataSetId = H5Dcreate2(fileId, "scalar", H5T_NATIVE_INT, spaceId,
+                               H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  const int value = 42;
+  EXPECT_GE(H5Dwrite(dataSetId, H5T_NATIVE_INT, H5S_ALL, H5S_ALL,
+                     H5P_DEFAULT, &value),
+            0);
+  H5Dclose(dataSetId);
+  H5Sclose(spaceId);
+  H5Fclose(fileId);
+
+  H5ReadWrite reader(test_file);
+  NDArray<int> result;
+  ASSERT_TRUE(reader.readData("/scalar", result));
+  EXPECT_EQ(result.shape(), vector<int>({ 1 }));
+  EXPECT_EQ(result(0), 42);
+}
@@ -0,0 +1,153 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5capi.h>
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::H5ReadWrite;
+using h5::OpenOptions;
+
+static const string test_file = "open_options_test.h5";
+
+// The id of the open file test_file, or a negative value if it is not open
+static hid_t openFileId()
+{
+  ssize_t count = H5Fget_obj_count(H5F_OBJ_ALL, H5F_OBJ_FILE);
+  vector<hid_t> ids(count > 0 ? count : 0);
+  if (count > 0)
+    H5Fget_obj_ids(H5F_OBJ_ALL, H5F_OBJ_FILE, ids.size(), ids.data());
+
+  for (hid_t id : ids) {
+    char name[256] = "";
+    H5Fget_name(id, name, sizeof(name));
+    if (string(name).find(test_file) != string::npos)
+      return id;
+  }
+  return -1;
+}
+
+// Check that the open file uses the settings of @p options, or the HDF5
+// defaults where they are zero. The page buffer is only used if
+// @p paged.
+static void expectSettings(const OpenOptions& options, bool paged)
+{
+  hid_t fileId = openFileId();
+  ASSERT_GE(fileId, 0);
+  hid_t accessId = H5Fget_access_plist(fileId);
+  hid_t defaultsId = H5Pcreate(H5P_FILE_ACCESS);
+  ASSERT_GE(accessId, 0);
+
+  H5F_libver_t low, high;
+  H5Pget_libver_bounds(accessId, &low, &high);
+  if (options.latestFormat)
+    EXPECT_EQ(high, H5F_LIBVER_LATEST);
+
+  size_t pageBufferSize = 0;
+  unsigned minMeta = 0, minRaw = 0;
+  H5Pget_page_buffer_size(accessId, &pageBufferSize, &minMeta, &minRaw);
+  EXPECT_EQ(pageBufferSize, paged ? options.pageBufferSize : 0);
+
+  H5AC_cache_config_t config, defaultConfig;
+  config.version = defaultConfig.version = H5AC__CURR_CACHE_CONFIG_VERSION;
+  H5Pget_mdc_config(accessId, &config);
+  H5Pget_mdc_config(defaultsId, &defaultConfig);
+  if (options.metadataCacheSize > 0) {
+    EXPECT_TRUE(config.set_initial_size);
+    EXPECT_EQ(config.initial_size, options.metadataCacheSize);
+  } else {
+    EXPECT_EQ(config.initial_size, defaultConfig.initial_size);
+  }
+
+  hsize_t blockSize, defaultBlockSize;
+  H5Pget_meta_block_size(accessId, &blockSize);
+  H5Pget_meta_block_size(defaultsId, &defaultBlockSize);
+  EXPECT_EQ(blockSize, options.metadataBlockSize > 0
+                         ? options.metadataBlockSize
+                         : defaultBlockSize);
+
+  hsize_t threshold, alignment, defaultThreshold, defaultAlignment;
+  H5Pget_alignment(accessId, &threshold, &alignment);
+  H5Pget_alignment(defaultsId, &defaultThreshold, &defaultAlignment);
+  if (options.alignment > 0) {
+    EXPECT_EQ(threshold, options.alignmentThreshold);
+    EXPECT_EQ(alignment, options.alignment);
+  } else {
+    EXPECT_EQ(threshold, defaultThreshold);
+    EXPECT_EQ(alignment, defaultAlignment);
+  }
+
+  size_t sieveSize, defaultSieveSize;
+  H5Pget_sieve_buf_size(accessId, &sieveSize);
+  H5Pget_sieve_buf_size(defaultsId, &defaultSieveSize);
+  EXPECT_EQ(sieveSize, options.sieveBufferSize > 0 ? options.sieveBufferSize
+                                                   : defaultSieveSize);
+
+  int elements;
+  size_t slots, bytes, defaultBytes;
+  double preemption;
+  H5Pget_cache(accessId, &elements, &slots, &bytes, &preemption);
+  H5Pget_cache(defaultsId, &elements, &slots, &defaultBytes, &preemption);
+  EXPECT_EQ(bytes, options.chunkCacheSize > 0 ? options.chunkCacheSize
+                                              : defaultBytes);
+
+  H5Pclose(defaultsId);
+  H5Pclose(accessId);
+}
+
+static void writeAndRead(const OpenOptions& createOptions,
+                         const OpenOptions& openOptions)
+{
+  vector<double> data = { 1.0, 2.0, 3.0, 4.0, 5.0, 6.0 };
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly,
+                       createOptions);
+    EXPECT_TRUE(writer.createGroup("/group"));
+    EXPECT_TRUE(writer.writeData("/group", "data", { 2, 3 }, data));
+
+    // The page size is a setting of the file
+    hid_t creationId = H5Fget_create_plist(openFileId());
+    hsize_t pageSize = 0;
+    H5Pget_file_space_page_size(creationId, &pageSize);
+    H5Pclose(creationId);
+    if (createOptions.pageSize > 0)
+      EXPECT_EQ(pageSize, createOptions.pageSize);
+  }
+
+  H5ReadWrite reader(test_file, H5ReadWrite::OpenMode::ReadOnly,
+                     openOptions);
+  expectSettings(openOptions, createOptions.pageSize > 0);
+
+  vector<int> dims;
+  vector<double> result = reader.readData<double>("/group/data", dims);
+  EXPECT_EQ(dims.size(), 2);
+  EXPECT_EQ(result, data);
+}
+
+TEST(OpenOptionsTest, defaults)
+{
+  writeAndRead(OpenOptions(), OpenOptions());
+}
+
+TEST(OpenOptionsTest, presets)
+{
+  writeAndRead(OpenOptions::parallelFilesystem(),
+               OpenOptions::parallelFilesystem());
+  writeAndRead(OpenOptions::localNVMe(), OpenOptions::localNVMe());
+  writeAndRead(OpenOptions::manySmallObjects(),
+               OpenOptions::manySmallObjects());
+}
+
+TEST(OpenOptionsTest, pageBufferOnUnpagedFile)
+{
+  // The page buffer must be skipped for files that are not paged, and
+  // the other settings kept
+  writeAndRead(OpenOptions(), OpenOptions::manySmallObjects());
+}
@@ -0,0 +1,209 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5openpmdreader.h>
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::H5ReadWrite;
+using h5::NDArray;
+using h5::OpenPMDReader;
+
+static const string pmd_test_file = TESTDATADIR + string("/open_pmd_2d.h5");
+static const string test_file = "openpmd_test.h5";
+
+TEST(OpenPMDTest, index)
+{
+  OpenPMDReader reader(pmd_test_file);
+  ASSERT_TRUE(reader.isValid());
+  EXPECT_EQ(reader.version(), "1.1.0");
+  EXPECT_EQ(reader.iterationEncoding(), "fileBased");
+
+  ASSERT_EQ(reader.iterations().size(), 1u);
+  const OpenPMDReader::Iteration* iteration = reader.iteration(255);
+  ASSERT_NE(iteration, nullptr);
+  EXPECT_EQ(iteration->path, "/data/255");
+  EXPECT_EQ(reader.iteration(0), nullptr);
+
+  // The electric field has three components, and rho is a scalar mesh
+  ASSERT_EQ(iteration->meshes.size(), 2u);
+  const OpenPMDReader::Mesh* field = iteration->mesh("E");
+  ASSERT_NE(field, nullptr);
+  EXPECT_EQ(field->path, "/data/255/fields/E");
+  EXPECT_EQ(field->components.size(), 3u);
+  EXPECT_EQ(field->unitDimension.size(), 7u);
+
+  const OpenPMDReader::Component* x = field->component("x");
+  ASSERT_NE(x, nullptr);
+  EXPECT_EQ(x->path, "/data/255/fields/E/x");
+  EXPECT_EQ(x->type, H5ReadWrite::DataType::Double);
+  EXPECT_EQ(x->shape, vector<int>({ 51, 201 }));
+  EXPECT_EQ(x->position.size(), 2u);
+  EXPECT_FALSE(x->constant);
+
+  const OpenPMDReader::Mesh* rho = iteration->mesh("rho");
+  ASSERT_NE(rho, nullptr);
+  ASSERT_EQ(rho->components.size(), 1u);
+  EXPECT_EQ(rho->components[0].name, "");
+  EXPECT_EQ(rho->components[0].path, "/data/255/fields/rho");
+
+  // Particle records are groups of components, data sets or constants
+  ASSERT_EQ(iteration->particles.size(), 2u);
+  const OpenPMDReader::Species* electrons = iteration->species("electrons");
+  ASSERT_NE(electrons, nullptr);
+  EXPECT_EQ(electrons->record("particlePatches"), nullptr);
+
+  const OpenPMDReader::Record* position = electrons->record("position");
+  ASSERT_NE(position, nullptr);
+  EXPECT_EQ(position->components.size(), 3u);
+
+  const OpenPMDReader::Record* charge = electrons->record("charge");
+  ASSERT_NE(charge, nullptr);
+  ASSERT_EQ(charge->components.size(), 1u);
+  EXPECT_TRUE(charge->components[0].constant);
+  EXPECT_LT(charge->components[0].value, 0.0);
+}
+
+TEST(OpenPMDTest, geometry)
+{
+  OpenPMDReader reader(pmd_test_file);
+  ASSERT_TRUE(reader.isValid());
+
+  bool ok;
+  OpenPMDReader::MeshGeometry geometry = reader.geometry(255, "E", &ok);
+  ASSERT_TRUE(ok);
+  EXPECT_EQ(geometry.geometry, "cartesian");
+  EXPECT_EQ(geometry.dataOrder, "C");
+  EXPECT_EQ(geometry.axisLabels, vector<string>({ "x", "z" }));
+  EXPECT_EQ(geometry.shape, vector<int>({ 51, 201 }));
+  ASSERT_EQ(geometry.gridSpacing.size(), 2u);
+  EXPECT_DOUBLE_EQ(geometry.gridSpacing[0], 6e-07);
+  EXPECT_DOUBLE_EQ(geometry.gridSpacing[1], 1e-07);
+  ASSERT_EQ(geometry.gridGlobalOffset.size(), 2u);
+  EXPECT_DOUBLE_EQ(geometry.gridGlobalOffset[0], -1.5e-05);
+  EXPECT_DOUBLE_EQ(geometry.gridUnitSI, 1.0);
+
+  reader.geometry(255, "B", &ok);
+  EXPECT_FALSE(ok);
+  reader.geometry(1, "E", &ok);
+  EXPECT_FALSE(ok);
+}
+
+TEST(OpenPMDTest, readComponent)
+{
+  OpenPMDReader reader(pmd_test_file);
+  ASSERT_TRUE(reader.isValid());
+
+  const OpenPMDReader::Mesh* field = reader.iteration(255)->mesh("E");
+  const OpenPMDReader::Component& x = *field->component("x");
+
+  // The data matches a plain read of the same data set
+  H5ReadWrite plain(pmd_test_file);
+  NDArray<double> expected;
+  ASSERT_TRUE(plain.readData(x.path, expected));
+
+  NDArray<double> array;
+  ASSERT_TRUE(reader.readComponent(x, array));
+  ASSERT_EQ(array.shape(), expected.shape());
+  for (size_t i = 0; i < array.size(); ++i)
+    ASSERT_EQ(array.data()[i], expected.data()[i]);
+
+  // The data is converted to the type of the array
+  NDArray<float> converted;
+  ASSERT_TRUE(reader.readComponent(x, converted));
+  ASSERT_EQ(converted.shape(), expected.shape());
+  for (size_t i = 0; i < converted.size(); ++i)
+    ASSERT_FLOAT_EQ(converted.data()[i],
+                    static_cast<float>(expected.data()[i]));
+
+  // Constant components are filled with their value
+  const OpenPMDReader::Species* electrons =
+    reader.iteration(255)->species("electrons");
+  const OpenPMDReader::Component& charge =
+    electrons->record("charge")->components[0];
+  NDArray<double> charges;
+  ASSERT_TRUE(reader.readComponent(charge, charges));
+  ASSERT_EQ(charges.size(), 9968u);
+  EXPECT_EQ(charges.data()[0], charge.value);
+  EXPECT_EQ(charges.data()[9967], charge.value);
+}
+
+TEST(OpenPMDTest, forEachIteration)
+{
+  // A group based series with several iterations
+  const int iterationCount = 20;
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    writer.setAttribute("/", "openPMD", "1.1.0");
+    writer.setAttribute("/", "iterationEncoding", "groupBased");
+    writer.setAttribute("/", "basePath", "/data/%T/");
+    writer.setAttribute("/", "meshesPath", "meshes/");
+    ASSERT_TRUE(writer.createGroup("/data"));
+
+    for (int i = 0; i < iterationCount; ++i) {
+      string path = "/data/" + std::to_string(i * 10);
+      ASSERT_TRUE(writer.createGroup(path));
+      ASSERT_TRUE(writer.createGroup(path + "/meshes"));
+      writer.setAttribute(path, "time", i * 0.5);
+
+      vector<int> values(6, i);
+      ASSERT_TRUE(writer.writeData(path + "/meshes", "density", { 2, 3 },
+                                   values));
+      writer.setAttribute(path + "/meshes/density", "geometry", "cartesian");
+    }
+
+    // Other groups are not iterations, including those with names that
+    // are not ASCII
+    ASSERT_TRUE(writer.createGroup("/data/notes"));
+    ASSERT_TRUE(writer.createGroup("/data/\xc3\xa9t\xc3\xa9"));
+  }
+
+  OpenPMDReader reader(test_file);
+  ASSERT_TRUE(reader.isValid());
+  ASSERT_EQ(reader.iterations().size(), static_cast<size_t>(iterationCount));
+
+  // The iterations are sorted by their index, not by their name
+  EXPECT_EQ(reader.iterations()[2].index, 20);
+  EXPECT_EQ(reader.iterations()[10].index, 100);
+  EXPECT_DOUBLE_EQ(reader.iteration(100)->time, 5.0);
+
+  vector<long long> indices;
+  for (const auto& iteration : reader.iterations())
+    indices.push_back(iteration.index);
+
+  std::atomic<long long> sum(0);
+  auto function = [&](const OpenPMDReader::Iteration& iteration) {
+    const OpenPMDReader::Mesh* density = iteration.mesh("density");
+    if (!density || density->geometry.geometry != "cartesian")
+      return false;
+
+    NDArray<long long> array;
+    if (!reader.readComponent(density->components[0], array))
+      return false;
+
+    long long total = 0;
+    for (size_t i = 0; i < array.size(); ++i)
+      total += array.data()[i];
+    sum += total;
+    return true;
+  };
+
+  EXPECT_TRUE(reader.forEachIteration(indices, function, 4));
+
+  // Each iteration i holds 6 values of i
+  long long expected = 6 * iterationCount * (iterationCount - 1) / 2;
+  EXPECT_EQ(sum, expected);
+
+  // Unknown iterations fail before anything is read
+  sum = 0;
+  EXPECT_FALSE(reader.forEachIteration({ 0, 5 }, function));
+  EXPECT_EQ(sum, 0);
+}
@@ -0,0 +1,208 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5dataset.h>
+#include <h5cpp/h5filters.h>
+#include <h5cpp/h5quantize.h>
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::DataSet;
+using h5::H5ReadWrite;
+using h5::Quantization;
+using h5::WriteOptions;
+
+using DataType = H5ReadWrite::DataType;
+using Layout = WriteOptions::Layout;
+
+static const string test_file = "quantize_test.h5";
+
+static size_t fileSize(const string& fileName)
+{
+  std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+  return static_cast<size_t>(file.tellg());
+}
+
+// A smooth 64^3 volume from -3 to 5
+static vector<float> volume()
+{
+  vector<float> data(64 * 64 * 64);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = 1.0f + 4.0f * std::sin(i * 0.001f);
+  return data;
+}
+
+TEST(QuantizeTest, roundTrip)
+{
+  vector<float> values = volume();
+  for (int bits : { 4, 8, 12, 16 }) {
+    Quantization quantization =
+      h5::chooseQuantization(values.data(), values.size(), bits);
+    EXPECT_NEAR(quantization.offset, -3.0f, 1e-3);
+    EXPECT_NEAR(quantization.scale * ((1 << bits) - 1), 8.0f, 1e-3);
+
+    vector<unsigned short> codes(values.size());
+    h5::quantize<unsigned short>(values.data(), codes.data(), values.size(),
+                                 quantization, 0, (1 << bits) - 1);
+
+    vector<float> restored(values.size());
+    h5::dequantize(codes.data(), restored.data(), codes.size(),
+                   quantization);
+
+    for (size_t i = 0; i < values.size(); ++i) {
+      ASSERT_LE(codes[i], (1 << bits) - 1);
+      ASSERT_NEAR(restored[i], values[i], quantization.scale * 0.51f);
+    }
+  }
+}
+
+TEST(QuantizeTest, clamping)
+{
+  Quantization quantization;
+  quantization.scale = 0.5f;
+  quantization.offset = -1.0f;
+
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const float infinity = std::numeric_limits<float>::infinity();
+  vector<float> values = { -1.0f, -0.74f, -0.76f, 1e9f, -1e9f, nan, infinity,
+                           -infinity };
+
+  vector<short> codes(values.size());
+  h5::quantize<short>(values.data(), codes.data(), values.size(),
+                      quantization, -100, 100);
+  EXPECT_EQ(codes, vector<short>({ 0, 1, 0, 100, -100, -100, 100, -100 }));
+
+  // Constant data is stored as code 0
+  vector<float> constant(10, 7.0f);
+  quantization = h5::chooseQuantization(constant.data(), constant.size(), 8);
+  EXPECT_EQ(quantization.offset, 7.0f);
+  EXPECT_EQ(quantization.scale, 1.0f);
+}
+
+TEST(QuantizeTest, writeQuantized)
+{
+  vector<float> data = volume();
+
+  WriteOptions options;
+  options.layout = Layout::Chunked;
+  options.quantizeBits = 12;
+
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(writer.writeData("/", "data", { 64, 64, 64 }, data,
+                                 options));
+  }
+
+  // The 12-bit codes are packed, to 3/8 of the size of the floats
+  EXPECT_LT(fileSize(test_file), data.size() * 3 / 2 + 64 * 1024);
+
+  H5ReadWrite reader(test_file);
+  EXPECT_EQ(reader.dataType("/data"), DataType::UInt16);
+
+  const float scale = reader.attribute<float>("/data", "scale_factor");
+  const float offset = reader.attribute<float>("/data", "add_offset");
+  EXPECT_NEAR(scale, 8.0f / 4095, 1e-6);
+  EXPECT_NEAR(offset, -3.0f, 1e-3);
+
+  // Reading as float restores the values
+  vector<int> dims;
+  vector<float> values = reader.readData<float>("/data", dims);
+  EXPECT_EQ(dims, vector<int>({ 64, 64, 64 }));
+  ASSERT_EQ(values.size(), data.size());
+  for (size_t i = 0; i < data.size(); ++i)
+    ASSERT_NEAR(values[i], data[i], scale * 0.51f);
+
+  // The codes can be read too
+  vector<unsigned short> codes = reader.readData<unsigned short>("/data",
+                                                                  dims);
+  ASSERT_EQ(codes.size(), data.size());
+  for (size_t i = 0; i < data.size(); ++i) {
+    ASSERT_LT(codes[i], 4096);
+    ASSERT_EQ(values[i], codes[i] * scale + offset);
+  }
+
+  vector<float> slab(64);
+  ASSERT_TRUE(reader.readSlab("/data", { 5, 6, 0 }, { 1, 1, 64 },
+                              slab.data()));
+  for (size_t i = 0; i < slab.size(); ++i)
+    EXPECT_EQ(slab[i], values[(5 * 64 + 6) * 64 + i]);
+
+  DataSet dataSet = reader.openDataSet("/data");
+  vector<float> all(data.size());
+  ASSERT_TRUE(dataSet.readData(all.data()));
+  EXPECT_EQ(all, values);
+
+  // But not as other types
+  vector<double> doubles(data.size());
+  EXPECT_FALSE(reader.readData("/data", doubles.data()));
+}
+
+TEST(QuantizeTest, options)
+{
+  vector<float> data = volume();
+
+  WriteOptions options;
+  options.quantizeBits = 8;
+
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(writer.writeData("/", "bytes", { 64, 64, 64 }, data,
+                                 options));
+
+    // Float writes to quantized data sets are quantized too
+    vector<float> row(64, 5.0f);
+    ASSERT_TRUE(writer.writeSlab("/bytes", { 0, 0, 0 }, { 1, 1, 64 },
+                                 row.data()));
+
+    // The option is ignored for other types
+    vector<double> doubles(data.begin(), data.end());
+    ASSERT_TRUE(writer.writeData("/", "doubles", { 64, 64, 64 }, doubles,
+                                 options));
+
+    // And it takes precedence over Float16
+    options.storeFloat16 = true;
+    if (h5::compressionAvailable(WriteOptions::Compression::Zstd))
+      options.compression = WriteOptions::Compression::Zstd;
+    ASSERT_TRUE(writer.writeData("/", "compressed", { 64, 64, 64 }, data,
+                                 options));
+
+    // Too many bits
+    options.quantizeBits = 20;
+    EXPECT_FALSE(writer.writeData("/", "wide", { 64, 64, 64 }, data,
+                                  options));
+  }
+
+  H5ReadWrite reader(test_file);
+  EXPECT_EQ(reader.dataType("/bytes"), DataType::UInt8);
+  EXPECT_EQ(reader.dataType("/doubles"), DataType::Double);
+  EXPECT_EQ(reader.dataType("/compressed"), DataType::UInt8);
+
+  const float scale = reader.attribute<float>("/bytes", "scale_factor");
+  vector<int> dims;
+  for (const char* path : { "/bytes", "/compressed" }) {
+    vector<float> values = reader.readData<float>(path, dims);
+    ASSERT_EQ(values.size(), data.size());
+    for (size_t i = 64; i < data.size(); ++i)
+      ASSERT_NEAR(values[i], data[i], scale * 0.51f);
+  }
+
+  vector<float> row(64);
+  ASSERT_TRUE(reader.readSlab("/bytes", { 0, 0, 0 }, { 1, 1, 64 },
+                              row.data()));
+  for (float value : row)
+    EXPECT_NEAR(value, 5.0f, 1e-5);
+
+  // Run this last
+  std::remove(test_file.c_str());
+}
@@ -0,0 +1,275 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5readwrite.h>
+#include <h5cpp/h5reducer.h>
+
+using std::string;
+using std::vector;
+
+using h5::H5ReadWrite;
+using h5::NDArray;
+using h5::ReduceOptions;
+using h5::Reducer;
+using h5::WriteOptions;
+
+static const string test_file = "reducer_test.h5";
+
+static const vector<int> dims = { 9, 7, 5 };
+
+static short value(int i, int j, int k)
+{
+  return static_cast<short>((i * 31 + j * 17 + k * 7) % 23 - 11);
+}
+
+static void writeVolumes()
+{
+  vector<short> volume;
+  for (int i = 0; i < dims[0]; ++i) {
+    for (int j = 0; j < dims[1]; ++j) {
+      for (int k = 0; k < dims[2]; ++k)
+        volume.push_back(value(i, j, k));
+    }
+  }
+
+  H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+
+  WriteOptions chunked;
+  chunked.chunkDimensions = { 2, 3, 5 };
+  ASSERT_TRUE(writer.writeData("/", "chunked", dims, volume, chunked));
+
+  WriteOptions contiguous;
+  contiguous.layout = WriteOptions::Layout::Contiguous;
+  ASSERT_TRUE(writer.writeData("/", "contiguous", dims, volume, contiguous));
+
+  vector<float> line = { 1.5f, -2.0f, 4.0f };
+  ASSERT_TRUE(writer.writeData("/", "line", { 3 }, line));
+}
+
+// Reduce the volume in memory, the slow way
+static vector<double> expected(int axis, Reducer::Operation operation)
+{
+  vector<int> shape;
+  for (int i = 0; i < 3; ++i) {
+    if (i != axis)
+      shape.push_back(dims[i]);
+  }
+
+  vector<double> result;
+  for (int a = 0; a < shape[0]; ++a) {
+    for (int b = 0; b < shape[1]; ++b) {
+      double sum = 0;
+      double low = std::numeric_limits<double>::infinity();
+      double high = -low;
+      for (int c = 0; c < dims[axis]; ++c) {
+        int index[3];
+        index[axis] = c;
+        index[axis == 0 ? 1 : 0] = a;
+        index[axis == 2 ? 1 : 2] = b;
+        double v = value(index[0], index[1], index[2]);
+        sum += v;
+        low = std::min(low, v);
+        high = std::max(high, v);
+      }
+
+      switch (operation) {
+        case Reducer::Operation::Sum:
+          result.push_back(sum);
+          break;
+        case Reducer::Operation::Mean:
+          result.push_back(sum / dims[axis]);
+          break;
+        case Reducer::Operation::Min:
+          result.push_back(low);
+          break;
+        case Reducer::Operation::Max:
+          result.push_back(high);
+          break;
+      }
+    }
+  }
+  return result;
+}
+
+TEST(ReducerTest, builtins)
+{
+  writeVolumes();
+
+  H5ReadWrite reader(test_file);
+  const Reducer::Operation operations[] = {
+    Reducer::Operation::Sum, Reducer::Operation::Mean,
+    Reducer::Operation::Min, Reducer::Operation::Max
+  };
+
+  // A tiny memory bound forces many small blocks
+  ReduceOptions small;
+  small.memoryBytes = 512;
+  small.threads = 3;
+
+  ReduceOptions single;
+  single.threads = 1;
+
+  for (const char* path : { "/chunked", "/contiguous" }) {
+    Reducer reducer(reader, path);
+    ASSERT_TRUE(reducer.isValid());
+    EXPECT_EQ(reducer.dimensions(), dims);
+
+    for (int axis = 0; axis < 3; ++axis) {
+      for (auto operation : operations) {
+        vector<double> reference = expected(axis, operation);
+        for (const ReduceOptions& options :
+             { ReduceOptions(), small, single }) {
+          NDArray<double> result;
+          ASSERT_TRUE(reducer.reduce(axis, operation, result, options));
+          ASSERT_EQ(result.size(), reference.size());
+          for (size_t i = 0; i < reference.size(); ++i)
+            EXPECT_DOUBLE_EQ(result.data()[i], reference[i])
+              << path << " axis " << axis << " at " << i;
+        }
+      }
+    }
+  }
+}
+
+TEST(ReducerTest, blockShape)
+{
+  writeVolumes();
+
+  H5ReadWrite reader(test_file);
+  Reducer reducer(reader, "/chunked");
+  ASSERT_TRUE(reducer.isValid());
+
+  // With plenty of memory, blocks grow by whole chunks along the axis
+  ReduceOptions options;
+  options.threads = 1;
+  EXPECT_EQ(reducer.blockShape(0, options), vector<int>({ 9, 7, 5 }));
+
+  // Blocks split chunks to stay within the memory bound of each thread,
+  // which also holds a chunk in the chunk cache
+  const size_t chunkBytes = 2 * 3 * 5 * sizeof(short);
+  options.memoryBytes = 256;
+  vector<int> block = reducer.blockShape(0, options);
+  ASSERT_EQ(block.size(), 3u);
+  size_t elements = block[0] * block[1] * block[2];
+  EXPECT_LT(elements, 2u * 3 * 5);
+  EXPECT_LE(chunkBytes + elements * sizeof(short) +
+              2 * block[1] * block[2] * 8,
+            256u);
+
+  // Chunks are not split when the chunk cache would not fit
+  options.memoryBytes = 2 * chunkBytes;
+  options.threads = 2;
+  EXPECT_EQ(reducer.blockShape(0, options), vector<int>({ 2, 3, 5 }));
+
+  EXPECT_TRUE(reducer.blockShape(3).empty());
+}
+
+TEST(ReducerTest, customFold)
+{
+  writeVolumes();
+
+  H5ReadWrite reader(test_file);
+  Reducer reducer(reader, "/chunked");
+  ASSERT_TRUE(reducer.isValid());
+
+  // The sum of squares
+  auto fold = [](double* accumulators, const double* values, size_t count) {
+    for (size_t i = 0; i < count; ++i)
+      accumulators[i] += values[i] * values[i];
+  };
+
+  ReduceOptions options;
+  options.memoryBytes = 1024;
+  NDArray<double> result;
+  ASSERT_TRUE(reducer.reduce(1, 0.0, fold, result, options));
+  ASSERT_EQ(result.shape(), vector<int>({ 9, 5 }));
+  for (int i = 0; i < 9; ++i) {
+    for (int k = 0; k < 5; ++k) {
+      double sum = 0;
+      for (int j = 0; j < 7; ++j)
+        sum += value(i, j, k) * value(i, j, k);
+      EXPECT_DOUBLE_EQ(result(i, k), sum);
+    }
+  }
+}
+
+TEST(ReducerTest, edgeCases)
+{
+  writeVolumes();
+
+  H5ReadWrite reader(test_file);
+  Reducer line(reader, "/line");
+  ASSERT_TRUE(line.isValid());
+
+  NDArray<double> result;
+  ASSERT_TRUE(line.reduce(0, Reducer::Operation::Sum, result));
+  ASSERT_EQ(result.shape(), vector<int>({ 1 }));
+  EXPECT_DOUBLE_EQ(result.data()[0], 3.5);
+
+  EXPECT_FALSE(line.reduce(1, Reducer::Operation::Sum, result));
+
+  Reducer missing(reader, "/missing");
+  EXPECT_FALSE(missing.isValid());
+  EXPECT_FALSE(missing.reduce(0, Reducer::Operation::Sum, result));
+}
+
+TEST(ReducerTest, float16)
+{
+  // Small integers are exact in half precision
+  vector<float> volume = { 1.0f, 2.0f, -3.0f, 4.0f, 0.5f, 6.0f };
+  WriteOptions options;
+  options.storeFloat16 = true;
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(writer.writeData("/", "half", { 2, 3 }, volume, options));
+  }
+
+  H5ReadWrite reader(test_file);
+  Reducer half(reader, "/half");
+  ASSERT_TRUE(half.isValid());
+
+  NDArray<double> result;
+  ASSERT_TRUE(half.reduce(0, Reducer::Operation::Sum, result));
+  ASSERT_EQ(result.shape(), vector<int>({ 3 }));
+  EXPECT_DOUBLE_EQ(result.data()[0], 5.0);
+  EXPECT_DOUBLE_EQ(result.data()[1], 2.5);
+  EXPECT_DOUBLE_EQ(result.data()[2], 3.0);
+}
+
+TEST(ReducerTest, quantized)
+{
+  vector<float> volume(4 * 8);
+  for (size_t i = 0; i < volume.size(); ++i)
+    volume[i] = static_cast<float>(i % 5) * 0.25f - 0.5f;
+
+  WriteOptions options;
+  options.quantizeBits = 12;
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(writer.writeData("/", "packed", { 4, 8 }, volume, options));
+  }
+
+  H5ReadWrite reader(test_file);
+  const float scale = reader.attribute<float>("/packed", "scale_factor");
+
+  // The values are restored, not the integer codes folded
+  Reducer packed(reader, "/packed");
+  ASSERT_TRUE(packed.isValid());
+
+  NDArray<double> result;
+  ASSERT_TRUE(packed.reduce(0, Reducer::Operation::Sum, result));
+  ASSERT_EQ(result.shape(), vector<int>({ 8 }));
+  for (int j = 0; j < 8; ++j) {
+    double sum = 0;
+    for (int i = 0; i < 4; ++i)
+      sum += volume[i * 8 + j];
+    EXPECT_NEAR(result.data()[j], sum, 4 * scale);
+  }
+}
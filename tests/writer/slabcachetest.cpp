@@ -0,0 +1,182 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5dataset.h>
+#include <h5cpp/h5readwrite.h>
+#include <h5cpp/h5slabcache.h>
+
+using std::string;
+using std::vector;
+
+using h5::DataSet;
+using h5::H5ReadWrite;
+using h5::SlabCache;
+
+static const string test_file = "slabcache_test.h5";
+
+static void writeFile(int length, int offset)
+{
+  vector<int> data(length);
+  for (int i = 0; i < length; ++i)
+    data[i] = i + offset;
+
+  H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+  ASSERT_TRUE(writer.writeData("/", "data", { length }, data));
+  ASSERT_TRUE(writer.writeData("/", "other", { length }, data));
+}
+
+// Enables the cache for one test, and leaves it disabled afterwards
+class SlabCacheTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    SlabCache::instance().setCapacity(1024 * 1024);
+    SlabCache::instance().clear();
+    SlabCache::instance().resetStatistics();
+  }
+
+  void TearDown() override { SlabCache::instance().setCapacity(0); }
+};
+
+TEST_F(SlabCacheTest, sharedBetweenInstances)
+{
+  writeFile(100, 0);
+  SlabCache& cache = SlabCache::instance();
+
+  {
+    H5ReadWrite reader(test_file);
+    vector<int> data = reader.readData<int>("/data");
+    ASSERT_EQ(data.size(), 100u);
+    EXPECT_EQ(cache.statistics().misses, 1u);
+    EXPECT_EQ(cache.statistics().entries, 1u);
+    EXPECT_EQ(cache.statistics().bytes, 400u);
+  }
+
+  // Another instance of the same file reads from the cache
+  H5ReadWrite reader(test_file);
+  vector<int> data = reader.readData<int>("/data");
+  ASSERT_EQ(data.size(), 100u);
+  EXPECT_EQ(data[99], 99);
+  EXPECT_EQ(cache.statistics().hits, 1u);
+
+  // Hyperslabs inside a cached data set are copied from it
+  vector<int> slab(10);
+  ASSERT_TRUE(reader.readSlab("/data", { 20 }, { 10 }, slab.data()));
+  EXPECT_EQ(slab[0], 20);
+  EXPECT_EQ(slab[9], 29);
+  EXPECT_EQ(cache.statistics().hits, 2u);
+  EXPECT_EQ(cache.statistics().misses, 1u);
+  EXPECT_EQ(cache.statistics().entries, 1u);
+
+  // A type mismatch is not served from the cache
+  EXPECT_TRUE(reader.readData<float>("/data").empty());
+}
+
+TEST_F(SlabCacheTest, overlappingSlabs)
+{
+  const int size = 20;
+  vector<int> data(size * size * size);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<int>(i);
+
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(writer.writeData("/", "volume", { size, size, size }, data));
+  }
+
+  SlabCache& cache = SlabCache::instance();
+  H5ReadWrite reader(test_file);
+  vector<int> slab(10 * 10 * 10);
+  ASSERT_TRUE(
+    reader.readSlab("/volume", { 5, 5, 5 }, { 10, 10, 10 }, slab.data()));
+  EXPECT_EQ(cache.statistics().misses, 1u);
+
+  // A region inside the slab, through a data set handle
+  DataSet dataSet = reader.openDataSet("/volume");
+  ASSERT_TRUE(dataSet.isValid());
+  vector<int> inner(3 * 4 * 5);
+  ASSERT_TRUE(dataSet.readSlab({ 7, 8, 9 }, { 3, 4, 5 }, inner.data()));
+  EXPECT_EQ(cache.statistics().hits, 1u);
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      for (int k = 0; k < 5; ++k) {
+        int index = ((7 + i) * size + 8 + j) * size + 9 + k;
+        EXPECT_EQ(inner[(i * 4 + j) * 5 + k], data[index]);
+      }
+    }
+  }
+
+  // A region that crosses the edge of the slab is read from the file
+  inner.resize(4 * 4 * 5);
+  ASSERT_TRUE(dataSet.readSlab({ 12, 8, 9 }, { 4, 4, 5 }, inner.data()));
+  EXPECT_EQ(cache.statistics().misses, 2u);
+  EXPECT_EQ(inner[0], data[(12 * size + 8) * size + 9]);
+  EXPECT_EQ(cache.statistics().entries, 2u);
+}
+
+TEST_F(SlabCacheTest, eviction)
+{
+  writeFile(100, 0);
+  SlabCache& cache = SlabCache::instance();
+
+  // Room for only one of the data sets
+  cache.setCapacity(600);
+
+  H5ReadWrite reader(test_file);
+  reader.readData<int>("/data");
+  reader.readData<int>("/other");
+  EXPECT_EQ(cache.statistics().evictions, 1u);
+  EXPECT_EQ(cache.statistics().entries, 1u);
+
+  // "/data" was the least recently used, and it is gone
+  reader.readData<int>("/data");
+  EXPECT_EQ(cache.statistics().hits, 0u);
+  EXPECT_EQ(cache.statistics().misses, 3u);
+
+  // Too large to be cached at all
+  cache.setCapacity(100);
+  EXPECT_EQ(cache.statistics().entries, 0u);
+  reader.readData<int>("/data");
+  EXPECT_EQ(cache.statistics().entries, 0u);
+}
+
+TEST_F(SlabCacheTest, invalidation)
+{
+  writeFile(100, 0);
+  SlabCache& cache = SlabCache::instance();
+
+  {
+    H5ReadWrite reader(test_file);
+    reader.readData<int>("/data");
+  }
+
+  // Rewrite the file with different contents
+  writeFile(120, 1000);
+
+  H5ReadWrite reader(test_file);
+  vector<int> data = reader.readData<int>("/data");
+  ASSERT_EQ(data.size(), 120u);
+  EXPECT_EQ(data[0], 1000);
+  EXPECT_EQ(cache.statistics().invalidations, 1u);
+  EXPECT_EQ(cache.statistics().hits, 0u);
+}
+
+TEST_F(SlabCacheTest, writersBypass)
+{
+  writeFile(100, 0);
+  SlabCache& cache = SlabCache::instance();
+
+  H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::ReadWrite);
+  writer.readData<int>("/data");
+  EXPECT_EQ(cache.statistics().misses, 0u);
+  EXPECT_EQ(cache.statistics().entries, 0u);
+
+  cache.setCapacity(0);
+  EXPECT_FALSE(cache.enabled());
+}
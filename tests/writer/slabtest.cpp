@@ -0,0 +1,67 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::H5ReadWrite;
+
+static const string test_file = "slab_test.h5";
+
+TEST(SlabTest, updateInPlace)
+{
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    vector<float> data(4 * 5, 1.0f);
+    EXPECT_TRUE(writer.writeData("/", "volume", { 4, 5 }, data));
+  }
+
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::ReadWrite);
+
+    // Overwrite the middle of the second and third rows
+    vector<float> slab = { 2.0f, 3.0f, 4.0f, 5.0f };
+    EXPECT_TRUE(writer.writeSlab("/volume", { 1, 1 }, { 2, 2 },
+                                 slab.data()));
+
+    // A slab that does not fit in the data set must fail
+    EXPECT_FALSE(writer.writeSlab("/volume", { 3, 4 }, { 2, 2 },
+                                  slab.data()));
+    EXPECT_FALSE(writer.writeSlab("/volume", { 0 }, { 2 }, slab.data()));
+
+    // Existing files can also have data sets added to them
+    vector<int> extra = { 7, 8, 9 };
+    EXPECT_TRUE(writer.writeData("/", "extra", { 3 }, extra));
+  }
+
+  H5ReadWrite reader(test_file);
+  vector<int> dims;
+  vector<float> data = reader.readData<float>("/volume", dims);
+  EXPECT_EQ(data.size(), 20);
+  EXPECT_FLOAT_EQ(data[0], 1.0f);
+  EXPECT_FLOAT_EQ(data[6], 2.0f);
+  EXPECT_FLOAT_EQ(data[7], 3.0f);
+  EXPECT_FLOAT_EQ(data[8], 1.0f);
+  EXPECT_FLOAT_EQ(data[11], 4.0f);
+  EXPECT_FLOAT_EQ(data[12], 5.0f);
+
+  vector<float> slab(2 * 3);
+  EXPECT_TRUE(reader.readSlab("/volume", { 1, 0 }, { 2, 3 }, slab.data()));
+  EXPECT_FLOAT_EQ(slab[0], 1.0f);
+  EXPECT_FLOAT_EQ(slab[1], 2.0f);
+  EXPECT_FLOAT_EQ(slab[2], 3.0f);
+  EXPECT_FLOAT_EQ(slab[4], 4.0f);
+
+  // Wrong type
+  vector<int> wrong(6);
+  EXPECT_FALSE(reader.readSlab("/volume", { 1, 0 }, { 2, 3 }, wrong.data()));
+
+  EXPECT_EQ(reader.readData<int>("/extra").size(), 3);
+}
@@ -0,0 +1,185 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5readwrite.h>
+#include <h5cpp/h5sliceiterator.h>
+
+using std::string;
+using std::vector;
+
+using h5::H5ReadWrite;
+using h5::SliceIterator;
+using h5::WriteOptions;
+
+static const string test_file = "sliceiterator_test.h5";
+
+// A 10 x 4 x 3 volume where each value is its linear index
+static void writeVolume()
+{
+  vector<int> volume(120);
+  for (size_t i = 0; i < volume.size(); ++i)
+    volume[i] = static_cast<int>(i);
+
+  WriteOptions options;
+  options.layout = WriteOptions::Layout::Chunked;
+  options.chunkDimensions = { 1, 4, 3 };
+
+  H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+  ASSERT_TRUE(writer.writeData("/", "volume", { 10, 4, 3 }, volume, options));
+}
+
+TEST(SliceIteratorTest, firstAxis)
+{
+  writeVolume();
+
+  H5ReadWrite reader(test_file);
+  SliceIterator<int> slices(reader, "/volume", 0, 3);
+  ASSERT_TRUE(slices.isValid());
+  EXPECT_EQ(slices.count(), 10);
+  EXPECT_EQ(slices.sliceShape(), vector<int>({ 4, 3 }));
+  EXPECT_EQ(slices.index(), -1);
+  EXPECT_TRUE(slices.slice().empty());
+
+  int index = 0;
+  while (slices.next()) {
+    EXPECT_EQ(slices.index(), index);
+    ASSERT_EQ(slices.slice().shape(), vector<int>({ 4, 3 }));
+    for (size_t i = 0; i < 12; ++i)
+      EXPECT_EQ(slices.slice().data()[i], index * 12 + static_cast<int>(i));
+    ++index;
+  }
+  EXPECT_EQ(index, 10);
+
+  // The end stays the end
+  EXPECT_FALSE(slices.next());
+}
+
+TEST(SliceIteratorTest, otherAxes)
+{
+  writeVolume();
+
+  H5ReadWrite reader(test_file);
+  SliceIterator<int> slices(reader, "/volume", 2, 1);
+  ASSERT_TRUE(slices.isValid());
+  EXPECT_EQ(slices.count(), 3);
+  EXPECT_EQ(slices.sliceShape(), vector<int>({ 10, 4 }));
+
+  for (int k = 0; k < 3; ++k) {
+    ASSERT_TRUE(slices.next());
+    const auto& slice = slices.slice();
+    for (int i = 0; i < 10; ++i) {
+      for (int j = 0; j < 4; ++j)
+        EXPECT_EQ(slice(i, j), i * 12 + j * 3 + k);
+    }
+  }
+  EXPECT_FALSE(slices.next());
+}
+
+TEST(SliceIteratorTest, seek)
+{
+  writeVolume();
+
+  H5ReadWrite reader(test_file);
+  SliceIterator<int> slices(reader, "/volume", 0);
+  ASSERT_TRUE(slices.isValid());
+
+  ASSERT_TRUE(slices.next());
+  ASSERT_TRUE(slices.next());
+  EXPECT_EQ(slices.index(), 1);
+
+  // Jump back and forth, as when scrubbing through a viewer
+  ASSERT_TRUE(slices.seek(7));
+  ASSERT_TRUE(slices.next());
+  EXPECT_EQ(slices.index(), 7);
+  EXPECT_EQ(slices.slice().data()[0], 84);
+
+  ASSERT_TRUE(slices.seek(0));
+  ASSERT_TRUE(slices.next());
+  EXPECT_EQ(slices.index(), 0);
+  EXPECT_EQ(slices.slice().data()[0], 0);
+  ASSERT_TRUE(slices.next());
+  EXPECT_EQ(slices.index(), 1);
+
+  EXPECT_FALSE(slices.seek(10));
+  EXPECT_FALSE(slices.seek(-1));
+}
+
+TEST(SliceIteratorTest, invalid)
+{
+  writeVolume();
+
+  H5ReadWrite reader(test_file);
+
+  // The type must match the data set
+  SliceIterator<float> wrongType(reader, "/volume", 0);
+  EXPECT_FALSE(wrongType.isValid());
+  EXPECT_FALSE(wrongType.next());
+
+  SliceIterator<int> wrongAxis(reader, "/volume", 3);
+  EXPECT_FALSE(wrongAxis.isValid());
+
+  // Stopping early must not hang
+  SliceIterator<int> early(reader, "/volume", 0, 4);
+  ASSERT_TRUE(early.next());
+}
+
+TEST(SliceIteratorTest, float16)
+{
+  // Small integers are exact in half precision
+  vector<float> volume = { 1.0f, 2.0f, -3.0f, 4.0f, 0.5f, 6.0f };
+  WriteOptions options;
+  options.storeFloat16 = true;
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(writer.writeData("/", "half", { 2, 3 }, volume, options));
+  }
+
+  // Float16 data sets are read as float
+  H5ReadWrite reader(test_file);
+  SliceIterator<float> slices(reader, "/half", 0);
+  ASSERT_TRUE(slices.isValid());
+
+  size_t offset = 0;
+  while (slices.next()) {
+    ASSERT_EQ(slices.slice().shape(), vector<int>({ 3 }));
+    for (size_t i = 0; i < 3; ++i)
+      EXPECT_EQ(slices.slice().data()[i], volume[offset + i]);
+    offset += 3;
+  }
+  EXPECT_EQ(offset, volume.size());
+}
+
+TEST(SliceIteratorTest, quantized)
+{
+  vector<float> volume = { -1.0f, 0.0f, 0.5f, 2.0f, 1.5f, -0.25f };
+  WriteOptions options;
+  options.quantizeBits = 12;
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(writer.writeData("/", "packed", { 2, 3 }, volume, options));
+  }
+
+  // Quantized data sets are restored as float
+  H5ReadWrite reader(test_file);
+  const float scale = reader.attribute<float>("/packed", "scale_factor");
+  SliceIterator<float> slices(reader, "/packed", 0);
+  ASSERT_TRUE(slices.isValid());
+
+  size_t offset = 0;
+  while (slices.next()) {
+    ASSERT_EQ(slices.slice().shape(), vector<int>({ 3 }));
+    for (size_t i = 0; i < 3; ++i)
+      EXPECT_NEAR(slices.slice().data()[i], volume[offset + i], scale);
+    offset += 3;
+  }
+  EXPECT_EQ(offset, volume.size());
+
+  // And not handed out as their codes
+  SliceIterator<int> codes(reader, "/packed", 0);
+  EXPECT_FALSE(codes.isValid());
+}
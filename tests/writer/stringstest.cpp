@@ -0,0 +1,104 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::H5ReadWrite;
+using h5::StringTable;
+using h5::WriteOptions;
+
+static const string test_file = "strings_test.h5";
+
+TEST(StringsTest, variableLength)
+{
+  vector<string> labels = { "background", "", "a much longer label", "x" };
+
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(writer.writeData("/", "labels", { 4 }, labels));
+
+    vector<string> grid = { "a", "b", "c", "d", "e", "f" };
+    ASSERT_TRUE(writer.writeData("/", "grid", { 2, 3 }, grid));
+
+    // The dimensions must match the number of strings
+    EXPECT_FALSE(writer.writeData("/", "wrong", { 3 }, labels));
+  }
+
+  H5ReadWrite reader(test_file);
+  EXPECT_EQ(reader.dataType("/labels"), H5ReadWrite::DataType::String);
+  EXPECT_EQ(reader.readData<string>("/labels"), labels);
+
+  vector<int> dims;
+  EXPECT_EQ(reader.readData<string>("/grid", dims),
+            vector<string>({ "a", "b", "c", "d", "e", "f" }));
+  EXPECT_EQ(dims, vector<int>({ 2, 3 }));
+}
+
+TEST(StringsTest, fixedLength)
+{
+  vector<string> files = { "tilt_000.tif", "tilt_001.tif", "dark.tif" };
+
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    WriteOptions options;
+    options.fixedLengthStrings = true;
+    ASSERT_TRUE(writer.writeData("/", "files", { 3 }, files, options));
+  }
+
+  H5ReadWrite reader(test_file);
+  EXPECT_EQ(reader.dataType("/files"), H5ReadWrite::DataType::String);
+  EXPECT_EQ(reader.readData<string>("/files"), files);
+
+  // Strings cannot be read as numbers
+  EXPECT_TRUE(reader.readData<char>("/files").empty());
+}
+
+TEST(StringsTest, stringTable)
+{
+  vector<string> labels = { "background", "", "a much longer label", "x" };
+  vector<string> files = { "tilt_000.tif", "tilt_001.tif" };
+
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(writer.writeData("/", "labels", { 2, 2 }, labels));
+
+    WriteOptions options;
+    options.fixedLengthStrings = true;
+    ASSERT_TRUE(writer.writeData("/", "files", { 2 }, files, options));
+    ASSERT_TRUE(writer.writeData("/", "numbers", { 2 }, vector<int>{ 1, 2 }));
+  }
+
+  H5ReadWrite reader(test_file);
+
+  // Variable-length strings are copied back to back
+  StringTable table;
+  ASSERT_TRUE(reader.readData("/labels", table));
+  EXPECT_EQ(table.shape(), vector<int>({ 2, 2 }));
+  ASSERT_EQ(table.size(), labels.size());
+  for (size_t i = 0; i < labels.size(); ++i) {
+    EXPECT_EQ(table.string(i), labels[i]);
+    EXPECT_EQ(table.length(i), labels[i].size());
+    EXPECT_STREQ(table.data(i), labels[i].c_str());
+  }
+  EXPECT_EQ(table.data(1) + 1, table.data(2));
+
+  // Fixed-length strings lose their padding, and the table is refilled
+  ASSERT_TRUE(reader.readData("/files", table));
+  EXPECT_EQ(table.shape(), vector<int>({ 2 }));
+  ASSERT_EQ(table.size(), files.size());
+  EXPECT_EQ(table.string(0), files[0]);
+  EXPECT_EQ(std::strlen(table.data(1)), files[1].size());
+
+  EXPECT_FALSE(reader.readData("/numbers", table));
+  EXPECT_TRUE(table.empty());
+  EXPECT_FALSE(reader.readData("/missing", table));
+}
@@ -0,0 +1,56 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::H5ReadWrite;
+
+static const string test_file = "swmr_test.h5";
+
+TEST(SWMRTest, appendAndRefresh)
+{
+  using DataType = H5ReadWrite::DataType;
+
+  H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::SWMRWrite);
+
+  // The layout must be complete before SWMR writing starts
+  EXPECT_TRUE(writer.createGroup("/frames"));
+  EXPECT_TRUE(writer.createAppendableDataSet("/frames", "data", { 2, 3 },
+                                             DataType::Int32));
+  EXPECT_TRUE(writer.startSWMRWrite());
+
+  vector<int> frame = { 0, 1, 2, 3, 4, 5 };
+  EXPECT_TRUE(writer.appendData("/frames/data", frame.data()));
+
+  H5ReadWrite reader(test_file, H5ReadWrite::OpenMode::SWMRRead);
+  EXPECT_TRUE(reader.refresh("/frames/data"));
+
+  vector<int> dims = reader.getDimensions("/frames/data");
+  EXPECT_EQ(dims.size(), 3);
+  EXPECT_EQ(dims[0], 1);
+  EXPECT_EQ(dims[1], 2);
+  EXPECT_EQ(dims[2], 3);
+
+  // Append a second frame, and make sure the reader can see it
+  for (auto& value : frame)
+    value += 10;
+  EXPECT_TRUE(writer.appendData("/frames/data", DataType::Int32,
+                                frame.data()));
+
+  EXPECT_TRUE(reader.refresh("/frames/data"));
+  vector<int> data = reader.readData<int>("/frames/data", dims);
+  EXPECT_EQ(dims[0], 2);
+  EXPECT_EQ(data.size(), 12);
+  EXPECT_EQ(data[0], 0);
+  EXPECT_EQ(data[5], 5);
+  EXPECT_EQ(data[6], 10);
+  EXPECT_EQ(data[11], 15);
+}
@@ -0,0 +1,205 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5dataset.h>
+#include <h5cpp/h5filters.h>
+#include <h5cpp/h5readwrite.h>
+#include <h5cpp/h5trace.h>
+
+using std::string;
+using std::vector;
+
+using h5::H5ReadWrite;
+using h5::TraceSpan;
+using h5::Tracer;
+using h5::WriteOptions;
+
+using Span = Tracer::Span;
+
+static const string test_file = "trace_test.h5";
+static const string trace_file = "trace_test.json";
+
+// The spans of a category, and of a path if it is not empty
+static vector<Span> find(const vector<Span>& spans, const string& category,
+                         const string& path = string())
+{
+  vector<Span> result;
+  for (const Span& span : spans) {
+    if (span.category == category && (path.empty() || span.path == path))
+      result.push_back(span);
+  }
+  return result;
+}
+
+static size_t count(const string& text, const string& pattern)
+{
+  size_t result = 0;
+  for (size_t i = text.find(pattern); i != string::npos;
+       i = text.find(pattern, i + 1)) {
+    ++result;
+  }
+  return result;
+}
+
+TEST(TraceTest, operations)
+{
+  Tracer& tracer = Tracer::instance();
+  tracer.start();
+
+  vector<float> data(32 * 32 * 32);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<float>(i % 100);
+
+  WriteOptions options;
+  options.chunkDimensions = { 8, 32, 32 };
+  if (h5::compressionAvailable(WriteOptions::Compression::Zstd))
+    options.compression = WriteOptions::Compression::Zstd;
+
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(writer.writeData("/", "volume", { 32, 32, 32 }, data,
+                                 options));
+
+    WriteOptions halfOptions;
+    halfOptions.storeFloat16 = true;
+    ASSERT_TRUE(writer.writeData("/", "half", { 32, 32, 32 }, data,
+                                 halfOptions));
+  }
+
+  {
+    H5ReadWrite reader(test_file);
+    vector<float> slab(32 * 32);
+    ASSERT_TRUE(reader.readSlab("/volume", { 3, 0, 0 }, { 1, 32, 32 },
+                                slab.data()));
+    vector<float> all(data.size());
+    ASSERT_TRUE(reader.readData("/half", all.data()));
+  }
+
+  tracer.stop();
+  vector<Span> spans = tracer.spans();
+
+  // The file is opened and closed twice
+  EXPECT_EQ(find(spans, "open", test_file).size(), 2u);
+  EXPECT_EQ(find(spans, "close", test_file).size(), 2u);
+
+  // Each call is a span, with the phases inside it
+  vector<Span> calls = find(spans, "H5ReadWrite", "/volume");
+  ASSERT_EQ(calls.size(), 2u);
+  EXPECT_STREQ(calls[0].name, "writeData");
+  EXPECT_STREQ(calls[1].name, "readSlab");
+
+  vector<Span> reads = find(spans, "read", "/volume");
+  ASSERT_EQ(reads.size(), 1u);
+  EXPECT_EQ(reads[0].bytes, 32 * 32 * 4);
+  EXPECT_GE(reads[0].start, calls[1].start);
+  EXPECT_LE(reads[0].start + reads[0].duration,
+            calls[1].start + calls[1].duration);
+  EXPECT_EQ(reads[0].thread, calls[1].thread);
+
+  vector<Span> writes = find(spans, "write", "/volume");
+  ASSERT_EQ(writes.size(), 1u);
+  EXPECT_EQ(writes[0].bytes, static_cast<int64_t>(data.size() * 4));
+
+  EXPECT_EQ(find(spans, "metadata", "/volume").size(), 2u);
+
+  // Float16 data sets are converted when they are written and read
+  vector<Span> conversions = find(spans, "convert", "/half");
+  ASSERT_EQ(conversions.size(), 2u);
+  for (const Span& span : conversions)
+    EXPECT_EQ(span.bytes, static_cast<int64_t>(data.size() * 4));
+  ASSERT_EQ(find(spans, "read", "/half").size(), 1u);
+  EXPECT_EQ(find(spans, "read", "/half")[0].bytes,
+            static_cast<int64_t>(data.size() * 2));
+
+  if (options.compression == WriteOptions::Compression::Zstd) {
+    EXPECT_EQ(find(spans, "compress").size(), 4u);
+    vector<Span> decompressions = find(spans, "decompress");
+    ASSERT_EQ(decompressions.size(), 1u);
+    EXPECT_STREQ(decompressions[0].name, "zstd");
+    EXPECT_EQ(decompressions[0].bytes, 8 * 32 * 32 * 4);
+  }
+
+  // The trace is Chrome trace-event JSON, with one complete event a span
+  ASSERT_TRUE(tracer.write(trace_file));
+  std::ifstream file(trace_file);
+  const string json((std::istreambuf_iterator<char>(file)),
+                    std::istreambuf_iterator<char>());
+  const string header = "{\"displayTimeUnit\":\"ms\",\"traceEvents\"";
+  EXPECT_EQ(json.compare(0, header.size(), header), 0);
+  EXPECT_EQ(count(json, "\"ph\":\"X\""), spans.size());
+  size_t volumeSpans = 0;
+  for (const Span& span : spans)
+    volumeSpans += span.path == "/volume" ? 1 : 0;
+  EXPECT_EQ(count(json, "\"path\":\"/volume\""), volumeSpans);
+  EXPECT_NE(json.find("\"cat\":\"read\""), string::npos);
+  EXPECT_NE(json.find("\"bytes\":4096"), string::npos);
+
+  std::remove(trace_file.c_str());
+}
+
+TEST(TraceTest, threads)
+{
+  Tracer& tracer = Tracer::instance();
+  tracer.start();
+
+  std::thread thread([]() { TraceSpan span("work", "test", "/other"); });
+  {
+    TraceSpan span("work", "test", "/main");
+    span.setBytes(10);
+  }
+  thread.join();
+
+  tracer.stop();
+  vector<Span> spans = find(tracer.spans(), "test");
+  ASSERT_EQ(spans.size(), 2u);
+  std::set<int> threads;
+  for (const Span& span : spans) {
+    threads.insert(span.thread);
+    EXPECT_GE(span.duration, 0);
+    EXPECT_EQ(span.bytes, span.path == "/main" ? 10 : -1);
+  }
+  EXPECT_EQ(threads.size(), 2u);
+  EXPECT_EQ(Tracer::threadNumber(), spans[0].path == "/main"
+                                      ? spans[0].thread
+                                      : spans[1].thread);
+}
+
+TEST(TraceTest, disabled)
+{
+  Tracer& tracer = Tracer::instance();
+  tracer.start();
+  tracer.stop();
+  EXPECT_FALSE(tracer.enabled());
+
+  {
+    TraceSpan span("work", "test", "/path");
+    EXPECT_FALSE(span.active());
+    span.setBytes(10);
+
+    H5ReadWrite reader(test_file);
+    EXPECT_EQ(reader.getDimensions("/volume"), vector<int>({ 32, 32, 32 }));
+  }
+
+  EXPECT_TRUE(tracer.spans().empty());
+
+  // Starting again discards the earlier spans
+  tracer.start();
+  { TraceSpan span("work", "test"); }
+  EXPECT_EQ(tracer.spans().size(), 1u);
+  tracer.start();
+  EXPECT_TRUE(tracer.spans().empty());
+  tracer.stop();
+
+  // Run this last
+  std::remove(test_file.c_str());
+}
@@ -0,0 +1,241 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <h5cpp/h5dataset.h>
+#include <h5cpp/h5float16.h>
+#include <h5cpp/h5readwrite.h>
+
+using std::string;
+using std::vector;
+
+using h5::DataSet;
+using h5::H5ReadWrite;
+using h5::WriteOptions;
+using h5::float16;
+
+using DataType = H5ReadWrite::DataType;
+
+static const string test_file = "types_test.h5";
+
+// The value of the bits of a half, computed from its fields
+static float referenceHalf(uint16_t bits)
+{
+  const int exponent = (bits >> 10) & 0x1f;
+  const int mantissa = bits & 0x3ff;
+  const float sign = (bits & 0x8000) ? -1.0f : 1.0f;
+  if (exponent == 0)
+    return sign * std::ldexp(static_cast<float>(mantissa), -24);
+
+  if (exponent == 31) {
+    return mantissa == 0 ? sign * std::numeric_limits<float>::infinity()
+                         : std::numeric_limits<float>::quiet_NaN();
+  }
+
+  return sign * std::ldexp(static_cast<float>(mantissa + 1024),
+                           exponent - 25);
+}
+
+TEST(TypesTest, float16Conversion)
+{
+  for (uint32_t i = 0; i < 0x10000; ++i) {
+    const uint16_t bits = static_cast<uint16_t>(i);
+    const float value = h5::halfBitsToFloat(bits);
+    const float expected = referenceHalf(bits);
+    if (std::isnan(expected)) {
+      EXPECT_TRUE(std::isnan(value)) << bits;
+      EXPECT_TRUE(std::isnan(static_cast<float>(float16(value)))) << bits;
+      continue;
+    }
+
+    ASSERT_EQ(value, expected) << bits;
+    ASSERT_EQ(h5::floatToHalfBits(value), bits) << bits;
+  }
+}
+
+TEST(TypesTest, float16Rounding)
+{
+  // Halfway between 1 and the next half rounds to even, above it rounds up
+  EXPECT_EQ(h5::floatToHalfBits(1.0f + std::ldexp(1.0f, -11)), 0x3c00);
+  EXPECT_EQ(h5::floatToHalfBits(1.0f + 3 * std::ldexp(1.0f, -11)), 0x3c02);
+  EXPECT_EQ(h5::floatToHalfBits(1.0f + std::ldexp(1.1f, -11)), 0x3c01);
+
+  // The largest half, and what overflows it
+  EXPECT_EQ(h5::floatToHalfBits(65504.0f), 0x7bff);
+  EXPECT_EQ(h5::floatToHalfBits(65519.0f), 0x7bff);
+  EXPECT_EQ(h5::floatToHalfBits(65520.0f), 0x7c00);
+  EXPECT_EQ(h5::floatToHalfBits(-1e10f), 0xfc00);
+
+  // Subnormals, and what underflows them
+  EXPECT_EQ(h5::floatToHalfBits(std::ldexp(1.0f, -24)), 0x0001);
+  EXPECT_EQ(h5::floatToHalfBits(std::ldexp(1.0f, -25)), 0x0000);
+  EXPECT_EQ(h5::floatToHalfBits(3 * std::ldexp(1.0f, -26)), 0x0001);
+  EXPECT_EQ(h5::floatToHalfBits(-std::ldexp(1.0f, -30)), 0x8000);
+
+  EXPECT_EQ(h5::floatToHalfBits(std::numeric_limits<float>::infinity()),
+            0x7c00);
+  EXPECT_EQ(h5::floatToHalfBits(std::numeric_limits<float>::quiet_NaN()) &
+              0x7e00,
+            0x7e00);
+}
+
+TEST(TypesTest, float16Arrays)
+{
+  vector<float> values(1000);
+  for (size_t i = 0; i < values.size(); ++i)
+    values[i] = (static_cast<float>(i) - 500.0f) * 0.37f;
+
+  vector<float16> halves(values.size());
+  h5::convertFloatToFloat16(values.data(), halves.data(), values.size());
+
+  vector<float> widened(values.size());
+  h5::convertFloat16ToFloat(halves.data(), widened.data(), halves.size());
+
+  for (size_t i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(halves[i].bits, float16(values[i]).bits);
+    EXPECT_EQ(widened[i], static_cast<float>(halves[i]));
+    EXPECT_NEAR(widened[i], values[i], std::abs(values[i]) / 1024);
+  }
+}
+
+TEST(TypesTest, float16DataSet)
+{
+  vector<float16> data;
+  for (int i = 0; i < 24; ++i)
+    data.push_back(float16(i * 0.5f - 3.0f));
+
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(writer.writeData("/", "half", { 2, 3, 4 }, data));
+    ASSERT_TRUE(writer.setAttribute("/half", "scale", float16(0.25f)));
+  }
+
+  H5ReadWrite reader(test_file);
+  EXPECT_EQ(reader.dataType("/half"), DataType::Float16);
+  EXPECT_EQ(reader.attribute<float16>("/half", "scale").bits,
+            float16(0.25f).bits);
+
+  vector<int> dims;
+  vector<float16> halves = reader.readData<float16>("/half", dims);
+  EXPECT_EQ(dims, vector<int>({ 2, 3, 4 }));
+  ASSERT_EQ(halves.size(), data.size());
+  for (size_t i = 0; i < data.size(); ++i)
+    EXPECT_EQ(halves[i].bits, data[i].bits);
+
+  // Float16 data sets are widened when they are read as float
+  vector<float> floats(data.size());
+  ASSERT_TRUE(reader.readData("/half", floats.data()));
+  for (size_t i = 0; i < data.size(); ++i)
+    EXPECT_EQ(floats[i], i * 0.5f - 3.0f);
+
+  vector<float> slab(4);
+  ASSERT_TRUE(reader.readSlab("/half", { 1, 2, 0 }, { 1, 1, 4 },
+                              slab.data()));
+  for (size_t i = 0; i < slab.size(); ++i)
+    EXPECT_EQ(slab[i], (20 + i) * 0.5f - 3.0f);
+
+  // But not as other types
+  vector<double> doubles(data.size());
+  EXPECT_FALSE(reader.readData("/half", doubles.data()));
+
+  DataSet dataSet = reader.openDataSet("/half");
+  EXPECT_EQ(dataSet.type(), DataType::Float16);
+  vector<float> all(data.size());
+  ASSERT_TRUE(dataSet.readData(all.data()));
+  EXPECT_EQ(all, floats);
+}
+
+TEST(TypesTest, storeFloat16)
+{
+  vector<float> data(64 * 64);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = std::sin(i * 0.01f) * 100.0f;
+
+  WriteOptions options;
+  options.storeFloat16 = true;
+
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(writer.writeData("/", "stored", { 64, 64 }, data, options));
+
+    // The option is ignored for other types
+    vector<double> doubles(data.begin(), data.end());
+    ASSERT_TRUE(
+      writer.writeData("/", "doubles", { 64, 64 }, doubles, options));
+
+    // Float writes to Float16 data sets are narrowed too
+    vector<float> row(64, 1.5f);
+    ASSERT_TRUE(writer.writeSlab("/stored", { 10, 0 }, { 1, 64 },
+                                 row.data()));
+  }
+
+  H5ReadWrite reader(test_file);
+  EXPECT_EQ(reader.dataType("/stored"), DataType::Float16);
+  EXPECT_EQ(reader.dataType("/doubles"), DataType::Double);
+
+  vector<int> dims;
+  vector<float> values = reader.readData<float>("/stored", dims);
+  EXPECT_EQ(dims, vector<int>({ 64, 64 }));
+  ASSERT_EQ(values.size(), data.size());
+  for (size_t i = 0; i < data.size(); ++i) {
+    if (i / 64 == 10)
+      EXPECT_EQ(values[i], 1.5f);
+    else
+      EXPECT_EQ(values[i], static_cast<float>(float16(data[i])));
+  }
+}
+
+TEST(TypesTest, complex)
+{
+  vector<std::complex<float>> singles;
+  vector<std::complex<double>> doubles;
+  for (int i = 0; i < 12; ++i) {
+    singles.emplace_back(i * 1.5f, -i * 0.25f);
+    doubles.emplace_back(i * 1e-3, i * 1e3);
+  }
+
+  {
+    H5ReadWrite writer(test_file, H5ReadWrite::OpenMode::WriteOnly);
+    ASSERT_TRUE(writer.writeData("/", "complex64", { 3, 4 }, singles));
+    ASSERT_TRUE(writer.writeData("/", "complex128", { 12 }, doubles));
+    ASSERT_TRUE(writer.setAttribute("/complex128", "phase",
+                                    std::complex<double>(0.5, -2.0)));
+  }
+
+  H5ReadWrite reader(test_file);
+  EXPECT_EQ(reader.dataType("/complex64"), DataType::Complex64);
+  EXPECT_EQ(reader.dataType("/complex128"), DataType::Complex128);
+  EXPECT_EQ(reader.attribute<std::complex<double>>("/complex128", "phase"),
+            std::complex<double>(0.5, -2.0));
+
+  vector<int> dims;
+  EXPECT_EQ(reader.readData<std::complex<float>>("/complex64", dims),
+            singles);
+  EXPECT_EQ(dims, vector<int>({ 3, 4 }));
+  EXPECT_EQ(reader.readData<std::complex<double>>("/complex128"), doubles);
+
+  // The parts are the members "r" and "i", as h5py writes them
+  EXPECT_EQ(reader.compoundMemberType("/complex64", "r"), DataType::Float);
+  EXPECT_EQ(reader.readColumn<double>("/complex128", "i"),
+            vector<double>({ 0, 1e3, 2e3, 3e3, 4e3, 5e3, 6e3, 7e3, 8e3, 9e3,
+                             10e3, 11e3 }));
+
+  vector<std::complex<float>> slab(4);
+  ASSERT_TRUE(reader.readSlab("/complex64", { 2, 0 }, { 1, 4 }, slab.data()));
+  EXPECT_EQ(slab, vector<std::complex<float>>(singles.begin() + 8,
+                                              singles.end()));
+
+  EXPECT_TRUE(
+    reader.readData<std::complex<double>>("/complex64", dims).empty());
+
+  // Run this last
+  std::remove(test_file.c_str());
+}
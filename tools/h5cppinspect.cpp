@@ -0,0 +1,333 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+// h5cpp-inspect prints the groups, data sets and attributes of a file, as
+// a tree or as JSON. Run it with --help for its options.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <h5cpp/h5inspect.h>
+#include <h5cpp/h5readwrite.h>
+
+using std::cerr;
+using std::cout;
+using std::string;
+using std::vector;
+
+using h5::AttributeInfo;
+using h5::H5ReadWrite;
+using h5::InspectOptions;
+using h5::ObjectInfo;
+
+using Kind = ObjectInfo::Kind;
+using Layout = h5::WriteOptions::Layout;
+
+namespace {
+
+const char* usage =
+  "Usage: h5cpp-inspect [options] <file> [path]\n"
+  "\n"
+  "Print the groups, data sets and attributes under path (default /),\n"
+  "with the type, shape, chunks, filters and sizes of each data set.\n"
+  "\n"
+  "Options:\n"
+  "  --json           Print JSON rather than a tree\n"
+  "  --no-attributes  Do not list attributes\n"
+  "  --time           Print the time taken to stderr\n"
+  "  --help           Print this message\n";
+
+string layoutName(Layout layout)
+{
+  switch (layout) {
+    case Layout::Compact:
+      return "Compact";
+    case Layout::Contiguous:
+      return "Contiguous";
+    case Layout::Chunked:
+      return "Chunked";
+    default:
+      return "Other";
+  }
+}
+
+string formatBytes(uint64_t bytes)
+{
+  static const char* units[] = { "KiB", "MiB", "GiB", "TiB", "PiB" };
+  if (bytes < 1024)
+    return std::to_string(bytes) + " B";
+
+  double value = static_cast<double>(bytes) / 1024;
+  int unit = 0;
+  while (value >= 1024 && unit < 4) {
+    value /= 1024;
+    ++unit;
+  }
+
+  std::ostringstream stream;
+  stream << std::fixed << std::setprecision(1) << value << ' ' << units[unit];
+  return stream.str();
+}
+
+string formatDimensions(const vector<int>& dims)
+{
+  string result = "[";
+  for (size_t i = 0; i < dims.size(); ++i) {
+    if (i > 0)
+      result += ", ";
+    result += std::to_string(dims[i]);
+  }
+  return result + "]";
+}
+
+// The last component of a path, or the path itself for the root
+string baseName(const string& path)
+{
+  const size_t slash = path.find_last_of('/');
+  if (slash == string::npos || slash + 1 == path.size())
+    return path;
+
+  return path.substr(slash + 1);
+}
+
+size_t depth(const string& path)
+{
+  size_t result = 0;
+  for (size_t i = 1; i < path.size(); ++i) {
+    if (path[i] == '/')
+      ++result;
+  }
+  return path.size() > 1 ? result + 1 : result;
+}
+
+string quoted(const string& value)
+{
+  string result = "\"";
+  for (char c : value) {
+    switch (c) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      case '\n':
+        result += "\\n";
+        break;
+      case '\t':
+        result += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+          result += escaped;
+        } else {
+          result += c;
+        }
+    }
+  }
+  return result + '"';
+}
+
+string formatNumber(double value, int precision)
+{
+  // JSON has no NaN or infinity
+  if (!std::isfinite(value))
+    return "null";
+
+  std::ostringstream stream;
+  stream << std::setprecision(precision) << value;
+  return stream.str();
+}
+
+string formatValues(const AttributeInfo& attribute, bool json)
+{
+  const int precision = json ? 17 : 10;
+  vector<string> values;
+  for (double number : attribute.numbers)
+    values.push_back(formatNumber(number, precision));
+  for (const string& value : attribute.strings)
+    values.push_back(quoted(value));
+
+  if (values.empty())
+    return json ? "null" : "";
+
+  if (values.size() == 1)
+    return values[0];
+
+  string result = "[";
+  for (size_t i = 0; i < values.size(); ++i) {
+    if (i > 0)
+      result += ", ";
+    result += values[i];
+  }
+  return result + "]";
+}
+
+void printTree(const vector<ObjectInfo>& objects)
+{
+  size_t groups = 0;
+  size_t dataSets = 0;
+  uint64_t logicalBytes = 0;
+  uint64_t storedBytes = 0;
+  const size_t rootDepth = objects.empty() ? 0 : depth(objects[0].path);
+
+  for (const ObjectInfo& object : objects) {
+    const string indent(2 * (depth(object.path) - rootDepth), ' ');
+    cout << indent << baseName(object.path);
+    switch (object.kind) {
+      case Kind::Group:
+        ++groups;
+        if (object.path != "/")
+          cout << '/';
+        break;
+      case Kind::DataSet:
+        ++dataSets;
+        logicalBytes += object.logicalBytes;
+        storedBytes += object.storedBytes;
+
+        cout << "  " << object.typeName << ' '
+             << formatDimensions(object.dimensions) << "  "
+             << layoutName(object.layout);
+        if (!object.chunkDimensions.empty())
+          cout << ' ' << formatDimensions(object.chunkDimensions);
+
+        for (size_t i = 0; i < object.filters.size(); ++i)
+          cout << (i == 0 ? "  " : ", ") << object.filters[i];
+
+        cout << "  " << formatBytes(object.storedBytes) << " stored of "
+             << formatBytes(object.logicalBytes);
+        break;
+      default:
+        cout << "  " << h5::kindToString(object.kind);
+        break;
+    }
+    cout << '\n';
+
+    for (const AttributeInfo& attribute : object.attributes) {
+      cout << indent << "  @" << attribute.name << "  " << attribute.typeName;
+      if (!attribute.dimensions.empty())
+        cout << ' ' << formatDimensions(attribute.dimensions);
+
+      const string values = formatValues(attribute, false);
+      if (!values.empty())
+        cout << " = " << values;
+      cout << '\n';
+    }
+  }
+
+  cout << groups << " groups, " << dataSets << " data sets, "
+       << formatBytes(storedBytes) << " stored of "
+       << formatBytes(logicalBytes) << '\n';
+}
+
+void printJson(const string& fileName, const vector<ObjectInfo>& objects)
+{
+  cout << "{\n  \"file\": " << quoted(fileName) << ",\n  \"objects\": [";
+  for (size_t i = 0; i < objects.size(); ++i) {
+    const ObjectInfo& object = objects[i];
+    cout << (i == 0 ? "\n" : ",\n") << "    { \"path\": "
+         << quoted(object.path)
+         << ", \"kind\": " << quoted(h5::kindToString(object.kind));
+
+    if (object.kind == Kind::DataSet) {
+      cout << ", \"type\": " << quoted(object.typeName)
+           << ", \"dimensions\": " << formatDimensions(object.dimensions)
+           << ", \"layout\": " << quoted(layoutName(object.layout));
+      if (!object.chunkDimensions.empty()) {
+        cout << ", \"chunkDimensions\": "
+             << formatDimensions(object.chunkDimensions);
+      }
+
+      cout << ", \"filters\": [";
+      for (size_t j = 0; j < object.filters.size(); ++j)
+        cout << (j == 0 ? "" : ", ") << quoted(object.filters[j]);
+
+      cout << "], \"logicalBytes\": " << object.logicalBytes
+           << ", \"storedBytes\": " << object.storedBytes;
+    }
+
+    cout << ", \"attributes\": [";
+    for (size_t j = 0; j < object.attributes.size(); ++j) {
+      const AttributeInfo& attribute = object.attributes[j];
+      cout << (j == 0 ? "" : ", ") << "{ \"name\": " << quoted(attribute.name)
+           << ", \"type\": " << quoted(attribute.typeName)
+           << ", \"dimensions\": " << formatDimensions(attribute.dimensions)
+           << ", \"value\": " << formatValues(attribute, true) << " }";
+    }
+    cout << "] }";
+  }
+  cout << "\n  ]\n}\n";
+}
+
+} // end namespace
+
+int main(int argc, char* argv[])
+{
+  bool json = false;
+  bool time = false;
+  InspectOptions options;
+  vector<string> arguments;
+  for (int i = 1; i < argc; ++i) {
+    const string argument = argv[i];
+    if (argument == "--json") {
+      json = true;
+    } else if (argument == "--no-attributes") {
+      options.attributes = false;
+    } else if (argument == "--time") {
+      time = true;
+    } else if (argument == "--help") {
+      cout << usage;
+      return 0;
+    } else if (argument.compare(0, 2, "--") == 0) {
+      cerr << "Unknown option " << argument << "\n\n" << usage;
+      return 1;
+    } else {
+      arguments.push_back(argument);
+    }
+  }
+
+  if (arguments.empty() || arguments.size() > 2) {
+    cerr << usage;
+    return 1;
+  }
+
+  const string fileName = arguments[0];
+  const string path = arguments.size() > 1 ? arguments[1] : "/";
+
+  // Trees of hundreds of thousands of lines are printed
+  std::ios::sync_with_stdio(false);
+
+  auto start = std::chrono::steady_clock::now();
+  bool ok = false;
+  vector<ObjectInfo> objects;
+  {
+    H5ReadWrite file(fileName);
+    objects = h5::inspect(file, path, options, &ok);
+  }
+  const double seconds = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+
+  if (objects.empty())
+    return 1;
+
+  if (json)
+    printJson(fileName, objects);
+  else
+    printTree(objects);
+
+  if (time) {
+    cerr << "Inspected " << objects.size() << " objects in " << std::fixed
+         << std::setprecision(3) << seconds << " s\n";
+  }
+
+  return ok ? 0 : 2;
+}